@@ -0,0 +1,62 @@
+// LICENSE
+// =======
+// Copyright (c) 2017-2019 Advanced Micro Devices, Inc. All rights reserved.
+// -------
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// -------
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+// -------
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE
+#version 450
+#extension  GL_GOOGLE_include_directive : require
+
+// casGroupSize of cas_tile.h
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set=0, binding=0) uniform sampler2D img;
+layout(set=0, binding=1) uniform writeonly image2D outImg;
+
+layout (constant_id = 0) const float sharpness = 0.4;
+
+#include "cas.h"
+#include "cas_tile.h"
+
+// the tile with a border of one pixel
+shared vec4 tile[casApronSize][casApronSize];
+
+vec4 casFetchTexel(ivec2 coord)
+{
+    return texelFetch(img, coord, 0);
+}
+
+vec4 casTileTexel(ivec2 local)
+{
+    return tile[local.y][local.x];
+}
+
+void casStoreTileTexel(ivec2 local, vec4 texel)
+{
+    tile[local.y][local.x] = texel;
+}
+
+void casStorePixel(ivec2 coord, vec4 color)
+{
+    imageStore(outImg, coord, color);
+}
+
+void main()
+{
+    ivec2 size       = textureSize(img, 0);
+    ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * casTileSize;
+
+    casLoadTile(tileOrigin, int(gl_LocalInvocationIndex), size);
+    barrier();
+    casSharpenPixels(tileOrigin, ivec2(gl_LocalInvocationID.xy), size);
+}
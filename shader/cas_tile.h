@@ -0,0 +1,57 @@
+// the tiling of the compute shader of cas, the cpu reference of tests/cas_reference_test.cpp runs the same code.
+// Every invocation of a work group of 8x8 sharpens 2x2 pixels, so a work group covers a tile of 16x16 pixels.
+// The tile with a border of one pixel gets loaded once, so every pixel gets fetched only once instead of 9 times.
+// needs cas.h, the includer defines how the images and the tile get accessed
+
+const int casGroupSize = 8;
+const int casTileSize  = 16;
+const int casApronSize = casTileSize + 2;
+
+// the texel of the input image
+vec4 casFetchTexel(ivec2 coord);
+// the texel at local in the tile with the border
+vec4 casTileTexel(ivec2 local);
+void casStoreTileTexel(ivec2 local, vec4 texel);
+// writes the output image
+void casStorePixel(ivec2 coord, vec4 color);
+
+// the part of the tile with the border that the invocation loads, the work group has to wait for all of it before casSharpenPixels
+void casLoadTile(ivec2 tileOrigin, int invocationIndex, ivec2 size)
+{
+    for (int index = invocationIndex; index < casApronSize * casApronSize; index += casGroupSize * casGroupSize)
+    {
+        ivec2 local = ivec2(index % casApronSize, index / casApronSize);
+        // wraps around like the repeating sampler of the fragment shader
+        casStoreTileTexel(local, casFetchTexel((tileOrigin + local - 1 + size) % size));
+    }
+}
+
+void casSharpenPixels(ivec2 tileOrigin, ivec2 invocation, ivec2 size)
+{
+    for (int y = 0; y < 2; y++)
+    {
+        for (int x = 0; x < 2; x++)
+        {
+            // the position in the tile without the border
+            ivec2 local = invocation * 2 + ivec2(x, y);
+            ivec2 coord = tileOrigin + local;
+            if (coord.x >= size.x || coord.y >= size.y)
+            {
+                continue;
+            }
+
+            // the 3x3 neighborhood around the pixel 'e' starts at local in the tile with the border
+            vec3 a = casTileTexel(local + ivec2(0, 0)).rgb;
+            vec3 b = casTileTexel(local + ivec2(1, 0)).rgb;
+            vec3 c = casTileTexel(local + ivec2(2, 0)).rgb;
+            vec3 d = casTileTexel(local + ivec2(0, 1)).rgb;
+            vec4 e = casTileTexel(local + ivec2(1, 1));
+            vec3 f = casTileTexel(local + ivec2(2, 1)).rgb;
+            vec3 g = casTileTexel(local + ivec2(0, 2)).rgb;
+            vec3 h = casTileTexel(local + ivec2(1, 2)).rgb;
+            vec3 i = casTileTexel(local + ivec2(2, 2)).rgb;
+
+            casStorePixel(coord, vec4(casFilter(a, b, c, d, e.rgb, f, g, h, i), e.a));
+        }
+    }
+}
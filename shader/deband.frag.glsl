@@ -24,6 +24,11 @@
  */
 #version 450
 
+#ifdef FUSE_LUT
+#extension  GL_GOOGLE_include_directive : require
+#include "lut.h"
+#endif
+
 layout(set=0, binding=0) uniform sampler2D img;
 
 layout(constant_id = 0) const float screenWidth = 1920;
@@ -160,5 +165,10 @@ void main()
 	//shift the color by dither_shift
 	res += dither_shift_RGB;
 
+#ifdef FUSE_LUT
+    // the unfused lut reads the clamped color back from the image in between
+    res = applyLut(clamp(res, 0.0, 1.0));
+#endif
+
     fragColor = vec4(res,ori_alpha.a);
 }
@@ -0,0 +1,27 @@
+// applies the color lookup table, used by lut.frag.glsl and by the effects that get the lut fused into their pass.
+// The constant ids start at 16 so that they don't collide with the constants of the effect the lut gets fused into.
+
+layout(set=1, binding=0) uniform sampler3D lut;
+
+//Only works with cubes not with cuboids
+layout(constant_id = 16) const int lutSize = 32;
+//the input range of the lut, DOMAIN_MIN and DOMAIN_MAX of .cube files
+layout(constant_id = 17) const float domainMinR = 0.0;
+layout(constant_id = 18) const float domainMinG = 0.0;
+layout(constant_id = 19) const float domainMinB = 0.0;
+layout(constant_id = 20) const float domainMaxR = 1.0;
+layout(constant_id = 21) const float domainMaxG = 1.0;
+layout(constant_id = 22) const float domainMaxB = 1.0;
+
+vec3 applyLut(vec3 color)
+{
+    vec3 domainMin = vec3(domainMinR, domainMinG, domainMinB);
+    vec3 domainMax = vec3(domainMaxR, domainMaxG, domainMaxB);
+    vec3 coord = clamp((color - domainMin) / (domainMax - domainMin), 0.0, 1.0);
+
+    //see https://developer.nvidia.com/gpugems/GPUGems2/gpugems2_chapter24.html
+    vec3 scale = (vec3(lutSize) - 1.0) / vec3(lutSize);
+    vec3 offset = 1.0 / (2.0 * vec3(lutSize));
+
+    return texture(lut, scale * coord + offset).rgb;
+}
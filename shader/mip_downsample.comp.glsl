@@ -0,0 +1,175 @@
+#version 450
+
+// Generates the mip levels of an image of up to 4096x4096 in a single dispatch, in the style of AMD's single pass downsampler.
+// Every work group reduces a tile of 64x64 texels of level 0 to the levels 1 to 6 in shared memory.
+// The last work group that is done reduces level 6 of all tiles to the remaining levels, it finds out that it is the last one
+// with an atomic counter. Every texel is the average of the 2x2 texels of the level above,
+// a level with a width or height of 1 repeats its last row or column.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// level 0, with a linear sampler that clamps to the edge
+layout(set=0, binding=0) uniform sampler2D img;
+// the levels 1 to 12, the levels the image doesn't have point to its last level
+layout(set=0, binding=1) uniform writeonly image2D mips[12];
+layout(set=0, binding=2) coherent buffer GlobalData
+{
+    uint counter; // the work groups that are done with level 6, the last one resets it for the next dispatch
+    vec4 level6[]; // level 6 of all tiles, a row has one texel per work group
+};
+
+shared vec4 tileA[16][16];
+shared vec4 tileB[8][8];
+shared bool isLast;
+
+int   levelCount;
+int   baseLevel; // 0 for the tiles of level 0, 6 for the single tile of level 6
+ivec2 tile;
+
+ivec2 levelSize(int level)
+{
+    return max(textureSize(img, 0) >> level, ivec2(1));
+}
+
+// the first texel of the tile at level
+ivec2 tileOrigin(int level)
+{
+    return tile * (64 >> (level - baseLevel));
+}
+
+// the last texel of level that is inside of the image, relative to the tile
+ivec2 lastTexel(int level)
+{
+    return max(levelSize(level) - 1 - tileOrigin(level), ivec2(0));
+}
+
+void store(int level, ivec2 local, vec4 value)
+{
+    ivec2 coord = tileOrigin(level) + local;
+    if (level < levelCount && all(lessThan(coord, levelSize(level))))
+    {
+        imageStore(mips[level - 1], coord, value);
+    }
+}
+
+vec4 level6Texel(ivec2 coord)
+{
+    coord = min(coord, levelSize(6) - 1);
+    return level6[coord.y * gl_NumWorkGroups.x + coord.x];
+}
+
+// the texel of level baseLevel + 1 at local in the tile
+vec4 loadFirstLevel(ivec2 local)
+{
+    ivec2 coord = tileOrigin(baseLevel + 1) + local;
+    if (baseLevel == 0)
+    {
+        // the linear sampler averages the 2x2 texels around their shared corner
+        return textureLod(img, vec2(coord * 2 + 1) / vec2(textureSize(img, 0)), 0.0);
+    }
+    return (level6Texel(coord * 2) + level6Texel(coord * 2 + ivec2(1, 0)) + level6Texel(coord * 2 + ivec2(0, 1))
+            + level6Texel(coord * 2 + ivec2(1, 1)))
+           * 0.25;
+}
+
+vec4 reduceTileA(int level, ivec2 local)
+{
+    ivec2 first = min(local * 2, lastTexel(level - 1));
+    ivec2 last  = min(local * 2 + 1, lastTexel(level - 1));
+    return (tileA[first.y][first.x] + tileA[first.y][last.x] + tileA[last.y][first.x] + tileA[last.y][last.x]) * 0.25;
+}
+
+vec4 reduceTileB(int level, ivec2 local)
+{
+    ivec2 first = min(local * 2, lastTexel(level - 1));
+    ivec2 last  = min(local * 2 + 1, lastTexel(level - 1));
+    return (tileB[first.y][first.x] + tileB[first.y][last.x] + tileB[last.y][first.x] + tileB[last.y][last.x]) * 0.25;
+}
+
+// writes the levels baseLevel + 1 to baseLevel + 6 of the tile
+void downsample()
+{
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+
+    // every invocation writes 2x2 texels of the first level and reduces them to one texel of the second level
+    vec4 texels[4];
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 offset = ivec2(i % 2, i / 2);
+        texels[i]    = loadFirstLevel(local * 2 + offset);
+        store(baseLevel + 1, local * 2 + offset, texels[i]);
+    }
+    ivec2 far   = clamp(lastTexel(baseLevel + 1) - local * 2, ivec2(0), ivec2(1));
+    vec4  value = (texels[0] + texels[far.x] + texels[far.y * 2] + texels[far.y * 2 + far.x]) * 0.25;
+    store(baseLevel + 2, local, value);
+    tileA[local.y][local.x] = value;
+    barrier();
+
+    if (all(lessThan(local, ivec2(8))))
+    {
+        value = reduceTileA(baseLevel + 3, local);
+        store(baseLevel + 3, local, value);
+        tileB[local.y][local.x] = value;
+    }
+    barrier();
+
+    if (all(lessThan(local, ivec2(4))))
+    {
+        value = reduceTileB(baseLevel + 4, local);
+        store(baseLevel + 4, local, value);
+        tileA[local.y][local.x] = value;
+    }
+    barrier();
+
+    if (all(lessThan(local, ivec2(2))))
+    {
+        value = reduceTileA(baseLevel + 5, local);
+        store(baseLevel + 5, local, value);
+        tileB[local.y][local.x] = value;
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        value = reduceTileB(baseLevel + 6, local);
+        store(baseLevel + 6, local, value);
+        if (baseLevel == 0)
+        {
+            level6[gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x] = value;
+        }
+    }
+}
+
+void main()
+{
+    levelCount = textureQueryLevels(img);
+    baseLevel  = 0;
+    tile       = ivec2(gl_WorkGroupID.xy);
+    downsample();
+
+    if (levelCount <= 7)
+    {
+        return;
+    }
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        memoryBarrierBuffer();
+        isLast = atomicAdd(counter, 1) == gl_NumWorkGroups.x * gl_NumWorkGroups.y - 1;
+    }
+    barrier();
+    if (!isLast)
+    {
+        return;
+    }
+    // level 6 of the other work groups
+    memoryBarrierBuffer();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        counter = 0;
+    }
+    baseLevel = 6;
+    tile      = ivec2(0);
+    downsample();
+}
@@ -1,6 +1,7 @@
 #include "vulkan_include.hpp"
 
 #include <mutex>
+#include <atomic>
 #include <map>
 #include <vector>
 #include <unordered_map>
@@ -8,12 +9,20 @@
 #include <string>
 #include <memory>
 #include <cstring>
+#include <chrono>
+#include <future>
+#include <thread>
 
 #include "util.hpp"
 #include "keyboard_input.hpp"
 
 #include "logical_device.hpp"
 #include "logical_swapchain.hpp"
+#include "object_map.hpp"
+#include "memory_allocator.hpp"
+#include "thread_pool.hpp"
+#include "transient_memory.hpp"
+#include "upload_batch.hpp"
 
 #include "image_view.hpp"
 #include "sampler.hpp"
@@ -21,6 +30,7 @@
 #include "descriptor_set.hpp"
 #include "shader.hpp"
 #include "graphics_pipeline.hpp"
+#include "pipeline_cache.hpp"
 #include "command_buffer.hpp"
 #include "buffer.hpp"
 #include "config.hpp"
@@ -51,12 +61,12 @@ namespace vkBasalt
     Logger Logger::s_instance;
 
     // layer book-keeping information, to store dispatch tables by key
-    std::unordered_map<void*, VkLayerInstanceDispatchTable>               instanceDispatchMap;
-    std::unordered_map<void*, VkInstance>                                 instanceMap;
-    std::unordered_map<void*, std::shared_ptr<LogicalDevice>>             deviceMap;
-    std::unordered_map<VkSwapchainKHR, std::shared_ptr<LogicalSwapchain>> swapchainMap;
+    // the maps only get locked per shard, the objects themselves have their own mutex for mutable state
+    ObjectMap<void*, VkLayerInstanceDispatchTable>               instanceDispatchMap;
+    ObjectMap<void*, VkInstance>                                 instanceMap;
+    ObjectMap<void*, std::shared_ptr<LogicalDevice>>             deviceMap;
+    ObjectMap<VkSwapchainKHR, std::shared_ptr<LogicalSwapchain>> swapchainMap;
 
-    std::mutex globalLock;
 #ifdef _GCC_
     using scoped_lock __attribute__((unused)) = std::lock_guard<std::mutex>;
 #else
@@ -125,27 +135,20 @@ namespace vkBasalt
         layer_init_instance_dispatch_table(*pInstance, &dispatchTable, gpa);
 
         // store the table by key
-        {
-            scoped_lock l(globalLock);
-            instanceDispatchMap[GetKey(*pInstance)] = dispatchTable;
-            instanceMap[GetKey(*pInstance)]         = *pInstance;
-        }
+        instanceDispatchMap.insert(GetKey(*pInstance), dispatchTable);
+        instanceMap.insert(GetKey(*pInstance), *pInstance);
 
         return ret;
     }
 
     VK_LAYER_EXPORT void VKAPI_CALL vkBasalt_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
     {
-        scoped_lock l(globalLock);
-
         Logger::trace("vkDestroyInstance");
 
-        VkLayerInstanceDispatchTable dispatchTable = instanceDispatchMap[GetKey(instance)];
+        VkLayerInstanceDispatchTable dispatchTable = instanceDispatchMap.remove(GetKey(instance));
+        instanceMap.remove(GetKey(instance));
 
         dispatchTable.DestroyInstance(instance, pAllocator);
-
-        instanceDispatchMap.erase(GetKey(instance));
-        instanceMap.erase(GetKey(instance));
     }
 
     VK_LAYER_EXPORT VkResult VKAPI_CALL vkBasalt_CreateDevice(VkPhysicalDevice             physicalDevice,
@@ -179,10 +182,11 @@ namespace vkBasalt
         // check and activate extentions
         uint32_t extensionCount = 0;
 
-        instanceDispatchMap[GetKey(physicalDevice)].EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+        VkLayerInstanceDispatchTable instanceDispatchTable = instanceDispatchMap.get(GetKey(physicalDevice));
+
+        instanceDispatchTable.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
         std::vector<VkExtensionProperties> extensionProperties(extensionCount);
-        instanceDispatchMap[GetKey(physicalDevice)].EnumerateDeviceExtensionProperties(
-            physicalDevice, nullptr, &extensionCount, extensionProperties.data());
+        instanceDispatchTable.EnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensionProperties.data());
 
         bool supportsMutableFormat = false;
         for (VkExtensionProperties properties : extensionProperties)
@@ -204,6 +208,24 @@ namespace vkBasalt
             supportsMutableFormat = false;
         }
 
+        // compute effects and the mip map generation write storage images, which needs views with a different format than the image
+        // to support the extended usage, and shaders that do not know the format of the image
+        VkPhysicalDeviceFeatures supportedFeatures;
+        instanceDispatchTable.GetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        bool supportsStorageImages = false;
+        if ((pConfig->getOption("casCompute", "off") != "off" || pConfig->getOption("computeMipMaps", "on") == "on")
+            && supportedFeatures.shaderStorageImageWriteWithoutFormat && supportedFeatures.shaderStorageImageArrayDynamicIndexing)
+        {
+            for (VkExtensionProperties properties : extensionProperties)
+            {
+                if (properties.extensionName == std::string("VK_KHR_maintenance2"))
+                {
+                    supportsStorageImages = true;
+                    break;
+                }
+            }
+        }
+
         VkDeviceCreateInfo       modifiedCreateInfo = *pCreateInfo;
         std::vector<const char*> enabledExtensionNames;
         if (modifiedCreateInfo.enabledExtensionCount)
@@ -218,6 +240,11 @@ namespace vkBasalt
             addUniqueCString(enabledExtensionNames, "VK_KHR_swapchain_mutable_format");
         }
         addUniqueCString(enabledExtensionNames, "VK_KHR_image_format_list");
+        if (supportsStorageImages)
+        {
+            Logger::debug("activating maintenance2");
+            addUniqueCString(enabledExtensionNames, "VK_KHR_maintenance2");
+        }
         modifiedCreateInfo.ppEnabledExtensionNames = enabledExtensionNames.data();
         modifiedCreateInfo.enabledExtensionCount   = enabledExtensionNames.size();
 
@@ -228,7 +255,20 @@ namespace vkBasalt
             deviceFeatures = *(modifiedCreateInfo.pEnabledFeatures);
         }
         deviceFeatures.shaderImageGatherExtended = VK_TRUE;
-        modifiedCreateInfo.pEnabledFeatures      = &deviceFeatures;
+        if (supportsStorageImages)
+        {
+            deviceFeatures.shaderStorageImageWriteWithoutFormat   = VK_TRUE;
+            deviceFeatures.shaderStorageImageArrayDynamicIndexing = VK_TRUE;
+        }
+
+        // lets dds textures stay block compressed on the gpu
+        bool supportsTextureCompressionBC = supportedFeatures.textureCompressionBC;
+        if (supportsTextureCompressionBC)
+        {
+            deviceFeatures.textureCompressionBC = VK_TRUE;
+        }
+
+        modifiedCreateInfo.pEnabledFeatures = &deviceFeatures;
 
         VkResult ret = createFunc(physicalDevice, &modifiedCreateInfo, pAllocator, pDevice);
 
@@ -237,45 +277,68 @@ namespace vkBasalt
         layer_init_device_dispatch_table(*pDevice, &dispatchTable, gdpa);
 
         std::shared_ptr<LogicalDevice> pLogicalDevice(new LogicalDevice());
-        pLogicalDevice->vkd                   = dispatchTable;
-        pLogicalDevice->vki                   = instanceDispatchMap[GetKey(physicalDevice)];
-        pLogicalDevice->device                = *pDevice;
-        pLogicalDevice->physicalDevice        = physicalDevice;
-        pLogicalDevice->instance              = instanceMap[GetKey(physicalDevice)];
-        pLogicalDevice->queue                 = VK_NULL_HANDLE;
-        pLogicalDevice->queueFamilyIndex      = 0;
-        pLogicalDevice->commandPool           = VK_NULL_HANDLE;
-        pLogicalDevice->supportsMutableFormat = supportsMutableFormat;
+        pLogicalDevice->vkd                          = dispatchTable;
+        pLogicalDevice->vki                          = instanceDispatchTable;
+        pLogicalDevice->device                       = *pDevice;
+        pLogicalDevice->physicalDevice               = physicalDevice;
+        pLogicalDevice->instance                     = instanceMap.get(GetKey(physicalDevice));
+        pLogicalDevice->queue                        = VK_NULL_HANDLE;
+        pLogicalDevice->queueFamilyIndex             = 0;
+        pLogicalDevice->commandPool                  = VK_NULL_HANDLE;
+        pLogicalDevice->deferSubmitCount             = 0;
+        pLogicalDevice->supportsMutableFormat        = supportsMutableFormat;
+        pLogicalDevice->supportsTextureCompressionBC = supportsTextureCompressionBC;
+        pLogicalDevice->supportsStorageImages        = supportsStorageImages;
+        pLogicalDevice->pipelineCache                = VK_NULL_HANDLE;
+        pLogicalDevice->pipelineCount                = 0;
+        pLogicalDevice->pipelineCreationTime         = 0;
+
+        VkPhysicalDeviceProperties       physicalDeviceProperties;
+        VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
+        instanceDispatchTable.GetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+        instanceDispatchTable.GetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
+        pLogicalDevice->allocator = std::make_unique<MemoryAllocator>(
+            &pLogicalDevice->vkd, *pDevice, physicalDeviceMemoryProperties, physicalDeviceProperties.limits.bufferImageGranularity);
+        pLogicalDevice->resourceCache = std::make_unique<ResourceCache>(&pLogicalDevice->vkd, *pDevice, pLogicalDevice->allocator.get());
+
+        createPipelineCache(pLogicalDevice);
 
         // store the table by key
-        {
-            scoped_lock l(globalLock);
-            deviceMap[GetKey(*pDevice)] = pLogicalDevice;
-        }
+        deviceMap.insert(GetKey(*pDevice), pLogicalDevice);
 
         return ret;
     }
 
     VK_LAYER_EXPORT void VKAPI_CALL vkBasalt_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
     {
-        scoped_lock l(globalLock);
-
         Logger::trace("vkDestroyDevice");
 
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
-        if (pLogicalDevice->commandPool != VK_NULL_HANDLE)
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.remove(GetKey(device));
         {
-            Logger::debug("DestroyCommandPool");
-            pLogicalDevice->vkd.DestroyCommandPool(device, pLogicalDevice->commandPool, pAllocator);
+            scoped_lock l(pLogicalDevice->mutex);
+            destroyPipelineCache(pLogicalDevice);
+            if (pLogicalDevice->commandPool != VK_NULL_HANDLE)
+            {
+                Logger::debug("DestroyCommandPool");
+                flushPendingSubmits(pLogicalDevice, true);
+                pLogicalDevice->vkd.DestroyCommandPool(device, pLogicalDevice->commandPool, pAllocator);
+            }
+            // the swapchains are gone, so all present fences are signaled
+            for (auto& pPresentFence : pLogicalDevice->presentFences)
+            {
+                pLogicalDevice->vkd.DestroyFence(device, pPresentFence->fence, nullptr);
+            }
+            pLogicalDevice->resourceCache.reset();
+            pLogicalDevice->allocator.reset();
         }
 
         pLogicalDevice->vkd.DestroyDevice(device, pAllocator);
-
-        deviceMap.erase(GetKey(device));
     }
 
     static void saveDeviceQueue(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t queueFamilyIndex, VkQueue* pQueue)
     {
+        scoped_lock l(pLogicalDevice->mutex);
+
         if (pLogicalDevice->queue != VK_NULL_HANDLE)
         {
             return; // we allready have a queue
@@ -320,11 +383,9 @@ namespace vkBasalt
 
     VKAPI_ATTR void VKAPI_CALL vkBasalt_GetDeviceQueue2(VkDevice device, const VkDeviceQueueInfo2* pQueueInfo, VkQueue* pQueue)
     {
-        scoped_lock l(globalLock);
-
         Logger::trace("vkGetDeviceQueue2");
 
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
 
         pLogicalDevice->vkd.GetDeviceQueue2(device, pQueueInfo, pQueue);
 
@@ -333,27 +394,116 @@ namespace vkBasalt
 
     VKAPI_ATTR void VKAPI_CALL vkBasalt_GetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue* pQueue)
     {
-        scoped_lock l(globalLock);
-
         Logger::trace("vkGetDeviceQueue");
 
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
 
         pLogicalDevice->vkd.GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
 
         saveDeviceQueue(pLogicalDevice, queueFamilyIndex, pQueue);
     }
 
+    // a lut right after cas or deband gets applied in the pass of that effect, which saves a full screen pass and the images in between.
+    // The lut only looks at the pixel itself, so the result is the same as with two passes.
+    // The compute shader of cas has no lut, so selectComputeEffects has to run first and a cas it selected stays a pass of its own
+    static std::vector<std::string> fuseEffects(const std::vector<std::string>& effectStrings)
+    {
+        std::vector<std::string> fusedStrings;
+        for (uint32_t i = 0; i < effectStrings.size(); i++)
+        {
+            const std::string& effectString = effectStrings[i];
+            bool               nextIsLut    = i + 1 < effectStrings.size() && effectStrings[i + 1] == "lut";
+            if ((effectString == "cas" || effectString == "deband") && nextIsLut)
+            {
+                Logger::debug("fusing " + effectString + " and lut into one pass");
+                fusedStrings.push_back(effectString + "+lut");
+                i++;
+            }
+            else
+            {
+                if (effectString == "cas.compute" && nextIsLut)
+                {
+                    Logger::info("cas runs as compute shader, so the lut after it does not get fused into it");
+                }
+                fusedStrings.push_back(effectString);
+            }
+        }
+        return fusedStrings;
+    }
+
+    // cas can run as compute shader that shares the texels of a tile between the pixels, which is faster on large images.
+    // It is the only effect with a compute shader, auto decides by the resolution alone.
+    // The output images of the compute effects need the storage usage, so this has to be decided before they get created
+    static std::vector<std::string> selectComputeEffects(std::shared_ptr<LogicalSwapchain> pLogicalSwapchain,
+                                                         const std::vector<std::string>&   effectStrings)
+    {
+        std::string computeOption = pConfig->getOption("casCompute", "off");
+        if (computeOption == "off")
+        {
+            return effectStrings;
+        }
+        if (!pLogicalSwapchain->supportsStorageImages)
+        {
+            if (computeOption == "on")
+            {
+                Logger::warn("the swapchain images can't be written by compute shaders, cas runs as fragment shader");
+            }
+            return effectStrings;
+        }
+
+        VkExtent2D extent = pLogicalSwapchain->imageExtent;
+        if (computeOption == "auto" && extent.width * extent.height < 2560 * 1440)
+        {
+            return effectStrings;
+        }
+
+        std::vector<std::string> selectedStrings = effectStrings;
+        for (auto& effectString : selectedStrings)
+        {
+            if (effectString == "cas")
+            {
+                Logger::debug("using the compute shader for cas");
+                effectString = "cas.compute";
+            }
+        }
+        return selectedStrings;
+    }
+
+    // the effects of the swapchain in the order they get applied, with the compute and fused variants already chosen
+    static std::vector<std::string> selectEffects(std::shared_ptr<LogicalSwapchain> pLogicalSwapchain)
+    {
+        std::vector<std::string> effectStrings;
+        std::string              effectOption = pConfig->getOption("effects", "cas");
+
+        while (effectOption != std::string(""))
+        {
+            size_t colon = effectOption.find(":");
+            effectStrings.push_back(effectOption.substr(0, colon));
+            if (colon == std::string::npos)
+            {
+                effectOption = std::string("");
+            }
+            else
+            {
+                effectOption = effectOption.substr(colon + 1);
+            }
+        }
+        effectStrings = selectComputeEffects(pLogicalSwapchain, effectStrings);
+        if (pConfig->getOption("fuseEffects", "on") == "on")
+        {
+            effectStrings = fuseEffects(effectStrings);
+        }
+        return effectStrings;
+    }
+
     VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_CreateSwapchainKHR(VkDevice                        device,
                                                                const VkSwapchainCreateInfoKHR* pCreateInfo,
                                                                const VkAllocationCallbacks*    pAllocator,
                                                                VkSwapchainKHR*                 pSwapchain)
     {
-        scoped_lock l(globalLock);
-
         Logger::trace("vkCreateSwapchainKHR");
 
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
 
         VkSwapchainCreateInfoKHR modifiedCreateInfo = *pCreateInfo;
 
@@ -383,84 +533,56 @@ namespace vkBasalt
 
         modifiedCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
+        VkFormatProperties formatProperties;
+        pLogicalDevice->vki.GetPhysicalDeviceFormatProperties(pLogicalDevice->physicalDevice, unormFormat, &formatProperties);
+        bool supportsStorageImages = pLogicalDevice->supportsStorageImages && pConfig->getOption("casCompute", "off") != "off"
+                                     && (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+        if (supportsStorageImages && pLogicalDevice->supportsMutableFormat)
+        {
+            // the last effect writes the swapchain images directly
+            VkSurfaceCapabilitiesKHR surfaceCapabilities;
+            pLogicalDevice->vki.GetPhysicalDeviceSurfaceCapabilitiesKHR(pLogicalDevice->physicalDevice, pCreateInfo->surface, &surfaceCapabilities);
+            supportsStorageImages = surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT;
+        }
+
         Logger::debug("format " + std::to_string(modifiedCreateInfo.imageFormat));
         std::shared_ptr<LogicalSwapchain> pLogicalSwapchain(new LogicalSwapchain());
-        pLogicalSwapchain->pLogicalDevice      = pLogicalDevice;
-        pLogicalSwapchain->swapchainCreateInfo = *pCreateInfo;
-        pLogicalSwapchain->imageExtent         = modifiedCreateInfo.imageExtent;
-        pLogicalSwapchain->format              = modifiedCreateInfo.imageFormat;
-        pLogicalSwapchain->imageCount          = 0;
+        pLogicalSwapchain->pLogicalDevice        = pLogicalDevice;
+        pLogicalSwapchain->swapchainCreateInfo   = *pCreateInfo;
+        pLogicalSwapchain->imageExtent           = modifiedCreateInfo.imageExtent;
+        pLogicalSwapchain->format                = modifiedCreateInfo.imageFormat;
+        pLogicalSwapchain->supportsStorageImages = supportsStorageImages;
+        pLogicalSwapchain->imageCount            = 0;
+        pLogicalSwapchain->effectsReady          = false;
+        pLogicalSwapchain->effectsActive         = false;
+        pLogicalSwapchain->effectStrings         = selectEffects(pLogicalSwapchain);
+
+        // the storage usage can keep the driver from compressing the swapchain images, so they only get it if a compute effect writes them
+        if (pLogicalDevice->supportsMutableFormat && pLogicalSwapchain->effectStrings.size()
+            && pLogicalSwapchain->effectStrings.back() == "cas.compute")
+        {
+            modifiedCreateInfo.imageUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
+        }
 
         VkResult result = pLogicalDevice->vkd.CreateSwapchainKHR(device, &modifiedCreateInfo, pAllocator, pSwapchain);
 
-        swapchainMap[*pSwapchain] = pLogicalSwapchain;
+        swapchainMap.insert(*pSwapchain, pLogicalSwapchain);
 
         return result;
     }
 
-    VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_GetSwapchainImagesKHR(VkDevice       device,
-                                                                  VkSwapchainKHR swapchain,
-                                                                  uint32_t*      pCount,
-                                                                  VkImage*       pSwapchainImages)
+    // only reads the parts of the swapchain that don't change after vkGetSwapchainImagesKHR, so no lock is needed
+    static std::vector<std::shared_ptr<Effect>> createEffects(std::shared_ptr<LogicalDevice>    pLogicalDevice,
+                                                              std::shared_ptr<LogicalSwapchain> pLogicalSwapchain,
+                                                              const std::vector<std::string>&   effectStrings)
     {
-        scoped_lock l(globalLock);
-        Logger::trace("vkGetSwapchainImagesKHR " + std::to_string(*pCount));
-
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
-
-        if (pSwapchainImages == nullptr)
-        {
-            return pLogicalDevice->vkd.GetSwapchainImagesKHR(device, swapchain, pCount, pSwapchainImages);
-        }
-
-        std::shared_ptr<LogicalSwapchain> pLogicalSwapchain = swapchainMap[swapchain];
-
-        // If the images got already requested once, return them again instead of creating new images
-        if (pLogicalSwapchain->fakeImages.size())
-        {
-            std::memcpy(pSwapchainImages, pLogicalSwapchain->fakeImages.data(), sizeof(VkImage) * (*pCount));
-            return VK_SUCCESS;
-        }
-
-        pLogicalSwapchain->imageCount = *pCount;
-        pLogicalSwapchain->images.reserve(*pCount);
-
-        std::string effectOption = pConfig->getOption("effects", "cas");
-
-        std::vector<std::string> effectStrings;
-        while (effectOption != std::string(""))
-        {
-            size_t colon = effectOption.find(":");
-            effectStrings.push_back(effectOption.substr(0, colon));
-            if (colon == std::string::npos)
-            {
-                effectOption = std::string("");
-            }
-            else
-            {
-                effectOption = effectOption.substr(colon + 1);
-            }
-        }
-
-        pLogicalSwapchain->fakeImages = createFakeSwapchainImages(
-            pLogicalDevice,
-            pLogicalSwapchain->swapchainCreateInfo,
-            *pCount
-                * (effectStrings.size()
-                   + !pLogicalDevice->supportsMutableFormat), // create 1 more set of images when we can't use the swapchain it self
-            pLogicalSwapchain->fakeImageMemory);
-        Logger::debug("created fake swapchain images");
-
-        VkResult result = pLogicalDevice->vkd.GetSwapchainImagesKHR(device, swapchain, pCount, pSwapchainImages);
-        for (unsigned int i = 0; i < *pCount; i++)
-        {
-            pLogicalSwapchain->images.push_back(pSwapchainImages[i]);
-            pSwapchainImages[i] = pLogicalSwapchain->fakeImages[i];
-        }
+        // the cpu heavy parts like compiling reshade effects and decoding textures run in parallel on the thread pool
+        VkFormat   format      = pLogicalSwapchain->format;
+        VkExtent2D imageExtent = pLogicalSwapchain->imageExtent;
 
+        std::vector<std::future<std::shared_ptr<Effect>>> effectFutures;
         for (uint32_t i = 0; i < effectStrings.size(); i++)
         {
-            Logger::debug("current effectString " + effectStrings[i]);
             std::vector<VkImage> firstImages(pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * i,
                                              pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount * (i + 1));
             Logger::debug(std::to_string(firstImages.size()) + " images in firstImages");
@@ -480,49 +602,82 @@ namespace vkBasalt
                 Logger::debug("not using swapchain images as second images");
             }
             Logger::debug(std::to_string(secondImages.size()) + " images in secondImages");
-            if (effectStrings[i] == std::string("fxaa"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new FxaaEffect(
-                    pLogicalDevice, convertToSRGB(pLogicalSwapchain->format), pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                Logger::debug("created FxaaEffect");
-            }
-            else if (effectStrings[i] == std::string("cas"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new CasEffect(
-                    pLogicalDevice, convertToUNORM(pLogicalSwapchain->format), pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                Logger::debug("created CasEffect");
-            }
-            else if (effectStrings[i] == std::string("deband"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new DebandEffect(
-                    pLogicalDevice, convertToUNORM(pLogicalSwapchain->format), pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                Logger::debug("created DebandEffect");
-            }
-            else if (effectStrings[i] == std::string("smaa"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new SmaaEffect(
-                    pLogicalDevice, convertToUNORM(pLogicalSwapchain->format), pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                Logger::debug("created SmaaEffect");
-            }
-            else if (effectStrings[i] == std::string("lut"))
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new LutEffect(
-                    pLogicalDevice, convertToUNORM(pLogicalSwapchain->format), pLogicalSwapchain->imageExtent, firstImages, secondImages, pConfig)));
-                Logger::debug("created LutEffect");
-            }
-            else
-            {
-                pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new ReshadeEffect(pLogicalDevice,
-                                                                                               pLogicalSwapchain->format,
-                                                                                               pLogicalSwapchain->imageExtent,
-                                                                                               firstImages,
-                                                                                               secondImages,
-                                                                                               pConfig,
-                                                                                               effectStrings[i])));
-                Logger::debug("created ReshadeEffect");
-            }
+
+            // the effects only share the device, every effect records its uploads into its own batch,
+            // which gets submitted when the batch goes out of scope after the effect is created
+            effectFutures.push_back(getThreadPool().submit([=, effectString = effectStrings[i]]() -> std::shared_ptr<Effect> {
+                Logger::debug("current effectString " + effectString);
+                MemoryTag           memoryTag(effectString);
+                TransientImageScope transientImageScope(pLogicalSwapchain->transientImageMemory.get(), i);
+                UploadBatch         uploadBatch(pLogicalDevice);
+                if (effectString == std::string("fxaa"))
+                {
+                    Logger::debug("creating FxaaEffect");
+                    return std::shared_ptr<Effect>(
+                        new FxaaEffect(pLogicalDevice, convertToSRGB(format), imageExtent, firstImages, secondImages, pConfig));
+                }
+                else if (effectString == std::string("cas.compute"))
+                {
+                    Logger::debug("creating CasComputeEffect");
+                    return std::shared_ptr<Effect>(
+                        new CasComputeEffect(pLogicalDevice, convertToUNORM(format), imageExtent, firstImages, secondImages, pConfig));
+                }
+                else if (effectString == std::string("cas") || effectString == std::string("cas+lut"))
+                {
+                    Logger::debug("creating CasEffect");
+                    return std::shared_ptr<Effect>(new CasEffect(
+                        pLogicalDevice, convertToUNORM(format), imageExtent, firstImages, secondImages, pConfig, effectString == "cas+lut"));
+                }
+                else if (effectString == std::string("deband") || effectString == std::string("deband+lut"))
+                {
+                    Logger::debug("creating DebandEffect");
+                    return std::shared_ptr<Effect>(new DebandEffect(
+                        pLogicalDevice, convertToUNORM(format), imageExtent, firstImages, secondImages, pConfig, effectString == "deband+lut"));
+                }
+                else if (effectString == std::string("smaa"))
+                {
+                    Logger::debug("creating SmaaEffect");
+                    return std::shared_ptr<Effect>(
+                        new SmaaEffect(pLogicalDevice, convertToUNORM(format), imageExtent, firstImages, secondImages, pConfig));
+                }
+                else if (effectString == std::string("lut"))
+                {
+                    Logger::debug("creating LutEffect");
+                    return std::shared_ptr<Effect>(
+                        new LutEffect(pLogicalDevice, convertToUNORM(format), imageExtent, firstImages, secondImages, pConfig));
+                }
+                else
+                {
+                    Logger::debug("creating ReshadeEffect");
+                    return std::shared_ptr<Effect>(
+                        new ReshadeEffect(pLogicalDevice, format, imageExtent, firstImages, secondImages, pConfig, effectString));
+                }
+            }));
+        }
+
+        // keep the order of the effect option, get() also rethrows if creating an effect failed
+        std::vector<std::shared_ptr<Effect>> effects;
+        for (auto& effectFuture : effectFutures)
+        {
+            effects.push_back(effectFuture.get());
         }
 
+        std::chrono::duration<float, std::milli> effectTime = std::chrono::high_resolution_clock::now() - pLogicalSwapchain->effectStartTime;
+        Logger::info("creating " + std::to_string(effectStrings.size()) + " effects took " + std::to_string(effectTime.count()) + " ms");
+        pLogicalDevice->allocator->logStatistics();
+        pLogicalSwapchain->transientImageMemory->logStatistics();
+
+        return effects;
+    }
+
+    // the caller has to hold the mutex of the device and of the swapchain
+    static void activateEffects(std::shared_ptr<LogicalDevice>       pLogicalDevice,
+                                std::shared_ptr<LogicalSwapchain>    pLogicalSwapchain,
+                                std::vector<std::shared_ptr<Effect>> effects,
+                                std::vector<std::string>             effectNames)
+    {
+        pLogicalSwapchain->effects = std::move(effects);
+
         if (!pLogicalDevice->supportsMutableFormat)
         {
             pLogicalSwapchain->effects.push_back(std::shared_ptr<Effect>(new TransferEffect(
@@ -532,95 +687,258 @@ namespace vkBasalt
                 std::vector<VkImage>(pLogicalSwapchain->fakeImages.end() - pLogicalSwapchain->imageCount, pLogicalSwapchain->fakeImages.end()),
                 pLogicalSwapchain->images,
                 pConfig)));
+            effectNames.push_back("transfer");
+        }
+
+        if (pConfig->getOption("profileEffects", "off") == "on")
+        {
+            pLogicalSwapchain->profiler = std::make_unique<GpuProfiler>(pLogicalDevice,
+                                                                        pLogicalSwapchain->imageCount,
+                                                                        effectNames,
+                                                                        std::stof(pConfig->getOption("profileInterval", "5")),
+                                                                        pConfig->getOption("profileFile"));
+            if (!pLogicalSwapchain->profiler->isSupported())
+            {
+                pLogicalSwapchain->profiler.reset();
+            }
         }
 
         VkImageView depthImageView = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImageViews[0] : VK_NULL_HANDLE;
         VkImage     depthImage     = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImages[0] : VK_NULL_HANDLE;
         VkFormat    depthFormat    = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthFormats[0] : VK_FORMAT_UNDEFINED;
 
-        Logger::debug("effect string count: " + std::to_string(effectStrings.size()));
         Logger::debug("effect count: " + std::to_string(pLogicalSwapchain->effects.size()));
 
         pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
-        Logger::debug("allocated ComandBuffers " + std::to_string(pLogicalSwapchain->commandBuffersEffect.size()) + " for swapchain "
-                      + convertToString(swapchain));
+        Logger::debug("allocated ComandBuffers " + std::to_string(pLogicalSwapchain->commandBuffersEffect.size()));
 
-        writeCommandBuffers(
-            pLogicalDevice, pLogicalSwapchain->effects, depthImage, depthImageView, depthFormat, pLogicalSwapchain->commandBuffersEffect);
+        writeCommandBuffers(pLogicalDevice,
+                            pLogicalSwapchain->effects,
+                            depthImage,
+                            depthImageView,
+                            depthFormat,
+                            pLogicalSwapchain->commandBuffersEffect,
+                            pLogicalSwapchain->transientImageMemory->isAliasing(),
+                            pLogicalSwapchain->profiler.get());
         Logger::debug("wrote CommandBuffers");
 
-        pLogicalSwapchain->semaphores = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
-        Logger::debug("created semaphores");
         for (unsigned int i = 0; i < pLogicalSwapchain->imageCount; i++)
         {
             Logger::debug(std::to_string(i) + " writen commandbuffer " + convertToString(pLogicalSwapchain->commandBuffersEffect[i]));
         }
-        Logger::trace("vkGetSwapchainImagesKHR");
 
-        pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(new TransferEffect(
-            pLogicalDevice,
-            pLogicalSwapchain->format,
-            pLogicalSwapchain->imageExtent,
-            std::vector<VkImage>(pLogicalSwapchain->fakeImages.begin(), pLogicalSwapchain->fakeImages.begin() + pLogicalSwapchain->imageCount),
-            pLogicalSwapchain->images,
-            pConfig));
+        pLogicalSwapchain->effectsReady = true;
+    }
 
-        pLogicalSwapchain->commandBuffersNoEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
+    VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_GetSwapchainImagesKHR(VkDevice       device,
+                                                                  VkSwapchainKHR swapchain,
+                                                                  uint32_t*      pCount,
+                                                                  VkImage*       pSwapchainImages)
+    {
+        Logger::trace("vkGetSwapchainImagesKHR " + std::to_string(*pCount));
 
-        writeCommandBuffers(pLogicalDevice,
-                            {pLogicalSwapchain->defaultTransfer},
-                            VK_NULL_HANDLE,
-                            VK_NULL_HANDLE,
-                            VK_FORMAT_UNDEFINED,
-                            pLogicalSwapchain->commandBuffersNoEffect);
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
 
-        for (unsigned int i = 0; i < pLogicalSwapchain->imageCount; i++)
+        if (pSwapchainImages == nullptr)
         {
-            Logger::debug(std::to_string(i) + " writen commandbuffer " + convertToString(pLogicalSwapchain->commandBuffersNoEffect[i]));
+            return pLogicalDevice->vkd.GetSwapchainImagesKHR(device, swapchain, pCount, pSwapchainImages);
         }
 
+        std::shared_ptr<LogicalSwapchain> pLogicalSwapchain = swapchainMap.get(swapchain);
+
+        std::vector<std::string> effectStrings;
+        VkResult                 result;
+        {
+            // setting up the swapchain needs the command pool and the depth images of the device. Creating the effects can take seconds,
+            // so it happens after the locks got released, otherwise the image functions of the application would wait for it
+            scoped_lock deviceLock(pLogicalDevice->mutex);
+            scoped_lock swapchainLock(pLogicalSwapchain->mutex);
+
+            // If the images got already requested once, return them again instead of creating new images
+            if (pLogicalSwapchain->fakeImages.size())
+            {
+                std::memcpy(pSwapchainImages, pLogicalSwapchain->fakeImages.data(), sizeof(VkImage) * (*pCount));
+                return VK_SUCCESS;
+            }
+
+            pLogicalSwapchain->imageCount = *pCount;
+            pLogicalSwapchain->images.reserve(*pCount);
+
+            effectStrings = pLogicalSwapchain->effectStrings;
+
+            // the first set of images belongs to the application, the other sets are only alive between two effects
+            // create 1 more set of images when we can't use the swapchain it self
+            uint32_t fakeImageSetCount = effectStrings.size() + !pLogicalDevice->supportsMutableFormat;
+
+            MemoryTag            memoryTag("swapchain");
+            std::vector<VkImage> fakeImages = createFakeSwapchainImages(
+                pLogicalDevice, pLogicalSwapchain->swapchainCreateInfo, *pCount, pLogicalSwapchain->fakeImageMemory);
+
+            pLogicalSwapchain->transientImageMemory = std::make_unique<TransientImageMemory>(
+                pLogicalDevice, *pCount, pConfig->getOption("aliasTransientImages", "on") == "on");
+            for (uint32_t i = 1; i < fakeImageSetCount; i++)
+            {
+                // the storage usage can keep the driver from compressing the images, so only the outputs of compute effects get it
+                VkSwapchainCreateInfoKHR fakeImageCreateInfo = pLogicalSwapchain->swapchainCreateInfo;
+                if (effectStrings[i - 1] == "cas.compute")
+                {
+                    fakeImageCreateInfo.imageUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
+                }
+                std::vector<VkImage> transientImages =
+                    createFakeSwapchainImages(pLogicalDevice, fakeImageCreateInfo, *pCount, *pLogicalSwapchain->transientImageMemory, i - 1);
+                fakeImages.insert(fakeImages.end(), transientImages.begin(), transientImages.end());
+            }
+            Logger::debug("created fake swapchain images");
+
+            result = pLogicalDevice->vkd.GetSwapchainImagesKHR(device, swapchain, pCount, pSwapchainImages);
+            for (unsigned int i = 0; i < *pCount; i++)
+            {
+                pLogicalSwapchain->images.push_back(pSwapchainImages[i]);
+                pSwapchainImages[i] = fakeImages[i];
+            }
+
+            // the swapchain can be presented through defaultTransfer right away, even if the effects are not ready yet
+            pLogicalSwapchain->semaphores = createSemaphores(pLogicalDevice, pLogicalSwapchain->imageCount);
+            pLogicalSwapchain->fences.assign(pLogicalSwapchain->imageCount, nullptr);
+            Logger::debug("created semaphores");
+
+            pLogicalSwapchain->defaultTransfer = std::shared_ptr<Effect>(
+                new TransferEffect(pLogicalDevice,
+                                   pLogicalSwapchain->format,
+                                   pLogicalSwapchain->imageExtent,
+                                   std::vector<VkImage>(fakeImages.begin(), fakeImages.begin() + pLogicalSwapchain->imageCount),
+                                   pLogicalSwapchain->images,
+                                   pConfig));
+
+            pLogicalSwapchain->commandBuffersNoEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
+
+            writeCommandBuffers(pLogicalDevice,
+                                {pLogicalSwapchain->defaultTransfer},
+                                VK_NULL_HANDLE,
+                                VK_NULL_HANDLE,
+                                VK_FORMAT_UNDEFINED,
+                                pLogicalSwapchain->commandBuffersNoEffect,
+                                false);
+
+            for (unsigned int i = 0; i < pLogicalSwapchain->imageCount; i++)
+            {
+                Logger::debug(std::to_string(i) + " writen commandbuffer " + convertToString(pLogicalSwapchain->commandBuffersNoEffect[i]));
+            }
+
+            // other callers only get the images once everything that presenting them needs exists
+            pLogicalSwapchain->fakeImages = std::move(fakeImages);
+
+            pLogicalSwapchain->effectStartTime = std::chrono::high_resolution_clock::now();
+            if (pConfig->getOption("asyncEffectCreation", "off") == "on")
+            {
+                // the queue belongs to the application while the effects get created, so the uploads wait for the next present
+                {
+                    scoped_lock submitLock(pLogicalDevice->submitMutex);
+                    pLogicalDevice->deferSubmitCount++;
+                }
+                pLogicalSwapchain->effectThread = std::thread([pLogicalDevice, pLogicalSwapchain, effectStrings]() {
+                    std::vector<std::shared_ptr<Effect>> effects = createEffects(pLogicalDevice, pLogicalSwapchain, effectStrings);
+                    {
+                        scoped_lock submitLock(pLogicalDevice->submitMutex);
+                        pLogicalDevice->deferSubmitCount--;
+                    }
+
+                    scoped_lock deviceLock(pLogicalDevice->mutex);
+                    scoped_lock swapchainLock(pLogicalSwapchain->mutex);
+                    activateEffects(pLogicalDevice, pLogicalSwapchain, std::move(effects), effectStrings);
+                });
+                Logger::trace("vkGetSwapchainImagesKHR");
+                return result;
+            }
+        }
+
+        // until the effects are active the swapchain gets presented through commandBuffersNoEffect
+        std::vector<std::shared_ptr<Effect>> effects = createEffects(pLogicalDevice, pLogicalSwapchain, effectStrings);
+        {
+            scoped_lock deviceLock(pLogicalDevice->mutex);
+            scoped_lock swapchainLock(pLogicalSwapchain->mutex);
+            activateEffects(pLogicalDevice, pLogicalSwapchain, std::move(effects), effectStrings);
+        }
+
+        Logger::trace("vkGetSwapchainImagesKHR");
+
         return result;
     }
 
     VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_QueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
     {
-        scoped_lock l(globalLock);
-
-        static bool pressed       = false;
-        static bool presentEffect = true;
+        static std::atomic<bool> pressed       = false;
+        static std::atomic<bool> presentEffect = true;
 
         if (isKeyPressed(XK_Home))
         {
-            if (!pressed)
+            if (!pressed.exchange(true))
             {
                 presentEffect = !presentEffect;
-                pressed       = true;
             }
         }
         else
         {
-            if (pressed)
-            {
-                pressed = false;
-            }
+            pressed = false;
         }
 
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(queue)];
+        LogicalDevice* pLogicalDevice = deviceMap.getPointer(GetKey(queue));
 
-        std::vector<VkSemaphore> presentSemaphores;
-        presentSemaphores.reserve(pPresentInfo->swapchainCount);
+        // scratch memory that gets reused every frame, so presenting does not allocate once the vectors are big enough
+        static thread_local std::vector<VkSemaphore>                  presentSemaphores;
+        static thread_local std::vector<VkPipelineStageFlags>         waitStages;
+        static thread_local std::vector<VkSubmitInfo>                 submitInfos;
+        static thread_local std::vector<PresentFence**>               submitFences;
+        static thread_local std::vector<std::unique_lock<std::mutex>> swapchainLocks;
 
-        std::vector<VkPipelineStageFlags> waitStages(pPresentInfo->waitSemaphoreCount, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        presentSemaphores.clear();
+        submitInfos.clear();
+        submitFences.clear();
+        swapchainLocks.clear();
+        waitStages.assign(pPresentInfo->waitSemaphoreCount, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
         for (unsigned int i = 0; i < (*pPresentInfo).swapchainCount; i++)
         {
-            uint32_t                          index             = (*pPresentInfo).pImageIndices[i];
-            VkSwapchainKHR                    swapchain         = (*pPresentInfo).pSwapchains[i];
-            std::shared_ptr<LogicalSwapchain> pLogicalSwapchain = swapchainMap[swapchain];
+            uint32_t          index             = (*pPresentInfo).pImageIndices[i];
+            VkSwapchainKHR    swapchain         = (*pPresentInfo).pSwapchains[i];
+            LogicalSwapchain* pLogicalSwapchain = swapchainMap.getPointer(swapchain);
+
+            // only contends with rewriting the command buffers when the depth image changes,
+            // the lock is held until the command buffers got submitted
+            swapchainLocks.emplace_back(pLogicalSwapchain->mutex);
+
+            // swap the effects in once they got created in the background, the uploads they need get submitted first
+            if (pLogicalSwapchain->effectsReady && !pLogicalSwapchain->effectsActive)
+            {
+                flushPendingSubmits(pLogicalSwapchain->pLogicalDevice, false);
+                pLogicalSwapchain->effectsActive = true;
+
+                std::chrono::duration<float, std::milli> readyTime =
+                    std::chrono::high_resolution_clock::now() - pLogicalSwapchain->effectStartTime;
+                Logger::info("effects of swapchain " + convertToString(swapchain) + " are active after " + std::to_string(readyTime.count())
+                             + " ms");
+            }
+
+            // the effects keep per swapchain image state like the uniforms, the last frame of this image has to be done with it
+            if (pLogicalSwapchain->fences[index])
+            {
+                pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &pLogicalSwapchain->fences[index]->fence, VK_TRUE, UINT64_MAX);
+            }
+            submitFences.push_back(&pLogicalSwapchain->fences[index]);
 
             for (auto& effect : pLogicalSwapchain->effects)
             {
-                effect->updateEffect();
+                effect->updateEffect(index);
+            }
+
+            bool useEffects = presentEffect && pLogicalSwapchain->effectsActive;
+            if (pLogicalSwapchain->profiler)
+            {
+                pLogicalSwapchain->profiler->collect(index);
+                if (useEffects)
+                {
+                    pLogicalSwapchain->profiler->markSubmitted(index);
+                }
             }
 
             VkSubmitInfo submitInfo;
@@ -631,19 +949,45 @@ namespace vkBasalt
             submitInfo.pWaitDstStageMask  = i == 0 ? waitStages.data() : nullptr;
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers =
-                presentEffect ? &(pLogicalSwapchain->commandBuffersEffect[index]) : &(pLogicalSwapchain->commandBuffersNoEffect[index]);
+                useEffects ? &(pLogicalSwapchain->commandBuffersEffect[index]) : &(pLogicalSwapchain->commandBuffersNoEffect[index]);
             submitInfo.signalSemaphoreCount = 1;
             submitInfo.pSignalSemaphores    = &(pLogicalSwapchain->semaphores[index]);
 
+            submitInfos.push_back(submitInfo);
             presentSemaphores.push_back(pLogicalSwapchain->semaphores[index]);
+        }
 
-            VkResult vr = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
+        // the upload batches of effects that get created on other threads submit to the same queue
+        scoped_lock submitLock(pLogicalDevice->submitMutex);
 
-            if (vr != VK_SUCCESS)
+        // one submit for all swapchains of this present, every presented image references its fence.
+        // The fences they referenced before got waited on above, a failed submit leaves them signaled for the next frame
+        std::shared_ptr<LogicalDevice>& pSharedDevice = swapchainMap.getPointer(pPresentInfo->pSwapchains[0])->pLogicalDevice;
+        PresentFence*                   pPresentFence = acquirePresentFence(pSharedDevice);
+
+        VkResult vr = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, submitInfos.size(), submitInfos.data(), pPresentFence->fence);
+        if (vr == VK_SUCCESS)
+        {
+            for (PresentFence** ppFence : submitFences)
             {
-                return vr;
+                if (*ppFence)
+                {
+                    releasePresentFence(pSharedDevice, *ppFence);
+                }
+                *ppFence = pPresentFence;
+                pPresentFence->referenceCount++;
             }
         }
+        else
+        {
+            releasePresentFence(pSharedDevice, pPresentFence);
+        }
+        swapchainLocks.clear();
+
+        if (vr != VK_SUCCESS)
+        {
+            return vr;
+        }
 
         VkPresentInfoKHR presentInfo   = *pPresentInfo;
         presentInfo.waitSemaphoreCount = presentSemaphores.size();
@@ -654,13 +998,24 @@ namespace vkBasalt
 
     VKAPI_ATTR void VKAPI_CALL vkBasalt_DestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks* pAllocator)
     {
-        scoped_lock l(globalLock);
         // we need to delete the infos of the oldswapchain
 
         Logger::trace("vkDestroySwapchainKHR " + convertToString(swapchain));
-        swapchainMap[swapchain]->destroy();
-        swapchainMap.erase(swapchain);
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice>    pLogicalDevice    = deviceMap.get(GetKey(device));
+        std::shared_ptr<LogicalSwapchain> pLogicalSwapchain = swapchainMap.remove(swapchain);
+
+        // the effects might still get created in the background, their uploads have to be done before the images get destroyed
+        if (pLogicalSwapchain->effectThread.joinable())
+        {
+            pLogicalSwapchain->effectThread.join();
+        }
+        flushPendingSubmits(pLogicalDevice, true);
+
+        {
+            scoped_lock deviceLock(pLogicalDevice->mutex);
+            scoped_lock swapchainLock(pLogicalSwapchain->mutex);
+            pLogicalSwapchain->destroy();
+        }
 
         pLogicalDevice->vkd.DestroySwapchainKHR(device, swapchain, pAllocator);
     }
@@ -670,9 +1025,7 @@ namespace vkBasalt
                                                         const VkAllocationCallbacks* pAllocator,
                                                         VkImage*                     pImage)
     {
-        scoped_lock l(globalLock);
-
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
         if (isDepthFormat(pCreateInfo->format) && pCreateInfo->samples == VK_SAMPLE_COUNT_1_BIT
             && ((pCreateInfo->usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) == VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT))
         {
@@ -684,6 +1037,8 @@ namespace vkBasalt
             VkImageCreateInfo modifiedCreateInfo = *pCreateInfo;
             modifiedCreateInfo.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
             VkResult result = pLogicalDevice->vkd.CreateImage(device, &modifiedCreateInfo, pAllocator, pImage);
+
+            scoped_lock l(pLogicalDevice->mutex);
             pLogicalDevice->depthImages.push_back(*pImage);
             pLogicalDevice->depthFormats.push_back(pCreateInfo->format);
 
@@ -697,11 +1052,11 @@ namespace vkBasalt
 
     VKAPI_ATTR VkResult VKAPI_CALL vkBasalt_BindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
     {
-        scoped_lock l(globalLock);
-
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
 
         VkResult result = pLogicalDevice->vkd.BindImageMemory(device, image, memory, memoryOffset);
+
+        scoped_lock l(pLogicalDevice->mutex);
         // TODO what if the application creates more than one image before binding memory?
         if (pLogicalDevice->depthImages.size() && image == pLogicalDevice->depthImages.back())
         {
@@ -721,11 +1076,10 @@ namespace vkBasalt
                 return result;
             }
 
-            for (auto& it : swapchainMap)
-            {
-                std::shared_ptr<LogicalSwapchain> pLogicalSwapchain = it.second;
+            swapchainMap.forEach([&](VkSwapchainKHR swapchain, const std::shared_ptr<LogicalSwapchain>& pLogicalSwapchain) {
                 if (pLogicalSwapchain->pLogicalDevice == pLogicalDevice)
                 {
+                    scoped_lock swapchainLock(pLogicalSwapchain->mutex);
                     if (pLogicalSwapchain->commandBuffersEffect.size())
                     {
                         pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device,
@@ -734,24 +1088,29 @@ namespace vkBasalt
                                                                pLogicalSwapchain->commandBuffersEffect.data());
                         pLogicalSwapchain->commandBuffersEffect.clear();
                         pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
-                        Logger::debug("allocated CommandBuffers for swapchain " + convertToString(it.first));
-
-                        writeCommandBuffers(
-                            pLogicalDevice, pLogicalSwapchain->effects, image, depthImageView, depthFormat, pLogicalSwapchain->commandBuffersEffect);
+                        Logger::debug("allocated CommandBuffers for swapchain " + convertToString(swapchain));
+
+                        writeCommandBuffers(pLogicalDevice,
+                                            pLogicalSwapchain->effects,
+                                            image,
+                                            depthImageView,
+                                            depthFormat,
+                                            pLogicalSwapchain->commandBuffersEffect,
+                                            pLogicalSwapchain->transientImageMemory->isAliasing(),
+                                            pLogicalSwapchain->profiler.get());
                         Logger::debug("wrote CommandBuffers");
                     }
                 }
-            }
+            });
         }
         return result;
     }
 
     VKAPI_ATTR void VKAPI_CALL vkBasalt_DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
     {
-        scoped_lock l(globalLock);
-
-        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap[GetKey(device)];
+        std::shared_ptr<LogicalDevice> pLogicalDevice = deviceMap.get(GetKey(device));
 
+        scoped_lock l(pLogicalDevice->mutex);
         for (uint32_t i = 0; i < pLogicalDevice->depthImages.size(); i++)
         {
             if (pLogicalDevice->depthImages[i] == image)
@@ -768,11 +1127,10 @@ namespace vkBasalt
                 VkImageView depthImageView = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImageViews[0] : VK_NULL_HANDLE;
                 VkImage     depthImage     = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthImages[0] : VK_NULL_HANDLE;
                 VkFormat    depthFormat    = pLogicalDevice->depthImageViews.size() ? pLogicalDevice->depthFormats[0] : VK_FORMAT_UNDEFINED;
-                for (auto& it : swapchainMap)
-                {
-                    std::shared_ptr<LogicalSwapchain> pLogicalSwapchain = it.second;
+                swapchainMap.forEach([&](VkSwapchainKHR swapchain, const std::shared_ptr<LogicalSwapchain>& pLogicalSwapchain) {
                     if (pLogicalSwapchain->pLogicalDevice == pLogicalDevice)
                     {
+                        scoped_lock swapchainLock(pLogicalSwapchain->mutex);
                         if (pLogicalSwapchain->commandBuffersEffect.size())
                         {
                             pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device,
@@ -781,18 +1139,20 @@ namespace vkBasalt
                                                                    pLogicalSwapchain->commandBuffersEffect.data());
                             pLogicalSwapchain->commandBuffersEffect.clear();
                             pLogicalSwapchain->commandBuffersEffect = allocateCommandBuffer(pLogicalDevice, pLogicalSwapchain->imageCount);
-                            Logger::debug("allocated CommandBuffers for swapchain " + convertToString(it.first));
+                            Logger::debug("allocated CommandBuffers for swapchain " + convertToString(swapchain));
 
                             writeCommandBuffers(pLogicalDevice,
                                                 pLogicalSwapchain->effects,
                                                 depthImage,
                                                 depthImageView,
                                                 depthFormat,
-                                                pLogicalSwapchain->commandBuffersEffect);
+                                                pLogicalSwapchain->commandBuffersEffect,
+                                                pLogicalSwapchain->transientImageMemory->isAliasing(),
+                                                pLogicalSwapchain->profiler.get());
                             Logger::debug("wrote CommandBuffers");
                         }
                     }
-                }
+                });
             }
         }
 
@@ -855,9 +1215,8 @@ namespace vkBasalt
                 return VK_SUCCESS;
             }
 
-            scoped_lock l(globalLock);
-            return instanceDispatchMap[GetKey(physicalDevice)].EnumerateDeviceExtensionProperties(
-                physicalDevice, pLayerName, pPropertyCount, pProperties);
+            return instanceDispatchMap.get(GetKey(physicalDevice))
+                .EnumerateDeviceExtensionProperties(physicalDevice, pLayerName, pPropertyCount, pProperties);
         }
 
         // don't expose any extensions
@@ -923,10 +1282,7 @@ extern "C"
 
         INTERCEPT_CALLS
 
-        {
-            vkBasalt::scoped_lock l(vkBasalt::globalLock);
-            return vkBasalt::deviceMap[vkBasalt::GetKey(device)]->vkd.GetDeviceProcAddr(device, pName);
-        }
+        return vkBasalt::deviceMap.get(vkBasalt::GetKey(device))->vkd.GetDeviceProcAddr(device, pName);
     }
 
     VK_LAYER_EXPORT PFN_vkVoidFunction VKAPI_CALL vkBasalt_GetInstanceProcAddr(VkInstance instance, const char* pName)
@@ -938,10 +1294,7 @@ extern "C"
 
         INTERCEPT_CALLS
 
-        {
-            vkBasalt::scoped_lock l(vkBasalt::globalLock);
-            return vkBasalt::instanceDispatchMap[vkBasalt::GetKey(instance)].GetInstanceProcAddr(instance, pName);
-        }
+        return vkBasalt::instanceDispatchMap.get(vkBasalt::GetKey(instance)).GetInstanceProcAddr(instance, pName);
     }
 
 } // extern "C"
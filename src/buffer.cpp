@@ -8,7 +8,7 @@ namespace vkBasalt
                       VkBufferUsageFlags             usage,
                       VkMemoryPropertyFlags          properties,
                       VkBuffer&                      buffer,
-                      VkDeviceMemory&                bufferMemory)
+                      MemoryAllocation&              bufferMemory)
     {
         VkBufferCreateInfo bufferInfo = {};
 
@@ -23,16 +23,9 @@ namespace vkBasalt
         VkMemoryRequirements memRequirements;
         pLogicalDevice->vkd.GetBufferMemoryRequirements(pLogicalDevice->device, buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo = {};
+        bufferMemory = allocateMemory(pLogicalDevice, memRequirements, properties, true);
 
-        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize  = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryTypeIndex(pLogicalDevice, memRequirements.memoryTypeBits, properties);
-
-        result = pLogicalDevice->vkd.AllocateMemory(pLogicalDevice->device, &allocInfo, nullptr, &bufferMemory);
-        ASSERT_VULKAN(result);
-
-        result = pLogicalDevice->vkd.BindBufferMemory(pLogicalDevice->device, buffer, bufferMemory, 0);
+        result = pLogicalDevice->vkd.BindBufferMemory(pLogicalDevice->device, buffer, bufferMemory.memory, bufferMemory.offset);
         ASSERT_VULKAN(result);
     }
 
@@ -18,7 +18,7 @@ namespace vkBasalt
                       VkBufferUsageFlags             usage,
                       VkMemoryPropertyFlags          properties,
                       VkBuffer&                      buffer,
-                      VkDeviceMemory&                bufferMemory);
+                      MemoryAllocation&              bufferMemory);
 }
 
 #endif // BUFFER_HPP_INCLUDED
@@ -0,0 +1,68 @@
+#include "builtin_shaders.hpp"
+
+// every shader of the shader directory, the symbol name and the name of the SPIR-V file
+#define BUILTIN_SHADERS(X)                                                                                                                           \
+    X(cas_comp, "cas.comp.spv")                                                                                                                      \
+    X(cas_frag, "cas.frag.spv")                                                                                                                      \
+    X(cas_lut_frag, "cas_lut.frag.spv")                                                                                                              \
+    X(deband_frag, "deband.frag.spv")                                                                                                                \
+    X(deband_lut_frag, "deband_lut.frag.spv")                                                                                                        \
+    X(full_screen_triangle_vert, "full_screen_triangle.vert.spv")                                                                                    \
+    X(fxaa_frag, "fxaa.frag.spv")                                                                                                                    \
+    X(lut_frag, "lut.frag.spv")                                                                                                                      \
+    X(mip_downsample_comp, "mip_downsample.comp.spv")                                                                                                \
+    X(smaa_blend_frag, "smaa_blend.frag.spv")                                                                                                        \
+    X(smaa_blend_vert, "smaa_blend.vert.spv")                                                                                                        \
+    X(smaa_edge_vert, "smaa_edge.vert.spv")                                                                                                          \
+    X(smaa_edge_color_frag, "smaa_edge_color.frag.spv")                                                                                              \
+    X(smaa_edge_luma_frag, "smaa_edge_luma.frag.spv")                                                                                                \
+    X(smaa_neighbor_frag, "smaa_neighbor.frag.spv")                                                                                                  \
+    X(smaa_neighbor_vert, "smaa_neighbor.vert.spv")
+
+// VKBASALT_SHADER_BUILD_DIR is set by the makefile to the directory that shader/makefile writes the optimized SPIR-V to.
+// The files get included as they are with .incbin, the symbols are hidden so that they don't leak out of the layer.
+#define INCLUDE_BUILTIN_SHADER(symbol, fileName)                                                                                                     \
+    asm(".pushsection .rodata\n"                                                                                                                     \
+        ".balign 4\n"                                                                                                                                \
+        ".global vkBasalt_shader_" #symbol "\n"                                                                                                      \
+        ".hidden vkBasalt_shader_" #symbol "\n"                                                                                                      \
+        "vkBasalt_shader_" #symbol ":\n"                                                                                                             \
+        ".incbin \"" VKBASALT_SHADER_BUILD_DIR "/" fileName "\"\n"                                                                                   \
+        ".global vkBasalt_shader_" #symbol "_end\n"                                                                                                  \
+        ".hidden vkBasalt_shader_" #symbol "_end\n"                                                                                                  \
+        "vkBasalt_shader_" #symbol "_end:\n"                                                                                                         \
+        ".popsection\n");                                                                                                                            \
+    extern "C" const char vkBasalt_shader_##symbol[];                                                                                                \
+    extern "C" const char vkBasalt_shader_##symbol##_end[];
+
+#define BUILTIN_SHADER_ENTRY(symbol, fileName) {fileName, vkBasalt_shader_##symbol, vkBasalt_shader_##symbol##_end},
+
+BUILTIN_SHADERS(INCLUDE_BUILTIN_SHADER)
+
+namespace vkBasalt
+{
+    namespace
+    {
+        struct BuiltinShader
+        {
+            const char* name;
+            const char* begin;
+            const char* end;
+        };
+
+        const BuiltinShader builtinShaders[] = {BUILTIN_SHADERS(BUILTIN_SHADER_ENTRY)};
+    } // namespace
+
+    bool getBuiltinShader(const std::string& name, std::vector<char>& code)
+    {
+        for (const auto& shader : builtinShaders)
+        {
+            if (name == shader.name)
+            {
+                code.assign(shader.begin, shader.end);
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace vkBasalt
@@ -0,0 +1,13 @@
+#ifndef BUILTIN_SHADERS_HPP_INCLUDED
+#define BUILTIN_SHADERS_HPP_INCLUDED
+#include <vector>
+#include <string>
+
+namespace vkBasalt
+{
+    // Returns the SPIR-V of a shader from the shader directory that got linked into the layer, e.g. "cas.frag.spv".
+    // Returns false if there is no builtin shader with that name.
+    bool getBuiltinShader(const std::string& name, std::vector<char>& code);
+} // namespace vkBasalt
+
+#endif // BUILTIN_SHADERS_HPP_INCLUDED
@@ -2,6 +2,7 @@
 
 #include "format.hpp"
 #include "util.hpp"
+#include "memory.hpp"
 
 namespace vkBasalt
 {
@@ -31,7 +32,9 @@ namespace vkBasalt
                              VkImage                                        depthImage,
                              VkImageView                                    depthImageView,
                              VkFormat                                       depthFormat,
-                             std::vector<VkCommandBuffer>                   commandBuffers)
+                             std::vector<VkCommandBuffer>                   commandBuffers,
+                             bool                                           aliasing,
+                             GpuProfiler*                                   pProfiler)
     {
         VkCommandBufferBeginInfo beginInfo = {};
 
@@ -51,58 +54,51 @@ namespace vkBasalt
             VkResult result = pLogicalDevice->vkd.BeginCommandBuffer(commandBuffers[i], &beginInfo);
             ASSERT_VULKAN(result);
 
-            VkImageMemoryBarrier memoryBarrier;
-            memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            memoryBarrier.pNext               = nullptr;
-            memoryBarrier.image               = depthImage;
-            memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            memoryBarrier.srcAccessMask       = 0;
-            memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-            memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            memoryBarrier.subresourceRange.aspectMask =
-                isStencilFormat(depthFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
-            memoryBarrier.subresourceRange.baseMipLevel   = 0;
-            memoryBarrier.subresourceRange.levelCount     = 1;
-            memoryBarrier.subresourceRange.baseArrayLayer = 0;
-            memoryBarrier.subresourceRange.layerCount     = 1;
+            if (pProfiler)
+            {
+                pProfiler->beginCommandBuffer(i, commandBuffers[i]);
+            }
+
+            ImageStateTracker imageStates(pLogicalDevice, commandBuffers[i]);
 
+            // the depth image stays in the layout the application uses, the effects read it in the layout for sampling
             if (depthImageView)
             {
-                pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
-                                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                       0,
-                                                       0,
-                                                       nullptr,
-                                                       0,
-                                                       nullptr,
-                                                       1,
-                                                       &memoryBarrier);
+                imageStates.addImage(depthImage,
+                                     VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                     isStencilFormat(depthFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT
+                                                                  : VK_IMAGE_ASPECT_DEPTH_BIT);
+                imageStates.use(
+                    depthImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
             }
 
             for (uint32_t j = 0; j < effects.size(); j++)
             {
+                // the transient images of an effect can share memory with the images of the previous effects,
+                // so an effect must not start to write before the previous effects are done with that memory
+                if (j > 0 && aliasing)
+                {
+                    imageStates.memoryBarrier();
+                }
                 Logger::debug("before applying effect " + convertToString(effects[j]));
-                effects[j]->applyEffect(i, commandBuffers[i]);
+                if (pProfiler)
+                {
+                    pProfiler->beginEffectScope(commandBuffers[i], j);
+                }
+                effects[j]->applyEffect(i, commandBuffers[i], imageStates);
+                if (pProfiler)
+                {
+                    pProfiler->endScope(commandBuffers[i]);
+                }
             }
 
-            memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            memoryBarrier.dstAccessMask = 0;
-            if (depthImageView)
+            imageStates.finish();
+            Logger::debug("recorded " + std::to_string(imageStates.getBarrierCount()) + " pipeline barriers for " + std::to_string(effects.size())
+                          + " effects");
+
+            if (pProfiler)
             {
-                pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffers[i],
-                                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                                       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                                                       0,
-                                                       0,
-                                                       nullptr,
-                                                       0,
-                                                       nullptr,
-                                                       1,
-                                                       &memoryBarrier);
+                pProfiler->endCommandBuffer();
             }
 
             result = pLogicalDevice->vkd.EndCommandBuffer(commandBuffers[i]);
@@ -125,4 +121,48 @@ namespace vkBasalt
         return semaphores;
     }
 
+    std::vector<VkFence> createFences(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count)
+    {
+        std::vector<VkFence> fences(count);
+        VkFenceCreateInfo    info;
+        info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        info.pNext = nullptr;
+        info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &info, nullptr, &fences[i]);
+        }
+        return fences;
+    }
+
+    PresentFence* acquirePresentFence(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        if (pLogicalDevice->freePresentFences.empty())
+        {
+            VkFenceCreateInfo info;
+            info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            info.pNext = nullptr;
+            info.flags = 0;
+
+            pLogicalDevice->presentFences.push_back(std::make_unique<PresentFence>());
+            PresentFence* pPresentFence   = pLogicalDevice->presentFences.back().get();
+            pPresentFence->referenceCount = 0;
+            pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &info, nullptr, &pPresentFence->fence);
+            return pPresentFence;
+        }
+
+        PresentFence* pPresentFence = pLogicalDevice->freePresentFences.back();
+        pLogicalDevice->freePresentFences.pop_back();
+        pLogicalDevice->vkd.ResetFences(pLogicalDevice->device, 1, &pPresentFence->fence);
+        return pPresentFence;
+    }
+
+    void releasePresentFence(std::shared_ptr<LogicalDevice> pLogicalDevice, PresentFence* pPresentFence)
+    {
+        if (pPresentFence->referenceCount == 0 || --pPresentFence->referenceCount == 0)
+        {
+            pLogicalDevice->freePresentFences.push_back(pPresentFence);
+        }
+    }
 } // namespace vkBasalt
@@ -12,19 +12,32 @@
 #include "logical_device.hpp"
 
 #include "effect.hpp"
+#include "gpu_profiler.hpp"
+#include "image_state_tracker.hpp"
 namespace vkBasalt
 {
 
     std::vector<VkCommandBuffer> allocateCommandBuffer(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count);
 
+    // aliasing has to be set if the transient images of different effects can share memory
     void writeCommandBuffers(std::shared_ptr<LogicalDevice>                 pLogicalDevice,
                              std::vector<std::shared_ptr<vkBasalt::Effect>> effects,
                              VkImage                                        depthImage,
                              VkImageView                                    depthImageView,
                              VkFormat                                       depthFormat,
-                             std::vector<VkCommandBuffer>                   commandBuffers);
+                             std::vector<VkCommandBuffer>                   commandBuffers,
+                             bool                                           aliasing,
+                             GpuProfiler*                                   pProfiler = nullptr);
 
     std::vector<VkSemaphore> createSemaphores(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count);
+
+    // the fences start signaled
+    std::vector<VkFence> createFences(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count);
+
+    // an unsignaled fence for the submit of a present, without references. The caller holds submitMutex
+    PresentFence* acquirePresentFence(std::shared_ptr<LogicalDevice> pLogicalDevice);
+    // drops one reference, a fence that never got one goes straight back. It has to be signaled or never submitted by then, the caller holds submitMutex
+    void releasePresentFence(std::shared_ptr<LogicalDevice> pLogicalDevice, PresentFence* pPresentFence);
 } // namespace vkBasalt
 
 #endif // COMMAND_BUFFER_HPP_INCLUDED
@@ -0,0 +1,35 @@
+#include "compute_pipeline.hpp"
+
+#include "pipeline_cache.hpp"
+
+namespace vkBasalt
+{
+    VkPipeline createComputePipeline(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                     VkShaderModule                 computeModule,
+                                     VkSpecializationInfo*          computeSpecializationInfo,
+                                     std::string                    computeEntryPoint,
+                                     VkPipelineLayout               pipelineLayout)
+    {
+        VkPipeline pipeline;
+
+        VkComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.pNext                     = nullptr;
+        pipelineCreateInfo.flags                     = 0;
+        pipelineCreateInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.pNext               = nullptr;
+        pipelineCreateInfo.stage.flags               = 0;
+        pipelineCreateInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineCreateInfo.stage.module              = computeModule;
+        pipelineCreateInfo.stage.pName               = computeEntryPoint.c_str();
+        pipelineCreateInfo.stage.pSpecializationInfo = computeSpecializationInfo;
+        pipelineCreateInfo.layout                    = pipelineLayout;
+        pipelineCreateInfo.basePipelineHandle        = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex         = -1;
+
+        VkResult result = createCachedComputePipeline(pLogicalDevice, &pipelineCreateInfo, &pipeline);
+        ASSERT_VULKAN(result);
+
+        return pipeline;
+    }
+} // namespace vkBasalt
@@ -0,0 +1,21 @@
+#ifndef COMPUTE_PIPELINE_HPP_INCLUDED
+#define COMPUTE_PIPELINE_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // the layout can come from createGraphicsPipelineLayout, it does not depend on the stages
+    VkPipeline createComputePipeline(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                     VkShaderModule                 computeModule,
+                                     VkSpecializationInfo*          computeSpecializationInfo,
+                                     std::string                    computeEntryPoint,
+                                     VkPipelineLayout               pipelineLayout);
+} // namespace vkBasalt
+
+#endif // COMPUTE_PIPELINE_HPP_INCLUDED
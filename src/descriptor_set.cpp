@@ -27,11 +27,9 @@ namespace vkBasalt
 
     VkDescriptorSetLayout createUniformBufferDescriptorSetLayout(std::shared_ptr<LogicalDevice> pLogicalDevice)
     {
-        VkDescriptorSetLayout descriptorSetLayout;
-
         VkDescriptorSetLayoutBinding descriptorSetLayoutBinding;
         descriptorSetLayoutBinding.binding            = 0;
-        descriptorSetLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorSetLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         descriptorSetLayoutBinding.descriptorCount    = 1;
         descriptorSetLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT;
         descriptorSetLayoutBinding.pImmutableSamplers = nullptr;
@@ -43,17 +41,14 @@ namespace vkBasalt
         descriptorSetCreateInfo.bindingCount = 1;
         descriptorSetCreateInfo.pBindings    = &descriptorSetLayoutBinding;
 
-        VkResult result =
-            pLogicalDevice->vkd.CreateDescriptorSetLayout(pLogicalDevice->device, &descriptorSetCreateInfo, nullptr, &descriptorSetLayout);
-        ASSERT_VULKAN(result)
-
-        return descriptorSetLayout;
+        return pLogicalDevice->resourceCache->getDescriptorSetLayout(descriptorSetCreateInfo);
     }
 
     VkDescriptorSet writeBufferDescriptorSet(std::shared_ptr<LogicalDevice> pLogicalDevice,
                                              VkDescriptorPool               descriptorPool,
                                              VkDescriptorSetLayout          descriptorSetLayout,
-                                             VkBuffer                       buffer)
+                                             VkBuffer                       buffer,
+                                             VkDeviceSize                   range)
     {
         VkDescriptorSet descriptorSet;
 
@@ -70,7 +65,7 @@ namespace vkBasalt
         VkDescriptorBufferInfo bufferInfo;
         bufferInfo.buffer = buffer;
         bufferInfo.offset = 0;
-        bufferInfo.range  = VK_WHOLE_SIZE;
+        bufferInfo.range  = range;
 
         VkWriteDescriptorSet writeDescriptorSet = {};
 
@@ -80,7 +75,7 @@ namespace vkBasalt
         writeDescriptorSet.dstBinding       = 0;
         writeDescriptorSet.dstArrayElement  = 0;
         writeDescriptorSet.descriptorCount  = 1;
-        writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeDescriptorSet.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet.pImageInfo       = nullptr;
         writeDescriptorSet.pBufferInfo      = &bufferInfo;
         writeDescriptorSet.pTexelBufferView = nullptr;
@@ -93,8 +88,6 @@ namespace vkBasalt
 
     VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count)
     {
-        VkDescriptorSetLayout descriptorSetLayout;
-
         std::vector<VkDescriptorSetLayoutBinding> bindigs(count);
         for (uint32_t i = 0; i < count; i++)
         {
@@ -114,10 +107,7 @@ namespace vkBasalt
         descriptorSetCreateInfo.bindingCount = count;
         descriptorSetCreateInfo.pBindings    = bindigs.data();
 
-        VkResult result =
-            pLogicalDevice->vkd.CreateDescriptorSetLayout(pLogicalDevice->device, &descriptorSetCreateInfo, nullptr, &descriptorSetLayout);
-        ASSERT_VULKAN(result)
-        return descriptorSetLayout;
+        return pLogicalDevice->resourceCache->getDescriptorSetLayout(descriptorSetCreateInfo);
     }
 
     std::vector<VkDescriptorSet> allocateAndWriteImageSamplerDescriptorSets(std::shared_ptr<LogicalDevice>        pLogicalDevice,
@@ -177,4 +167,82 @@ namespace vkBasalt
         }
         return descriptorSets;
     }
+
+    VkDescriptorSetLayout createComputeImageDescriptorSetLayout(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                                uint32_t                       samplerCount,
+                                                                uint32_t                       storageImageCount)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindigs(samplerCount + storageImageCount);
+        for (uint32_t i = 0; i < bindigs.size(); i++)
+        {
+            VkDescriptorSetLayoutBinding descriptorSetLayoutBinding;
+            descriptorSetLayoutBinding.binding = i;
+            descriptorSetLayoutBinding.descriptorType =
+                i < samplerCount ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            descriptorSetLayoutBinding.descriptorCount    = 1;
+            descriptorSetLayoutBinding.stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+            descriptorSetLayoutBinding.pImmutableSamplers = nullptr;
+            bindigs[i]                                    = descriptorSetLayoutBinding;
+        }
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetCreateInfo;
+        descriptorSetCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetCreateInfo.pNext        = nullptr;
+        descriptorSetCreateInfo.flags        = 0;
+        descriptorSetCreateInfo.bindingCount = bindigs.size();
+        descriptorSetCreateInfo.pBindings    = bindigs.data();
+
+        return pLogicalDevice->resourceCache->getDescriptorSetLayout(descriptorSetCreateInfo);
+    }
+
+    std::vector<VkDescriptorSet> allocateAndWriteComputeImageDescriptorSets(std::shared_ptr<LogicalDevice>        pLogicalDevice,
+                                                                            VkDescriptorPool                      descriptorPool,
+                                                                            VkDescriptorSetLayout                 descriptorSetLayout,
+                                                                            VkSampler                             sampler,
+                                                                            std::vector<std::vector<VkImageView>> sampledImageViewsVectors,
+                                                                            std::vector<std::vector<VkImageView>> storageImageViewsVectors)
+    {
+        uint32_t                     bindingCount = sampledImageViewsVectors.size() + storageImageViewsVectors.size();
+        std::vector<VkDescriptorSet> descriptorSets(sampledImageViewsVectors.size() ? sampledImageViewsVectors[0].size()
+                                                                                    : storageImageViewsVectors[0].size());
+
+        std::vector<VkDescriptorSetLayout> layouts(descriptorSets.size(), descriptorSetLayout);
+        VkDescriptorSetAllocateInfo        descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = descriptorSets.size();
+        descriptorSetAllocateInfo.pSetLayouts        = layouts.data();
+
+        VkResult result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, descriptorSets.data());
+        ASSERT_VULKAN(result);
+
+        std::vector<VkDescriptorImageInfo> imageInfos(bindingCount);
+        std::vector<VkWriteDescriptorSet>  writeDescriptorSets(bindingCount);
+        for (unsigned int i = 0; i < descriptorSets.size(); i++)
+        {
+            for (uint32_t j = 0; j < bindingCount; j++)
+            {
+                bool        sampled   = j < sampledImageViewsVectors.size();
+                VkImageView imageView = sampled ? sampledImageViewsVectors[j][i] : storageImageViewsVectors[j - sampledImageViewsVectors.size()][i];
+
+                imageInfos[j].sampler     = sampled ? sampler : VK_NULL_HANDLE;
+                imageInfos[j].imageView   = imageView;
+                imageInfos[j].imageLayout = sampled ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+                writeDescriptorSets[j].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writeDescriptorSets[j].pNext            = nullptr;
+                writeDescriptorSets[j].dstSet           = descriptorSets[i];
+                writeDescriptorSets[j].dstBinding       = j;
+                writeDescriptorSets[j].dstArrayElement  = 0;
+                writeDescriptorSets[j].descriptorCount  = 1;
+                writeDescriptorSets[j].descriptorType   = sampled ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                writeDescriptorSets[j].pImageInfo       = &imageInfos[j];
+                writeDescriptorSets[j].pBufferInfo      = nullptr;
+                writeDescriptorSets[j].pTexelBufferView = nullptr;
+            }
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+        }
+        return descriptorSets;
+    }
 } // namespace vkBasalt
@@ -15,12 +15,15 @@ namespace vkBasalt
 {
     VkDescriptorPool createDescriptorPool(std::shared_ptr<LogicalDevice> pLogicalDevice, const std::vector<VkDescriptorPoolSize>& poolSizes);
 
+    // the uniform buffer is dynamic, so that every command buffer can read its own slice of the buffer
     VkDescriptorSetLayout createUniformBufferDescriptorSetLayout(std::shared_ptr<LogicalDevice> pLogicalDevice);
 
+    // range is the size of one slice
     VkDescriptorSet writeBufferDescriptorSet(std::shared_ptr<LogicalDevice> pLogicalDevice,
                                              VkDescriptorPool               descriptorPool,
                                              VkDescriptorSetLayout          descriptorSetLayout,
-                                             VkBuffer                       buffer);
+                                             VkBuffer                       buffer,
+                                             VkDeviceSize                   range);
 
     VkDescriptorSetLayout createImageSamplerDescriptorSetLayout(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count);
 
@@ -29,6 +32,19 @@ namespace vkBasalt
                                                                             VkDescriptorSetLayout                 descriptorSetLayout,
                                                                             std::vector<VkSampler>                samplers,
                                                                             std::vector<std::vector<VkImageView>> imageViewsVectors);
+
+    // for compute shaders, the sampled images come first and the storage images after them
+    VkDescriptorSetLayout createComputeImageDescriptorSetLayout(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                                uint32_t                       samplerCount,
+                                                                uint32_t                       storageImageCount);
+
+    // the storage images are in VK_IMAGE_LAYOUT_GENERAL
+    std::vector<VkDescriptorSet> allocateAndWriteComputeImageDescriptorSets(std::shared_ptr<LogicalDevice>        pLogicalDevice,
+                                                                            VkDescriptorPool                      descriptorPool,
+                                                                            VkDescriptorSetLayout                 descriptorSetLayout,
+                                                                            VkSampler                             sampler,
+                                                                            std::vector<std::vector<VkImageView>> sampledImageViewsVectors,
+                                                                            std::vector<std::vector<VkImageView>> storageImageViewsVectors);
 } // namespace vkBasalt
 
 #endif // DESCRIPTOR_SET_HPP_INCLUDED
@@ -9,13 +9,17 @@
 
 #include "vulkan_include.hpp"
 
+#include "image_state_tracker.hpp"
+
 namespace vkBasalt
 {
     class Effect
     {
     public:
-        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) = 0;
-        void virtual updateEffect(){};
+        // the effect declares its image accesses to imageStates and flushes the barriers before it records its commands
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) = 0;
+        // gets called before the command buffer of imageIndex gets submitted, after the last submit of it is done
+        void virtual updateEffect(uint32_t imageIndex){};
         void virtual useDepthImage(VkImageView depthImageView){};
         virtual ~Effect(){};
 
@@ -18,10 +18,11 @@ namespace vkBasalt
                          VkExtent2D                        imageExtent,
                          std::vector<VkImage>              inputImages,
                          std::vector<VkImage>              outputImages,
-                         std::shared_ptr<vkBasalt::Config> pConfig)
+                         std::shared_ptr<vkBasalt::Config> pConfig,
+                         bool                              fuseLut)
     {
         std::string fullScreenRectFile = "full_screen_triangle.vert.spv";
-        std::string casFragmentFile    = "cas.frag.spv";
+        std::string casFragmentFile    = fuseLut ? "cas_lut.frag.spv" : "cas.frag.spv";
 
         float sharpness = std::stod(pConfig->getOption("casSharpness", "0.4"));
 
@@ -33,18 +34,73 @@ namespace vkBasalt
         sharpnessMapEntry.offset     = 0;
         sharpnessMapEntry.size       = sizeof(float);
 
+        std::vector<VkSpecializationMapEntry> specMapEntrys = {sharpnessMapEntry};
+        std::vector<char>                     specData(sizeof(float));
+        std::memcpy(specData.data(), &sharpness, sizeof(float));
+
+        if (fuseLut)
+        {
+            lutTexture = std::make_unique<LutTexture>(pLogicalDevice, pConfig);
+            lutTexture->addSpecialization(specMapEntrys, specData);
+            descriptorSetLayouts.push_back(lutTexture->descriptorSetLayout);
+        }
+
         VkSpecializationInfo fragmentSpecializationInfo;
-        fragmentSpecializationInfo.mapEntryCount = 1;
-        fragmentSpecializationInfo.pMapEntries   = &sharpnessMapEntry;
-        fragmentSpecializationInfo.dataSize      = sizeof(float);
-        fragmentSpecializationInfo.pData         = &sharpness;
+        fragmentSpecializationInfo.mapEntryCount = specMapEntrys.size();
+        fragmentSpecializationInfo.pMapEntries   = specMapEntrys.data();
+        fragmentSpecializationInfo.dataSize      = specData.size();
+        fragmentSpecializationInfo.pData         = specData.data();
 
         pVertexSpecInfo   = nullptr;
         pFragmentSpecInfo = &fragmentSpecializationInfo;
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+
+        if (lutTexture)
+        {
+            lutTexture->createDescriptorSet(sampler);
+        }
     }
     CasEffect::~CasEffect()
     {
     }
+    void CasEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates)
+    {
+        if (lutTexture)
+        {
+            lutTexture->bind(commandBuffer, pipelineLayout);
+        }
+        SimpleEffect::applyEffect(imageIndex, commandBuffer, imageStates);
+    }
+
+    CasComputeEffect::CasComputeEffect(std::shared_ptr<LogicalDevice>    pLogicalDevice,
+                                       VkFormat                          format,
+                                       VkExtent2D                        imageExtent,
+                                       std::vector<VkImage>              inputImages,
+                                       std::vector<VkImage>              outputImages,
+                                       std::shared_ptr<vkBasalt::Config> pConfig)
+    {
+        float sharpness = std::stod(pConfig->getOption("casSharpness", "0.4"));
+
+        computeCode = readFile("cas.comp.spv");
+        tileSize    = 16;
+
+        VkSpecializationMapEntry sharpnessMapEntry;
+        sharpnessMapEntry.constantID = 0;
+        sharpnessMapEntry.offset     = 0;
+        sharpnessMapEntry.size       = sizeof(float);
+
+        VkSpecializationInfo computeSpecializationInfo;
+        computeSpecializationInfo.mapEntryCount = 1;
+        computeSpecializationInfo.pMapEntries   = &sharpnessMapEntry;
+        computeSpecializationInfo.dataSize      = sizeof(float);
+        computeSpecializationInfo.pData         = &sharpness;
+
+        pComputeSpecInfo = &computeSpecializationInfo;
+
+        init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+    }
+    CasComputeEffect::~CasComputeEffect()
+    {
+    }
 } // namespace vkBasalt
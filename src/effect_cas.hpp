@@ -11,6 +11,8 @@
 #include "vulkan_include.hpp"
 
 #include "effect_simple.hpp"
+#include "effect_compute.hpp"
+#include "effect_lut.hpp"
 #include "config.hpp"
 
 namespace vkBasalt
@@ -23,8 +25,28 @@ namespace vkBasalt
                   VkExtent2D                        imageExtent,
                   std::vector<VkImage>              inputImages,
                   std::vector<VkImage>              outputImages,
-                  std::shared_ptr<vkBasalt::Config> pConfig);
+                  std::shared_ptr<vkBasalt::Config> pConfig,
+                  bool                              fuseLut = false);
         ~CasEffect();
+        void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
+
+    private:
+        // applies the lut in the same pass, if the lut effect came right after this one
+        std::unique_ptr<LutTexture> lutTexture;
+    };
+
+    // the same filter as CasEffect, the work groups load their tile with its border into shared memory once
+    // instead of sampling 9 texels for every pixel
+    class CasComputeEffect : public ComputeEffect
+    {
+    public:
+        CasComputeEffect(std::shared_ptr<LogicalDevice>    pLogicalDevice,
+                         VkFormat                          format,
+                         VkExtent2D                        imageExtent,
+                         std::vector<VkImage>              inputImages,
+                         std::vector<VkImage>              outputImages,
+                         std::shared_ptr<vkBasalt::Config> pConfig);
+        ~CasComputeEffect();
     };
 } // namespace vkBasalt
 
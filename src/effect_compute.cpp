@@ -0,0 +1,94 @@
+#include "effect_compute.hpp"
+
+#include <cstring>
+
+#include "image_view.hpp"
+#include "descriptor_set.hpp"
+#include "graphics_pipeline.hpp"
+#include "compute_pipeline.hpp"
+#include "shader.hpp"
+#include "sampler.hpp"
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    ComputeEffect::ComputeEffect()
+    {
+    }
+    void ComputeEffect::init(std::shared_ptr<LogicalDevice>    pLogicalDevice,
+                             VkFormat                          format,
+                             VkExtent2D                        imageExtent,
+                             std::vector<VkImage>              inputImages,
+                             std::vector<VkImage>              outputImages,
+                             std::shared_ptr<vkBasalt::Config> pConfig)
+    {
+        Logger::debug("in creating ComputeEffect");
+
+        this->pLogicalDevice = pLogicalDevice;
+        this->format         = format;
+        this->imageExtent    = imageExtent;
+        this->inputImages    = inputImages;
+        this->outputImages   = outputImages;
+        this->pConfig        = pConfig;
+
+        inputImageViews  = createImageViews(pLogicalDevice, format, inputImages);
+        outputImageViews = createImageViews(pLogicalDevice, format, outputImages);
+        Logger::debug("created ImageViews");
+        sampler = createSampler(pLogicalDevice);
+
+        imageDescriptorSetLayout = createComputeImageDescriptorSetLayout(pLogicalDevice, 1, 1);
+
+        VkDescriptorPoolSize imagePoolSize;
+        imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        imagePoolSize.descriptorCount = inputImages.size();
+
+        VkDescriptorPoolSize storagePoolSize;
+        storagePoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        storagePoolSize.descriptorCount = outputImages.size();
+
+        std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize, storagePoolSize};
+
+        descriptorPool = createDescriptorPool(pLogicalDevice, poolSizes);
+        Logger::debug("created descriptorPool");
+
+        createShaderModule(pLogicalDevice, computeCode, &computeModule);
+
+        pipelineLayout  = createGraphicsPipelineLayout(pLogicalDevice, {imageDescriptorSetLayout});
+        computePipeline = createComputePipeline(pLogicalDevice, computeModule, pComputeSpecInfo, "main", pipelineLayout);
+
+        imageDescriptorSets = allocateAndWriteComputeImageDescriptorSets(
+            pLogicalDevice, descriptorPool, imageDescriptorSetLayout, sampler, {inputImageViews}, {outputImageViews});
+    }
+    void ComputeEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates)
+    {
+        Logger::debug("applying ComputeEffect to cb " + convertToString(commandBuffer));
+        imageStates.use(
+            inputImages[imageIndex], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        imageStates.discard(outputImages[imageIndex], VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+        imageStates.flush();
+
+        pLogicalDevice->vkd.CmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &(imageDescriptorSets[imageIndex]), 0, nullptr);
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+
+        pLogicalDevice->vkd.CmdDispatch(
+            commandBuffer, (imageExtent.width + tileSize - 1) / tileSize, (imageExtent.height + tileSize - 1) / tileSize, 1);
+        Logger::debug("after dispatch");
+    }
+    ComputeEffect::~ComputeEffect()
+    {
+        Logger::debug("destroying ComputeEffect " + convertToString(this));
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, computePipeline, nullptr);
+        pLogicalDevice->resourceCache->releasePipelineLayout(pipelineLayout);
+        pLogicalDevice->resourceCache->releaseDescriptorSetLayout(imageDescriptorSetLayout);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, computeModule, nullptr);
+
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        for (unsigned int i = 0; i < inputImageViews.size(); i++)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, inputImageViews[i], nullptr);
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, outputImageViews[i], nullptr);
+        }
+        pLogicalDevice->resourceCache->releaseSampler(sampler);
+    }
+} // namespace vkBasalt
@@ -0,0 +1,59 @@
+#ifndef EFFECT_COMPUTE_HPP_INCLUDED
+#define EFFECT_COMPUTE_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "effect.hpp"
+#include "config.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Like SimpleEffect, but a compute shader reads the input image at binding 0 and writes the output image at binding 1 as storage image.
+    // Every work group covers a tile of tileSize x tileSize pixels, so the shader can share the texels of the tile between its invocations.
+    // The output images need VK_IMAGE_USAGE_STORAGE_BIT.
+    class ComputeEffect : public Effect
+    {
+    public:
+        ComputeEffect();
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
+        virtual ~ComputeEffect();
+
+    protected:
+        std::shared_ptr<LogicalDevice>    pLogicalDevice;
+        std::vector<VkImage>              inputImages;
+        std::vector<VkImage>              outputImages;
+        std::vector<VkImageView>          inputImageViews;
+        std::vector<VkImageView>          outputImageViews;
+        std::vector<VkDescriptorSet>      imageDescriptorSets;
+        VkDescriptorSetLayout             imageDescriptorSetLayout;
+        VkDescriptorPool                  descriptorPool;
+        VkShaderModule                    computeModule;
+        VkPipelineLayout                  pipelineLayout;
+        VkPipeline                        computePipeline;
+        VkExtent2D                        imageExtent;
+        VkFormat                          format;
+        VkSampler                         sampler;
+        std::shared_ptr<vkBasalt::Config> pConfig;
+        std::vector<char>                 computeCode;
+        VkSpecializationInfo*             pComputeSpecInfo;
+        uint32_t                          tileSize;
+
+        void init(std::shared_ptr<LogicalDevice>    pLogicalDevice,
+                  VkFormat                          format,
+                  VkExtent2D                        imageExtent,
+                  std::vector<VkImage>              inputImages,
+                  std::vector<VkImage>              outputImages,
+                  std::shared_ptr<vkBasalt::Config> pConfig);
+    };
+} // namespace vkBasalt
+
+#endif // EFFECT_COMPUTE_HPP_INCLUDED
@@ -18,10 +18,11 @@ namespace vkBasalt
                                VkExtent2D                        imageExtent,
                                std::vector<VkImage>              inputImages,
                                std::vector<VkImage>              outputImages,
-                               std::shared_ptr<vkBasalt::Config> pConfig)
+                               std::shared_ptr<vkBasalt::Config> pConfig,
+                               bool                              fuseLut)
     {
         std::string fullScreenRectFile = "full_screen_triangle.vert.spv";
-        std::string debandFragmentFile = "deband.frag.spv";
+        std::string debandFragmentFile = fuseLut ? "deband_lut.frag.spv" : "deband.frag.spv";
 
         vertexCode   = readFile(fullScreenRectFile);
         fragmentCode = readFile(debandFragmentFile);
@@ -59,18 +60,41 @@ namespace vkBasalt
             specMapEntrys[i].size       = sizeof(float);
         }
 
+        std::vector<char> specData(sizeof(debandOptions));
+        std::memcpy(specData.data(), &debandOptions, sizeof(debandOptions));
+
+        if (fuseLut)
+        {
+            lutTexture = std::make_unique<LutTexture>(pLogicalDevice, pConfig);
+            lutTexture->addSpecialization(specMapEntrys, specData);
+            descriptorSetLayouts.push_back(lutTexture->descriptorSetLayout);
+        }
+
         VkSpecializationInfo specializationInfo;
         specializationInfo.mapEntryCount = specMapEntrys.size();
         specializationInfo.pMapEntries   = specMapEntrys.data();
-        specializationInfo.dataSize      = sizeof(debandOptions);
-        specializationInfo.pData         = &debandOptions;
+        specializationInfo.dataSize      = specData.size();
+        specializationInfo.pData         = specData.data();
 
         pVertexSpecInfo   = nullptr;
         pFragmentSpecInfo = &specializationInfo;
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
+
+        if (lutTexture)
+        {
+            lutTexture->createDescriptorSet(sampler);
+        }
     }
     DebandEffect::~DebandEffect()
     {
     }
+    void DebandEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates)
+    {
+        if (lutTexture)
+        {
+            lutTexture->bind(commandBuffer, pipelineLayout);
+        }
+        SimpleEffect::applyEffect(imageIndex, commandBuffer, imageStates);
+    }
 } // namespace vkBasalt
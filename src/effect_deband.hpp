@@ -11,6 +11,7 @@
 #include "vulkan_include.hpp"
 
 #include "effect_simple.hpp"
+#include "effect_lut.hpp"
 #include "config.hpp"
 
 namespace vkBasalt
@@ -23,8 +24,14 @@ namespace vkBasalt
                      VkExtent2D                        imageExtent,
                      std::vector<VkImage>              inputImages,
                      std::vector<VkImage>              outputImages,
-                     std::shared_ptr<vkBasalt::Config> pConfig);
+                     std::shared_ptr<vkBasalt::Config> pConfig,
+                     bool                              fuseLut = false);
         ~DebandEffect();
+        void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
+
+    private:
+        // applies the lut in the same pass, if the lut effect came right after this one
+        std::unique_ptr<LutTexture> lutTexture;
     };
 } // namespace vkBasalt
 
@@ -1,6 +1,8 @@
 #include "effect_lut.hpp"
 
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 #include "image_view.hpp"
 #include "descriptor_set.hpp"
@@ -11,87 +13,181 @@
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "image.hpp"
+#include "memory.hpp"
 #include "lut_cube.hpp"
+#include "format.hpp"
+#include "logger.hpp"
 
 #include "stb_image.h"
 
 namespace vkBasalt
 {
-    LutEffect::LutEffect(std::shared_ptr<LogicalDevice>    pLogicalDevice,
-                         VkFormat                          format,
-                         VkExtent2D                        imageExtent,
-                         std::vector<VkImage>              inputImages,
-                         std::vector<VkImage>              outputImages,
-                         std::shared_ptr<vkBasalt::Config> pConfig)
+    // png luts are strips of size * size pixels with one row per green value and one size wide block per blue value,
+    // they get reordered into a real cube, so that the shader does the same lookup for both kinds of luts
+    static std::vector<float> loadLutPng(const std::string& file, int& size)
     {
-        std::string fullScreenRectFile = "full_screen_triangle.vert.spv";
-        std::string lutFragmentFile    = "lut.frag.spv";
-
-        vertexCode   = readFile(fullScreenRectFile);
-        fragmentCode = readFile(lutFragmentFile);
-
-        int      height;
-        LutCube  lutCube;
-        stbi_uc* pixels;
-        int32_t  usingPNG =
-            (pConfig->getOption("lutFile").find(".cube") != std::string::npos || pConfig->getOption("lutFile").find(".CUBE") != std::string::npos)
-                ? 0
-                : 1;
-        if (!usingPNG)
+        int      width, height, channels;
+        stbi_us* pixels = stbi_load_16(file.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (pixels == nullptr || width != height * height)
         {
-            lutCube = LutCube(pConfig->getOption("lutFile"));
-            pixels  = lutCube.colorCube.data();
-            height  = lutCube.size;
+            Logger::err("bad lut");
+            stbi_image_free(pixels);
+            return {};
         }
-        else
+
+        size = height;
+        std::vector<float> cube(size * size * size * 4);
+        for (int g = 0; g < size; g++)
         {
-            int channels, width;
-            pixels = stbi_load(pConfig->getOption("lutFile").c_str(), &width, &height, &channels, STBI_rgb_alpha);
-            if (width != height * height)
+            for (int b = 0; b < size; b++)
             {
-                Logger::err("bad lut");
+                for (int r = 0; r < size; r++)
+                {
+                    const stbi_us* pixel = pixels + (g * width + b * size + r) * 4;
+                    float*         color = cube.data() + ((b * size + g) * size + r) * 4;
+
+                    color[0] = pixel[0] / 65535.0f;
+                    color[1] = pixel[1] / 65535.0f;
+                    color[2] = pixel[2] / 65535.0f;
+                    color[3] = 1.0f;
+                }
             }
         }
+        stbi_image_free(pixels);
+        return cube;
+    }
 
-        std::vector<VkSpecializationMapEntry> specMapEntrys(2);
-        for (uint32_t i = 0; i < specMapEntrys.size(); i++)
+    // more than 8 bits per channel avoid banding in smooth gradients, falls back to the next best format the device can filter
+    static VkFormat getLutFormat(std::shared_ptr<LogicalDevice> pLogicalDevice, const std::string& option)
+    {
+        std::vector<VkFormat> formats = {
+            VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_R8G8B8A8_UNORM};
+        if (option == "rgba16f")
         {
-            specMapEntrys[i].constantID = i;
-            specMapEntrys[i].offset     = sizeof(int32_t) * i;
-            specMapEntrys[i].size       = sizeof(int32_t);
+            std::swap(formats[0], formats[1]);
         }
-        std::vector<int32_t> specData = {height, usingPNG};
-
-        VkSpecializationInfo fragmentSpecializationInfo;
-        fragmentSpecializationInfo.mapEntryCount = specMapEntrys.size();
-        fragmentSpecializationInfo.pMapEntries   = specMapEntrys.data();
-        fragmentSpecializationInfo.dataSize      = specMapEntrys.size() * sizeof(int32_t);
-        fragmentSpecializationInfo.pData         = specData.data();
-
-        pVertexSpecInfo   = nullptr;
-        pFragmentSpecInfo = &fragmentSpecializationInfo;
+        else if (option == "rgb10a2")
+        {
+            formats.erase(formats.begin(), formats.begin() + 2);
+        }
+        else if (option == "rgba8")
+        {
+            formats.erase(formats.begin(), formats.begin() + 3);
+        }
+        return getSupportedFormat(pLogicalDevice, formats, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    }
 
-        VkExtent3D lutImageExtent = {(uint32_t) height, (uint32_t) height, (uint32_t) height};
+    // only handles normal numbers, smaller values become 0 and bigger ones infinity
+    static uint16_t convertToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
 
-        lutImage = createImages(pLogicalDevice,
-                                1,
-                                lutImageExtent,
-                                VK_FORMAT_R8G8B8A8_UNORM, // TODO search for format and save it
-                                VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                lutMemory)[0];
+        uint32_t sign     = (bits >> 16) & 0x8000;
+        int32_t  exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffff;
+        if (exponent <= 0)
+        {
+            return sign;
+        }
+        if (exponent >= 31)
+        {
+            return sign | 0x7c00;
+        }
+        // rounding can carry into the exponent, which is still the correct result
+        return (sign | (exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1);
+    }
 
-        uploadToImage(pLogicalDevice, lutImage, lutImageExtent, height * height * height * 4, pixels);
+    static std::vector<unsigned char> convertLut(const std::vector<float>& cube, VkFormat format)
+    {
+        std::vector<unsigned char> data;
+        auto                       unorm = [](float value, float maxValue) { return std::lround(std::clamp(value, 0.0f, 1.0f) * maxValue); };
+        switch (format)
+        {
+            case VK_FORMAT_R16G16B16A16_UNORM:
+            {
+                std::vector<uint16_t> texels(cube.size());
+                std::transform(cube.begin(), cube.end(), texels.begin(), [&](float value) { return unorm(value, 65535.0f); });
+                data.resize(texels.size() * sizeof(uint16_t));
+                std::memcpy(data.data(), texels.data(), data.size());
+                break;
+            }
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            {
+                std::vector<uint16_t> texels(cube.size());
+                std::transform(cube.begin(), cube.end(), texels.begin(), convertToHalf);
+                data.resize(texels.size() * sizeof(uint16_t));
+                std::memcpy(data.data(), texels.data(), data.size());
+                break;
+            }
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            {
+                std::vector<uint32_t> texels(cube.size() / 4);
+                for (size_t i = 0; i < texels.size(); i++)
+                {
+                    texels[i] = unorm(cube[i * 4], 1023.0f) | (unorm(cube[i * 4 + 1], 1023.0f) << 10) | (unorm(cube[i * 4 + 2], 1023.0f) << 20)
+                                | (uint32_t(unorm(cube[i * 4 + 3], 3.0f)) << 30);
+                }
+                data.resize(texels.size() * sizeof(uint32_t));
+                std::memcpy(data.data(), texels.data(), data.size());
+                break;
+            }
+            default:
+            {
+                data.resize(cube.size());
+                std::transform(cube.begin(), cube.end(), data.begin(), [&](float value) { return unorm(value, 255.0f); });
+                break;
+            }
+        }
+        return data;
+    }
 
-        if (usingPNG)
+    LutTexture::LutTexture(std::shared_ptr<LogicalDevice> pLogicalDevice, std::shared_ptr<vkBasalt::Config> pConfig)
+        : pLogicalDevice(pLogicalDevice)
+    {
+        LutCube            lutCube;
+        std::vector<float> cube;
+        int                size    = 0;
+        std::string        lutFile = pConfig->getOption("lutFile");
+        if (lutFile.find(".cube") != std::string::npos || lutFile.find(".CUBE") != std::string::npos)
         {
-            stbi_image_free(pixels);
+            lutCube = LutCube(lutFile);
+            cube    = std::move(lutCube.colorCube);
+            size    = lutCube.size;
+        }
+        else
+        {
+            cube = loadLutPng(lutFile, size);
+        }
+        if (cube.empty())
+        {
+            // an identity cube keeps the colors as they are
+            size = 2;
+            cube = {0, 0, 0, 1, 1, 0, 0, 1, 0, 1, 0, 1, 1, 1, 0, 1, 0, 0, 1, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1};
         }
 
-        lutImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8G8B8A8_UNORM, std::vector<VkImage>(1, lutImage), VK_IMAGE_VIEW_TYPE_3D)[0];
+        specData = {size,
+                    {lutCube.domainMin[0], lutCube.domainMin[1], lutCube.domainMin[2]},
+                    {lutCube.domainMax[0], lutCube.domainMax[1], lutCube.domainMax[2]}};
 
-        lutDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 1);
-        descriptorSetLayouts.push_back(lutDescriptorSetLayout);
+        VkExtent3D lutImageExtent = {(uint32_t) size, (uint32_t) size, (uint32_t) size};
+        VkFormat   lutFormat      = getLutFormat(pLogicalDevice, pConfig->getOption("lutFormat", "rgba16"));
+        Logger::debug("lut format: " + std::to_string(lutFormat));
+
+        image = createImages(pLogicalDevice,
+                             1,
+                             lutImageExtent,
+                             lutFormat,
+                             VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                             memory)[0];
+
+        std::vector<unsigned char> lutData = convertLut(cube, lutFormat);
+        uploadToImage(pLogicalDevice, image, lutImageExtent, lutData.size(), lutData.data());
+
+        imageView = createImageViews(pLogicalDevice, lutFormat, std::vector<VkImage>(1, image), VK_IMAGE_VIEW_TYPE_3D)[0];
+
+        descriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 1);
 
         VkDescriptorPoolSize imagePoolSize;
         imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -99,29 +195,83 @@ namespace vkBasalt
 
         std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize};
 
-        lutDescriptorPool = createDescriptorPool(pLogicalDevice, poolSizes);
+        descriptorPool = createDescriptorPool(pLogicalDevice, poolSizes);
+    }
+    LutTexture::~LutTexture()
+    {
+        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, imageView, nullptr);
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        pLogicalDevice->resourceCache->releaseDescriptorSetLayout(descriptorSetLayout);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+        freeMemory(pLogicalDevice, memory);
+    }
+    void LutTexture::addSpecialization(std::vector<VkSpecializationMapEntry>& mapEntries, std::vector<char>& data)
+    {
+        uint32_t offset = data.size();
+        for (uint32_t i = 0; i < 7; i++)
+        {
+            VkSpecializationMapEntry mapEntry;
+            mapEntry.constantID = 16 + i;
+            mapEntry.offset     = offset + sizeof(int32_t) * i;
+            mapEntry.size       = sizeof(int32_t);
+            mapEntries.push_back(mapEntry);
+        }
+        data.resize(offset + sizeof(specData));
+        std::memcpy(data.data() + offset, &specData, sizeof(specData));
+    }
+    void LutTexture::createDescriptorSet(VkSampler sampler)
+    {
+        descriptorSet =
+            allocateAndWriteImageSamplerDescriptorSets(pLogicalDevice,
+                                                       descriptorPool,
+                                                       descriptorSetLayout,
+                                                       {sampler},
+                                                       std::vector<std::vector<VkImageView>>(1, std::vector<VkImageView>(1, imageView)))[0];
+    }
+    void LutTexture::bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+    {
+        pLogicalDevice->vkd.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &descriptorSet, 0, nullptr);
+    }
+
+    LutEffect::LutEffect(std::shared_ptr<LogicalDevice>    pLogicalDevice,
+                         VkFormat                          format,
+                         VkExtent2D                        imageExtent,
+                         std::vector<VkImage>              inputImages,
+                         std::vector<VkImage>              outputImages,
+                         std::shared_ptr<vkBasalt::Config> pConfig)
+        : lutTexture(pLogicalDevice, pConfig)
+    {
+        std::string fullScreenRectFile = "full_screen_triangle.vert.spv";
+        std::string lutFragmentFile    = "lut.frag.spv";
+
+        vertexCode   = readFile(fullScreenRectFile);
+        fragmentCode = readFile(lutFragmentFile);
+
+        std::vector<VkSpecializationMapEntry> specMapEntrys;
+        std::vector<char>                     specData;
+        lutTexture.addSpecialization(specMapEntrys, specData);
+
+        VkSpecializationInfo fragmentSpecializationInfo;
+        fragmentSpecializationInfo.mapEntryCount = specMapEntrys.size();
+        fragmentSpecializationInfo.pMapEntries   = specMapEntrys.data();
+        fragmentSpecializationInfo.dataSize      = specData.size();
+        fragmentSpecializationInfo.pData         = specData.data();
+
+        pVertexSpecInfo   = nullptr;
+        pFragmentSpecInfo = &fragmentSpecializationInfo;
+
+        descriptorSetLayouts.push_back(lutTexture.descriptorSetLayout);
 
         init(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig);
 
-        lutDescriptorSet =
-            allocateAndWriteImageSamplerDescriptorSets(pLogicalDevice,
-                                                       lutDescriptorPool,
-                                                       lutDescriptorSetLayout,
-                                                       {sampler},
-                                                       std::vector<std::vector<VkImageView>>(1, std::vector<VkImageView>(1, lutImageView)))[0];
+        lutTexture.createDescriptorSet(sampler);
     }
     LutEffect::~LutEffect()
     {
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, lutImageView, nullptr);
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, lutImage, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, lutDescriptorSetLayout, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, lutDescriptorPool, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, lutMemory, nullptr);
     }
-    void LutEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    void LutEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates)
     {
-        pLogicalDevice->vkd.CmdBindDescriptorSets(
-            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &(lutDescriptorSet), 0, nullptr);
-        SimpleEffect::applyEffect(imageIndex, commandBuffer);
+        lutTexture.bind(commandBuffer, pipelineLayout);
+        SimpleEffect::applyEffect(imageIndex, commandBuffer, imageStates);
     }
 } // namespace vkBasalt
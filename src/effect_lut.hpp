@@ -15,6 +15,39 @@
 
 namespace vkBasalt
 {
+    // The lut as 3D texture with its descriptor set, used by the lut effect and by the effects that apply the lut in their own pass.
+    // The descriptor set is set 1, the specialization constants have the ids 16 to 22, see shader/lut.h
+    class LutTexture
+    {
+    public:
+        LutTexture(std::shared_ptr<LogicalDevice> pLogicalDevice, std::shared_ptr<vkBasalt::Config> pConfig);
+        ~LutTexture();
+
+        // appends the specialization constants of the lut behind the ones in data
+        void addSpecialization(std::vector<VkSpecializationMapEntry>& mapEntries, std::vector<char>& data);
+        // the sampler of the effect gets used for the lut as well
+        void createDescriptorSet(VkSampler sampler);
+        void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+
+        VkDescriptorSetLayout descriptorSetLayout;
+
+    private:
+        // one int for the size and the domain as six floats, all of them are 4 bytes
+        struct
+        {
+            int32_t lutSize;
+            float   domainMin[3];
+            float   domainMax[3];
+        } specData;
+
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        VkImage                        image;
+        MemoryAllocation               memory;
+        VkImageView                    imageView;
+        VkDescriptorPool               descriptorPool;
+        VkDescriptorSet                descriptorSet;
+    };
+
     class LutEffect : public SimpleEffect
     {
     public:
@@ -25,15 +58,10 @@ namespace vkBasalt
                   std::vector<VkImage>              outputImages,
                   std::shared_ptr<vkBasalt::Config> pConfig);
         ~LutEffect();
-        void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
 
     private:
-        VkImage               lutImage;
-        VkDeviceMemory        lutMemory;
-        VkImageView           lutImageView;
-        VkDescriptorSetLayout lutDescriptorSetLayout;
-        VkDescriptorPool      lutDescriptorPool;
-        VkDescriptorSet       lutDescriptorSet;
+        LutTexture lutTexture;
     };
 } // namespace vkBasalt
 
@@ -8,23 +8,32 @@
 #include <set>
 #include <variant>
 #include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
+#include <future>
 
 #include "image_view.hpp"
 #include "descriptor_set.hpp"
 #include "buffer.hpp"
 #include "renderpass.hpp"
 #include "graphics_pipeline.hpp"
+#include "pipeline_cache.hpp"
 #include "framebuffer.hpp"
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "image.hpp"
+#include "memory.hpp"
 #include "format.hpp"
+#include "reshade_module_cache.hpp"
+#include "texture_loader.hpp"
+#include "thread_pool.hpp"
+#include "gpu_profiler.hpp"
 
 #include "util.hpp"
 
-#include "stb_image.h"
-#include "stb_image_dds.h"
-#include "stb_image_resize.h"
 
 namespace vkBasalt
 {
@@ -63,30 +72,54 @@ namespace vkBasalt
         bufferSize = module.total_uniform_size;
         if (bufferSize)
         {
+            // one slice per swapchain image, the command buffer of each swapchain image reads its own slice through a dynamic offset,
+            // so updating the uniforms never touches a slice that a frame in flight still reads
+            VkPhysicalDeviceProperties properties;
+            pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &properties);
+            VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+            uniformSliceSize       = (bufferSize + alignment - 1) / alignment * alignment;
+
             createBuffer(pLogicalDevice,
-                         bufferSize,
+                         uniformSliceSize * inputImages.size(),
                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         stagingBuffer,
-                         stagingBufferMemory);
+                         uniformBuffer,
+                         uniformBufferMemory);
         }
 
         stencilFormat = getStencilFormat(pLogicalDevice);
         Logger::debug("Stencil Format: " + std::to_string(stencilFormat));
-        textureMemory.push_back(VK_NULL_HANDLE);
-        stencilImage = createImages(pLogicalDevice,
-                                    1,
-                                    {imageExtent.width, imageExtent.height, 1},
-                                    stencilFormat,
-                                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                    textureMemory.back())[0];
+        // the stencil gets cleared on the first access, so it can share its memory with other effects
+        stencilImage = createTransientImages(pLogicalDevice,
+                                             1,
+                                             {imageExtent.width, imageExtent.height, 1},
+                                             stencilFormat,
+                                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)[0];
 
         stencilImageView = createImageViews(
             pLogicalDevice, stencilFormat, {stencilImage}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)[0];
 
         std::vector<std::vector<VkImageView>> imageViewVector;
 
+        struct TextureLoad
+        {
+            VkImage                  image;
+            VkExtent3D               extent;
+            uint32_t                 mipLevels;
+            VkFormat                 format;
+            VkFormat                 compressedFormat; // VK_FORMAT_UNDEFINED if the pixels got decoded
+            std::future<TextureData> data;
+        };
+        std::vector<TextureLoad> textureLoads;
+
+        // reshade only samples the lower mip levels of a texture if one of its samplers allows it
+        auto samplesMipMaps = [&](const std::string& textureName) {
+            return std::any_of(module.samplers.begin(), module.samplers.end(), [&](const auto& sampler) {
+                return sampler.texture_name == textureName && sampler.max_lod > 0.0f;
+            });
+        };
+        bool computeMipMaps = pConfig->getOption("computeMipMaps", "on") == "on";
+
         for (size_t i = 0; i < module.textures.size(); i++)
         {
             textureMipLevels[module.textures[i].unique_name] = module.textures[i].levels;
@@ -122,18 +155,54 @@ namespace vkBasalt
                     module.textures[i].annotations.begin(), module.textures[i].annotations.end(), [](const auto& a) { return a.name == "source"; });
                 source == module.textures[i].annotations.end())
             {
-                textureMemory.push_back(VK_NULL_HANDLE);
-                std::vector<VkImage> images = createImages(pLogicalDevice,
-                                                           1,
-                                                           textureExtent,
-                                                           convertReshadeFormat(module.textures[i].format),
-                                                           VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
-                                                               | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-                                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                                           textureMemory.back(),
-                                                           module.textures[i].levels);
+                // pooled render targets don't keep their content between frames, like in reshade they share memory with other effects
+                bool pooled = std::any_of(module.textures[i].annotations.begin(),
+                                          module.textures[i].annotations.end(),
+                                          [](const auto& a) { return a.name == "pooled" && a.value.as_uint[0]; });
+
+                VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+                                          | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+                // formats without storage support and larger images fall back to the blits
+                VkFormat textureFormat = convertReshadeFormat(module.textures[i].format);
+                bool mipGeneratorImage = computeMipMaps && module.textures[i].levels > 1 && samplesMipMaps(module.textures[i].unique_name)
+                                         && MipGenerator::isSupported(pLogicalDevice, textureFormat, textureExtent, module.textures[i].levels);
+                if (mipGeneratorImage)
+                {
+                    usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+                }
+
+                std::vector<VkImage> images;
+                if (pooled)
+                {
+                    images = createTransientImages(
+                        pLogicalDevice, 1, textureExtent, convertReshadeFormat(module.textures[i].format), usage, module.textures[i].levels);
+                    pooledImages.push_back(images[0]);
+                }
+                else
+                {
+                    textureMemory.push_back(MemoryAllocation());
+                    images = createImages(pLogicalDevice,
+                                          1,
+                                          textureExtent,
+                                          convertReshadeFormat(module.textures[i].format),
+                                          usage,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                          textureMemory.back(),
+                                          module.textures[i].levels);
+                }
 
                 textureImages[module.textures[i].unique_name] = images;
+                if (mipGeneratorImage)
+                {
+                    if (!mipGenerator)
+                    {
+                        mipGenerator = std::make_unique<MipGenerator>(pLogicalDevice);
+                    }
+                    mipGeneratorImages[module.textures[i].unique_name] =
+                        mipGenerator->addImage(images[0], textureFormat, textureExtent, module.textures[i].levels);
+                }
+
                 std::vector<VkImageView> imageViewsUNORM =
                     std::vector<VkImageView>(inputImages.size(),
                                              createImageViews(pLogicalDevice,
@@ -174,17 +243,27 @@ namespace vkBasalt
 
                 textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(convertReshadeFormat(module.textures[i].format));
                 textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(convertReshadeFormat(module.textures[i].format));
-                changeImageLayout(pLogicalDevice, images, module.textures[i].levels);
+                if (!pooled)
+                {
+                    changeImageLayout(pLogicalDevice, images, module.textures[i].levels);
+                }
                 continue;
             }
             else
             {
-                textureMemory.push_back(VK_NULL_HANDLE);
+                std::string filePath      = pConfig->getOption("reshadeTexturePath") + "/" + source->value.string_data;
+                VkFormat    textureFormat = convertReshadeFormat(module.textures[i].format);
+                // block compressed dds files get uploaded as they are if the device can sample them
+                VkFormat compressedFormat =
+                    getCompressedTextureFormat(pLogicalDevice, filePath, textureFormat, textureExtent, module.textures[i].levels);
+                VkFormat imageFormat = compressedFormat != VK_FORMAT_UNDEFINED ? compressedFormat : textureFormat;
+
+                textureMemory.push_back(MemoryAllocation());
                 std::vector<VkImage> images =
                     createImages(pLogicalDevice,
                                  1,
                                  textureExtent,
-                                 convertReshadeFormat(module.textures[i].format), // TODO search for format and save it
+                                 imageFormat,
                                  VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                  textureMemory.back(),
@@ -193,7 +272,7 @@ namespace vkBasalt
                 textureImages[module.textures[i].unique_name] = images;
 
                 std::vector<VkImageView> imageViews = createImageViews(pLogicalDevice,
-                                                                       convertToUNORM(convertReshadeFormat(module.textures[i].format)),
+                                                                       convertToUNORM(imageFormat),
                                                                        images,
                                                                        VK_IMAGE_VIEW_TYPE_2D,
                                                                        VK_IMAGE_ASPECT_COLOR_BIT,
@@ -201,12 +280,8 @@ namespace vkBasalt
 
                 std::vector<VkImageView> imageViewsUNORM = std::vector<VkImageView>(inputImages.size(), imageViews[0]);
 
-                imageViews = createImageViews(pLogicalDevice,
-                                              convertToSRGB(convertReshadeFormat(module.textures[i].format)),
-                                              images,
-                                              VK_IMAGE_VIEW_TYPE_2D,
-                                              VK_IMAGE_ASPECT_COLOR_BIT,
-                                              module.textures[i].levels);
+                imageViews = createImageViews(
+                    pLogicalDevice, convertToSRGB(imageFormat), images, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, module.textures[i].levels);
 
                 std::vector<VkImageView> imageViewsSRGB = std::vector<VkImageView>(inputImages.size(), imageViews[0]);
 
@@ -216,75 +291,60 @@ namespace vkBasalt
                 renderImageViewsUNORM[module.textures[i].unique_name] = imageViewsUNORM;
                 renderImageViewsSRGB[module.textures[i].unique_name]  = imageViewsSRGB;
 
-                textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(convertReshadeFormat(module.textures[i].format));
-                textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(convertReshadeFormat(module.textures[i].format));
-
-                int desiredChannels;
-                switch (textureFormatsUNORM[module.textures[i].unique_name])
-                {
-                    case VK_FORMAT_R8_UNORM: desiredChannels = STBI_grey; break;
-                    case VK_FORMAT_R8G8_UNORM:
-                        desiredChannels = STBI_rgb_alpha; // TODO why doesn't STBI_grey_alpha work?
-                        break;
-                    case VK_FORMAT_R8G8B8A8_UNORM: desiredChannels = STBI_rgb_alpha; break;
-                    case VK_FORMAT_R8G8B8A8_SRGB: desiredChannels = STBI_rgb_alpha; break;
-                    default:
-                        Logger::err("unsupported texture upload format" + std::to_string(textureFormatsUNORM[module.textures[i].unique_name]));
-                        desiredChannels = 4;
-                        break;
-                }
-
-                std::string          filePath = pConfig->getOption("reshadeTexturePath") + "/" + source->value.string_data;
-                stbi_uc*             pixels;
-                std::vector<stbi_uc> resizedPixels;
-                uint32_t             size;
-                int                  width;
-                int                  height;
-
-                size = textureExtent.width * textureExtent.height * desiredChannels;
-
-                FILE* const file = fopen(filePath.c_str(), "rb");
-
-                if (file == nullptr)
-                {
-                    Logger::err("couldn't open texture: " + filePath);
-                }
-                if (stbi_dds_test_file(file))
-                {
-                    int channels;
-                    pixels = stbi_dds_load_from_file(file, &width, &height, &channels, desiredChannels);
-                }
-                else
-                {
-                    int channels;
-                    pixels = stbi_load_from_file(file, &width, &height, &channels, desiredChannels);
-                }
-
-                // change RGBA to RG
-                if (textureFormatsUNORM[module.textures[i].unique_name] == VK_FORMAT_R8G8_UNORM)
-                {
-                    uint32_t pos = 0;
-                    for (uint32_t j = 0; j < size; j += 4)
-                    {
-                        pixels[pos] = pixels[j];
-                        pos++;
-                        pixels[pos] = pixels[j + 1];
-                        pos++;
-                    }
-                    size /= 2;
-                    desiredChannels /= 2;
-                }
+                textureFormatsUNORM[module.textures[i].unique_name] = convertToUNORM(textureFormat);
+                textureFormatsSRGB[module.textures[i].unique_name]  = convertToSRGB(textureFormat);
+
+                // the files get read and decoded on the thread pool while the remaining textures get created
+                // textures with a different size get resized by a blit on the gpu if the format allows it
+                uint32_t mipLevels   = module.textures[i].levels;
+                bool     resizeOnCpu = !supportsBlitResize(pLogicalDevice, textureFormat);
+                auto     data        = getThreadPool().submit([=]() {
+                    return compressedFormat != VK_FORMAT_UNDEFINED ? loadCompressedTexture(filePath, compressedFormat, textureExtent, mipLevels)
+                                                                   : loadTexture(filePath, textureFormat, textureExtent, resizeOnCpu);
+                });
+                textureLoads.push_back({images[0], textureExtent, mipLevels, textureFormat, compressedFormat, std::move(data)});
+            }
+        }
 
-                if (static_cast<uint32_t>(width) != textureExtent.width || static_cast<uint32_t>(height) != textureExtent.height)
-                {
-                    resizedPixels.resize(size);
-                    stbir_resize_uint8(pixels, width, height, 0, resizedPixels.data(), textureExtent.width, textureExtent.height, 0, desiredChannels);
-                }
+        if (mipGenerator)
+        {
+            mipGenerator->init();
+        }
 
-                uploadToImage(
-                    pLogicalDevice, images[0], textureExtent, size, resizedPixels.size() ? resizedPixels.data() : pixels, module.textures[i].levels);
-                stbi_image_free(pixels);
+        // the uploads stay in the order of the textures, so the staging data only gets copied once per texture
+        for (auto& textureLoad : textureLoads)
+        {
+            TextureData data = getThreadPool().wait(textureLoad.data);
+            if (data.pixels.empty())
+            {
+                // the texture stays undefined, but it can still get sampled
+                changeImageLayout(pLogicalDevice, {textureLoad.image}, textureLoad.mipLevels);
+                continue;
             }
+            if (textureLoad.compressedFormat != VK_FORMAT_UNDEFINED)
+            {
+                uploadCompressedToImage(pLogicalDevice,
+                                        textureLoad.image,
+                                        textureLoad.extent,
+                                        textureLoad.compressedFormat,
+                                        data.pixels.size(),
+                                        data.pixels.data(),
+                                        textureLoad.mipLevels);
+                continue;
+            }
+            if (data.extent.width != textureLoad.extent.width || data.extent.height != textureLoad.extent.height)
+            {
+                uploadResizedToImage(pLogicalDevice,
+                                     textureLoad.image,
+                                     textureLoad.extent,
+                                     textureLoad.format,
+                                     data.extent,
+                                     data.pixels.size(),
+                                     data.pixels.data(),
+                                     textureLoad.mipLevels);
+                continue;
+            }
+            uploadToImage(pLogicalDevice, textureLoad.image, textureLoad.extent, data.pixels.size(), data.pixels.data(), textureLoad.mipLevels);
         }
 
         for (size_t i = 0; i < module.samplers.size(); i++)
@@ -307,7 +367,7 @@ namespace vkBasalt
         imagePoolSize.descriptorCount = inputImages.size() * module.samplers.size() * 3;
 
         VkDescriptorPoolSize bufferPoolSize;
-        bufferPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bufferPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         bufferPoolSize.descriptorCount = 3;
 
         std::vector<VkDescriptorPoolSize> poolSizes = {imagePoolSize, bufferPoolSize};
@@ -324,7 +384,8 @@ namespace vkBasalt
         Logger::debug("output writes: " + std::to_string(outputWrites));
         if (bufferSize)
         {
-            bufferDescriptorSet = writeBufferDescriptorSet(pLogicalDevice, descriptorPool, uniformDescriptorSetLayout, stagingBuffer);
+            bufferDescriptorSet =
+                writeBufferDescriptorSet(pLogicalDevice, descriptorPool, uniformDescriptorSetLayout, uniformBuffer, bufferSize);
         }
 
         inputDescriptorSets =
@@ -342,14 +403,11 @@ namespace vkBasalt
         // if there is only one outputWrite, we can directly write to outputImages
         if (outputWrites > 1)
         {
-            textureMemory.push_back(VK_NULL_HANDLE);
-            backBufferImages = createImages(pLogicalDevice,
-                                            inputImages.size(),
-                                            {imageExtent.width, imageExtent.height, 1},
-                                            format, // TODO search for format and save it
-                                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                            textureMemory.back());
+            backBufferImages = createTransientImages(pLogicalDevice,
+                                                     inputImages.size(),
+                                                     {imageExtent.width, imageExtent.height, 1},
+                                                     format, // TODO search for format and save it
+                                                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
 
             backBufferImageViewsSRGB  = createImageViews(pLogicalDevice, inputOutputFormatSRGB, backBufferImages);
             backBufferImageViewsUNORM = createImageViews(pLogicalDevice, inputOutputFormatUNORM, backBufferImages);
@@ -438,7 +496,32 @@ namespace vkBasalt
                 }
             }
 
-            renderTargets.push_back(currentRenderTargets);
+            // the mip levels only need to get generated if a sampler can read them, the content of pooled render targets
+            // does not outlive the last pass
+            bool                     lastPass = renderTargets.size() + 1 == module.techniques[0].passes.size();
+            std::vector<std::string> blitRenderTargets;
+            std::vector<uint32_t>    mipGeneratorIndices;
+            for (auto& target : currentRenderTargets)
+            {
+                if (textureMipLevels[target] < 2 || !samplesMipMaps(target))
+                {
+                    continue;
+                }
+                if (lastPass && std::find(pooledImages.begin(), pooledImages.end(), textureImages[target][0]) != pooledImages.end())
+                {
+                    continue;
+                }
+                if (auto it = mipGeneratorImages.find(target); it != mipGeneratorImages.end())
+                {
+                    mipGeneratorIndices.push_back(it->second);
+                }
+                else
+                {
+                    blitRenderTargets.push_back(target);
+                }
+            }
+            renderTargets.push_back(blitRenderTargets);
+            computeMipMapImages.push_back(mipGeneratorIndices);
 
             VkRect2D scissor;
             scissor.offset        = {0, 0};
@@ -519,9 +602,7 @@ namespace vkBasalt
             renderPassCreateInfo.dependencyCount = 1;
             renderPassCreateInfo.pDependencies   = &subpassDependency;
 
-            VkRenderPass renderPass;
-            VkResult     result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &renderPassCreateInfo, nullptr, &renderPass);
-            ASSERT_VULKAN(result);
+            VkRenderPass renderPass = pLogicalDevice->resourceCache->getRenderPass(renderPassCreateInfo);
             renderPasses.push_back(renderPass);
 
             VkRenderPassBeginInfo renderPassBeginInfo;
@@ -566,7 +647,10 @@ namespace vkBasalt
             {
                 if (!opt.name.empty())
                 {
-                    auto val = pConfig->getOption(opt.name);
+                    // the buffer size is only known here when the module got compiled resolution independent
+                    auto val = opt.name == "VKBASALT_BUFFER_WIDTH"    ? std::to_string(imageExtent.width)
+                               : opt.name == "VKBASALT_BUFFER_HEIGHT" ? std::to_string(imageExtent.height)
+                                                                      : pConfig->getOption(opt.name);
                     if (!val.empty())
                     {
                         std::variant<int32_t, uint32_t, float> convertedValue;
@@ -760,7 +844,7 @@ namespace vkBasalt
             pipelineCreateInfo.basePipelineIndex   = -1;
 
             VkPipeline pipeline;
-            result = pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+            VkResult   result = createCachedGraphicsPipeline(pLogicalDevice, &pipelineCreateInfo, &pipeline);
             ASSERT_VULKAN(result);
 
             graphicsPipelines.push_back(pipeline);
@@ -771,18 +855,16 @@ namespace vkBasalt
         Logger::debug("finished creating Reshade effect");
     }
 
-    void ReshadeEffect::updateEffect()
+    void ReshadeEffect::updateEffect(uint32_t imageIndex)
     {
         if (bufferSize)
         {
-            void*    data;
-            VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingBufferMemory, 0, bufferSize, 0, &data);
-            ASSERT_VULKAN(result);
+            // host visible memory stays mapped, the caller made sure that the last frame of this swapchain image is done
+            void* pSlice = static_cast<char*>(uniformBufferMemory.pMapped) + uniformSliceSize * imageIndex;
             for (auto& uniform : uniforms)
             {
-                uniform->update(data);
+                uniform->update(pSlice);
             }
-            pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingBufferMemory);
         }
     }
 
@@ -844,85 +926,42 @@ namespace vkBasalt
             }
         }
     }
-    void ReshadeEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    void ReshadeEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates)
     {
         Logger::debug("applying ReshadeEffect to command buffer" + convertToString(commandBuffer));
-        // Used to make the Image accessable by the shader
-        VkImageMemoryBarrier memoryBarrier;
-        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        memoryBarrier.pNext               = nullptr;
-        memoryBarrier.srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
-        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        memoryBarrier.image               = inputImages[imageIndex];
-
-        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        memoryBarrier.subresourceRange.baseMipLevel   = 0;
-        memoryBarrier.subresourceRange.levelCount     = 1;
-        memoryBarrier.subresourceRange.baseArrayLayer = 0;
-        memoryBarrier.subresourceRange.layerCount     = 1;
-
-        // Reverses the first Barrier
-        VkImageMemoryBarrier secondBarrier;
-        secondBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        secondBarrier.pNext               = nullptr;
-        secondBarrier.srcAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-        secondBarrier.dstAccessMask       = 0;
-        secondBarrier.oldLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        secondBarrier.newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        secondBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        secondBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        secondBarrier.image               = inputImages[imageIndex];
-
-        secondBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        secondBarrier.subresourceRange.baseMipLevel   = 0;
-        secondBarrier.subresourceRange.levelCount     = 1;
-        secondBarrier.subresourceRange.baseArrayLayer = 0;
-        secondBarrier.subresourceRange.layerCount     = 1;
-
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
-        memoryBarrier.image     = outputImages[imageIndex];
-        memoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        memoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+        // the render passes of the effect load the output and the back buffer in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        // their old content is never needed
+        imageStates.use(
+            inputImages[imageIndex], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        imageStates.discard(outputImages[imageIndex],
+                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
         if (outputWrites > 1)
         {
-            memoryBarrier.image = backBufferImages[imageIndex];
-            pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                                   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                                   0,
-                                                   0,
-                                                   nullptr,
-                                                   0,
-                                                   nullptr,
-                                                   1,
-                                                   &memoryBarrier);
+            imageStates.addImage(backBufferImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED);
+            imageStates.discard(backBufferImages[imageIndex],
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
         }
 
-        // stencil image
-        memoryBarrier.image                       = stencilImage;
-        memoryBarrier.srcAccessMask               = 0;
-        memoryBarrier.dstAccessMask               = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        memoryBarrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
-        memoryBarrier.newLayout                   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        memoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
-
-        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                                               VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                                               0,
-                                               0,
-                                               nullptr,
-                                               0,
-                                               nullptr,
-                                               1,
-                                               &memoryBarrier);
+        imageStates.addImage(stencilImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT);
+        imageStates.discard(stencilImage,
+                            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+        // the memory of pooled render targets got used by other effects in the meantime
+        for (auto& image : pooledImages)
+        {
+            imageStates.addImage(image, VK_IMAGE_LAYOUT_UNDEFINED);
+            imageStates.discard(image,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        }
+        imageStates.flush();
 
         Logger::debug("after the first pipeline barrier");
 
@@ -932,14 +971,23 @@ namespace vkBasalt
 
         if (bufferSize)
         {
+            uint32_t dynamicOffset = uniformSliceSize * imageIndex;
             pLogicalDevice->vkd.CmdBindDescriptorSets(
-                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &bufferDescriptorSet, 0, nullptr);
+                commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &bufferDescriptorSet, 1, &dynamicOffset);
             Logger::debug("after binding uniform buffer");
         }
 
+        // the passes get profiled on their own if the command buffer gets recorded with a profiler
+        GpuProfiler* pProfiler = GpuProfiler::current();
+
         bool backBufferNext = outputWrites % 2 == 0;
         for (size_t i = 0; i < graphicsPipelines.size(); i++)
         {
+            if (pProfiler)
+            {
+                pProfiler->beginScope(commandBuffer, "pass " + std::to_string(i));
+            }
+
             renderPassBeginInfos[i].framebuffer = framebuffers[i][imageIndex];
 
             Logger::debug("before beginn renderpass");
@@ -970,34 +1018,25 @@ namespace vkBasalt
                 backBufferNext = !backBufferNext;
             }
 
+            if (mipGenerator)
+            {
+                mipGenerator->generate(commandBuffer, computeMipMapImages[i]);
+            }
             for (auto& renderTarget : renderTargets[i])
             {
                 generateMipMaps(
                     pLogicalDevice, commandBuffer, textureImages[renderTarget][0], textureExtents[renderTarget], textureMipLevels[renderTarget]);
             }
+
+            if (pProfiler)
+            {
+                pProfiler->endScope(commandBuffer);
+            }
         }
-        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                               0,
-                                               0,
-                                               nullptr,
-                                               0,
-                                               nullptr,
-                                               1,
-                                               &secondBarrier);
-        secondBarrier.image = outputImages[imageIndex];
-        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                               0,
-                                               0,
-                                               nullptr,
-                                               0,
-                                               nullptr,
-                                               1,
-                                               &secondBarrier);
-        Logger::debug("after the second pipeline barrier");
+        imageStates.setState(outputImages[imageIndex],
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
     }
 
     ReshadeEffect::~ReshadeEffect()
@@ -1007,21 +1046,23 @@ namespace vkBasalt
         {
             pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, pipeline, nullptr);
         }
+        // the views of the generator have to go before the render targets
+        mipGenerator.reset();
 
         if (bufferSize)
         {
-            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stagingBufferMemory, nullptr);
-            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
+            freeMemory(pLogicalDevice, uniformBufferMemory);
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, uniformBuffer, nullptr);
         }
 
-        pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
+        pLogicalDevice->resourceCache->releasePipelineLayout(pipelineLayout);
         for (auto& renderPass : renderPasses)
         {
-            pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
+            pLogicalDevice->resourceCache->releaseRenderPass(renderPass);
         }
 
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, uniformDescriptorSetLayout, nullptr);
+        pLogicalDevice->resourceCache->releaseDescriptorSetLayout(imageSamplerDescriptorSetLayout);
+        pLogicalDevice->resourceCache->releaseDescriptorSetLayout(uniformDescriptorSetLayout);
 
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, shaderModule, nullptr);
 
@@ -1107,31 +1148,147 @@ namespace vkBasalt
 
         for (auto& sampler : samplers)
         {
-            pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
+            pLogicalDevice->resourceCache->releaseSampler(sampler);
         }
 
         for (auto& memory : textureMemory)
         {
-            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, memory, nullptr);
+            freeMemory(pLogicalDevice, memory);
+        }
+    }
+
+    // The preprocessor treats unknown identifiers in #if as 0, so an effect that checks the buffer size in a directive
+    // would silently get compiled wrong if the buffer size is not a number. Macros defined from the buffer size count too.
+    static bool usesBufferSizeInDirectives(const std::vector<std::filesystem::path>& files)
+    {
+        std::vector<std::vector<std::string>> directives;
+        for (const auto& file : files)
+        {
+            std::ifstream stream(file);
+            std::string   line;
+            while (std::getline(stream, line))
+            {
+                size_t first = line.find_first_not_of(" \t");
+                if (first == std::string::npos || line[first] != '#')
+                {
+                    continue;
+                }
+                // split the directive into identifiers, the first one is the directive name
+                std::vector<std::string> identifiers;
+                for (size_t i = first + 1; i < line.size();)
+                {
+                    if (std::isalpha(static_cast<unsigned char>(line[i])) || line[i] == '_')
+                    {
+                        size_t begin = i;
+                        while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_'))
+                        {
+                            i++;
+                        }
+                        identifiers.push_back(line.substr(begin, i - begin));
+                    }
+                    else
+                    {
+                        i++;
+                    }
+                }
+                if (identifiers.size() > 1)
+                {
+                    directives.push_back(identifiers);
+                }
+            }
+        }
+
+        std::set<std::string> bufferSizeMacros = {"BUFFER_WIDTH", "BUFFER_HEIGHT", "BUFFER_RCP_WIDTH", "BUFFER_RCP_HEIGHT"};
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (const auto& directive : directives)
+            {
+                if (directive[0] == "define" && !bufferSizeMacros.count(directive[1])
+                    && std::any_of(directive.begin() + 2, directive.end(), [&](const auto& id) { return bufferSizeMacros.count(id); }))
+                {
+                    bufferSizeMacros.insert(directive[1]);
+                    changed = true;
+                }
+            }
         }
+
+        return std::any_of(directives.begin(), directives.end(), [&](const auto& directive) {
+            return (directive[0] == "if" || directive[0] == "elif")
+                   && std::any_of(directive.begin() + 1, directive.end(), [&](const auto& id) { return bufferSizeMacros.count(id); });
+        });
     }
 
     void ReshadeEffect::createReshadeModule()
     {
-        std::string tempFile  = "/tmp/vkBasalt.spv";
-        std::string tempFile2 = "/tmp/vkBasalt.spv";
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        bool compiled = false;
+        if (pConfig->getOption("reshadeResolutionIndependent", "off") == "on")
+        {
+            compiled = compileReshadeModule(true);
+            if (!compiled)
+            {
+                Logger::info(effectName + " needs the buffer size at compile time, compiling it for " + std::to_string(imageExtent.width) + "x"
+                             + std::to_string(imageExtent.height));
+            }
+        }
+        if (!compiled)
+        {
+            compileReshadeModule(false);
+        }
+
+        std::chrono::duration<float, std::milli> moduleTime = std::chrono::high_resolution_clock::now() - startTime;
+        Logger::info("creating the reshade module for " + effectName + " took " + std::to_string(moduleTime.count()) + " ms");
+
+        VkShaderModuleCreateInfo shaderCreateInfo;
+        shaderCreateInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        shaderCreateInfo.pNext    = nullptr;
+        shaderCreateInfo.flags    = 0;
+        shaderCreateInfo.codeSize = module.spirv.size() * sizeof(uint32_t);
+        shaderCreateInfo.pCode    = module.spirv.data();
+
+        VkResult result = pLogicalDevice->vkd.CreateShaderModule(pLogicalDevice->device, &shaderCreateInfo, nullptr, &shaderModule);
+        ASSERT_VULKAN(result);
+
+        Logger::debug("created reshade shaderModule");
+    }
+
+    bool ReshadeEffect::compileReshadeModule(bool resolutionIndependent)
+    {
+        // effects that can't be compiled resolution independent, so we don't have to find that out again on every resize
+        static std::mutex                   incompatibleMutex;
+        static std::unordered_set<uint64_t> incompatibleModules;
 
         reshadefx::preprocessor preprocessor;
-        preprocessor.add_macro_definition("__RESHADE__", std::to_string(INT_MAX));
-        preprocessor.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "1");
-        preprocessor.add_macro_definition("__RENDERER__", "0x20000");
+
         // TODO add more macros
+        std::vector<std::pair<std::string, std::string>> macros = {
+            {"__RESHADE__", std::to_string(INT_MAX)},
+            {"__RESHADE_PERFORMANCE_MODE__", "1"},
+            {"__RENDERER__", "0x20000"},
+            {"BUFFER_WIDTH", resolutionIndependent ? "VKBASALT_BUFFER_WIDTH" : std::to_string(imageExtent.width)},
+            {"BUFFER_HEIGHT", resolutionIndependent ? "VKBASALT_BUFFER_HEIGHT" : std::to_string(imageExtent.height)},
+            {"BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)"},
+            {"BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)"},
+            {"BUFFER_COLOR_DEPTH", (inputOutputFormatUNORM == VK_FORMAT_A2R10G10B10_UNORM_PACK32) ? "10" : "8"},
+        };
+
+        // everything that changes the compiled module has to end up in the cache key,
+        // the preprocessed source already contains the included files
+        std::string cacheKeyData = "reshade " VKBASALT_RESHADE_VERSION "\ncodegen vulkan debug spec_constants flip_vertex\n";
+        for (auto& macro : macros)
+        {
+            preprocessor.add_macro_definition(macro.first, macro.second);
+            cacheKeyData += macro.first + "=" + macro.second + "\n";
+        }
+
+        if (resolutionIndependent)
+        {
+            // uniforms with an initializer become specialization constants, the values get set when creating the pipelines
+            preprocessor.append_string("uniform int VKBASALT_BUFFER_WIDTH = 1;\nuniform int VKBASALT_BUFFER_HEIGHT = 1;\n");
+        }
 
-        preprocessor.add_macro_definition("BUFFER_WIDTH", std::to_string(imageExtent.width));
-        preprocessor.add_macro_definition("BUFFER_HEIGHT", std::to_string(imageExtent.height));
-        preprocessor.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
-        preprocessor.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
-        preprocessor.add_macro_definition("BUFFER_COLOR_DEPTH", (inputOutputFormatUNORM == VK_FORMAT_A2R10G10B10_UNORM_PACK32) ? "10" : "8");
         preprocessor.add_include_path(pConfig->getOption("reshadeIncludePath"));
         if (!preprocessor.append_file(pConfig->getOption(effectName)))
         {
@@ -1139,17 +1296,53 @@ namespace vkBasalt
             Logger::err("Does the filepath exist and does it not include spaces?");
         }
 
-        reshadefx::parser parser;
-
         std::string errors = preprocessor.errors();
         if (errors != "")
         {
             Logger::err(errors);
         }
 
+        uint64_t cacheKey = hashString(preprocessor.output(), hashString(cacheKeyData));
+        if (resolutionIndependent)
+        {
+            std::lock_guard<std::mutex> lock(incompatibleMutex);
+            if (incompatibleModules.count(cacheKey))
+            {
+                return false;
+            }
+        }
+
+        if (loadReshadeModule(cacheKey, module))
+        {
+            return true;
+        }
+
+        if (resolutionIndependent)
+        {
+            std::vector<std::filesystem::path> files = preprocessor.included_files();
+            files.push_back(pConfig->getOption(effectName));
+            if (usesBufferSizeInDirectives(files))
+            {
+                std::lock_guard<std::mutex> lock(incompatibleMutex);
+                incompatibleModules.insert(cacheKey);
+                return false;
+            }
+        }
+
+        reshadefx::parser parser;
+
         std::unique_ptr<reshadefx::codegen> codegen(reshadefx::create_codegen_spirv(
             true /* vulkan semantics */, true /* debug info */, true /* uniforms to spec constants */, true /*flip vertex shader*/));
-        parser.parse(std::move(preprocessor.output()), codegen.get());
+        bool success = parser.parse(std::move(preprocessor.output()), codegen.get());
+
+        if (!success && resolutionIndependent)
+        {
+            // most likely the buffer size is used where the parser needs a literal, like texture sizes or array lengths
+            Logger::debug(parser.errors());
+            std::lock_guard<std::mutex> lock(incompatibleMutex);
+            incompatibleModules.insert(cacheKey);
+            return false;
+        }
 
         errors = parser.errors();
         if (errors != "")
@@ -1158,17 +1351,12 @@ namespace vkBasalt
         }
         codegen->write_result(module);
 
-        VkShaderModuleCreateInfo shaderCreateInfo;
-        shaderCreateInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        shaderCreateInfo.pNext    = nullptr;
-        shaderCreateInfo.flags    = 0;
-        shaderCreateInfo.codeSize = module.spirv.size() * sizeof(uint32_t);
-        shaderCreateInfo.pCode    = module.spirv.data();
-
-        VkResult result = pLogicalDevice->vkd.CreateShaderModule(pLogicalDevice->device, &shaderCreateInfo, nullptr, &shaderModule);
-        ASSERT_VULKAN(result);
-
-        Logger::debug("created reshade shaderModule");
+        // broken effects should not get cached, they might depend on files that get fixed later
+        if (success)
+        {
+            saveReshadeModule(cacheKey, module);
+        }
+        return true;
     }
 
     VkFormat ReshadeEffect::convertReshadeFormat(reshadefx::texture_format texFormat)
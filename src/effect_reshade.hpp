@@ -13,6 +13,7 @@
 #include "effect.hpp"
 #include "config.hpp"
 #include "reshade_uniforms.hpp"
+#include "mip_generator.hpp"
 
 #include "logical_device.hpp"
 
@@ -20,6 +21,10 @@
 #include "../reshade/source/effect_codegen.hpp"
 #include "../reshade/source/effect_preprocessor.hpp"
 
+#ifndef VKBASALT_RESHADE_VERSION
+#define VKBASALT_RESHADE_VERSION "unknown"
+#endif
+
 namespace vkBasalt
 {
     class ReshadeEffect : public Effect
@@ -32,8 +37,8 @@ namespace vkBasalt
                       std::vector<VkImage>              outputImages,
                       std::shared_ptr<vkBasalt::Config> pConfig,
                       std::string                       effectName);
-        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
-        void virtual updateEffect() override;
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
+        void virtual updateEffect(uint32_t imageIndex) override;
         void virtual useDepthImage(VkImageView depthImageView) override;
         virtual ~ReshadeEffect();
 
@@ -47,6 +52,7 @@ namespace vkBasalt
         std::vector<VkImageView>       outputImageViewsUNORM;
 
         std::unordered_map<std::string, std::vector<VkImage>>     textureImages;
+        std::vector<VkImage>                                      pooledImages;
         std::unordered_map<std::string, std::vector<VkImageView>> textureImageViewsUNORM;
         std::unordered_map<std::string, std::vector<VkImageView>> textureImageViewsSRGB;
         std::unordered_map<std::string, std::vector<VkImageView>> renderImageViewsSRGB;
@@ -68,7 +74,7 @@ namespace vkBasalt
         VkShaderModule                        shaderModule;
         VkDescriptorPool                      descriptorPool;
         std::vector<VkRenderPass>             renderPasses;
-        std::vector<std::vector<std::string>> renderTargets;
+        std::vector<std::vector<std::string>> renderTargets; // of each pass, that need their mip levels generated by blits
         std::vector<VkRenderPassBeginInfo>    renderPassBeginInfos;
         VkPipelineLayout                      pipelineLayout;
         std::vector<VkPipeline>               graphicsPipelines;
@@ -78,7 +84,12 @@ namespace vkBasalt
         std::shared_ptr<vkBasalt::Config>     pConfig;
         std::string                           effectName;
         reshadefx::module                     module;
-        std::vector<VkDeviceMemory>           textureMemory;
+        std::vector<MemoryAllocation>         textureMemory;
+
+        // the render targets that get their mip levels generated by a compute shader, and their images of each pass
+        std::unique_ptr<MipGenerator>             mipGenerator;
+        std::unordered_map<std::string, uint32_t> mipGeneratorImages;
+        std::vector<std::vector<uint32_t>>        computeMipMapImages;
 
         VkFormat    inputOutputFormatUNORM;
         VkFormat    inputOutputFormatSRGB;
@@ -91,14 +102,16 @@ namespace vkBasalt
         std::vector<VkImage>     backBufferImages;
         std::vector<VkImageView> backBufferImageViewsUNORM;
         std::vector<VkImageView> backBufferImageViewsSRGB;
-        VkBuffer                 stagingBuffer;
-        VkDeviceMemory           stagingBufferMemory;
+        VkBuffer                 uniformBuffer;
+        MemoryAllocation         uniformBufferMemory;
         uint32_t                 bufferSize;
+        VkDeviceSize             uniformSliceSize;
         VkDescriptorSet          bufferDescriptorSet;
 
         std::vector<std::shared_ptr<ReshadeUniform>> uniforms;
 
         void          createReshadeModule();
+        bool          compileReshadeModule(bool resolutionIndependent);
         VkFormat      convertReshadeFormat(reshadefx::texture_format texFormat);
         VkCompareOp   convertReshadeCompareOp(reshadefx::pass_stencil_func compareOp);
         VkStencilOp   convertReshadeStencilOp(reshadefx::pass_stencil_op stencilOp);
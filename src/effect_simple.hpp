@@ -21,7 +21,7 @@ namespace vkBasalt
     {
     public:
         SimpleEffect();
-        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
         virtual ~SimpleEffect();
 
     protected:
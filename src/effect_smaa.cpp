@@ -11,13 +11,35 @@
 #include "shader.hpp"
 #include "sampler.hpp"
 #include "image.hpp"
+#include "memory.hpp"
 #include "util.hpp"
+#include "format.hpp"
+#include "upload_batch.hpp"
 
 #include "AreaTex.h"
 #include "SearchTex.h"
 
 namespace vkBasalt
 {
+    static CachedTexture createSmaaTexture(
+        std::shared_ptr<LogicalDevice> pLogicalDevice, VkExtent3D extent, VkFormat format, uint32_t size, const unsigned char* pixels)
+    {
+        // submitted on its own, so that the texture is uploaded before any other effect can get it from the cache
+        UploadBatch uploadBatch(pLogicalDevice);
+
+        CachedTexture texture;
+        texture.image = createImages(pLogicalDevice,
+                                     1,
+                                     extent,
+                                     format,
+                                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                     texture.memory)[0];
+        uploadToImage(pLogicalDevice, texture.image, extent, size, pixels);
+        texture.imageView = createImageViews(pLogicalDevice, format, std::vector<VkImage>(1, texture.image))[0];
+        return texture;
+    }
+
     SmaaEffect::SmaaEffect(std::shared_ptr<LogicalDevice>    pLogicalDevice,
                            VkFormat                          format,
                            VkExtent2D                        imageExtent,
@@ -41,17 +63,25 @@ namespace vkBasalt
         this->outputImages   = outputImages;
         this->pConfig        = pConfig;
 
-        // create Images for the first and second pass at once -> less memory fragmentation
-        std::vector<VkImage> edgeAndBlendImages = createImages(pLogicalDevice,
-                                                               inputImages.size() * 2,
-                                                               {imageExtent.width, imageExtent.height, 1},
-                                                               VK_FORMAT_B8G8R8A8_UNORM, // TODO search for format and save it
-                                                               VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                                               imageMemory);
-
-        edgeImages  = std::vector<VkImage>(edgeAndBlendImages.begin(), edgeAndBlendImages.begin() + edgeAndBlendImages.size() / 2);
-        blendImages = std::vector<VkImage>(edgeAndBlendImages.begin() + edgeAndBlendImages.size() / 2, edgeAndBlendImages.end());
+        // the edge and blend images are only needed while smaa gets applied, so they share their memory with other effects
+        edgeImages  = createTransientImages(pLogicalDevice,
+                                            inputImages.size(),
+                                            {imageExtent.width, imageExtent.height, 1},
+                                            VK_FORMAT_B8G8R8A8_UNORM, // TODO search for format and save it
+                                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+        blendImages = createTransientImages(pLogicalDevice,
+                                            inputImages.size(),
+                                            {imageExtent.width, imageExtent.height, 1},
+                                            VK_FORMAT_B8G8R8A8_UNORM,
+                                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+        // the edge pass marks the pixels it writes edges for, the blend pass only runs on them
+        stencilFormat = getStencilFormat(pLogicalDevice);
+        Logger::debug("Stencil Format: " + std::to_string(stencilFormat));
+        stencilImages = createTransientImages(pLogicalDevice,
+                                              inputImages.size(),
+                                              {imageExtent.width, imageExtent.height, 1},
+                                              stencilFormat,
+                                              VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
 
         inputImageViews = createImageViews(pLogicalDevice, format, inputImages);
         Logger::debug("created input ImageViews");
@@ -59,38 +89,36 @@ namespace vkBasalt
         Logger::debug("created edge  ImageViews");
         blendImageViews = createImageViews(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, blendImages);
         Logger::debug("created blend ImageViews");
+        stencilImageViews = createImageViews(
+            pLogicalDevice, stencilFormat, stencilImages, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+        Logger::debug("created stencil ImageViews");
         outputImageViews = createImageViews(pLogicalDevice, format, outputImages);
         Logger::debug("created output ImageViews");
         sampler = createSampler(pLogicalDevice);
         Logger::debug("created sampler");
 
-        VkExtent3D areaImageExtent = {AREATEX_WIDTH, AREATEX_HEIGHT, 1};
-
-        areaImage = createImages(pLogicalDevice,
-                                 1,
-                                 areaImageExtent,
-                                 VK_FORMAT_R8G8_UNORM, // TODO search for format and save it
-                                 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                 areaMemory)[0];
-
-        VkExtent3D searchImageExtent = {SEARCHTEX_WIDTH, SEARCHTEX_HEIGHT, 1};
-
-        searchImage = createImages(pLogicalDevice,
-                                   1,
-                                   searchImageExtent,
-                                   VK_FORMAT_R8_UNORM, // TODO search for format and save it
-                                   VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                   searchMemory)[0];
-
-        uploadToImage(pLogicalDevice, areaImage, areaImageExtent, AREATEX_SIZE, areaTexBytes);
-
-        uploadToImage(pLogicalDevice, searchImage, searchImageExtent, SEARCHTEX_SIZE, searchTexBytes);
-
-        areaImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8G8_UNORM, std::vector<VkImage>(1, areaImage))[0];
+        // the lookup textures never change, so all smaa effects of the device share them
+        areaImageView = pLogicalDevice->resourceCache
+                            ->getTexture("smaa_area",
+                                         [&]() {
+                                             return createSmaaTexture(pLogicalDevice,
+                                                                      {AREATEX_WIDTH, AREATEX_HEIGHT, 1},
+                                                                      VK_FORMAT_R8G8_UNORM, // TODO search for format and save it
+                                                                      AREATEX_SIZE,
+                                                                      areaTexBytes);
+                                         })
+                            .imageView;
         Logger::debug("after creating area ImageView");
-        searchImageView = createImageViews(pLogicalDevice, VK_FORMAT_R8_UNORM, std::vector<VkImage>(1, searchImage))[0];
+        searchImageView = pLogicalDevice->resourceCache
+                              ->getTexture("smaa_search",
+                                           [&]() {
+                                               return createSmaaTexture(pLogicalDevice,
+                                                                        {SEARCHTEX_WIDTH, SEARCHTEX_HEIGHT, 1},
+                                                                        VK_FORMAT_R8_UNORM,
+                                                                        SEARCHTEX_SIZE,
+                                                                        searchTexBytes);
+                                           })
+                              .imageView;
         Logger::debug("created search ImageView");
 
         imageSamplerDescriptorSetLayout = createImageSamplerDescriptorSetLayout(pLogicalDevice, 5);
@@ -139,7 +167,8 @@ namespace vkBasalt
         createShaderModule(pLogicalDevice, shaderCode, &neignborFragmentModule);
 
         renderPass      = createRenderPass(pLogicalDevice, format);
-        unormRenderPass = createRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM);
+        edgeRenderPass  = createStencilRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, stencilFormat, true);
+        blendRenderPass = createStencilRenderPass(pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, stencilFormat, false);
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {imageSamplerDescriptorSetLayout};
         pipelineLayout                                          = createGraphicsPipelineLayout(pLogicalDevice, descriptorSetLayouts);
@@ -161,6 +190,35 @@ namespace vkBasalt
         specializationInfo.dataSize      = sizeof(smaaOptions);
         specializationInfo.pData         = &smaaOptions;
 
+        // the edge shader discards pixels without edges, so only the pixels with edges get the reference value in the stencil
+        VkPipelineDepthStencilStateCreateInfo edgeDepthStencilState = {};
+
+        edgeDepthStencilState.sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        edgeDepthStencilState.pNext                 = nullptr;
+        edgeDepthStencilState.depthTestEnable       = VK_FALSE;
+        edgeDepthStencilState.depthWriteEnable      = VK_FALSE;
+        edgeDepthStencilState.depthCompareOp        = VK_COMPARE_OP_ALWAYS;
+        edgeDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+        edgeDepthStencilState.stencilTestEnable     = VK_TRUE;
+        edgeDepthStencilState.front.failOp          = VK_STENCIL_OP_KEEP;
+        edgeDepthStencilState.front.passOp          = VK_STENCIL_OP_REPLACE;
+        edgeDepthStencilState.front.depthFailOp     = VK_STENCIL_OP_KEEP;
+        edgeDepthStencilState.front.compareOp       = VK_COMPARE_OP_ALWAYS;
+        edgeDepthStencilState.front.compareMask     = 0xff;
+        edgeDepthStencilState.front.writeMask       = 0xff;
+        edgeDepthStencilState.front.reference       = 1;
+        edgeDepthStencilState.back                  = edgeDepthStencilState.front;
+        edgeDepthStencilState.minDepthBounds        = 0.0f;
+        edgeDepthStencilState.maxDepthBounds        = 1.0f;
+
+        // the weights of pixels without edges are 0, which is what the blend image gets cleared to
+        VkPipelineDepthStencilStateCreateInfo blendDepthStencilState = edgeDepthStencilState;
+
+        blendDepthStencilState.front.passOp    = VK_STENCIL_OP_KEEP;
+        blendDepthStencilState.front.compareOp = VK_COMPARE_OP_EQUAL;
+        blendDepthStencilState.front.writeMask = 0;
+        blendDepthStencilState.back            = blendDepthStencilState.front;
+
         edgePipeline = createGraphicsPipeline(pLogicalDevice,
                                               edgeVertexModule,
                                               &specializationInfo,
@@ -169,8 +227,10 @@ namespace vkBasalt
                                               &specializationInfo,
                                               "main",
                                               imageExtent,
-                                              unormRenderPass,
-                                              pipelineLayout);
+                                              edgeRenderPass,
+                                              pipelineLayout,
+                                              false,
+                                              &edgeDepthStencilState);
 
         blendPipeline = createGraphicsPipeline(pLogicalDevice,
                                                blendVertexModule,
@@ -180,8 +240,10 @@ namespace vkBasalt
                                                &specializationInfo,
                                                "main",
                                                imageExtent,
-                                               unormRenderPass,
-                                               pipelineLayout);
+                                               blendRenderPass,
+                                               pipelineLayout,
+                                               false,
+                                               &blendDepthStencilState);
 
         neighborPipeline = createGraphicsPipeline(pLogicalDevice,
                                                   neighborVertexModule,
@@ -206,63 +268,43 @@ namespace vkBasalt
                                                                          std::vector<VkSampler>(imageViewsVector.size(), sampler),
                                                                          imageViewsVector);
 
-        edgeFramebuffers     = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {edgeImageViews});
-        blendFramebuffers    = createFramebuffers(pLogicalDevice, unormRenderPass, imageExtent, {blendImageViews});
+        edgeFramebuffers     = createFramebuffers(pLogicalDevice, edgeRenderPass, imageExtent, {edgeImageViews, stencilImageViews});
+        blendFramebuffers    = createFramebuffers(pLogicalDevice, blendRenderPass, imageExtent, {blendImageViews, stencilImageViews});
         neignborFramebuffers = createFramebuffers(pLogicalDevice, renderPass, imageExtent, {outputImageViews});
     }
-    void SmaaEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    void SmaaEffect::applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates)
     {
         Logger::debug("applying smaa effect to cb " + convertToString(commandBuffer));
-        // Used to make the Image accessable by the shader
-        VkImageMemoryBarrier memoryBarrier;
-        memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        memoryBarrier.pNext               = nullptr;
-        memoryBarrier.srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT;
-        memoryBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-        memoryBarrier.oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        memoryBarrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        memoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        memoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        memoryBarrier.image               = inputImages[imageIndex];
-
-        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        memoryBarrier.subresourceRange.baseMipLevel   = 0;
-        memoryBarrier.subresourceRange.levelCount     = 1;
-        memoryBarrier.subresourceRange.baseArrayLayer = 0;
-        memoryBarrier.subresourceRange.layerCount     = 1;
-
-        // Reverses the first Barrier
-        VkImageMemoryBarrier secondBarrier;
-        secondBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        secondBarrier.pNext               = nullptr;
-        secondBarrier.srcAccessMask       = VK_ACCESS_SHADER_READ_BIT;
-        secondBarrier.dstAccessMask       = 0;
-        secondBarrier.oldLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        secondBarrier.newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        secondBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        secondBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        secondBarrier.image               = inputImages[imageIndex];
-
-        secondBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        secondBarrier.subresourceRange.baseMipLevel   = 0;
-        secondBarrier.subresourceRange.levelCount     = 1;
-        secondBarrier.subresourceRange.baseArrayLayer = 0;
-        secondBarrier.subresourceRange.layerCount     = 1;
-
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+        // the edge and blend images only live during the effect, the render passes transition the written images on their own
+        imageStates.addImage(edgeImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED);
+        imageStates.addImage(blendImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED);
+        imageStates.addImage(stencilImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+
+        VkPipelineStageFlags stencilStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+        imageStates.use(
+            inputImages[imageIndex], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        imageStates.discard(
+            edgeImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        imageStates.discard(stencilImages[imageIndex],
+                            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                            stencilStages,
+                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+        imageStates.flush();
         Logger::debug("after the first pipeline barrier");
 
         VkRenderPassBeginInfo renderPassBeginInfo;
         renderPassBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassBeginInfo.pNext             = nullptr;
-        renderPassBeginInfo.renderPass        = unormRenderPass;
+        renderPassBeginInfo.renderPass        = edgeRenderPass;
         renderPassBeginInfo.framebuffer       = edgeFramebuffers[imageIndex];
         renderPassBeginInfo.renderArea.offset = {0, 0};
         renderPassBeginInfo.renderArea.extent = imageExtent;
-        VkClearValue clearValue               = {0.0f, 0.0f, 0.0f, 1.0f};
-        renderPassBeginInfo.clearValueCount   = 1;
-        renderPassBeginInfo.pClearValues      = &clearValue;
+        VkClearValue clearValues[2];
+        clearValues[0].color                = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        clearValues[1].depthStencil         = {1.0f, 0};
+        renderPassBeginInfo.clearValueCount = 2;
+        renderPassBeginInfo.pClearValues    = clearValues;
         // edge renderPass
         Logger::debug("before beginn edge renderpass");
         pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -281,12 +323,27 @@ namespace vkBasalt
         pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
         Logger::debug("after end renderpass");
 
-        memoryBarrier.image             = edgeImages[imageIndex];
+        imageStates.setState(edgeImages[imageIndex],
+                             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        imageStates.setState(stencilImages[imageIndex],
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                             stencilStages,
+                             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+        renderPassBeginInfo.renderPass  = blendRenderPass;
         renderPassBeginInfo.framebuffer = blendFramebuffers[imageIndex];
+        // the pixels that the stencil test skips have to end up with the weights 0 like without the stencil
+        clearValues[0].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
         // blend renderPass
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
-        Logger::debug("after the first pipeline barrier");
+        imageStates.use(
+            edgeImages[imageIndex], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        imageStates.use(
+            stencilImages[imageIndex], VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, stencilStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT);
+        imageStates.discard(
+            blendImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        imageStates.flush();
+        Logger::debug("after the second pipeline barrier");
 
         Logger::debug("before beginn blend renderpass");
         pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -301,13 +358,19 @@ namespace vkBasalt
         pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
         Logger::debug("after end renderpass");
 
-        memoryBarrier.image             = blendImages[imageIndex];
+        imageStates.setState(blendImages[imageIndex],
+                             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
         renderPassBeginInfo.framebuffer = neignborFramebuffers[imageIndex];
         renderPassBeginInfo.renderPass  = renderPass;
         // neighbor renderPass
-        pLogicalDevice->vkd.CmdPipelineBarrier(
-            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
-        Logger::debug("after the first pipeline barrier");
+        imageStates.use(
+            blendImages[imageIndex], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        imageStates.discard(
+            outputImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        imageStates.flush();
+        Logger::debug("after the third pipeline barrier");
 
         Logger::debug("before beginn neighbor renderpass");
         pLogicalDevice->vkd.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -322,17 +385,10 @@ namespace vkBasalt
         pLogicalDevice->vkd.CmdEndRenderPass(commandBuffer);
         Logger::debug("after end renderpass");
 
-        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
-                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                               0,
-                                               0,
-                                               nullptr,
-                                               0,
-                                               nullptr,
-                                               1,
-                                               &secondBarrier);
-        Logger::debug("after the second pipeline barrier");
+        imageStates.setState(outputImages[imageIndex],
+                             VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
     }
     SmaaEffect::~SmaaEffect()
     {
@@ -341,10 +397,11 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, blendPipeline, nullptr);
         pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, neighborPipeline, nullptr);
 
-        pLogicalDevice->vkd.DestroyPipelineLayout(pLogicalDevice->device, pipelineLayout, nullptr);
-        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, renderPass, nullptr);
-        pLogicalDevice->vkd.DestroyRenderPass(pLogicalDevice->device, unormRenderPass, nullptr);
-        pLogicalDevice->vkd.DestroyDescriptorSetLayout(pLogicalDevice->device, imageSamplerDescriptorSetLayout, nullptr);
+        pLogicalDevice->resourceCache->releasePipelineLayout(pipelineLayout);
+        pLogicalDevice->resourceCache->releaseRenderPass(renderPass);
+        pLogicalDevice->resourceCache->releaseRenderPass(edgeRenderPass);
+        pLogicalDevice->resourceCache->releaseRenderPass(blendRenderPass);
+        pLogicalDevice->resourceCache->releaseDescriptorSetLayout(imageSamplerDescriptorSetLayout);
 
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, edgeVertexModule, nullptr);
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, edgeFragmentModule, nullptr);
@@ -354,9 +411,6 @@ namespace vkBasalt
         pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, neignborFragmentModule, nullptr);
 
         pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, imageMemory, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, areaMemory, nullptr);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, searchMemory, nullptr);
         for (unsigned int i = 0; i < edgeFramebuffers.size(); i++)
         {
             pLogicalDevice->vkd.DestroyFramebuffer(pLogicalDevice->device, edgeFramebuffers[i], nullptr);
@@ -365,16 +419,16 @@ namespace vkBasalt
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, inputImageViews[i], nullptr);
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, edgeImageViews[i], nullptr);
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, blendImageViews[i], nullptr);
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, stencilImageViews[i], nullptr);
             pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, outputImageViews[i], nullptr);
             pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, edgeImages[i], nullptr);
             pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, blendImages[i], nullptr);
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, stencilImages[i], nullptr);
         }
         Logger::debug("after DestroyImageView");
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, areaImageView, nullptr);
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, areaImage, nullptr);
-        pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, searchImageView, nullptr);
-        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, searchImage, nullptr);
+        pLogicalDevice->resourceCache->releaseTexture("smaa_area");
+        pLogicalDevice->resourceCache->releaseTexture("smaa_search");
 
-        pLogicalDevice->vkd.DestroySampler(pLogicalDevice->device, sampler, nullptr);
+        pLogicalDevice->resourceCache->releaseSampler(sampler);
     }
 } // namespace vkBasalt
@@ -26,7 +26,7 @@ namespace vkBasalt
                    std::vector<VkImage>              inputImages,
                    std::vector<VkImage>              outputImages,
                    std::shared_ptr<vkBasalt::Config> pConfig);
-        void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
         ~SmaaEffect();
 
     private:
@@ -34,17 +34,17 @@ namespace vkBasalt
         std::vector<VkImage>           inputImages;
         std::vector<VkImage>           edgeImages;
         std::vector<VkImage>           blendImages;
+        std::vector<VkImage>           stencilImages;
         std::vector<VkImage>           outputImages;
         std::vector<VkImageView>       inputImageViews;
         std::vector<VkImageView>       edgeImageViews;
         std::vector<VkImageView>       blendImageViews;
+        std::vector<VkImageView>       stencilImageViews;
         std::vector<VkImageView>       outputImageViews;
         std::vector<VkDescriptorSet>   imageDescriptorSets;
         std::vector<VkFramebuffer>     edgeFramebuffers;
         std::vector<VkFramebuffer>     blendFramebuffers;
         std::vector<VkFramebuffer>     neignborFramebuffers;
-        VkImage                        areaImage;
-        VkImage                        searchImage;
         VkImageView                    areaImageView;
         VkImageView                    searchImageView;
         VkDescriptorSetLayout          imageSamplerDescriptorSetLayout;
@@ -56,16 +56,15 @@ namespace vkBasalt
         VkShaderModule                 neighborVertexModule;
         VkShaderModule                 neignborFragmentModule;
         VkRenderPass                   renderPass;
-        VkRenderPass                   unormRenderPass;
+        VkRenderPass                   edgeRenderPass;
+        VkRenderPass                   blendRenderPass;
         VkPipelineLayout               pipelineLayout;
         VkPipeline                     edgePipeline;
         VkPipeline                     blendPipeline;
         VkPipeline                     neighborPipeline;
         VkExtent2D                     imageExtent;
         VkFormat                       format;
-        VkDeviceMemory                 imageMemory;
-        VkDeviceMemory                 areaMemory;
-        VkDeviceMemory                 searchMemory;
+        VkFormat                       stencilFormat;
         VkSampler                      sampler;
 
         std::shared_ptr<vkBasalt::Config> pConfig;
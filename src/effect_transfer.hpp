@@ -26,7 +26,7 @@ namespace vkBasalt
                        std::vector<VkImage>              inputImages,
                        std::vector<VkImage>              outputImages,
                        std::shared_ptr<vkBasalt::Config> pConfig);
-        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer) override;
+        void virtual applyEffect(uint32_t imageIndex, VkCommandBuffer commandBuffer, ImageStateTracker& imageStates) override;
         virtual ~TransferEffect();
 
     private:
@@ -4,10 +4,9 @@
 
 namespace vkBasalt
 {
-    std::vector<VkImage> createFakeSwapchainImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
-                                                   VkSwapchainCreateInfoKHR       swapchainCreateInfo,
-                                                   uint32_t                       count,
-                                                   VkDeviceMemory&                deviceMemory)
+    static std::vector<VkImage> createUnboundFakeSwapchainImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                                 VkSwapchainCreateInfoKHR       swapchainCreateInfo,
+                                                                 uint32_t                       count)
     {
         std::vector<VkImage> fakeImages(count);
 
@@ -43,6 +42,11 @@ namespace vkBasalt
         imageCreateInfo.queueFamilyIndexCount = swapchainCreateInfo.queueFamilyIndexCount;
         imageCreateInfo.pQueueFamilyIndices   = swapchainCreateInfo.pQueueFamilyIndices;
         imageCreateInfo.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED;
+        // the srgb views of images that compute effects write to can't have the storage usage
+        if (unormFormat != srgbFormat && (imageCreateInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT))
+        {
+            imageCreateInfo.flags |= VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+        }
 
         VkResult result;
         for (uint32_t i = 0; i < count; i++)
@@ -50,6 +54,15 @@ namespace vkBasalt
             result = pLogicalDevice->vkd.CreateImage(pLogicalDevice->device, &imageCreateInfo, nullptr, &(fakeImages[i]));
             ASSERT_VULKAN(result);
         }
+        return fakeImages;
+    }
+
+    std::vector<VkImage> createFakeSwapchainImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                   VkSwapchainCreateInfoKHR       swapchainCreateInfo,
+                                                   uint32_t                       count,
+                                                   MemoryAllocation&              deviceMemory)
+    {
+        std::vector<VkImage> fakeImages = createUnboundFakeSwapchainImages(pLogicalDevice, swapchainCreateInfo, count);
 
         // Allocate a bunch of memory for all images at one
         VkMemoryRequirements memoryRequirements;
@@ -63,21 +76,28 @@ namespace vkBasalt
             memoryRequirements.size = (memoryRequirements.size / memoryRequirements.alignment + 1) * memoryRequirements.alignment;
         }
 
-        VkMemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memoryAllocateInfo.pNext          = nullptr;
-        memoryAllocateInfo.allocationSize = memoryRequirements.size * count;
-        memoryAllocateInfo.memoryTypeIndex =
-            findMemoryTypeIndex(pLogicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VkMemoryRequirements allImagesRequirements = memoryRequirements;
+        allImagesRequirements.size                 = memoryRequirements.size * count;
 
-        result = pLogicalDevice->vkd.AllocateMemory(pLogicalDevice->device, &memoryAllocateInfo, nullptr, &deviceMemory);
-        ASSERT_VULKAN(result);
+        deviceMemory = allocateMemory(pLogicalDevice, allImagesRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
 
         for (uint32_t i = 0; i < count; i++)
         {
-            result = pLogicalDevice->vkd.BindImageMemory(pLogicalDevice->device, fakeImages[i], deviceMemory, memoryRequirements.size * i);
+            VkResult result = pLogicalDevice->vkd.BindImageMemory(
+                pLogicalDevice->device, fakeImages[i], deviceMemory.memory, deviceMemory.offset + memoryRequirements.size * i);
             ASSERT_VULKAN(result);
         }
         return fakeImages;
     }
+
+    std::vector<VkImage> createFakeSwapchainImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                   VkSwapchainCreateInfoKHR       swapchainCreateInfo,
+                                                   uint32_t                       count,
+                                                   TransientImageMemory&          transientMemory,
+                                                   uint32_t                       writingEffect)
+    {
+        std::vector<VkImage> fakeImages = createUnboundFakeSwapchainImages(pLogicalDevice, swapchainCreateInfo, count);
+        transientMemory.bindImages(fakeImages, writingEffect, writingEffect + 1);
+        return fakeImages;
+    }
 } // namespace vkBasalt
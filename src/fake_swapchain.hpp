@@ -10,13 +10,22 @@
 #include "vulkan_include.hpp"
 
 #include "logical_device.hpp"
+#include "transient_memory.hpp"
 
 namespace vkBasalt
 {
     std::vector<VkImage> createFakeSwapchainImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
                                                    VkSwapchainCreateInfoKHR       swapchainCreateInfo,
                                                    uint32_t                       count,
-                                                   VkDeviceMemory&                deviceMemory);
-}
+                                                   MemoryAllocation&              deviceMemory);
+
+    // the images between two effects, they only live from writingEffect until the effect after it read them.
+    // If the usage of swapchainCreateInfo has VK_IMAGE_USAGE_STORAGE_BIT, the images can be the output of a compute effect
+    std::vector<VkImage> createFakeSwapchainImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                   VkSwapchainCreateInfoKHR       swapchainCreateInfo,
+                                                   uint32_t                       count,
+                                                   TransientImageMemory&          transientMemory,
+                                                   uint32_t                       writingEffect);
+} // namespace vkBasalt
 
 #endif // FAKE_SWAPCHAIN_HPP_INCLUDED
@@ -147,4 +147,24 @@ namespace vkBasalt
             default: return false;
         }
     }
+
+    uint32_t getBlockSize(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK: return 8;
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return 8;
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK: return 8;
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK: return 8;
+            case VK_FORMAT_BC4_UNORM_BLOCK: return 8;
+            case VK_FORMAT_BC2_UNORM_BLOCK: return 16;
+            case VK_FORMAT_BC2_SRGB_BLOCK: return 16;
+            case VK_FORMAT_BC3_UNORM_BLOCK: return 16;
+            case VK_FORMAT_BC3_SRGB_BLOCK: return 16;
+            case VK_FORMAT_BC5_UNORM_BLOCK: return 16;
+            case VK_FORMAT_BC7_UNORM_BLOCK: return 16;
+            case VK_FORMAT_BC7_SRGB_BLOCK: return 16;
+            default: return 0;
+        }
+    }
 } // namespace vkBasalt
@@ -33,6 +33,9 @@ namespace vkBasalt
     bool isDepthFormat(VkFormat format);
 
     bool isStencilFormat(VkFormat format);
+
+    // Returns the bytes of a 4x4 block of a BCn format, 0 if format is not block compressed
+    uint32_t getBlockSize(VkFormat format);
 } // namespace vkBasalt
 
 #endif // FORMAT_HPP_INCLUDED
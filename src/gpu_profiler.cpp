@@ -0,0 +1,242 @@
+#include "gpu_profiler.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <numeric>
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        thread_local GpuProfiler* pCurrentProfiler = nullptr;
+    } // namespace
+
+    GpuProfiler::GpuProfiler(std::shared_ptr<LogicalDevice>  pLogicalDevice,
+                             uint32_t                        imageCount,
+                             const std::vector<std::string>& effectNames,
+                             float                           interval,
+                             const std::string&              csvFile)
+        : pLogicalDevice(pLogicalDevice), effectNames(effectNames), imageScopes(imageCount), pending(imageCount, false), results(maxScopes * 4),
+          interval(interval), csvFile(csvFile)
+    {
+        VkPhysicalDeviceProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &properties);
+        timestampPeriod = properties.limits.timestampPeriod;
+
+        uint32_t queueFamilyCount = 0;
+        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+        uint32_t validBits = queueFamilies[pLogicalDevice->queueFamilyIndex].timestampValidBits;
+        if (validBits == 0)
+        {
+            Logger::warn("the queue does not support timestamps, profiling is disabled");
+            return;
+        }
+        timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+        VkQueryPoolCreateInfo queryPoolCreateInfo;
+        queryPoolCreateInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolCreateInfo.pNext              = nullptr;
+        queryPoolCreateInfo.flags              = 0;
+        queryPoolCreateInfo.queryType          = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolCreateInfo.queryCount         = imageCount * maxScopes * 2;
+        queryPoolCreateInfo.pipelineStatistics = 0;
+
+        VkResult result = pLogicalDevice->vkd.CreateQueryPool(pLogicalDevice->device, &queryPoolCreateInfo, nullptr, &queryPool);
+        ASSERT_VULKAN(result);
+
+        startTime  = std::chrono::steady_clock::now();
+        lastReport = startTime;
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+        if (queryPool != VK_NULL_HANDLE)
+        {
+            report();
+            pLogicalDevice->vkd.DestroyQueryPool(pLogicalDevice->device, queryPool, nullptr);
+        }
+    }
+
+    bool GpuProfiler::isSupported()
+    {
+        return queryPool != VK_NULL_HANDLE;
+    }
+
+    GpuProfiler* GpuProfiler::current()
+    {
+        return pCurrentProfiler;
+    }
+
+    void GpuProfiler::beginCommandBuffer(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+    {
+        recordingImage = imageIndex;
+        imageScopes[imageIndex].clear();
+        openScopes.clear();
+        pCurrentProfiler = this;
+
+        pLogicalDevice->vkd.CmdResetQueryPool(commandBuffer, queryPool, imageIndex * maxScopes * 2, maxScopes * 2);
+    }
+
+    void GpuProfiler::endCommandBuffer()
+    {
+        pCurrentProfiler = nullptr;
+    }
+
+    void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name)
+    {
+        std::vector<uint32_t>& recordedScopes = imageScopes[recordingImage];
+
+        OpenScope openScope;
+        openScope.name = openScopes.empty() ? name : openScopes.back().name + "/" + name;
+        openScope.pair = recordedScopes.size();
+        if (openScope.pair >= maxScopes)
+        {
+            Logger::warn("too many profiling scopes, ignoring " + openScope.name);
+            openScope.pair = maxScopes;
+            openScopes.push_back(openScope);
+            return;
+        }
+
+        auto it = scopeIndices.find(openScope.name);
+        if (it == scopeIndices.end())
+        {
+            it = scopeIndices.emplace(openScope.name, scopes.size()).first;
+            scopes.emplace_back();
+            scopes.back().name = openScope.name;
+        }
+        recordedScopes.push_back(it->second);
+
+        pLogicalDevice->vkd.CmdWriteTimestamp(
+            commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, (recordingImage * maxScopes + openScope.pair) * 2);
+        openScopes.push_back(std::move(openScope));
+    }
+
+    void GpuProfiler::beginEffectScope(VkCommandBuffer commandBuffer, uint32_t effectIndex)
+    {
+        beginScope(commandBuffer, effectIndex < effectNames.size() ? effectNames[effectIndex] : "effect " + std::to_string(effectIndex));
+    }
+
+    void GpuProfiler::endScope(VkCommandBuffer commandBuffer)
+    {
+        uint32_t pair = openScopes.back().pair;
+        openScopes.pop_back();
+        if (pair == maxScopes)
+        {
+            return;
+        }
+        pLogicalDevice->vkd.CmdWriteTimestamp(
+            commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, (recordingImage * maxScopes + pair) * 2 + 1);
+    }
+
+    void GpuProfiler::markSubmitted(uint32_t imageIndex)
+    {
+        pending[imageIndex] = true;
+    }
+
+    void GpuProfiler::collect(uint32_t imageIndex)
+    {
+        std::vector<uint32_t>& recordedScopes = imageScopes[imageIndex];
+        if (!pending[imageIndex] || recordedScopes.empty())
+        {
+            return;
+        }
+        pending[imageIndex] = false;
+
+        // every query gets its value followed by its availability
+        uint32_t queryCount = recordedScopes.size() * 2;
+        VkResult result     = pLogicalDevice->vkd.GetQueryPoolResults(pLogicalDevice->device,
+                                                                  queryPool,
+                                                                  imageIndex * maxScopes * 2,
+                                                                  queryCount,
+                                                                  queryCount * 2 * sizeof(uint64_t),
+                                                                  results.data(),
+                                                                  2 * sizeof(uint64_t),
+                                                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS && result != VK_NOT_READY)
+        {
+            Logger::err("reading the timestamps failed: " + std::to_string(result));
+            return;
+        }
+
+        for (uint32_t i = 0; i < recordedScopes.size(); i++)
+        {
+            const uint64_t* pBegin = &results[i * 4];
+            const uint64_t* pEnd   = &results[i * 4 + 2];
+            if (!pBegin[1] || !pEnd[1])
+            {
+                continue;
+            }
+
+            ScopeStatistics& scope = scopes[recordedScopes[i]];
+            float            time  = ((pEnd[0] - pBegin[0]) & timestampMask) * timestampPeriod / 1000000.0f;
+            if (scope.samples.size() < sampleCount)
+            {
+                scope.samples.push_back(time);
+            }
+            else
+            {
+                scope.samples[scope.nextSample] = time;
+            }
+            scope.nextSample = (scope.nextSample + 1) % sampleCount;
+        }
+
+        if (std::chrono::steady_clock::now() - lastReport >= interval)
+        {
+            report();
+        }
+    }
+
+    void GpuProfiler::report()
+    {
+        auto now   = std::chrono::steady_clock::now();
+        lastReport = now;
+
+        FILE* file = nullptr;
+        if (!csvFile.empty())
+        {
+            file = std::fopen(csvFile.c_str(), "a");
+            if (file == nullptr)
+            {
+                Logger::err("could not open profiling file " + csvFile);
+            }
+            else if (std::fseek(file, 0, SEEK_END) == 0 && std::ftell(file) == 0)
+            {
+                std::fprintf(file, "time_s,scope,min_ms,avg_ms,p99_ms,samples\n");
+            }
+        }
+
+        float              seconds = std::chrono::duration<float>(now - startTime).count();
+        std::vector<float> sorted;
+        for (auto& scope : scopes)
+        {
+            if (scope.samples.empty())
+            {
+                continue;
+            }
+            sorted = scope.samples;
+            std::sort(sorted.begin(), sorted.end());
+
+            float minimum    = sorted.front();
+            float average    = std::accumulate(sorted.begin(), sorted.end(), 0.0f) / sorted.size();
+            float percentile = sorted[(sorted.size() - 1) * 99 / 100];
+
+            char line[256];
+            std::snprintf(line, sizeof(line), "%.3f ms avg, %.3f ms min, %.3f ms p99", average, minimum, percentile);
+            Logger::info("gpu time of " + scope.name + ": " + line);
+            if (file)
+            {
+                std::fprintf(file, "%.3f,%s,%.4f,%.4f,%.4f,%zu\n", seconds, scope.name.c_str(), minimum, average, percentile, sorted.size());
+            }
+        }
+
+        if (file)
+        {
+            std::fclose(file);
+        }
+    }
+} // namespace vkBasalt
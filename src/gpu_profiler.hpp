@@ -0,0 +1,93 @@
+#ifndef GPU_PROFILER_HPP_INCLUDED
+#define GPU_PROFILER_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <unordered_map>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Measures the gpu time of every effect of a swapchain, and of every pass of reshade effects, with timestamp queries.
+    // Each swapchain image has its own range of queries in the pool, they get reset at the start of its command buffer.
+    // The results of an image are read back right after its fence got waited on for the next present, so reading never stalls.
+    // The rolling min, average and 99th percentile of each scope get logged every interval and appended to a csv file if one is set.
+    class GpuProfiler
+    {
+    public:
+        GpuProfiler(std::shared_ptr<LogicalDevice>  pLogicalDevice,
+                    uint32_t                        imageCount,
+                    const std::vector<std::string>& effectNames,
+                    float                           interval,
+                    const std::string&              csvFile);
+        ~GpuProfiler();
+
+        // false if the queue can't write timestamps, the profiler does nothing then
+        bool isSupported();
+
+        // the profiler of the command buffer that gets recorded on the current thread, nullptr if there is none
+        static GpuProfiler* current();
+
+        // resets the queries of imageIndex and makes this the current profiler until endCommandBuffer
+        void beginCommandBuffer(uint32_t imageIndex, VkCommandBuffer commandBuffer);
+        void endCommandBuffer();
+
+        // scopes can be nested, the name of a nested scope gets prefixed with the names of the outer scopes
+        void beginScope(VkCommandBuffer commandBuffer, const std::string& name);
+        void beginEffectScope(VkCommandBuffer commandBuffer, uint32_t effectIndex);
+        void endScope(VkCommandBuffer commandBuffer);
+
+        // the command buffer of imageIndex got submitted with the timestamps
+        void markSubmitted(uint32_t imageIndex);
+        // reads the timestamps of the last submit of imageIndex, its fence has to be signaled
+        void collect(uint32_t imageIndex);
+
+    private:
+        // every scope has a begin and an end query
+        static const uint32_t maxScopes   = 64;
+        static const uint32_t sampleCount = 512;
+
+        struct ScopeStatistics
+        {
+            std::string        name;
+            std::vector<float> samples; // ring buffer of the last sampleCount times in ms
+            uint32_t           nextSample = 0;
+        };
+
+        struct OpenScope
+        {
+            uint32_t    pair; // maxScopes if the scope did not fit into the pool
+            std::string name;
+        };
+
+        void report();
+
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        VkQueryPool                    queryPool = VK_NULL_HANDLE;
+        std::vector<std::string>       effectNames;
+        float                          timestampPeriod; // ns per tick
+        uint64_t                       timestampMask;
+
+        // the scope index of every query pair that got recorded for each image
+        std::vector<std::vector<uint32_t>>        imageScopes;
+        std::vector<bool>                         pending;
+        std::vector<ScopeStatistics>              scopes;
+        std::unordered_map<std::string, uint32_t> scopeIndices;
+
+        uint32_t               recordingImage = 0;
+        std::vector<OpenScope> openScopes;
+
+        std::vector<uint64_t>                 results;
+        std::chrono::duration<float>          interval;
+        std::string                           csvFile;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point lastReport;
+    };
+} // namespace vkBasalt
+
+#endif // GPU_PROFILER_HPP_INCLUDED
@@ -1,5 +1,7 @@
 #include "graphics_pipeline.hpp"
 
+#include "pipeline_cache.hpp"
+
 namespace vkBasalt
 {
     VkPipelineLayout createGraphicsPipelineLayout(std::shared_ptr<LogicalDevice>     pLogicalDevice,
@@ -14,23 +16,21 @@ namespace vkBasalt
         pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
         pipelineLayoutCreateInfo.pPushConstantRanges    = nullptr;
 
-        VkPipelineLayout pipelineLayout;
-        VkResult result = pLogicalDevice->vkd.CreatePipelineLayout(pLogicalDevice->device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
-        ASSERT_VULKAN(result);
-        return pipelineLayout;
+        return pLogicalDevice->resourceCache->getPipelineLayout(pipelineLayoutCreateInfo);
     }
 
-    VkPipeline createGraphicsPipeline(std::shared_ptr<LogicalDevice> pLogicalDevice,
-                                      VkShaderModule                 vertexModule,
-                                      VkSpecializationInfo*          vertexSpecializationInfo,
-                                      std::string                    vertexEntryPoint,
-                                      VkShaderModule                 fragmentModule,
-                                      VkSpecializationInfo*          fragmentSpecializationInfo,
-                                      std::string                    fragmentEntryPoint,
-                                      VkExtent2D                     extent,
-                                      VkRenderPass                   renderPass,
-                                      VkPipelineLayout               pipelineLayout,
-                                      bool                           flip)
+    VkPipeline createGraphicsPipeline(std::shared_ptr<LogicalDevice>               pLogicalDevice,
+                                      VkShaderModule                               vertexModule,
+                                      VkSpecializationInfo*                        vertexSpecializationInfo,
+                                      std::string                                  vertexEntryPoint,
+                                      VkShaderModule                               fragmentModule,
+                                      VkSpecializationInfo*                        fragmentSpecializationInfo,
+                                      std::string                                  fragmentEntryPoint,
+                                      VkExtent2D                                   extent,
+                                      VkRenderPass                                 renderPass,
+                                      VkPipelineLayout                             pipelineLayout,
+                                      bool                                         flip,
+                                      const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState)
     {
         VkResult result;
 
@@ -165,7 +165,7 @@ namespace vkBasalt
         pipelineCreateInfo.pViewportState      = &viewportStateCreateInfo;
         pipelineCreateInfo.pRasterizationState = &rasterizationCreateInfo;
         pipelineCreateInfo.pMultisampleState   = &multisampleCreateInfo;
-        pipelineCreateInfo.pDepthStencilState  = nullptr;
+        pipelineCreateInfo.pDepthStencilState  = pDepthStencilState;
         pipelineCreateInfo.pColorBlendState    = &colorBlendCreateInfo;
         pipelineCreateInfo.pDynamicState       = &dynamicStateCreateInfo;
         pipelineCreateInfo.layout              = pipelineLayout;
@@ -174,7 +174,7 @@ namespace vkBasalt
         pipelineCreateInfo.basePipelineHandle  = VK_NULL_HANDLE;
         pipelineCreateInfo.basePipelineIndex   = -1;
 
-        result = pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+        result = createCachedGraphicsPipeline(pLogicalDevice, &pipelineCreateInfo, &pipeline);
         ASSERT_VULKAN(result);
 
         return pipeline;
@@ -16,17 +16,18 @@ namespace vkBasalt
     VkPipelineLayout createGraphicsPipelineLayout(std::shared_ptr<LogicalDevice>     pLogicalDevice,
                                                   std::vector<VkDescriptorSetLayout> descriptorSetLayouts);
 
-    VkPipeline createGraphicsPipeline(std::shared_ptr<LogicalDevice> pLogicalDevice,
-                                      VkShaderModule                 vertexModule,
-                                      VkSpecializationInfo*          vertexSpecializationInfo,
-                                      std::string                    vertexEntryPoint,
-                                      VkShaderModule                 fragmentModule,
-                                      VkSpecializationInfo*          fragmentSpecializationInfo,
-                                      std::string                    fragmentEntryPoint,
-                                      VkExtent2D                     extent,
-                                      VkRenderPass                   renderPass,
-                                      VkPipelineLayout               pipelineLayout,
-                                      bool                           flip = false);
+    VkPipeline createGraphicsPipeline(std::shared_ptr<LogicalDevice>               pLogicalDevice,
+                                      VkShaderModule                               vertexModule,
+                                      VkSpecializationInfo*                        vertexSpecializationInfo,
+                                      std::string                                  vertexEntryPoint,
+                                      VkShaderModule                               fragmentModule,
+                                      VkSpecializationInfo*                        fragmentSpecializationInfo,
+                                      std::string                                  fragmentEntryPoint,
+                                      VkExtent2D                                   extent,
+                                      VkRenderPass                                 renderPass,
+                                      VkPipelineLayout                             pipelineLayout,
+                                      bool                                         flip = false,
+                                      const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState = nullptr);
 
 } // namespace vkBasalt
 
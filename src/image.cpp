@@ -1,18 +1,22 @@
 #include "image.hpp"
+
+#include <algorithm>
+
 #include "memory.hpp"
 #include "buffer.hpp"
 #include "format.hpp"
+#include "command_buffer.hpp"
+#include "transient_memory.hpp"
+#include "upload_batch.hpp"
 
 namespace vkBasalt
 {
-    std::vector<VkImage> createImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
-                                      uint32_t                       count,
-                                      VkExtent3D                     extent,
-                                      VkFormat                       format,
-                                      VkImageUsageFlags              usage,
-                                      VkMemoryPropertyFlags          properties,
-                                      VkDeviceMemory&                imageMemory,
-                                      uint32_t                       mipLevels)
+    static std::vector<VkImage> createUnboundImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                                    uint32_t                       count,
+                                                    VkExtent3D                     extent,
+                                                    VkFormat                       format,
+                                                    VkImageUsageFlags              usage,
+                                                    uint32_t                       mipLevels)
     {
         std::vector<VkImage> images(count);
 
@@ -50,6 +54,11 @@ namespace vkBasalt
         imageCreateInfo.queueFamilyIndexCount = 0;       // Don't care
         imageCreateInfo.pQueueFamilyIndices   = nullptr; // Don't care
         imageCreateInfo.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED;
+        // the srgb views of images that compute shaders write to can't have the storage usage
+        if (unormFormat != srgbFormat && (usage & VK_IMAGE_USAGE_STORAGE_BIT))
+        {
+            imageCreateInfo.flags |= VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+        }
 
         VkResult result;
         for (uint32_t i = 0; i < count; i++)
@@ -57,6 +66,32 @@ namespace vkBasalt
             result = pLogicalDevice->vkd.CreateImage(pLogicalDevice->device, &imageCreateInfo, nullptr, &(images[i]));
             ASSERT_VULKAN(result);
         }
+        return images;
+    }
+
+    // uploads record into the batch of the current thread if there is one, otherwise into an own batch that gets submitted at the end
+    static UploadBatch* getUploadBatch(std::shared_ptr<LogicalDevice> pLogicalDevice, std::unique_ptr<UploadBatch>& pOwnBatch)
+    {
+        UploadBatch* pBatch = UploadBatch::current();
+        if (!pBatch)
+        {
+            pOwnBatch = std::make_unique<UploadBatch>(pLogicalDevice);
+            pBatch    = pOwnBatch.get();
+        }
+        return pBatch;
+    }
+
+    std::vector<VkImage> createImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                      uint32_t                       count,
+                                      VkExtent3D                     extent,
+                                      VkFormat                       format,
+                                      VkImageUsageFlags              usage,
+                                      VkMemoryPropertyFlags          properties,
+                                      MemoryAllocation&              imageMemory,
+                                      uint32_t                       mipLevels)
+    {
+        std::vector<VkImage> images = createUnboundImages(pLogicalDevice, count, extent, format, usage, mipLevels);
+
         // Allocate a bunch of memory for all images at one
         VkMemoryRequirements memoryRequirements;
         pLogicalDevice->vkd.GetImageMemoryRequirements(pLogicalDevice->device, images[0], &memoryRequirements);
@@ -66,23 +101,32 @@ namespace vkBasalt
             memoryRequirements.size = (memoryRequirements.size / memoryRequirements.alignment + 1) * memoryRequirements.alignment;
         }
 
-        VkMemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memoryAllocateInfo.pNext           = nullptr;
-        memoryAllocateInfo.allocationSize  = memoryRequirements.size * count;
-        memoryAllocateInfo.memoryTypeIndex = findMemoryTypeIndex(pLogicalDevice, memoryRequirements.memoryTypeBits, properties);
+        VkMemoryRequirements allImagesRequirements = memoryRequirements;
+        allImagesRequirements.size                 = memoryRequirements.size * count;
 
-        result = pLogicalDevice->vkd.AllocateMemory(pLogicalDevice->device, &memoryAllocateInfo, nullptr, &imageMemory);
-        ASSERT_VULKAN(result);
+        imageMemory = allocateMemory(pLogicalDevice, allImagesRequirements, properties, false);
 
         for (uint32_t i = 0; i < count; i++)
         {
-            result = pLogicalDevice->vkd.BindImageMemory(pLogicalDevice->device, images[i], imageMemory, memoryRequirements.size * i);
+            VkResult result = pLogicalDevice->vkd.BindImageMemory(
+                pLogicalDevice->device, images[i], imageMemory.memory, imageMemory.offset + memoryRequirements.size * i);
             ASSERT_VULKAN(result);
         }
         return images;
     }
 
+    std::vector<VkImage> createTransientImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                               uint32_t                       count,
+                                               VkExtent3D                     extent,
+                                               VkFormat                       format,
+                                               VkImageUsageFlags              usage,
+                                               uint32_t                       mipLevels)
+    {
+        std::vector<VkImage> images = createUnboundImages(pLogicalDevice, count, extent, format, usage, mipLevels);
+        bindTransientImages(images);
+        return images;
+    }
+
     void uploadToImage(std::shared_ptr<LogicalDevice> pLogicalDevice,
                        VkImage                        image,
                        VkExtent3D                     extent,
@@ -90,40 +134,14 @@ namespace vkBasalt
                        const unsigned char*           writeData,
                        uint32_t                       mipLevels)
     {
+        std::unique_ptr<UploadBatch> pOwnBatch;
+        UploadBatch*                 pBatch = getUploadBatch(pLogicalDevice, pOwnBatch);
 
-        VkBuffer       stagingBuffer;
-        VkDeviceMemory stagingMemory;
-
-        createBuffer(pLogicalDevice,
-                     size,
-                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     stagingBuffer,
-                     stagingMemory);
-        void*    data;
-        VkResult result = pLogicalDevice->vkd.MapMemory(pLogicalDevice->device, stagingMemory, 0, size, 0, &data);
-        ASSERT_VULKAN(result);
-        std::memcpy(data, writeData, size);
-        pLogicalDevice->vkd.UnmapMemory(pLogicalDevice->device, stagingMemory);
-
-        VkCommandBufferAllocateInfo allocInfo = {};
-
-        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool        = pLogicalDevice->commandPool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        pLogicalDevice->vkd.AllocateCommandBuffers(pLogicalDevice->device, &allocInfo, &commandBuffer);
-        // initialize dispatch table for commandBuffer since it is a dispatchable object
-        initializeDispatchTable(commandBuffer, pLogicalDevice->device);
-
-        VkCommandBufferBeginInfo beginInfo = {};
-
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VkBuffer     stagingBuffer;
+        VkDeviceSize stagingOffset;
+        pBatch->stage(writeData, size, stagingBuffer, stagingOffset);
 
-        pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+        VkCommandBuffer commandBuffer = pBatch->getCommandBuffer();
 
         VkImageMemoryBarrier memoryBarrier;
         memoryBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -145,7 +163,7 @@ namespace vkBasalt
             commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
 
         VkBufferImageCopy region;
-        region.bufferOffset                    = 0;
+        region.bufferOffset                    = stagingOffset;
         region.bufferRowLength                 = 0;
         region.bufferImageHeight               = 0;
         region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -166,43 +184,200 @@ namespace vkBasalt
             commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
 
         generateMipMaps(pLogicalDevice, commandBuffer, image, extent, mipLevels);
+    }
 
-        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+    void uploadResizedToImage(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                              VkImage                        image,
+                              VkExtent3D                     extent,
+                              VkFormat                       format,
+                              VkExtent3D                     sourceExtent,
+                              uint32_t                       size,
+                              const unsigned char*           writeData,
+                              uint32_t                       mipLevels)
+    {
+        std::unique_ptr<UploadBatch> pOwnBatch;
+        UploadBatch*                 pBatch = getUploadBatch(pLogicalDevice, pOwnBatch);
+
+        // the pixels first go into an image of their own size, the batch destroys it once the blit is done
+        MemoryAllocation sourceMemory;
+        VkImage          sourceImage = createImages(pLogicalDevice,
+                                                    1,
+                                                    sourceExtent,
+                                                    format,
+                                                    VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                    sourceMemory)[0];
+        pBatch->keepImage(sourceImage, sourceMemory);
+
+        VkBuffer     stagingBuffer;
+        VkDeviceSize stagingOffset;
+        pBatch->stage(writeData, size, stagingBuffer, stagingOffset);
+
+        VkCommandBuffer commandBuffer = pBatch->getCommandBuffer();
+
+        VkImageMemoryBarrier memoryBarriers[2];
+        for (auto& memoryBarrier : memoryBarriers)
+        {
+            memoryBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            memoryBarrier.pNext                           = nullptr;
+            memoryBarrier.srcAccessMask                   = 0;
+            memoryBarrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memoryBarrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+            memoryBarrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            memoryBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            memoryBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            memoryBarrier.subresourceRange.baseMipLevel   = 0;
+            memoryBarrier.subresourceRange.levelCount     = 1;
+            memoryBarrier.subresourceRange.baseArrayLayer = 0;
+            memoryBarrier.subresourceRange.layerCount     = 1;
+        }
+        memoryBarriers[0].image = sourceImage;
+        memoryBarriers[1].image = image;
 
-        VkSubmitInfo submitInfo = {};
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, memoryBarriers);
 
-        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers    = &commandBuffer;
+        VkBufferImageCopy region;
+        region.bufferOffset                    = stagingOffset;
+        region.bufferRowLength                 = 0;
+        region.bufferImageHeight               = 0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount     = 1;
+        region.imageOffset                     = {0, 0, 0};
+        region.imageExtent                     = sourceExtent;
+
+        pLogicalDevice->vkd.CmdCopyBufferToImage(commandBuffer, stagingBuffer, sourceImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
-        pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
+        memoryBarriers[0].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        memoryBarriers[0].newLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        memoryBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarriers[0]);
+
+        VkImageBlit imageBlit;
+        imageBlit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.srcSubresource.mipLevel       = 0;
+        imageBlit.srcSubresource.baseArrayLayer = 0;
+        imageBlit.srcSubresource.layerCount     = 1;
+        imageBlit.srcOffsets[0]                 = {0, 0, 0};
+        imageBlit.srcOffsets[1]                 = {int32_t(sourceExtent.width), int32_t(sourceExtent.height), 1};
+        imageBlit.dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.dstSubresource.mipLevel       = 0;
+        imageBlit.dstSubresource.baseArrayLayer = 0;
+        imageBlit.dstSubresource.layerCount     = 1;
+        imageBlit.dstOffsets[0]                 = {0, 0, 0};
+        imageBlit.dstOffsets[1]                 = {int32_t(extent.width), int32_t(extent.height), 1};
+
+        pLogicalDevice->vkd.CmdBlitImage(commandBuffer,
+                                         sourceImage,
+                                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         image,
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         1,
+                                         &imageBlit,
+                                         VK_FILTER_LINEAR);
+
+        memoryBarriers[1].oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        memoryBarriers[1].newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
-        pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, stagingMemory, nullptr);
-        pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, stagingBuffer, nullptr);
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarriers[1]);
+
+        // the blit already built level 0, so the remaining levels come from it like for every other texture
+        generateMipMaps(pLogicalDevice, commandBuffer, image, extent, mipLevels);
     }
 
-    void changeImageLayout(std::shared_ptr<LogicalDevice> pLogicalDevice, std::vector<VkImage> images, uint32_t mipLevels)
+    bool supportsBlitResize(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format)
     {
-        VkCommandBufferAllocateInfo allocInfo = {};
+        VkFormatFeatureFlags features =
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
 
-        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool        = pLogicalDevice->commandPool;
-        allocInfo.commandBufferCount = 1;
+        VkFormatProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceFormatProperties(pLogicalDevice->physicalDevice, format, &properties);
+        return (properties.optimalTilingFeatures & features) == features;
+    }
 
-        VkCommandBuffer commandBuffer;
-        pLogicalDevice->vkd.AllocateCommandBuffers(pLogicalDevice->device, &allocInfo, &commandBuffer);
-        // initialize dispatch table for commandBuffer since it is a dispatchable object
-        initializeDispatchTable(commandBuffer, pLogicalDevice->device);
+    void uploadCompressedToImage(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                 VkImage                        image,
+                                 VkExtent3D                     extent,
+                                 VkFormat                       format,
+                                 uint32_t                       size,
+                                 const unsigned char*           writeData,
+                                 uint32_t                       mipLevels)
+    {
+        std::unique_ptr<UploadBatch> pOwnBatch;
+        UploadBatch*                 pBatch = getUploadBatch(pLogicalDevice, pOwnBatch);
 
-        VkCommandBufferBeginInfo beginInfo = {};
+        VkBuffer     stagingBuffer;
+        VkDeviceSize stagingOffset;
+        pBatch->stage(writeData, size, stagingBuffer, stagingOffset);
 
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VkCommandBuffer commandBuffer = pBatch->getCommandBuffer();
 
-        pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+        VkImageMemoryBarrier memoryBarrier;
+        memoryBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        memoryBarrier.pNext                           = nullptr;
+        memoryBarrier.srcAccessMask                   = 0;
+        memoryBarrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+        memoryBarrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        memoryBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        memoryBarrier.image                           = image;
+        memoryBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        memoryBarrier.subresourceRange.baseMipLevel   = 0;
+        memoryBarrier.subresourceRange.levelCount     = mipLevels;
+        memoryBarrier.subresourceRange.baseArrayLayer = 0;
+        memoryBarrier.subresourceRange.layerCount     = 1;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+        // the mip levels come from the file, blits can not write to block compressed images anyway
+        std::vector<VkBufferImageCopy> regions(mipLevels);
+        VkDeviceSize                   levelOffset = stagingOffset;
+        for (uint32_t i = 0; i < mipLevels; i++)
+        {
+            VkExtent3D levelExtent = {std::max(extent.width >> i, 1u), std::max(extent.height >> i, 1u), 1};
+
+            regions[i].bufferOffset                    = levelOffset;
+            regions[i].bufferRowLength                 = 0;
+            regions[i].bufferImageHeight               = 0;
+            regions[i].imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[i].imageSubresource.mipLevel       = i;
+            regions[i].imageSubresource.baseArrayLayer = 0;
+            regions[i].imageSubresource.layerCount     = 1;
+            regions[i].imageOffset                     = {0, 0, 0};
+            regions[i].imageExtent                     = levelExtent;
+
+            levelOffset += ((levelExtent.width + 3) / 4) * ((levelExtent.height + 3) / 4) * getBlockSize(format);
+        }
+
+        pLogicalDevice->vkd.CmdCopyBufferToImage(
+            commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+
+        memoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        memoryBarrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+    }
+
+    void changeImageLayout(std::shared_ptr<LogicalDevice> pLogicalDevice, std::vector<VkImage> images, uint32_t mipLevels)
+    {
+        std::unique_ptr<UploadBatch> pOwnBatch;
+        UploadBatch*                 pBatch = getUploadBatch(pLogicalDevice, pOwnBatch);
+
+        VkCommandBuffer commandBuffer = pBatch->getCommandBuffer();
 
         VkImageMemoryBarrier memoryBarrier;
         memoryBarrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -226,18 +401,6 @@ namespace vkBasalt
             pLogicalDevice->vkd.CmdPipelineBarrier(
                 commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
         }
-
-        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo       = {};
-        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers    = &commandBuffer;
-
-        pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE);
-        pLogicalDevice->vkd.QueueWaitIdle(pLogicalDevice->queue);
-
-        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
     }
 
     void generateMipMaps(
@@ -20,9 +20,20 @@ namespace vkBasalt
                                       VkFormat                       format,
                                       VkImageUsageFlags              usage,
                                       VkMemoryPropertyFlags          properties,
-                                      VkDeviceMemory&                imageMemory,
+                                      MemoryAllocation&              imageMemory,
                                       uint32_t                       mipLevels = 1);
 
+    // Like createImages, but the content only has to survive while the effect that gets created on this thread is applied.
+    // The memory is shared with images of other effects, see TransientImageMemory. The images have to be in
+    // VK_IMAGE_LAYOUT_UNDEFINED at their first use in each command buffer.
+    // count has to be the number of swapchain images or 1 for an image that the command buffers of all swapchain images use.
+    std::vector<VkImage> createTransientImages(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                               uint32_t                       count,
+                                               VkExtent3D                     extent,
+                                               VkFormat                       format,
+                                               VkImageUsageFlags              usage,
+                                               uint32_t                       mipLevels = 1);
+
     void uploadToImage(std::shared_ptr<LogicalDevice> pLogicalDevice,
                        VkImage                        image,
                        VkExtent3D                     extent,
@@ -30,6 +41,28 @@ namespace vkBasalt
                        const unsigned char*           writeData,
                        uint32_t                       mipLevels = 1);
 
+    // writeData has the size sourceExtent and gets scaled to the size of the image with a linear blit,
+    // only use this if supportsBlitResize returns true for the format of the image
+    void uploadResizedToImage(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                              VkImage                        image,
+                              VkExtent3D                     extent,
+                              VkFormat                       format,
+                              VkExtent3D                     sourceExtent,
+                              uint32_t                       size,
+                              const unsigned char*           writeData,
+                              uint32_t                       mipLevels = 1);
+
+    bool supportsBlitResize(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format);
+
+    // writeData contains all mip levels of a block compressed image, each level directly follows the previous one
+    void uploadCompressedToImage(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                 VkImage                        image,
+                                 VkExtent3D                     extent,
+                                 VkFormat                       format,
+                                 uint32_t                       size,
+                                 const unsigned char*           writeData,
+                                 uint32_t                       mipLevels);
+
     void changeImageLayout(std::shared_ptr<LogicalDevice> pLogicalDevice, std::vector<VkImage> images, uint32_t mipLevels = 1);
 
     void generateMipMaps(
@@ -0,0 +1,235 @@
+#include "image_state_tracker.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        const VkAccessFlags writeAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                              | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+                                              | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    } // namespace
+
+    ImageStateTracker::ImageStateTracker(std::shared_ptr<LogicalDevice> pLogicalDevice, VkCommandBuffer commandBuffer)
+        : pLogicalDevice(pLogicalDevice), commandBuffer(commandBuffer)
+    {
+    }
+
+    void ImageStateTracker::addImage(VkImage image, VkImageLayout layout, VkImageAspectFlags aspectMask)
+    {
+        ImageState state;
+        state.finalLayout = layout;
+        state.layout      = layout;
+        state.aspectMask  = aspectMask;
+        states.emplace(image, state);
+    }
+
+    void ImageStateTracker::use(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask)
+    {
+        access(image, layout, stageMask, accessMask, true);
+    }
+
+    void ImageStateTracker::discard(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask)
+    {
+        access(image, layout, stageMask, accessMask, false);
+    }
+
+    void ImageStateTracker::setState(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask)
+    {
+        ImageState& state = getState(image);
+
+        state.layout = layout;
+        if (accessMask & writeAccessMask)
+        {
+            state.writeStages   = stageMask;
+            state.writeAccess   = accessMask & writeAccessMask;
+            state.visibleStages = 0;
+            state.visibleAccess = 0;
+            state.readStages    = 0;
+        }
+        else
+        {
+            state.readStages |= stageMask;
+        }
+    }
+
+    void ImageStateTracker::memoryBarrier()
+    {
+        memoryDependency = true;
+    }
+
+    void ImageStateTracker::flush()
+    {
+        if (imageBarriers.empty() && !srcStageMask && !memoryDependency)
+        {
+            return;
+        }
+
+        VkMemoryBarrier memoryBarrier;
+        memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.pNext         = nullptr;
+        memoryBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        if (memoryDependency)
+        {
+            srcStageMask |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            dstStageMask |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        }
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               srcStageMask,
+                                               dstStageMask,
+                                               0,
+                                               memoryDependency ? 1 : 0,
+                                               &memoryBarrier,
+                                               0,
+                                               nullptr,
+                                               imageBarriers.size(),
+                                               imageBarriers.data());
+        barrierCount++;
+
+        for (auto& image : pendingImages)
+        {
+            states[image].pending = false;
+        }
+        pendingImages.clear();
+        imageBarriers.clear();
+        srcStageMask     = 0;
+        dstStageMask     = 0;
+        memoryDependency = false;
+    }
+
+    void ImageStateTracker::finish()
+    {
+        // nothing after the effects can use aliased memory
+        memoryDependency = false;
+
+        for (auto& [image, state] : states)
+        {
+            if (state.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || state.layout == state.finalLayout)
+            {
+                continue;
+            }
+            if (state.pending)
+            {
+                flush();
+            }
+            // the application or the present engine does its own synchronization with the stages it uses next
+            addBarrier(image, state, state.layout, state.finalLayout, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0);
+            state.layout = state.finalLayout;
+        }
+        flush();
+    }
+
+    uint32_t ImageStateTracker::getBarrierCount()
+    {
+        return barrierCount;
+    }
+
+    ImageStateTracker::ImageState& ImageStateTracker::getState(VkImage image)
+    {
+        auto it = states.find(image);
+        if (it == states.end())
+        {
+            ImageState state;
+            state.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            state.layout      = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            state.aspectMask  = VK_IMAGE_ASPECT_COLOR_BIT;
+            it                = states.emplace(image, state).first;
+        }
+        return it->second;
+    }
+
+    void ImageStateTracker::access(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask, bool keepContent)
+    {
+        ImageState& state = getState(image);
+
+        bool          write      = accessMask & writeAccessMask;
+        VkImageLayout newLayout  = layout == VK_IMAGE_LAYOUT_UNDEFINED ? state.layout : layout;
+        bool          transition = newLayout != state.layout;
+        // read after write and write after write need the write to be visible, write after read only needs the reads to be done
+        bool hazard = (state.writeStages && ((stageMask & ~state.visibleStages) || (accessMask & ~state.visibleAccess)))
+                      || (write && state.readStages);
+
+        if (transition || hazard)
+        {
+            // a second barrier for the same image has to come after the first one
+            if (state.pending)
+            {
+                flush();
+            }
+            addBarrier(image, state, keepContent ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED, newLayout, stageMask, accessMask);
+        }
+
+        state.layout = newLayout;
+        if (write)
+        {
+            state.writeStages   = stageMask;
+            state.writeAccess   = accessMask & writeAccessMask;
+            state.visibleStages = 0;
+            state.visibleAccess = 0;
+            state.readStages    = 0;
+        }
+        else if (transition)
+        {
+            // later reads in other stages have to wait for the transition
+            state.writeStages   = stageMask;
+            state.writeAccess   = 0;
+            state.visibleStages = stageMask;
+            state.visibleAccess = accessMask;
+            state.readStages    = stageMask;
+        }
+        else
+        {
+            if (hazard)
+            {
+                state.visibleStages |= stageMask;
+                state.visibleAccess |= accessMask;
+            }
+            state.readStages |= stageMask;
+        }
+    }
+
+    void ImageStateTracker::addBarrier(VkImage              image,
+                                       ImageState&          state,
+                                       VkImageLayout        oldLayout,
+                                       VkImageLayout        newLayout,
+                                       VkPipelineStageFlags stageMask,
+                                       VkAccessFlags        accessMask)
+    {
+        VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+        if (!srcStages)
+        {
+            // the image did not get used in this command buffer yet, the barrier has to chain with the semaphores of the submit
+            // and with the last submit that used the image
+            srcStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        }
+        srcStageMask |= srcStages;
+        dstStageMask |= stageMask;
+
+        state.pending = true;
+        pendingImages.push_back(image);
+
+        // an image without a layout only needs the execution dependency
+        if (newLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            return;
+        }
+
+        VkImageMemoryBarrier imageBarrier;
+        imageBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.pNext                           = nullptr;
+        imageBarrier.srcAccessMask                   = state.writeAccess;
+        imageBarrier.dstAccessMask                   = accessMask;
+        imageBarrier.oldLayout                       = oldLayout;
+        imageBarrier.newLayout                       = newLayout;
+        imageBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image                           = image;
+        imageBarrier.subresourceRange.aspectMask     = state.aspectMask;
+        imageBarrier.subresourceRange.baseMipLevel   = 0;
+        imageBarrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+        imageBarriers.push_back(imageBarrier);
+    }
+} // namespace vkBasalt
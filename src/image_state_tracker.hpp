@@ -0,0 +1,84 @@
+#ifndef IMAGE_STATE_TRACKER_HPP_INCLUDED
+#define IMAGE_STATE_TRACKER_HPP_INCLUDED
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Tracks the layout and the last accesses of the images while the effect chain of one command buffer gets recorded,
+    // so that the effects only get the barriers that are actually needed instead of transitioning their images back and forth.
+    // The effects declare how they access an image next, all barriers that are needed until the next flush get recorded
+    // with a single vkCmdPipelineBarrier with the exact stages of the accesses.
+    // Images that did not get added are images between effects, they are in VK_IMAGE_LAYOUT_PRESENT_SRC_KHR at the start
+    // and at the end of the command buffer.
+    class ImageStateTracker
+    {
+    public:
+        ImageStateTracker(std::shared_ptr<LogicalDevice> pLogicalDevice, VkCommandBuffer commandBuffer);
+
+        // the image is in layout at the start of the command buffer and has to be in it again at the end,
+        // VK_IMAGE_LAYOUT_UNDEFINED if the content does not outlive the command buffer. Does nothing if the image is known already
+        void addImage(VkImage image, VkImageLayout layout, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+
+        // the next commands access the image in layout, the content of the image stays
+        void use(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask);
+        // the next commands overwrite the image, so it gets transitioned from VK_IMAGE_LAYOUT_UNDEFINED.
+        // With VK_IMAGE_LAYOUT_UNDEFINED as layout the image keeps its layout, for render passes that transition it on their own
+        void discard(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask);
+        // a render pass accessed the image and left it in layout
+        void setState(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask);
+
+        // everything before the next flush has to be done before anything after it starts, for images that share memory
+        void memoryBarrier();
+
+        // records the barriers that got collected since the last flush
+        void flush();
+        // transitions the images back to the layout they had at the start and flushes
+        void finish();
+
+        uint32_t getBarrierCount();
+
+    private:
+        struct ImageState
+        {
+            VkImageLayout        finalLayout;
+            VkImageLayout        layout;
+            VkImageAspectFlags   aspectMask;
+            VkPipelineStageFlags writeStages   = 0; // of the last write or layout transition
+            VkAccessFlags        writeAccess   = 0;
+            VkPipelineStageFlags visibleStages = 0; // the stages and accesses the last write is visible to
+            VkAccessFlags        visibleAccess = 0;
+            VkPipelineStageFlags readStages    = 0; // of the reads since the last write
+            bool                 pending       = false;
+        };
+
+        ImageState& getState(VkImage image);
+        void        access(VkImage image, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask, bool keepContent);
+        void        addBarrier(VkImage              image,
+                               ImageState&          state,
+                               VkImageLayout        oldLayout,
+                               VkImageLayout        newLayout,
+                               VkPipelineStageFlags stageMask,
+                               VkAccessFlags        accessMask);
+
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        VkCommandBuffer                commandBuffer;
+
+        std::unordered_map<VkImage, ImageState> states;
+
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<VkImage>              pendingImages;
+        VkPipelineStageFlags              srcStageMask     = 0;
+        VkPipelineStageFlags              dstStageMask     = 0;
+        bool                              memoryDependency = false;
+        uint32_t                          barrierCount     = 0;
+    };
+} // namespace vkBasalt
+
+#endif // IMAGE_STATE_TRACKER_HPP_INCLUDED
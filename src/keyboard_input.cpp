@@ -2,48 +2,290 @@
 
 #include "keyboard_input.hpp"
 
-#include <memory>
-#include <functional>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include <unistd.h>
 #include <cstring>
 
 namespace vkBasalt
 {
-    bool isKeyPressed(KeySym ks)
+    namespace
     {
-        static int usesX11 = -1;
+        // Polls the X server on its own thread and publishes the state through atomics,
+        // so that the present path never has to wait for a round trip to the X server.
+        // With VKBASALT_FAKE_INPUT the thread polls that file instead, so the input works without an X server.
+        class InputThread
+        {
+        public:
+            InputThread()
+            {
+                const char* fakeInputVar = getenv("VKBASALT_FAKE_INPUT");
+                if (fakeInputVar && std::strcmp(fakeInputVar, ""))
+                {
+                    Logger::debug("reading the input from " + std::string(fakeInputVar));
+                    fakeInputFile = fakeInputVar;
+                    createFakeKeyCodeMap();
+                    thread = std::thread(&InputThread::run, this);
+                    return;
+                }
 
-        static std::unique_ptr<Display, std::function<void(Display*)>> display;
+                const char* disVar = getenv("DISPLAY");
+                if (!disVar || !std::strcmp(disVar, ""))
+                {
+                    Logger::debug("no X11 support");
+                    return;
+                }
 
-        if (usesX11 < 0)
-        {
-            const char* disVar = getenv("DISPLAY");
-            if (!disVar || !std::strcmp(disVar, ""))
+                display = XOpenDisplay(disVar);
+                if (!display)
+                {
+                    Logger::err("could not open X11 display " + std::string(disVar));
+                    return;
+                }
+                Logger::debug("X11 support");
+
+                createKeyCodeMap();
+                thread = std::thread(&InputThread::run, this);
+            }
+
+            ~InputThread()
             {
-                usesX11 = 0;
-                Logger::debug("no X11 support");
+                if (thread.joinable())
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(stopMutex);
+                        stop = true;
+                    }
+                    stopCondition.notify_one();
+                    thread.join();
+                }
+                if (display)
+                {
+                    XCloseDisplay(display);
+                }
             }
-            else
+
+            bool isKeyPressed(KeySym ks) const
             {
-                display = std::unique_ptr<Display, std::function<void(Display*)>>(XOpenDisplay(disVar), [](Display* d) { XCloseDisplay(d); });
-                usesX11 = 1;
-                Logger::debug("X11 support");
+                auto keyCode = keyCodes.find(ks);
+                if (keyCode == keyCodes.end())
+                {
+                    return false;
+                }
+                KeyCode kc = keyCode->second;
+                return !!(keys[kc >> 3].load(std::memory_order_relaxed) & (1 << (kc & 7)));
+            }
+
+            bool isMouseButtonPressed(uint32_t button) const
+            {
+                // reshade counts left, right, middle while X11 counts left, middle, right
+                const unsigned int buttonMasks[] = {Button1Mask, Button3Mask, Button2Mask, Button4Mask, Button5Mask};
+                if (button >= sizeof(buttonMasks) / sizeof(buttonMasks[0]))
+                {
+                    return false;
+                }
+                return !!(mouseButtons.load(std::memory_order_relaxed) & buttonMasks[button]);
             }
-        }
 
-        if (!usesX11)
+        private:
+            const std::chrono::milliseconds pollInterval = std::chrono::milliseconds(10);
+
+            Display*    display = nullptr;
+            std::string fakeInputFile;
+            std::thread thread;
+
+            std::mutex              stopMutex;
+            std::condition_variable stopCondition;
+            bool                    stop = false;
+
+            // only written before the thread starts, so it can be read without locking
+            std::unordered_map<KeySym, KeyCode> keyCodes;
+
+            std::array<std::atomic<uint8_t>, 32> keys         = {};
+            std::atomic<unsigned int>            mouseButtons = 0;
+
+            void createKeyCodeMap()
+            {
+                int minKeyCode = 0;
+                int maxKeyCode = 0;
+                XDisplayKeycodes(display, &minKeyCode, &maxKeyCode);
+
+                int     keySymsPerKeyCode = 0;
+                KeySym* keySyms           = XGetKeyboardMapping(display, minKeyCode, maxKeyCode - minKeyCode + 1, &keySymsPerKeyCode);
+                if (!keySyms)
+                {
+                    return;
+                }
+
+                for (int keyCode = minKeyCode; keyCode <= maxKeyCode; keyCode++)
+                {
+                    for (int i = 0; i < keySymsPerKeyCode; i++)
+                    {
+                        KeySym keySym = keySyms[(keyCode - minKeyCode) * keySymsPerKeyCode + i];
+                        if (keySym != NoSymbol)
+                        {
+                            // like XKeysymToKeycode, the lowest key code wins
+                            keyCodes.emplace(keySym, keyCode);
+                        }
+                    }
+                }
+                XFree(keySyms);
+            }
+
+            // the fake keyboard has a key for every key reshade knows, its key code is the windows virtual key code
+            void createFakeKeyCodeMap()
+            {
+                for (uint32_t virtualKeyCode = 0; virtualKeyCode < 256; virtualKeyCode++)
+                {
+                    KeySym keySym = convertToKeySym(virtualKeyCode);
+                    if (keySym != NoSymbol)
+                    {
+                        keyCodes.emplace(keySym, virtualKeyCode);
+                    }
+                }
+            }
+
+            void pollDisplay(char (&keysReturn)[32], unsigned int& mask)
+            {
+                XQueryKeymap(display, keysReturn);
+
+                Window root;
+                Window child;
+                int    rootX;
+                int    rootY;
+                int    windowX;
+                int    windowY;
+                XQueryPointer(display, DefaultRootWindow(display), &root, &child, &rootX, &rootY, &windowX, &windowY, &mask);
+            }
+
+            // every line of the file is a pressed key as keysym name like "Home" or a pressed mouse button from "Button1" to "Button5",
+            // all keys are released if the file does not exist
+            void pollFakeInput(char (&keysReturn)[32], unsigned int& mask)
+            {
+                std::ifstream file(fakeInputFile);
+                std::string   line;
+                while (std::getline(file, line))
+                {
+                    if (line.size() == 7 && line.compare(0, 6, "Button") == 0 && line[6] >= '1' && line[6] <= '5')
+                    {
+                        mask |= Button1Mask << (line[6] - '1');
+                        continue;
+                    }
+
+                    auto keyCode = keyCodes.find(XStringToKeysym(line.c_str()));
+                    if (keyCode != keyCodes.end())
+                    {
+                        keysReturn[keyCode->second >> 3] |= 1 << (keyCode->second & 7);
+                    }
+                }
+            }
+
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(stopMutex);
+                while (!stopCondition.wait_for(lock, pollInterval, [this] { return stop; }))
+                {
+                    char         keysReturn[32] = {};
+                    unsigned int mask           = 0;
+                    if (display)
+                    {
+                        pollDisplay(keysReturn, mask);
+                    }
+                    else
+                    {
+                        pollFakeInput(keysReturn, mask);
+                    }
+
+                    for (uint32_t i = 0; i < keys.size(); i++)
+                    {
+                        keys[i].store(keysReturn[i], std::memory_order_relaxed);
+                    }
+                    mouseButtons.store(mask, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        InputThread& getInputThread()
         {
-            return false;
+            static InputThread inputThread;
+            return inputThread;
         }
+    } // namespace
 
-        char keys_return[32];
+    bool isKeyPressed(KeySym ks)
+    {
+        return getInputThread().isKeyPressed(ks);
+    }
 
-        XQueryKeymap(display.get(), keys_return);
+    bool isMouseButtonPressed(uint32_t button)
+    {
+        return getInputThread().isMouseButtonPressed(button);
+    }
 
-        KeyCode kc2 = XKeysymToKeycode(display.get(), ks);
+    KeySym convertToKeySym(uint32_t virtualKeyCode)
+    {
+        if (virtualKeyCode >= 0x30 && virtualKeyCode <= 0x39)
+        {
+            return XK_0 + (virtualKeyCode - 0x30);
+        }
+        if (virtualKeyCode >= 0x41 && virtualKeyCode <= 0x5A)
+        {
+            return XK_a + (virtualKeyCode - 0x41);
+        }
+        if (virtualKeyCode >= 0x60 && virtualKeyCode <= 0x69)
+        {
+            return XK_KP_0 + (virtualKeyCode - 0x60);
+        }
+        if (virtualKeyCode >= 0x70 && virtualKeyCode <= 0x87)
+        {
+            return XK_F1 + (virtualKeyCode - 0x70);
+        }
 
-        return !!(keys_return[kc2 >> 3] & (1 << (kc2 & 7)));
+        switch (virtualKeyCode)
+        {
+            case 0x08: return XK_BackSpace;
+            case 0x09: return XK_Tab;
+            case 0x0D: return XK_Return;
+            case 0x10: return XK_Shift_L;
+            case 0x11: return XK_Control_L;
+            case 0x12: return XK_Alt_L;
+            case 0x13: return XK_Pause;
+            case 0x14: return XK_Caps_Lock;
+            case 0x1B: return XK_Escape;
+            case 0x20: return XK_space;
+            case 0x21: return XK_Prior;
+            case 0x22: return XK_Next;
+            case 0x23: return XK_End;
+            case 0x24: return XK_Home;
+            case 0x25: return XK_Left;
+            case 0x26: return XK_Up;
+            case 0x27: return XK_Right;
+            case 0x28: return XK_Down;
+            case 0x2C: return XK_Print;
+            case 0x2D: return XK_Insert;
+            case 0x2E: return XK_Delete;
+            case 0x6A: return XK_KP_Multiply;
+            case 0x6B: return XK_KP_Add;
+            case 0x6D: return XK_KP_Subtract;
+            case 0x6E: return XK_KP_Decimal;
+            case 0x6F: return XK_KP_Divide;
+            case 0x90: return XK_Num_Lock;
+            case 0x91: return XK_Scroll_Lock;
+            case 0xA0: return XK_Shift_L;
+            case 0xA1: return XK_Shift_R;
+            case 0xA2: return XK_Control_L;
+            case 0xA3: return XK_Control_R;
+            case 0xA4: return XK_Alt_L;
+            case 0xA5: return XK_Alt_R;
+            default: return NoSymbol;
+        }
     }
 
 } // namespace vkBasalt
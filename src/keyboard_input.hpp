@@ -1,12 +1,19 @@
 #ifndef KEYBOARD_INPUT_HPP_INCLUDED
 #define KEYBOARD_INPUT_HPP_INCLUDED
 
+#include <cstdint>
+
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
 
 namespace vkBasalt
 {
+    // the input state gets polled on a background thread, these only read the last published state
     bool isKeyPressed(KeySym ks);
-}
+    bool isMouseButtonPressed(uint32_t button);
+
+    // reshade uses windows virtual key codes in the keycode annotation
+    KeySym convertToKeySym(uint32_t virtualKeyCode);
+} // namespace vkBasalt
 
 #endif // KEYBOARD_INPUT_HPP_INCLUDED
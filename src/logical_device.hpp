@@ -5,11 +5,56 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <memory>
 
 #include "vulkan_include.hpp"
 
+#include "memory_allocator.hpp"
+#include "resource_cache.hpp"
+
 namespace vkBasalt
 {
+    // the recorded command buffer of an UploadBatch, its pool and the staging buffers and images it reads from
+    struct PendingSubmit
+    {
+        VkCommandPool                 commandPool;
+        VkCommandBuffer               commandBuffer;
+        std::vector<VkBuffer>         stagingBuffers;
+        std::vector<MemoryAllocation> stagingMemory;
+        std::vector<VkImage>          stagingImages;
+        std::vector<MemoryAllocation> stagingImageMemory;
+        std::vector<VkDeviceSize>     stagingRingOffsets;
+    };
+
+    // a range of the staging ring, done once the commands that copy from it are
+    struct StagingRange
+    {
+        VkDeviceSize offset;
+        bool         done;
+    };
+
+    // the host visible buffer that the upload batches of all threads sub-allocate their staging data from,
+    // the ranges are in the order they got allocated and only get freed once all older ones are done
+    struct StagingRing
+    {
+        std::mutex               mutex;
+        VkBuffer                 buffer = VK_NULL_HANDLE;
+        MemoryAllocation         memory;
+        VkDeviceSize             head = 0;
+        std::deque<StagingRange> ranges;
+    };
+
+    // the fence of one present, every swapchain image that got submitted with it holds a reference until its next present
+    struct PresentFence
+    {
+        VkFence  fence;
+        uint32_t referenceCount;
+    };
+
     struct LogicalDevice
     {
         VkLayerDispatchTable         vkd;
@@ -21,9 +66,31 @@ namespace vkBasalt
         uint32_t                     queueFamilyIndex;
         VkCommandPool                commandPool;
         bool                         supportsMutableFormat;
+        bool                         supportsTextureCompressionBC;
+        bool                         supportsStorageImages; // compute effects can write the swapchain formats without a format in the shader
         std::vector<VkImage>         depthImages;
         std::vector<VkFormat>        depthFormats;
         std::vector<VkImageView>     depthImageViews;
+        VkPipelineCache              pipelineCache;
+        std::atomic<uint32_t>        pipelineCount;
+        std::atomic<uint64_t>        pipelineCreationTime; // in microseconds
+        // all images and buffers of the layer get their memory from here
+        std::unique_ptr<MemoryAllocator> allocator;
+        // samplers, render passes, layouts and builtin textures that the effects share
+        std::unique_ptr<ResourceCache> resourceCache;
+        // guards the queue, the command pool and the depth image lists
+        std::mutex mutex;
+        // guards the pending submits and the upload submits, the effects get created on several threads
+        std::mutex submitMutex;
+        // while effects get created in the background the queue belongs to the application,
+        // so the one time commands get collected and only submitted at the next present
+        uint32_t                                                    deferSubmitCount;
+        std::vector<PendingSubmit>                                  pendingSubmits;
+        std::vector<std::pair<VkFence, std::vector<PendingSubmit>>> submittedPendingSubmits;
+        StagingRing                                                 stagingRing;
+        // guarded by submitMutex, fences without references get reused by the next present
+        std::vector<std::unique_ptr<PresentFence>> presentFences;
+        std::vector<PresentFence*>                 freePresentFences;
     };
 } // namespace vkBasalt
 
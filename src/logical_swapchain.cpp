@@ -1,31 +1,60 @@
 #include "logical_swapchain.hpp"
 
+#include "memory.hpp"
+#include "command_buffer.hpp"
+
 namespace vkBasalt
 {
     void LogicalSwapchain::destroy()
     {
         if (imageCount > 0)
         {
+            // the last submits of every swapchain image might still use everything below
+            for (PresentFence* pPresentFence : fences)
+            {
+                if (pPresentFence)
+                {
+                    pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &pPresentFence->fence, VK_TRUE, UINT64_MAX);
+                }
+            }
+
             effects.clear();
             defaultTransfer.reset();
 
-            pLogicalDevice->vkd.FreeCommandBuffers(
-                pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersEffect.size(), commandBuffersEffect.data());
+            // stays empty if creating the effects in the background failed
+            if (commandBuffersEffect.size())
+            {
+                pLogicalDevice->vkd.FreeCommandBuffers(
+                    pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersEffect.size(), commandBuffersEffect.data());
+            }
             pLogicalDevice->vkd.FreeCommandBuffers(
                 pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffersNoEffect.size(), commandBuffersNoEffect.data());
             Logger::debug("after free commandbuffer");
 
-            pLogicalDevice->vkd.FreeMemory(pLogicalDevice->device, fakeImageMemory, nullptr);
+            freeMemory(pLogicalDevice, fakeImageMemory);
 
             for (uint32_t i = 0; i < fakeImages.size(); i++)
             {
                 pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, fakeImages[i], nullptr);
             }
+            transientImageMemory.reset();
 
             for (unsigned int i = 0; i < imageCount; i++)
             {
                 pLogicalDevice->vkd.DestroySemaphore(pLogicalDevice->device, semaphores[i], nullptr);
             }
+
+            {
+                std::lock_guard<std::mutex> lock(pLogicalDevice->submitMutex);
+                for (PresentFence* pPresentFence : fences)
+                {
+                    if (pPresentFence)
+                    {
+                        releasePresentFence(pLogicalDevice, pPresentFence);
+                    }
+                }
+            }
+            profiler.reset();
             Logger::debug("after DestroySemaphore");
         }
     }
@@ -6,12 +6,17 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
 
 #include "effect.hpp"
 
 #include "vulkan_include.hpp"
 
 #include "logical_device.hpp"
+#include "transient_memory.hpp"
+#include "gpu_profiler.hpp"
 
 namespace vkBasalt
 {
@@ -22,15 +27,29 @@ namespace vkBasalt
         VkSwapchainCreateInfoKHR             swapchainCreateInfo;
         VkExtent2D                           imageExtent;
         VkFormat                             format;
+        bool                                 supportsStorageImages; // the unorm format can be written by compute effects
+        std::vector<std::string>             effectStrings;         // chosen at creation, the swapchain images depend on the last one
         uint32_t                             imageCount;
         std::vector<VkImage>                 images;
         std::vector<VkImage>                 fakeImages;
         std::vector<VkCommandBuffer>         commandBuffersEffect;
         std::vector<VkCommandBuffer>         commandBuffersNoEffect;
         std::vector<VkSemaphore>             semaphores;
+        std::vector<PresentFence*>           fences; // signaled once the last submit for the swapchain image is done, null before the first
         std::vector<std::shared_ptr<Effect>> effects;
         std::shared_ptr<Effect>              defaultTransfer;
-        VkDeviceMemory                       fakeImageMemory;
+        MemoryAllocation                     fakeImageMemory;
+        // the images between the effects and the scratch images of the effects
+        std::unique_ptr<TransientImageMemory> transientImageMemory;
+        // only exists if profileEffects is on
+        std::unique_ptr<GpuProfiler> profiler;
+        // guards the command buffers, they get rewritten when the depth image changes
+        std::mutex mutex;
+        // the effects can get created in the background, until then the swapchain gets presented through defaultTransfer
+        std::thread                                    effectThread;
+        std::chrono::high_resolution_clock::time_point effectStartTime;
+        bool                                           effectsReady;  // effects and commandBuffersEffect got created
+        bool                                           effectsActive; // the pending uploads of the effects got submitted
 
         void destroy();
     };
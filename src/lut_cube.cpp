@@ -1,124 +1,285 @@
 #include "lut_cube.hpp"
 
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "logger.hpp"
+#include "util.hpp"
 
 namespace vkBasalt
 {
-    LutCube::LutCube()
-    {
-    }
-    LutCube::LutCube(const std::string& file)
+    namespace
     {
-        std::ifstream cubeStream(file);
-        if (!cubeStream.good())
+        // increase this when the layout of the cache files changes
+        const uint32_t cacheFormatVersion = 2;
+        const char     cacheMagic[8]      = {'v', 'k', 'B', 'L', 'U', 'T', '3', 'D'};
+
+        std::string getCacheFileName(uint64_t key)
         {
-            Logger::err("lut cube file does not exist");
+            std::string cacheDir = getCacheDirectory();
+            if (cacheDir.empty())
+            {
+                return "";
+            }
+
+            std::stringstream ss;
+            ss << cacheDir << "/lut_" << std::hex << std::setw(16) << std::setfill('0') << key << ".cube";
+            return ss.str();
+        }
+
+        const char* skipWhiteSpace(const char* begin, const char* end)
+        {
+            while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+            {
+                begin++;
+            }
+            return begin;
         }
 
-        std::string line;
+        bool startsWith(const char* begin, const char* end, const char* keyword)
+        {
+            size_t length = std::strlen(keyword);
+            return static_cast<size_t>(end - begin) >= length && !std::memcmp(begin, keyword, length);
+        }
 
-        while (std::getline(cubeStream, line))
+        // from_chars does not accept a leading plus
+        const char* parseFloat(const char* begin, const char* end, float& value, bool& success)
         {
-            parseLine(line);
+            begin = skipWhiteSpace(begin, end);
+            if (begin < end && *begin == '+')
+            {
+                begin++;
+            }
+            auto result = std::from_chars(begin, end, value);
+            success &= result.ec == std::errc();
+            return result.ptr;
         }
+    } // namespace
+
+    LutCube::LutCube()
+    {
     }
-    void LutCube::parseLine(std::string line)
+
+    LutCube::LutCube(const std::string& file)
     {
-        if (line.length() == 0)
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
         {
+            Logger::err("lut cube file does not exist");
             return;
         }
-        if (line[0] == '#')
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
         {
+            Logger::err("could not read lut cube file " + file);
+            close(fd);
             return;
         }
-        if (line.find("LUT_3D_SIZE") != std::string::npos)
-        {
-            line = line.substr(line.find("LUT_3D_SIZE") + 11);
-            line = skipWhiteSpace(line);
-            size = std::stoi(line);
 
-            colorCube = std::vector<unsigned char>(size * size * size * 4, 255);
+        uint64_t key = hashString(file);
+        key          = hashString(std::to_string(fileStat.st_size) + ":" + std::to_string(fileStat.st_mtim.tv_sec) + "."
+                                      + std::to_string(fileStat.st_mtim.tv_nsec),
+                                  key);
+        if (loadCache(key))
+        {
+            close(fd);
             return;
         }
-        if (line.find("DOMAIN_MIN") != std::string::npos)
+
+        void* pMapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (pMapped == MAP_FAILED)
         {
-            line = line.substr(line.find("DOMAIN_MIN") + 10);
-            splitTripel(line, minX, minY, minZ);
+            Logger::err("could not map lut cube file " + file);
             return;
         }
-        if (line.find("DOMAIN_MAX") != std::string::npos)
+
+        const char* begin = static_cast<const char*>(pMapped);
+        parse(begin, begin + fileStat.st_size);
+        munmap(pMapped, fileStat.st_size);
+
+        if (colorCube.empty())
         {
-            line = line.substr(line.find("DOMAIN_MAX") + 10);
-            splitTripel(line, maxX, maxY, maxZ);
+            Logger::err("lut cube file " + file + " has no LUT_3D_SIZE");
             return;
         }
-        if (line.find_first_of("0123456789") == 0)
+        if (currentIndex != colorCube.size() / 4)
         {
-            float         x, y, z;
-            unsigned char outX, outY, outZ;
-            splitTripel(line, x, y, z);
-            clampTripel(x, y, z, outX, outY, outZ);
-            writeColor(currentX, currentY, currentZ, outX, outY, outZ);
-            if (currentX != size - 1)
-            {
-                currentX++;
-            }
-            else if (currentY != size - 1)
+            Logger::warn("lut cube file " + file + " has " + std::to_string(currentIndex) + " instead of "
+                         + std::to_string(colorCube.size() / 4) + " colors");
+        }
+        saveCache(key);
+    }
+
+    void LutCube::parse(const char* begin, const char* end)
+    {
+        while (begin < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (lineEnd == nullptr)
             {
-                currentY++;
-                currentX = 0;
+                lineEnd = end;
             }
-            else if (currentZ != size - 1)
+            parseLine(begin, lineEnd);
+            begin = lineEnd + 1;
+        }
+    }
+
+    void LutCube::parseLine(const char* begin, const char* end)
+    {
+        begin = skipWhiteSpace(begin, end);
+        if (begin == end || *begin == '#')
+        {
+            return;
+        }
+        if (startsWith(begin, end, "LUT_3D_SIZE"))
+        {
+            begin = skipWhiteSpace(begin + 11, end);
+            int  newSize;
+            auto result = std::from_chars(begin, end, newSize);
+            if (result.ec != std::errc() || newSize < 2 || newSize > 256)
             {
-                currentZ++;
-                currentX = 0;
-                currentY = 0;
+                Logger::err("invalid LUT_3D_SIZE in lut cube file");
+                return;
             }
+            size         = newSize;
+            colorCube    = std::vector<float>(size * size * size * 4, 1.0f);
+            currentIndex = 0;
+            return;
+        }
+        if (startsWith(begin, end, "DOMAIN_MIN"))
+        {
+            parseTripel(begin + 10, end, domainMin[0], domainMin[1], domainMin[2]);
+            return;
+        }
+        if (startsWith(begin, end, "DOMAIN_MAX"))
+        {
+            parseTripel(begin + 10, end, domainMax[0], domainMax[1], domainMax[2]);
             return;
         }
-    }
 
-    std::string LutCube::skipWhiteSpace(std::string text)
-    {
-        while (text.size() > 0 && (text[0] == ' ' || text[0] == '\t'))
+        // keywords like TITLE don't parse as numbers and get skipped
+        float x, y, z;
+        if (!parseTripel(begin, end, x, y, z))
         {
-            text = text.substr(1);
+            return;
         }
-        return text;
+        writeColor(x, y, z);
     }
 
-    void LutCube::splitTripel(std::string tripel, float& x, float& y, float& z)
+    bool LutCube::parseTripel(const char* begin, const char* end, float& x, float& y, float& z)
     {
-        tripel       = skipWhiteSpace(tripel);
-        size_t after = tripel.find_first_of(" \n");
-        x            = std::stof(tripel.substr(0, after));
-        tripel       = tripel.substr(after);
-
-        tripel = skipWhiteSpace(tripel);
-        after  = tripel.find_first_of(" \n");
-        y      = std::stof(tripel.substr(0, after));
-        tripel = tripel.substr(after);
-
-        tripel = skipWhiteSpace(tripel);
-        z      = std::stof(tripel);
+        bool success = true;
+        begin        = parseFloat(begin, end, x, success);
+        begin        = parseFloat(begin, end, y, success);
+        parseFloat(begin, end, z, success);
+        return success;
     }
 
-    void LutCube::clampTripel(float x, float y, float z, unsigned char& outX, unsigned char& outY, unsigned char& outZ)
+    void LutCube::writeColor(float r, float g, float b)
     {
-        outX = (unsigned char) 255 * (x / (maxX - minX));
-        outY = (unsigned char) 255 * (y / (maxY - minY));
-        outZ = (unsigned char) 255 * (z / (maxZ - minZ));
-    }
+        static const int colorSize = 4; // 4 floats per point in the cube, rgba
 
-    void LutCube::writeColor(int x, int y, int z, unsigned char r, unsigned char g, unsigned char b)
-    {
-        static const int colorSize = 4; // 4 bytes per point in the cube, rgba
+        // colors before LUT_3D_SIZE or after the last point of the cube get ignored
+        if ((currentIndex + 1) * colorSize > colorCube.size())
+        {
+            return;
+        }
 
-        int locationR = (((z * size) + y) * size + x) * colorSize;
+        size_t locationR = currentIndex * colorSize;
 
         colorCube[locationR + 0] = r;
         colorCube[locationR + 1] = g;
         colorCube[locationR + 2] = b;
+
+        currentIndex++;
+    }
+
+    bool LutCube::loadCache(uint64_t key)
+    {
+        std::string fileName = getCacheFileName(key);
+        if (fileName.empty())
+        {
+            return false;
+        }
+
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        char     magic[sizeof(cacheMagic)];
+        uint32_t formatVersion = 0;
+        uint64_t fileKey       = 0;
+        int32_t  fileSize      = 0;
+
+        bool success = fread(magic, sizeof(magic), 1, file) == 1 && fread(&formatVersion, sizeof(formatVersion), 1, file) == 1
+                       && fread(&fileKey, sizeof(fileKey), 1, file) == 1 && fread(&fileSize, sizeof(fileSize), 1, file) == 1
+                       && fread(domainMin.data(), sizeof(domainMin), 1, file) == 1 && fread(domainMax.data(), sizeof(domainMax), 1, file) == 1
+                       && !std::memcmp(magic, cacheMagic, sizeof(cacheMagic)) && formatVersion == cacheFormatVersion && fileKey == key
+                       && fileSize >= 2 && fileSize <= 256;
+        if (success)
+        {
+            colorCube.resize(size_t(fileSize) * fileSize * fileSize * 4);
+            success = fread(colorCube.data(), colorCube.size() * sizeof(float), 1, file) == 1;
+        }
+        fclose(file);
+
+        if (!success)
+        {
+            Logger::warn("ignoring invalid lut cache file " + fileName);
+            colorCube.clear();
+            domainMin = {0.0f, 0.0f, 0.0f};
+            domainMax = {1.0f, 1.0f, 1.0f};
+            return false;
+        }
+
+        size = fileSize;
+        Logger::debug("loaded lut from cache file " + fileName);
+        return true;
+    }
+
+    void LutCube::saveCache(uint64_t key)
+    {
+        std::string fileName = getCacheFileName(key);
+        if (fileName.empty())
+        {
+            return;
+        }
+
+        // write to a temporary file first so that concurrent processes never read a half written file
+        std::string tempFileName = getTempFileName(fileName);
+        FILE*       file         = fopen(tempFileName.c_str(), "wb");
+        if (file == nullptr)
+        {
+            Logger::warn("could not write lut cache file " + fileName);
+            return;
+        }
+
+        int32_t fileSize = size;
+        bool    success  = fwrite(cacheMagic, sizeof(cacheMagic), 1, file) == 1
+                       && fwrite(&cacheFormatVersion, sizeof(cacheFormatVersion), 1, file) == 1 && fwrite(&key, sizeof(key), 1, file) == 1
+                       && fwrite(&fileSize, sizeof(fileSize), 1, file) == 1 && fwrite(domainMin.data(), sizeof(domainMin), 1, file) == 1
+                       && fwrite(domainMax.data(), sizeof(domainMax), 1, file) == 1
+                       && fwrite(colorCube.data(), colorCube.size() * sizeof(float), 1, file) == 1;
+        success &= fclose(file) == 0;
+
+        if (!success || std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+        {
+            Logger::warn("could not write lut cache file " + fileName);
+            std::remove(tempFileName.c_str());
+            return;
+        }
+        Logger::debug("wrote lut cache file " + fileName);
     }
 } // namespace vkBasalt
@@ -8,56 +8,56 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdlib>
+#include <cstdint>
+#include <array>
 
 namespace vkBasalt
 {
     /*
        reads .cube files
-       returns a vector of bytes
-       one byte is one color value
-       4 bytes stand for rgba
-       the alpha value is always 255
+       returns a vector of floats
+       one float is one color value as it is in the file, so it can be outside of [0,1]
+       4 floats stand for rgba
+       the alpha value is always 1
 
        size will be set according to the size in the file, which can be in [2,256]
        the cube will have the dimentions size * size * size
 
        so the vector will have a length of size*size*size*4
 
+       domainMin and domainMax are the input range of the cube, the shader maps the colors into it before the lookup
+
        See: https://wwwimages2.adobe.com/content/dam/acom/en/products/speedgrade/cc/pdfs/cube-lut-specification-1.0.pdf
+
+       the file gets mapped and parsed in a single pass without allocations per line,
+       the decoded cube gets cached under the cache directory, keyed by the path, size and modification time of the file
     */
     class LutCube
     {
     public:
-        std::vector<unsigned char> colorCube;
-        int                        size;
+        std::vector<float>   colorCube;
+        int                  size;
+        std::array<float, 3> domainMin = {0.0f, 0.0f, 0.0f};
+        std::array<float, 3> domainMax = {1.0f, 1.0f, 1.0f};
 
         LutCube(const std::string& file);
         LutCube();
 
     private:
-        float minX = 0.0f;
-        float minY = 0.0f;
-        float minZ = 0.0f;
-
-        float maxX = 1.0f;
-        float maxY = 1.0f;
-        float maxZ = 1.0f;
-
-        int currentX = 0;
-        int currentY = 0;
-        int currentZ = 0;
+        // index of the next color in the cube, the red index changes fastest
+        size_t currentIndex = 0;
 
-        void writeColor(int x, int y, int z, unsigned char r, unsigned char g, unsigned char b);
+        void writeColor(float r, float g, float b);
 
-        void parseLine(std::string line);
+        void parse(const char* begin, const char* end);
 
-        // splits a tripel of floats
-        void splitTripel(std::string tripel, float& x, float& y, float& z);
+        void parseLine(const char* begin, const char* end);
 
-        void clampTripel(float x, float y, float z, unsigned char& outX, unsigned char& outY, unsigned char& outZ);
+        // parses a tripel of floats separated by whitespace, returns false if the text does not start with one
+        bool parseTripel(const char* begin, const char* end, float& x, float& y, float& z);
 
-        // returns the text without leading whitespace
-        std::string skipWhiteSpace(std::string text);
+        bool loadCache(uint64_t key);
+        void saveCache(uint64_t key);
     };
 
 } // namespace vkBasalt
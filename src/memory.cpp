@@ -17,4 +17,23 @@ namespace vkBasalt
         Logger::err("Found no correct memory type");
         return 0x70AD;
     }
+
+    MemoryAllocation allocateMemory(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                    VkMemoryRequirements           memoryRequirements,
+                                    VkMemoryPropertyFlags          properties,
+                                    bool                           linear)
+    {
+        MemoryAllocation allocation;
+
+        uint32_t memoryTypeIndex = findMemoryTypeIndex(pLogicalDevice, memoryRequirements.memoryTypeBits, properties);
+        VkResult result          = pLogicalDevice->allocator->allocate(memoryRequirements, memoryTypeIndex, linear, allocation);
+        ASSERT_VULKAN(result);
+
+        return allocation;
+    }
+
+    void freeMemory(std::shared_ptr<LogicalDevice> pLogicalDevice, const MemoryAllocation& allocation)
+    {
+        pLogicalDevice->allocator->free(allocation);
+    }
 } // namespace vkBasalt
@@ -14,6 +14,14 @@
 namespace vkBasalt
 {
     uint32_t findMemoryTypeIndex(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-}
+
+    // sub-allocates from the allocator of the device, linear is true for buffers and false for images
+    MemoryAllocation allocateMemory(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                    VkMemoryRequirements           memoryRequirements,
+                                    VkMemoryPropertyFlags          properties,
+                                    bool                           linear);
+
+    void freeMemory(std::shared_ptr<LogicalDevice> pLogicalDevice, const MemoryAllocation& allocation);
+} // namespace vkBasalt
 
 #endif // MEMORY_HPP_INCLUDED
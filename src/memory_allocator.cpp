@@ -0,0 +1,479 @@
+#include "memory_allocator.hpp"
+
+#include <algorithm>
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        const uint32_t noRegion = UINT32_MAX;
+
+        thread_local std::string currentTagName = "vkBasalt";
+
+        std::string formatBytes(VkDeviceSize bytes)
+        {
+            return std::to_string(bytes / 1024) + " KiB";
+        }
+    } // namespace
+
+    MemoryTag::MemoryTag(const std::string& name) : previousName(currentTagName)
+    {
+        currentTagName = name;
+    }
+
+    MemoryTag::~MemoryTag()
+    {
+        currentTagName = previousName;
+    }
+
+    MemoryAllocator::MemoryAllocator(const VkLayerDispatchTable*             pDispatchTable,
+                                     VkDevice                                device,
+                                     const VkPhysicalDeviceMemoryProperties& memoryProperties,
+                                     VkDeviceSize                            bufferImageGranularity,
+                                     VkDeviceSize                            blockSize)
+        : pDispatchTable(pDispatchTable), device(device), memoryProperties(memoryProperties),
+          bufferImageGranularity(bufferImageGranularity), blockSize(blockSize)
+    {
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        for (auto& tag : tags)
+        {
+            if (tag.count)
+            {
+                Logger::warn(std::to_string(tag.count) + " allocations of " + tag.name + " are still alive");
+            }
+        }
+        for (auto& pool : pools)
+        {
+            for (auto& block : pool.blocks)
+            {
+                if (block.memory != VK_NULL_HANDLE)
+                {
+                    pDispatchTable->FreeMemory(device, block.memory, nullptr);
+                }
+            }
+        }
+    }
+
+    VkResult MemoryAllocator::allocate(const VkMemoryRequirements& requirements,
+                                       uint32_t                    memoryTypeIndex,
+                                       bool                        linear,
+                                       MemoryAllocation&           allocation)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        allocation     = MemoryAllocation();
+        allocation.tag = getTag();
+
+        if (requirements.size > blockSize / 2)
+        {
+            char*    pMapped = nullptr;
+            VkResult result  = allocateDeviceMemory(requirements.size, memoryTypeIndex, allocation.memory, pMapped);
+            if (result != VK_SUCCESS)
+            {
+                return result;
+            }
+            allocation.size    = requirements.size;
+            allocation.pMapped = pMapped;
+
+            dedicatedCount++;
+            dedicatedBytes += requirements.size;
+            tags[allocation.tag].count++;
+            tags[allocation.tag].bytes += requirements.size;
+            return VK_SUCCESS;
+        }
+
+        allocation.pool = getPool(memoryTypeIndex, linear);
+        Pool& pool      = pools[allocation.pool];
+
+        // searching for the worst case padding guarantees that the aligned region fits into what we find
+        VkDeviceSize alignment  = std::max<VkDeviceSize>(requirements.alignment, 1);
+        VkDeviceSize searchSize = requirements.size + alignment - 1;
+
+        uint32_t regionIndex = findFreeRegion(pool, searchSize);
+        if (regionIndex == noRegion)
+        {
+            VkResult result = addBlock(pool);
+            if (result != VK_SUCCESS)
+            {
+                return result;
+            }
+            regionIndex = findFreeRegion(pool, searchSize);
+            if (regionIndex == noRegion)
+            {
+                return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+            }
+        }
+        removeFreeRegion(pool, regionIndex);
+
+        VkDeviceSize offset        = pool.regions[regionIndex].offset;
+        VkDeviceSize alignedOffset = (offset + alignment - 1) / alignment * alignment;
+        if (alignedOffset != offset)
+        {
+            // the padding in front stays free
+            uint32_t alignedIndex = splitRegion(pool, regionIndex, alignedOffset - offset);
+            insertFreeRegion(pool, regionIndex);
+            regionIndex = alignedIndex;
+        }
+        if (pool.regions[regionIndex].size > requirements.size)
+        {
+            insertFreeRegion(pool, splitRegion(pool, regionIndex, requirements.size));
+        }
+
+        const Region& region = pool.regions[regionIndex];
+        const Block&  block  = pool.blocks[region.block];
+
+        allocation.memory  = block.memory;
+        allocation.offset  = region.offset;
+        allocation.size    = region.size;
+        allocation.pMapped = block.pMapped ? block.pMapped + region.offset : nullptr;
+        allocation.region  = regionIndex;
+
+        tags[allocation.tag].count++;
+        tags[allocation.tag].bytes += region.size;
+        return VK_SUCCESS;
+    }
+
+    void MemoryAllocator::free(const MemoryAllocation& allocation)
+    {
+        if (allocation.memory == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        tags[allocation.tag].count--;
+        tags[allocation.tag].bytes -= allocation.size;
+
+        if (allocation.region == noRegion)
+        {
+            pDispatchTable->FreeMemory(device, allocation.memory, nullptr);
+            dedicatedCount--;
+            dedicatedBytes -= allocation.size;
+            return;
+        }
+
+        Pool&    pool        = pools[allocation.pool];
+        uint32_t regionIndex = allocation.region;
+
+        uint32_t prevIndex = pool.regions[regionIndex].prevPhysical;
+        if (prevIndex != noRegion && pool.regions[prevIndex].free)
+        {
+            removeFreeRegion(pool, prevIndex);
+            mergeRegions(pool, prevIndex, regionIndex);
+            regionIndex = prevIndex;
+        }
+        uint32_t nextIndex = pool.regions[regionIndex].nextPhysical;
+        if (nextIndex != noRegion && pool.regions[nextIndex].free)
+        {
+            removeFreeRegion(pool, nextIndex);
+            mergeRegions(pool, regionIndex, nextIndex);
+        }
+
+        // give empty blocks back to the driver, but keep the last one of the pool around for the next swapchain
+        const Region& region     = pool.regions[regionIndex];
+        uint32_t      liveBlocks = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const Block& b) { return b.memory != VK_NULL_HANDLE; });
+        if (region.size == pool.blocks[region.block].size && liveBlocks > 1)
+        {
+            uint32_t blockIndex = region.block;
+            pool.unusedRegions.push_back(regionIndex);
+            removeBlock(pool, blockIndex);
+            return;
+        }
+        insertFreeRegion(pool, regionIndex);
+    }
+
+    void MemoryAllocator::logStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto& tag : tags)
+        {
+            if (tag.count)
+            {
+                Logger::info("memory of " + tag.name + ": " + std::to_string(tag.count) + " allocations, " + formatBytes(tag.bytes));
+            }
+        }
+
+        uint32_t     blockCount = 0;
+        VkDeviceSize blockBytes = 0;
+        for (auto& pool : pools)
+        {
+            for (auto& block : pool.blocks)
+            {
+                if (block.memory != VK_NULL_HANDLE)
+                {
+                    blockCount++;
+                    blockBytes += block.size;
+                }
+            }
+        }
+        Logger::info("device memory: " + std::to_string(blockCount) + " blocks with " + formatBytes(blockBytes) + ", "
+                     + std::to_string(dedicatedCount) + " dedicated allocations with " + formatBytes(dedicatedBytes));
+    }
+
+    VkResult MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, VkDeviceMemory& memory, char*& pMapped)
+    {
+        VkMemoryAllocateInfo memoryAllocateInfo;
+        memoryAllocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocateInfo.pNext           = nullptr;
+        memoryAllocateInfo.allocationSize  = size;
+        memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+        VkResult result = pDispatchTable->AllocateMemory(device, &memoryAllocateInfo, nullptr, &memory);
+        if (result != VK_SUCCESS)
+        {
+            Logger::err("failed to allocate " + formatBytes(size) + " of device memory");
+            return result;
+        }
+
+        pMapped = nullptr;
+        if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            void* pData = nullptr;
+            result      = pDispatchTable->MapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &pData);
+            if (result != VK_SUCCESS)
+            {
+                pDispatchTable->FreeMemory(device, memory, nullptr);
+                memory = VK_NULL_HANDLE;
+                return result;
+            }
+            pMapped = static_cast<char*>(pData);
+        }
+        return VK_SUCCESS;
+    }
+
+    uint32_t MemoryAllocator::getPool(uint32_t memoryTypeIndex, bool linear)
+    {
+        // buffers and images may only share a block if the granularity does not force padding between them
+        linear = linear && bufferImageGranularity > 1;
+        for (uint32_t i = 0; i < pools.size(); i++)
+        {
+            if (pools[i].memoryTypeIndex == memoryTypeIndex && pools[i].linear == linear)
+            {
+                return i;
+            }
+        }
+
+        pools.emplace_back();
+        pools.back().memoryTypeIndex = memoryTypeIndex;
+        pools.back().linear          = linear;
+        for (auto& freeLists : pools.back().freeLists)
+        {
+            std::fill(std::begin(freeLists), std::end(freeLists), noRegion);
+        }
+        return pools.size() - 1;
+    }
+
+    uint32_t MemoryAllocator::getTag()
+    {
+        for (uint32_t i = 0; i < tags.size(); i++)
+        {
+            if (tags[i].name == currentTagName)
+            {
+                return i;
+            }
+        }
+        tags.emplace_back();
+        tags.back().name = currentTagName;
+        return tags.size() - 1;
+    }
+
+    VkResult MemoryAllocator::addBlock(Pool& pool)
+    {
+        Block    block;
+        VkResult result = allocateDeviceMemory(blockSize, pool.memoryTypeIndex, block.memory, block.pMapped);
+        if (result != VK_SUCCESS)
+        {
+            return result;
+        }
+        block.size = blockSize;
+
+        auto     unusedBlock = std::find_if(pool.blocks.begin(), pool.blocks.end(), [](const Block& b) { return b.memory == VK_NULL_HANDLE; });
+        uint32_t blockIndex  = unusedBlock - pool.blocks.begin();
+        if (unusedBlock == pool.blocks.end())
+        {
+            pool.blocks.push_back(block);
+        }
+        else
+        {
+            *unusedBlock = block;
+        }
+
+        uint32_t regionIndex                   = createRegion(pool);
+        pool.regions[regionIndex].offset       = 0;
+        pool.regions[regionIndex].size         = blockSize;
+        pool.regions[regionIndex].block        = blockIndex;
+        pool.regions[regionIndex].prevPhysical = noRegion;
+        pool.regions[regionIndex].nextPhysical = noRegion;
+        insertFreeRegion(pool, regionIndex);
+
+        Logger::debug("allocated memory block " + std::to_string(blockIndex) + " for memory type " + std::to_string(pool.memoryTypeIndex));
+        return VK_SUCCESS;
+    }
+
+    void MemoryAllocator::removeBlock(Pool& pool, uint32_t blockIndex)
+    {
+        pDispatchTable->FreeMemory(device, pool.blocks[blockIndex].memory, nullptr);
+        pool.blocks[blockIndex].memory  = VK_NULL_HANDLE;
+        pool.blocks[blockIndex].pMapped = nullptr;
+        Logger::debug("freed memory block " + std::to_string(blockIndex) + " of memory type " + std::to_string(pool.memoryTypeIndex));
+    }
+
+    uint32_t MemoryAllocator::createRegion(Pool& pool)
+    {
+        uint32_t regionIndex;
+        if (pool.unusedRegions.size())
+        {
+            regionIndex = pool.unusedRegions.back();
+            pool.unusedRegions.pop_back();
+        }
+        else
+        {
+            regionIndex = pool.regions.size();
+            pool.regions.emplace_back();
+        }
+        pool.regions[regionIndex].free     = false;
+        pool.regions[regionIndex].prevFree = noRegion;
+        pool.regions[regionIndex].nextFree = noRegion;
+        return regionIndex;
+    }
+
+    void MemoryAllocator::insertFreeRegion(Pool& pool, uint32_t regionIndex)
+    {
+        uint32_t fl, sl;
+        mapping(pool.regions[regionIndex].size, fl, sl);
+
+        Region& region = pool.regions[regionIndex];
+        region.free     = true;
+        region.prevFree = noRegion;
+        region.nextFree = pool.freeLists[fl][sl];
+        if (region.nextFree != noRegion)
+        {
+            pool.regions[region.nextFree].prevFree = regionIndex;
+        }
+        pool.freeLists[fl][sl] = regionIndex;
+
+        pool.flBitmap |= 1ull << fl;
+        pool.slBitmaps[fl] |= 1u << sl;
+    }
+
+    void MemoryAllocator::removeFreeRegion(Pool& pool, uint32_t regionIndex)
+    {
+        uint32_t fl, sl;
+        mapping(pool.regions[regionIndex].size, fl, sl);
+
+        Region& region = pool.regions[regionIndex];
+        if (region.prevFree != noRegion)
+        {
+            pool.regions[region.prevFree].nextFree = region.nextFree;
+        }
+        else
+        {
+            pool.freeLists[fl][sl] = region.nextFree;
+        }
+        if (region.nextFree != noRegion)
+        {
+            pool.regions[region.nextFree].prevFree = region.prevFree;
+        }
+        region.free     = false;
+        region.prevFree = noRegion;
+        region.nextFree = noRegion;
+
+        if (pool.freeLists[fl][sl] == noRegion)
+        {
+            pool.slBitmaps[fl] &= ~(1u << sl);
+            if (!pool.slBitmaps[fl])
+            {
+                pool.flBitmap &= ~(1ull << fl);
+            }
+        }
+    }
+
+    uint32_t MemoryAllocator::findFreeRegion(Pool& pool, VkDeviceSize size)
+    {
+        // round up to the next list, so that every region in the list we find is big enough
+        if (size >= slCount)
+        {
+            uint32_t log = 63 - __builtin_clzll(size);
+            size += (VkDeviceSize(1) << (log - slBits)) - 1;
+        }
+
+        uint32_t fl, sl;
+        mapping(size, fl, sl);
+        if (fl >= flCount)
+        {
+            return noRegion;
+        }
+
+        uint32_t slBitmap = pool.slBitmaps[fl] & (~0u << sl);
+        if (!slBitmap)
+        {
+            uint64_t flBitmap = fl + 1 < flCount ? pool.flBitmap & (~0ull << (fl + 1)) : 0;
+            if (!flBitmap)
+            {
+                return noRegion;
+            }
+            fl       = __builtin_ctzll(flBitmap);
+            slBitmap = pool.slBitmaps[fl];
+        }
+        sl = __builtin_ctz(slBitmap);
+
+        return pool.freeLists[fl][sl];
+    }
+
+    uint32_t MemoryAllocator::splitRegion(Pool& pool, uint32_t regionIndex, VkDeviceSize size)
+    {
+        uint32_t newIndex = createRegion(pool);
+
+        Region& region    = pool.regions[regionIndex];
+        Region& newRegion = pool.regions[newIndex];
+
+        newRegion.offset       = region.offset + size;
+        newRegion.size         = region.size - size;
+        newRegion.block        = region.block;
+        newRegion.prevPhysical = regionIndex;
+        newRegion.nextPhysical = region.nextPhysical;
+        if (newRegion.nextPhysical != noRegion)
+        {
+            pool.regions[newRegion.nextPhysical].prevPhysical = newIndex;
+        }
+        region.size         = size;
+        region.nextPhysical = newIndex;
+
+        return newIndex;
+    }
+
+    void MemoryAllocator::mergeRegions(Pool& pool, uint32_t firstIndex, uint32_t secondIndex)
+    {
+        Region& first  = pool.regions[firstIndex];
+        Region& second = pool.regions[secondIndex];
+
+        first.size += second.size;
+        first.nextPhysical = second.nextPhysical;
+        if (first.nextPhysical != noRegion)
+        {
+            pool.regions[first.nextPhysical].prevPhysical = firstIndex;
+        }
+        pool.unusedRegions.push_back(secondIndex);
+    }
+
+    void MemoryAllocator::mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl)
+    {
+        // sizes below slCount get a list each, above that every power of two gets split into slCount lists
+        if (size < slCount)
+        {
+            fl = 0;
+            sl = size;
+            return;
+        }
+        uint32_t log = 63 - __builtin_clzll(size);
+        fl           = log - slBits + 1;
+        sl           = (size >> (log - slBits)) ^ slCount;
+    }
+} // namespace vkBasalt
@@ -0,0 +1,129 @@
+#ifndef MEMORY_ALLOCATOR_HPP_INCLUDED
+#define MEMORY_ALLOCATOR_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+namespace vkBasalt
+{
+    struct MemoryAllocation
+    {
+        VkDeviceMemory memory  = VK_NULL_HANDLE;
+        VkDeviceSize   offset  = 0;
+        VkDeviceSize   size    = 0;
+        void*          pMapped = nullptr; // only set for host visible memory, points at offset already
+        uint32_t       pool    = 0;
+        uint32_t       region  = UINT32_MAX; // UINT32_MAX for dedicated allocations
+        uint32_t       tag     = 0;
+    };
+
+    // Sets the name that the allocations of the current thread get reported under, e.g. the effect that gets created.
+    class MemoryTag
+    {
+    public:
+        MemoryTag(const std::string& name);
+        ~MemoryTag();
+
+    private:
+        std::string previousName;
+    };
+
+    // Sub-allocates the memory of the layer from big blocks, so that effects with many textures neither run into
+    // maxMemoryAllocationCount nor fragment the memory of the application.
+    // Each memory type gets its own pool of blocks and every pool is managed by a two level segregated fit (TLSF) allocator,
+    // so finding and freeing a region is O(1). Buffers and images get separate pools if bufferImageGranularity requires it.
+    // Allocations bigger than half a block get their own VkDeviceMemory. Host visible blocks stay mapped for their whole lifetime.
+    class MemoryAllocator
+    {
+    public:
+        MemoryAllocator(const VkLayerDispatchTable*             pDispatchTable,
+                        VkDevice                                device,
+                        const VkPhysicalDeviceMemoryProperties& memoryProperties,
+                        VkDeviceSize                            bufferImageGranularity,
+                        VkDeviceSize                            blockSize = 64 * 1024 * 1024);
+        ~MemoryAllocator();
+
+        // linear is true for buffers and false for optimal tiling images
+        VkResult allocate(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex, bool linear, MemoryAllocation& allocation);
+        void     free(const MemoryAllocation& allocation);
+
+        // logs allocation count and bytes for every tag, as well as the memory that got allocated from the driver
+        void logStatistics();
+
+    private:
+        static const uint32_t slBits  = 4;
+        static const uint32_t slCount = 1 << slBits;
+        static const uint32_t flCount = 64;
+
+        struct Region
+        {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+            uint32_t     block;
+            uint32_t     prevPhysical;
+            uint32_t     nextPhysical;
+            uint32_t     prevFree;
+            uint32_t     nextFree;
+            bool         free;
+        };
+
+        struct Block
+        {
+            VkDeviceMemory memory;
+            VkDeviceSize   size;
+            char*          pMapped;
+        };
+
+        struct Pool
+        {
+            uint32_t memoryTypeIndex;
+            bool     linear;
+
+            std::vector<Block>    blocks;
+            std::vector<Region>   regions;
+            std::vector<uint32_t> unusedRegions;
+            uint64_t              flBitmap = 0;
+            uint32_t              slBitmaps[flCount] = {};
+            uint32_t              freeLists[flCount][slCount];
+        };
+
+        struct TagStatistics
+        {
+            std::string  name;
+            uint32_t     count = 0;
+            VkDeviceSize bytes = 0;
+        };
+
+        const VkLayerDispatchTable*      pDispatchTable;
+        VkDevice                         device;
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        VkDeviceSize                     bufferImageGranularity;
+        VkDeviceSize                     blockSize;
+
+        std::mutex                 mutex;
+        std::vector<Pool>          pools;
+        std::vector<TagStatistics> tags;
+        uint32_t                   dedicatedCount = 0;
+        VkDeviceSize               dedicatedBytes = 0;
+
+        VkResult allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, VkDeviceMemory& memory, char*& pMapped);
+        uint32_t getPool(uint32_t memoryTypeIndex, bool linear);
+        uint32_t getTag();
+        VkResult addBlock(Pool& pool);
+        void     removeBlock(Pool& pool, uint32_t blockIndex);
+
+        uint32_t createRegion(Pool& pool);
+        void     insertFreeRegion(Pool& pool, uint32_t regionIndex);
+        void     removeFreeRegion(Pool& pool, uint32_t regionIndex);
+        uint32_t findFreeRegion(Pool& pool, VkDeviceSize size);
+        uint32_t splitRegion(Pool& pool, uint32_t regionIndex, VkDeviceSize size);
+        void     mergeRegions(Pool& pool, uint32_t firstIndex, uint32_t secondIndex);
+
+        static void mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl);
+    };
+} // namespace vkBasalt
+
+#endif // MEMORY_ALLOCATOR_HPP_INCLUDED
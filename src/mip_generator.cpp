@@ -0,0 +1,348 @@
+#include "mip_generator.hpp"
+
+#include <algorithm>
+
+#include "image_view.hpp"
+#include "descriptor_set.hpp"
+#include "buffer.hpp"
+#include "memory.hpp"
+#include "format.hpp"
+#include "graphics_pipeline.hpp"
+#include "compute_pipeline.hpp"
+#include "shader.hpp"
+#include "upload_batch.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // a work group covers a tile of 64x64 texels of level 0
+        const uint32_t tileSize = 64;
+
+        uint32_t tileCount(uint32_t size)
+        {
+            return (size + tileSize - 1) / tileSize;
+        }
+    } // namespace
+
+    MipGenerator::MipGenerator(std::shared_ptr<LogicalDevice> pLogicalDevice) : pLogicalDevice(pLogicalDevice)
+    {
+        VkPhysicalDeviceProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &properties);
+        bufferAlignment = properties.limits.minStorageBufferOffsetAlignment;
+    }
+
+    MipGenerator::~MipGenerator()
+    {
+        pLogicalDevice->vkd.DestroyPipeline(pLogicalDevice->device, computePipeline, nullptr);
+        pLogicalDevice->resourceCache->releasePipelineLayout(pipelineLayout);
+        pLogicalDevice->resourceCache->releaseDescriptorSetLayout(descriptorSetLayout);
+        pLogicalDevice->resourceCache->releaseSampler(sampler);
+        pLogicalDevice->vkd.DestroyShaderModule(pLogicalDevice->device, computeModule, nullptr);
+        pLogicalDevice->vkd.DestroyDescriptorPool(pLogicalDevice->device, descriptorPool, nullptr);
+
+        for (auto& mipImage : images)
+        {
+            pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, mipImage.sampledView, nullptr);
+            for (auto& storageView : mipImage.storageViews)
+            {
+                pLogicalDevice->vkd.DestroyImageView(pLogicalDevice->device, storageView, nullptr);
+            }
+        }
+
+        if (buffer != VK_NULL_HANDLE)
+        {
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, buffer, nullptr);
+            freeMemory(pLogicalDevice, bufferMemory);
+        }
+    }
+
+    bool MipGenerator::isSupported(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format, VkExtent3D extent, uint32_t mipLevels)
+    {
+        if (!pLogicalDevice->supportsStorageImages || extent.depth != 1 || extent.width > tileSize * tileSize
+            || extent.height > tileSize * tileSize || mipLevels > maxStorageLevels + 1)
+        {
+            return false;
+        }
+
+        // level 0 gets read with a linear sampler
+        VkFormatProperties formatProperties;
+        pLogicalDevice->vki.GetPhysicalDeviceFormatProperties(pLogicalDevice->physicalDevice, convertToUNORM(format), &formatProperties);
+        VkFormatFeatureFlags features = VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return (formatProperties.optimalTilingFeatures & features) == features;
+    }
+
+    uint32_t MipGenerator::addImage(VkImage image, VkFormat format, VkExtent3D extent, uint32_t mipLevels)
+    {
+        MipImage mipImage;
+        mipImage.image     = image;
+        mipImage.extent    = extent;
+        mipImage.mipLevels = mipLevels;
+
+        VkFormat unormFormat = convertToUNORM(format);
+        mipImage.sampledView = createImageViews(pLogicalDevice, unormFormat, {image}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels)[0];
+        for (uint32_t level = 1; level < mipLevels; level++)
+        {
+            mipImage.storageViews.push_back(
+                createImageViews(pLogicalDevice, unormFormat, {image}, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 1, level)[0]);
+        }
+
+        // the counter is padded to the alignment of the vec4 texels of level 6 behind it
+        VkDeviceSize bufferOffset = images.size() ? images.back().bufferOffset + images.back().bufferSize : 0;
+        mipImage.bufferOffset     = (bufferOffset + bufferAlignment - 1) / bufferAlignment * bufferAlignment;
+        mipImage.bufferSize       = 16 + 16 * tileCount(extent.width) * tileCount(extent.height);
+
+        images.push_back(mipImage);
+        return images.size() - 1;
+    }
+
+    void MipGenerator::init()
+    {
+        VkSamplerCreateInfo samplerCreateInfo;
+        samplerCreateInfo.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerCreateInfo.pNext                   = nullptr;
+        samplerCreateInfo.flags                   = 0;
+        samplerCreateInfo.magFilter               = VK_FILTER_LINEAR;
+        samplerCreateInfo.minFilter               = VK_FILTER_LINEAR;
+        samplerCreateInfo.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerCreateInfo.addressModeU            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeV            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.addressModeW            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerCreateInfo.mipLodBias              = 0.0f;
+        samplerCreateInfo.anisotropyEnable        = VK_FALSE;
+        samplerCreateInfo.maxAnisotropy           = 1.0f;
+        samplerCreateInfo.compareEnable           = VK_FALSE;
+        samplerCreateInfo.compareOp               = VK_COMPARE_OP_ALWAYS;
+        samplerCreateInfo.minLod                  = 0.0f;
+        samplerCreateInfo.maxLod                  = 0.0f;
+        samplerCreateInfo.borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+
+        sampler = pLogicalDevice->resourceCache->getSampler(samplerCreateInfo);
+
+        VkDescriptorSetLayoutBinding bindings[3];
+        bindings[0].binding            = 0;
+        bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount    = 1;
+        bindings[0].stageFlags         = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+        bindings[1]                    = bindings[0];
+        bindings[1].binding            = 1;
+        bindings[1].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount    = maxStorageLevels;
+        bindings[2]                    = bindings[0];
+        bindings[2].binding            = 2;
+        bindings[2].descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext        = nullptr;
+        descriptorSetLayoutCreateInfo.flags        = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = 3;
+        descriptorSetLayoutCreateInfo.pBindings    = bindings;
+
+        descriptorSetLayout = pLogicalDevice->resourceCache->getDescriptorSetLayout(descriptorSetLayoutCreateInfo);
+
+        VkDescriptorPoolSize imagePoolSize;
+        imagePoolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        imagePoolSize.descriptorCount = images.size();
+
+        VkDescriptorPoolSize storagePoolSize;
+        storagePoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        storagePoolSize.descriptorCount = images.size() * maxStorageLevels;
+
+        VkDescriptorPoolSize bufferPoolSize;
+        bufferPoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bufferPoolSize.descriptorCount = images.size();
+
+        descriptorPool = createDescriptorPool(pLogicalDevice, {imagePoolSize, storagePoolSize, bufferPoolSize});
+
+        std::vector<char> computeCode = readFile("mip_downsample.comp.spv");
+        createShaderModule(pLogicalDevice, computeCode, &computeModule);
+
+        pipelineLayout  = createGraphicsPipelineLayout(pLogicalDevice, {descriptorSetLayout});
+        computePipeline = createComputePipeline(pLogicalDevice, computeModule, nullptr, "main", pipelineLayout);
+
+        // the counters have to start at 0, the last work group of each dispatch resets its counter
+        createBuffer(pLogicalDevice,
+                     images.back().bufferOffset + images.back().bufferSize,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     buffer,
+                     bufferMemory);
+
+        std::unique_ptr<UploadBatch> pOwnBatch;
+        UploadBatch*                 pBatch = UploadBatch::current();
+        if (!pBatch)
+        {
+            pOwnBatch = std::make_unique<UploadBatch>(pLogicalDevice);
+            pBatch    = pOwnBatch.get();
+        }
+        VkCommandBuffer commandBuffer = pBatch->getCommandBuffer();
+        pLogicalDevice->vkd.CmdFillBuffer(commandBuffer, buffer, 0, VK_WHOLE_SIZE, 0);
+
+        VkBufferMemoryBarrier bufferBarrier;
+        bufferBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.pNext               = nullptr;
+        bufferBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer              = buffer;
+        bufferBarrier.offset              = 0;
+        bufferBarrier.size                = VK_WHOLE_SIZE;
+
+        pLogicalDevice->vkd.CmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+        std::vector<VkDescriptorSetLayout> layouts(images.size(), descriptorSetLayout);
+        std::vector<VkDescriptorSet>       descriptorSets(images.size());
+
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext              = nullptr;
+        descriptorSetAllocateInfo.descriptorPool     = descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = descriptorSets.size();
+        descriptorSetAllocateInfo.pSetLayouts        = layouts.data();
+
+        VkResult result = pLogicalDevice->vkd.AllocateDescriptorSets(pLogicalDevice->device, &descriptorSetAllocateInfo, descriptorSets.data());
+        ASSERT_VULKAN(result);
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            MipImage& mipImage     = images[i];
+            mipImage.descriptorSet = descriptorSets[i];
+
+            VkDescriptorImageInfo sampledInfo;
+            sampledInfo.sampler     = sampler;
+            sampledInfo.imageView   = mipImage.sampledView;
+            sampledInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            // the shader never writes the levels the image doesn't have, but every descriptor of the array has to be valid
+            VkDescriptorImageInfo storageInfos[maxStorageLevels];
+            for (uint32_t level = 0; level < maxStorageLevels; level++)
+            {
+                storageInfos[level].sampler     = VK_NULL_HANDLE;
+                storageInfos[level].imageView   = mipImage.storageViews[std::min<size_t>(level, mipImage.storageViews.size() - 1)];
+                storageInfos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            }
+
+            VkDescriptorBufferInfo bufferInfo;
+            bufferInfo.buffer = buffer;
+            bufferInfo.offset = mipImage.bufferOffset;
+            bufferInfo.range  = mipImage.bufferSize;
+
+            VkWriteDescriptorSet writeDescriptorSets[3];
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                writeDescriptorSets[j].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writeDescriptorSets[j].pNext            = nullptr;
+                writeDescriptorSets[j].dstSet           = mipImage.descriptorSet;
+                writeDescriptorSets[j].dstBinding       = j;
+                writeDescriptorSets[j].dstArrayElement  = 0;
+                writeDescriptorSets[j].descriptorCount  = bindings[j].descriptorCount;
+                writeDescriptorSets[j].descriptorType   = bindings[j].descriptorType;
+                writeDescriptorSets[j].pImageInfo       = nullptr;
+                writeDescriptorSets[j].pBufferInfo      = nullptr;
+                writeDescriptorSets[j].pTexelBufferView = nullptr;
+            }
+            writeDescriptorSets[0].pImageInfo  = &sampledInfo;
+            writeDescriptorSets[1].pImageInfo  = storageInfos;
+            writeDescriptorSets[2].pBufferInfo = &bufferInfo;
+
+            pLogicalDevice->vkd.UpdateDescriptorSets(pLogicalDevice->device, 3, writeDescriptorSets, 0, nullptr);
+        }
+    }
+
+    void MipGenerator::generate(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& imageIndices)
+    {
+        if (imageIndices.empty())
+        {
+            return;
+        }
+
+        VkImageMemoryBarrier imageBarrier;
+        imageBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.pNext                           = nullptr;
+        imageBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount     = 1;
+
+        // level 0 keeps what the render pass wrote, the other levels get overwritten completely.
+        // The memory barrier covers the counters and level 6 that earlier dispatches used
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        for (auto& index : imageIndices)
+        {
+            imageBarrier.image                         = images[index].image;
+            imageBarrier.srcAccessMask                 = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            imageBarrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+            imageBarrier.oldLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageBarrier.newLayout                     = VK_IMAGE_LAYOUT_GENERAL;
+            imageBarrier.subresourceRange.baseMipLevel = 0;
+            imageBarrier.subresourceRange.levelCount   = 1;
+            imageBarriers.push_back(imageBarrier);
+
+            imageBarrier.srcAccessMask                 = 0;
+            imageBarrier.dstAccessMask                 = VK_ACCESS_SHADER_WRITE_BIT;
+            imageBarrier.oldLayout                     = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageBarrier.subresourceRange.baseMipLevel = 1;
+            imageBarrier.subresourceRange.levelCount   = VK_REMAINING_MIP_LEVELS;
+            imageBarriers.push_back(imageBarrier);
+        }
+
+        VkMemoryBarrier memoryBarrier;
+        memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.pNext         = nullptr;
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        // the shaders of earlier passes might still read the lower levels
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                                                   | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               0,
+                                               1,
+                                               &memoryBarrier,
+                                               0,
+                                               nullptr,
+                                               imageBarriers.size(),
+                                               imageBarriers.data());
+
+        pLogicalDevice->vkd.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+        for (auto& index : imageIndices)
+        {
+            pLogicalDevice->vkd.CmdBindDescriptorSets(
+                commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &(images[index].descriptorSet), 0, nullptr);
+            pLogicalDevice->vkd.CmdDispatch(commandBuffer, tileCount(images[index].extent.width), tileCount(images[index].extent.height), 1);
+        }
+
+        imageBarriers.clear();
+        for (auto& index : imageIndices)
+        {
+            imageBarrier.image                         = images[index].image;
+            imageBarrier.srcAccessMask                 = VK_ACCESS_SHADER_WRITE_BIT;
+            imageBarrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+            imageBarrier.oldLayout                     = VK_IMAGE_LAYOUT_GENERAL;
+            imageBarrier.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageBarrier.subresourceRange.baseMipLevel = 0;
+            imageBarrier.subresourceRange.levelCount   = VK_REMAINING_MIP_LEVELS;
+            imageBarriers.push_back(imageBarrier);
+        }
+
+        // later passes sample the levels or render into level 0 again
+        pLogicalDevice->vkd.CmdPipelineBarrier(commandBuffer,
+                                               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                               VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                                                   | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                               0,
+                                               0,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               imageBarriers.size(),
+                                               imageBarriers.data());
+    }
+} // namespace vkBasalt
@@ -0,0 +1,65 @@
+#ifndef MIP_GENERATOR_HPP_INCLUDED
+#define MIP_GENERATOR_HPP_INCLUDED
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Generates all mip levels of an image with a single compute dispatch, see shader/mip_downsample.comp.glsl,
+    // instead of a blit and four barriers per level like generateMipMaps.
+    // The images of one generate call share one barrier before and one after their dispatches.
+    // Images that isSupported rejects have to use generateMipMaps.
+    class MipGenerator
+    {
+    public:
+        MipGenerator(std::shared_ptr<LogicalDevice> pLogicalDevice);
+        ~MipGenerator();
+
+        // the unorm variant of format has to support storage images and the image can be at most 4096x4096
+        static bool isSupported(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format, VkExtent3D extent, uint32_t mipLevels);
+
+        // the image needs VK_IMAGE_USAGE_STORAGE_BIT, returns the index of the image for generate
+        uint32_t addImage(VkImage image, VkFormat format, VkExtent3D extent, uint32_t mipLevels);
+        // creates the pipeline and the descriptor sets, after the last image got added
+        void init();
+
+        // level 0 got written by a render pass, all levels are in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL before and after
+        void generate(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& imageIndices);
+
+    private:
+        // the levels the shader can write, without level 0
+        static const uint32_t maxStorageLevels = 12;
+
+        struct MipImage
+        {
+            VkImage                  image;
+            VkExtent3D               extent;
+            uint32_t                 mipLevels;
+            VkImageView              sampledView; // all levels, so that the shader knows how many there are
+            std::vector<VkImageView> storageViews;
+            VkDeviceSize             bufferOffset; // of the counter and level 6 of all tiles
+            VkDeviceSize             bufferSize;
+            VkDescriptorSet          descriptorSet;
+        };
+
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        std::vector<MipImage>          images;
+
+        VkSampler             sampler             = VK_NULL_HANDLE;
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool      descriptorPool      = VK_NULL_HANDLE;
+        VkShaderModule        computeModule       = VK_NULL_HANDLE;
+        VkPipelineLayout      pipelineLayout      = VK_NULL_HANDLE;
+        VkPipeline            computePipeline     = VK_NULL_HANDLE;
+        VkBuffer              buffer              = VK_NULL_HANDLE;
+        MemoryAllocation      bufferMemory;
+        VkDeviceSize          bufferAlignment;
+    };
+} // namespace vkBasalt
+
+#endif // MIP_GENERATOR_HPP_INCLUDED
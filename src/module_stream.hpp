@@ -0,0 +1,160 @@
+#ifndef MODULE_STREAM_HPP_INCLUDED
+#define MODULE_STREAM_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace vkBasalt
+{
+    // The binary layout of the cache files: trivially copyable values as they are in memory,
+    // strings and vectors with their size in front. Derived adds the overloads for the structs it stores,
+    // the elements of vectors that are not trivially copyable get written through it.
+    template<typename Derived>
+    class ModuleWriter
+    {
+    public:
+        std::vector<char> data;
+
+        template<typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "needs a write overload");
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            data.insert(data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void write(const std::string& value)
+        {
+            write<uint64_t>(value.size());
+            data.insert(data.end(), value.begin(), value.end());
+        }
+
+        template<typename T>
+        void write(const std::vector<T>& values)
+        {
+            write<uint64_t>(values.size());
+            if constexpr (std::is_trivially_copyable<T>::value)
+            {
+                const char* bytes = reinterpret_cast<const char*>(values.data());
+                data.insert(data.end(), bytes, bytes + values.size() * sizeof(T));
+            }
+            else
+            {
+                for (const auto& value : values)
+                {
+                    static_cast<Derived*>(this)->write(value);
+                }
+            }
+        }
+
+        // every file starts with the magic, the version of its layout and the key it belongs to
+        void writeHeader(const char (&magic)[8], uint32_t formatVersion, uint64_t key)
+        {
+            write(magic);
+            write(formatVersion);
+            write(key);
+        }
+    };
+
+    // reads what ModuleWriter wrote, a file that is too short or has sizes that don't fit sets failed instead of reading past the end
+    template<typename Derived>
+    class ModuleReader
+    {
+    public:
+        ModuleReader(const std::vector<char>& data) : data(data)
+        {
+        }
+
+        bool failed = false;
+
+        template<typename T>
+        void read(T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "needs a read overload");
+            if (failed || sizeof(T) > data.size() - offset)
+            {
+                failed = true;
+                return;
+            }
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+        }
+
+        void read(std::string& value)
+        {
+            uint64_t size = 0;
+            read(size);
+            if (failed || size > data.size() - offset)
+            {
+                failed = true;
+                return;
+            }
+            value.assign(data.data() + offset, size);
+            offset += size;
+        }
+
+        template<typename T>
+        void read(std::vector<T>& values)
+        {
+            uint64_t count = 0;
+            read(count);
+            // every element takes at least one byte, this stops broken files from allocating huge amounts of memory
+            if (failed || count > data.size() - offset)
+            {
+                failed = true;
+                return;
+            }
+            if constexpr (std::is_trivially_copyable<T>::value)
+            {
+                if (count * sizeof(T) > data.size() - offset)
+                {
+                    failed = true;
+                    return;
+                }
+                values.resize(count);
+                if (count)
+                {
+                    std::memcpy(values.data(), data.data() + offset, count * sizeof(T));
+                }
+                offset += count * sizeof(T);
+            }
+            else
+            {
+                values.resize(count);
+                for (auto& value : values)
+                {
+                    static_cast<Derived*>(this)->read(value);
+                }
+            }
+        }
+
+        // sets failed if the file does not start with the header that ModuleWriter::writeHeader wrote for these values
+        void readHeader(const char (&magic)[8], uint32_t formatVersion, uint64_t key)
+        {
+            char     fileMagic[8];
+            uint32_t fileFormatVersion = 0;
+            uint64_t fileKey           = 0;
+            read(fileMagic);
+            read(fileFormatVersion);
+            read(fileKey);
+            if (failed || std::memcmp(fileMagic, magic, sizeof(fileMagic)) || fileFormatVersion != formatVersion || fileKey != key)
+            {
+                failed = true;
+            }
+        }
+
+        // all bytes got read, anything after the last value means the file is not what the reader expects
+        bool atEnd() const
+        {
+            return offset == data.size();
+        }
+
+    private:
+        const std::vector<char>& data;
+        size_t                   offset = 0;
+    };
+} // namespace vkBasalt
+
+#endif // MODULE_STREAM_HPP_INCLUDED
@@ -0,0 +1,103 @@
+#ifndef OBJECT_MAP_HPP_INCLUDED
+#define OBJECT_MAP_HPP_INCLUDED
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace vkBasalt
+{
+    // Thread safe map from vulkan handles to our layer objects.
+    // The entries are spread over several shards that each have their own reader/writer lock,
+    // so lookups from the hot paths (present, resource creation) only take a shared lock
+    // and never wait on each other or on insertions into another shard.
+    template<typename Key, typename Value, size_t ShardCount = 16>
+    class ObjectMap
+    {
+    public:
+        // returns a copy of the stored value, or a default constructed value if the key is unknown
+        Value get(const Key& key) const
+        {
+            const Shard&                        shard = getShard(key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+            auto it = shard.map.find(key);
+            return it != shard.map.end() ? it->second : Value();
+        }
+
+        // same as get but for shared_ptr values, returns the raw pointer to skip the refcount traffic
+        // only use this when the vulkan spec guarantees that the object can't get destroyed concurrently
+        template<typename V = Value>
+        typename V::element_type* getPointer(const Key& key) const
+        {
+            const Shard&                        shard = getShard(key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+            auto it = shard.map.find(key);
+            return it != shard.map.end() ? it->second.get() : nullptr;
+        }
+
+        void insert(const Key& key, Value value)
+        {
+            Shard&                              shard = getShard(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            shard.map[key] = std::move(value);
+        }
+
+        // removes the entry and hands the stored value back to the caller
+        Value remove(const Key& key)
+        {
+            Shard&                              shard = getShard(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+            Value value = Value();
+            auto  it    = shard.map.find(key);
+            if (it != shard.map.end())
+            {
+                value = std::move(it->second);
+                shard.map.erase(it);
+            }
+            return value;
+        }
+
+        // calls func(key, value) for every entry, each shard is only read locked while it gets visited
+        template<typename Func>
+        void forEach(Func func) const
+        {
+            for (const Shard& shard : shards)
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                for (const auto& it : shard.map)
+                {
+                    func(it.first, it.second);
+                }
+            }
+        }
+
+    private:
+        struct Shard
+        {
+            mutable std::shared_mutex      mutex;
+            std::unordered_map<Key, Value> map;
+        };
+
+        std::array<Shard, ShardCount> shards;
+
+        const Shard& getShard(const Key& key) const
+        {
+            // handles are mostly aligned pointers, so mix the bits before picking a shard
+            uint64_t hash = static_cast<uint64_t>(std::hash<Key>()(key)) * 0x9E3779B97F4A7C15ull;
+            return shards[(hash >> 32) % ShardCount];
+        }
+
+        Shard& getShard(const Key& key)
+        {
+            return const_cast<Shard&>(static_cast<const ObjectMap*>(this)->getShard(key));
+        }
+    };
+} // namespace vkBasalt
+
+#endif // OBJECT_MAP_HPP_INCLUDED
@@ -0,0 +1,176 @@
+#include "pipeline_cache.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    static std::string getPipelineCacheFileName(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        std::string cacheDir = getCacheDirectory();
+        if (cacheDir.empty())
+        {
+            return "";
+        }
+
+        VkPhysicalDeviceProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &properties);
+
+        std::stringstream ss;
+        ss << cacheDir << "/pipeline_cache_" << std::hex << std::setw(4) << std::setfill('0') << properties.vendorID << "_" << std::setw(4)
+           << properties.deviceID << ".bin";
+        return ss.str();
+    }
+
+    static bool isPipelineCacheCompatible(std::shared_ptr<LogicalDevice> pLogicalDevice, const std::vector<char>& data)
+    {
+        // the layout of VkPipelineCacheHeaderVersionOne, our vulkan headers are too old to have the struct
+        struct
+        {
+            uint32_t headerSize;
+            uint32_t headerVersion;
+            uint32_t vendorID;
+            uint32_t deviceID;
+            uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+        } header;
+        static_assert(sizeof(header) == 16 + VK_UUID_SIZE);
+
+        if (data.size() < sizeof(header))
+        {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        VkPhysicalDeviceProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &properties);
+
+        return header.headerSize >= sizeof(header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+               && header.vendorID == properties.vendorID && header.deviceID == properties.deviceID
+               && !std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    }
+
+    void createPipelineCache(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        std::vector<char> data;
+
+        std::string fileName = getPipelineCacheFileName(pLogicalDevice);
+        if (!fileName.empty())
+        {
+            std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+            if (file)
+            {
+                data.resize((size_t) file.tellg());
+                file.seekg(0);
+                file.read(data.data(), data.size());
+            }
+        }
+
+        if (data.size() && !isPipelineCacheCompatible(pLogicalDevice, data))
+        {
+            Logger::info("pipeline cache " + fileName + " was written by a different driver or device, starting with an empty one");
+            data.clear();
+        }
+
+        VkPipelineCacheCreateInfo pipelineCacheCreateInfo;
+        pipelineCacheCreateInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        pipelineCacheCreateInfo.pNext           = nullptr;
+        pipelineCacheCreateInfo.flags           = 0;
+        pipelineCacheCreateInfo.initialDataSize = data.size();
+        pipelineCacheCreateInfo.pInitialData    = data.data();
+
+        VkResult result =
+            pLogicalDevice->vkd.CreatePipelineCache(pLogicalDevice->device, &pipelineCacheCreateInfo, nullptr, &pLogicalDevice->pipelineCache);
+        if (result != VK_SUCCESS && data.size())
+        {
+            // the driver did not like the data after all
+            pipelineCacheCreateInfo.initialDataSize = 0;
+            pipelineCacheCreateInfo.pInitialData    = nullptr;
+
+            result =
+                pLogicalDevice->vkd.CreatePipelineCache(pLogicalDevice->device, &pipelineCacheCreateInfo, nullptr, &pLogicalDevice->pipelineCache);
+        }
+        ASSERT_VULKAN(result);
+
+        Logger::debug("created pipeline cache with " + std::to_string(data.size()) + " bytes of initial data");
+    }
+
+    void destroyPipelineCache(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        if (pLogicalDevice->pipelineCache == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        Logger::info("created " + std::to_string(pLogicalDevice->pipelineCount) + " pipelines in "
+                     + std::to_string(pLogicalDevice->pipelineCreationTime / 1000.0) + " ms");
+
+        std::string fileName = getPipelineCacheFileName(pLogicalDevice);
+
+        size_t   dataSize = 0;
+        VkResult result   = pLogicalDevice->vkd.GetPipelineCacheData(pLogicalDevice->device, pLogicalDevice->pipelineCache, &dataSize, nullptr);
+        std::vector<char> data(dataSize);
+        if (result == VK_SUCCESS && dataSize)
+        {
+            result = pLogicalDevice->vkd.GetPipelineCacheData(pLogicalDevice->device, pLogicalDevice->pipelineCache, &dataSize, data.data());
+        }
+
+        if (!fileName.empty() && result == VK_SUCCESS && dataSize)
+        {
+            // write to a temporary file first so that other processes never read a half written cache
+            std::string   tempFileName = getTempFileName(fileName);
+            std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), dataSize);
+            file.close();
+
+            if (!file || std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+            {
+                Logger::warn("could not write pipeline cache " + fileName);
+                std::remove(tempFileName.c_str());
+            }
+            else
+            {
+                Logger::debug("wrote pipeline cache " + fileName);
+            }
+        }
+
+        pLogicalDevice->vkd.DestroyPipelineCache(pLogicalDevice->device, pLogicalDevice->pipelineCache, nullptr);
+        pLogicalDevice->pipelineCache = VK_NULL_HANDLE;
+    }
+
+    VkResult createCachedGraphicsPipeline(std::shared_ptr<LogicalDevice>      pLogicalDevice,
+                                          const VkGraphicsPipelineCreateInfo* pCreateInfo,
+                                          VkPipeline*                         pPipeline)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        VkResult result =
+            pLogicalDevice->vkd.CreateGraphicsPipelines(pLogicalDevice->device, pLogicalDevice->pipelineCache, 1, pCreateInfo, nullptr, pPipeline);
+
+        auto creationTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+        pLogicalDevice->pipelineCreationTime += creationTime.count();
+        pLogicalDevice->pipelineCount++;
+
+        return result;
+    }
+
+    VkResult createCachedComputePipeline(std::shared_ptr<LogicalDevice>     pLogicalDevice,
+                                         const VkComputePipelineCreateInfo* pCreateInfo,
+                                         VkPipeline*                        pPipeline)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        VkResult result =
+            pLogicalDevice->vkd.CreateComputePipelines(pLogicalDevice->device, pLogicalDevice->pipelineCache, 1, pCreateInfo, nullptr, pPipeline);
+
+        auto creationTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+        pLogicalDevice->pipelineCreationTime += creationTime.count();
+        pLogicalDevice->pipelineCount++;
+
+        return result;
+    }
+} // namespace vkBasalt
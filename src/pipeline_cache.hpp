@@ -0,0 +1,33 @@
+#ifndef PIPELINE_CACHE_HPP_INCLUDED
+#define PIPELINE_CACHE_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // loads the pipeline cache of the device from the cache directory, or creates an empty one
+    // if the file is missing or was written by a different driver or device
+    void createPipelineCache(std::shared_ptr<LogicalDevice> pLogicalDevice);
+
+    // writes the pipeline cache back to disk and destroys it
+    void destroyPipelineCache(std::shared_ptr<LogicalDevice> pLogicalDevice);
+
+    // vkCreateGraphicsPipelines with the device wide pipeline cache, also keeps track of the time spent creating pipelines
+    VkResult createCachedGraphicsPipeline(std::shared_ptr<LogicalDevice>      pLogicalDevice,
+                                          const VkGraphicsPipelineCreateInfo* pCreateInfo,
+                                          VkPipeline*                         pPipeline);
+
+    VkResult createCachedComputePipeline(std::shared_ptr<LogicalDevice>     pLogicalDevice,
+                                         const VkComputePipelineCreateInfo* pCreateInfo,
+                                         VkPipeline*                        pPipeline);
+} // namespace vkBasalt
+
+#endif // PIPELINE_CACHE_HPP_INCLUDED
@@ -4,8 +4,6 @@ namespace vkBasalt
 {
     VkRenderPass createRenderPass(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format)
     {
-        VkRenderPass renderPass;
-
         VkAttachmentDescription attachmentDescription;
         attachmentDescription.flags          = 0;
         attachmentDescription.format         = format;
@@ -53,9 +51,70 @@ namespace vkBasalt
         renderPassCreateInfo.dependencyCount = 1;
         renderPassCreateInfo.pDependencies   = &subpassDependency;
 
-        VkResult result = pLogicalDevice->vkd.CreateRenderPass(pLogicalDevice->device, &renderPassCreateInfo, nullptr, &renderPass);
-        ASSERT_VULKAN(result);
+        return pLogicalDevice->resourceCache->getRenderPass(renderPassCreateInfo);
+    }
+
+    VkRenderPass createStencilRenderPass(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format, VkFormat stencilFormat, bool clearStencil)
+    {
+        VkAttachmentDescription attachmentDescriptions[2];
+        attachmentDescriptions[0].flags          = 0;
+        attachmentDescriptions[0].format         = format;
+        attachmentDescriptions[0].samples        = VK_SAMPLE_COUNT_1_BIT;
+        attachmentDescriptions[0].loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachmentDescriptions[0].storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        attachmentDescriptions[0].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDescriptions[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDescriptions[0].initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDescriptions[0].finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        attachmentDescriptions[1].flags          = 0;
+        attachmentDescriptions[1].format         = stencilFormat;
+        attachmentDescriptions[1].samples        = VK_SAMPLE_COUNT_1_BIT;
+        attachmentDescriptions[1].loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDescriptions[1].storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDescriptions[1].stencilLoadOp  = clearStencil ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+        attachmentDescriptions[1].stencilStoreOp = clearStencil ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachmentDescriptions[1].initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        attachmentDescriptions[1].finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference attachmentReferences[2];
+        attachmentReferences[0].attachment = 0;
+        attachmentReferences[0].layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachmentReferences[1].attachment = 1;
+        attachmentReferences[1].layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpassDescription;
+        subpassDescription.flags                   = 0;
+        subpassDescription.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpassDescription.inputAttachmentCount    = 0;
+        subpassDescription.pInputAttachments       = nullptr;
+        subpassDescription.colorAttachmentCount    = 1;
+        subpassDescription.pColorAttachments       = &attachmentReferences[0];
+        subpassDescription.pResolveAttachments     = nullptr;
+        subpassDescription.pDepthStencilAttachment = &attachmentReferences[1];
+        subpassDescription.preserveAttachmentCount = 0;
+        subpassDescription.pPreserveAttachments    = nullptr;
+
+        VkSubpassDependency subpassDependency;
+        subpassDependency.srcSubpass      = VK_SUBPASS_EXTERNAL;
+        subpassDependency.dstSubpass      = 0;
+        subpassDependency.srcStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        subpassDependency.dstStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        subpassDependency.srcAccessMask   = 0;
+        subpassDependency.dstAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        subpassDependency.dependencyFlags = 0;
+
+        VkRenderPassCreateInfo renderPassCreateInfo;
+        renderPassCreateInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassCreateInfo.pNext           = nullptr;
+        renderPassCreateInfo.flags           = 0;
+        renderPassCreateInfo.attachmentCount = 2;
+        renderPassCreateInfo.pAttachments    = attachmentDescriptions;
+        renderPassCreateInfo.subpassCount    = 1;
+        renderPassCreateInfo.pSubpasses      = &subpassDescription;
+        renderPassCreateInfo.dependencyCount = 1;
+        renderPassCreateInfo.pDependencies   = &subpassDependency;
 
-        return renderPass;
+        return pLogicalDevice->resourceCache->getRenderPass(renderPassCreateInfo);
     }
 } // namespace vkBasalt
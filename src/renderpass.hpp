@@ -14,6 +14,9 @@
 namespace vkBasalt
 {
     VkRenderPass createRenderPass(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format);
+    // like createRenderPass with a stencil attachment, which is in VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL before and after.
+    // The stencil either gets cleared to 0 and stored, or loads what an earlier render pass stored
+    VkRenderPass createStencilRenderPass(std::shared_ptr<LogicalDevice> pLogicalDevice, VkFormat format, VkFormat stencilFormat, bool clearStencil);
 }
 
 #endif // RENDERPASS_HPP_INCLUDED
@@ -0,0 +1,307 @@
+#include "reshade_module_cache.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+#include "logger.hpp"
+#include "module_stream.hpp"
+#include "util.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // increase this when the layout of the cache files changes
+        const uint32_t cacheFormatVersion = 1;
+        const char     cacheMagic[8]      = {'v', 'k', 'B', 'M', 'O', 'D', 'U', 'L'};
+
+        std::atomic<uint32_t> cacheHits   = 0;
+        std::atomic<uint32_t> cacheMisses = 0;
+
+        class ReshadeModuleWriter : public ModuleWriter<ReshadeModuleWriter>
+        {
+        public:
+            using ModuleWriter::write;
+
+            void write(const reshadefx::constant& value)
+            {
+                write(value.as_uint);
+                write(value.string_data);
+                write(value.array_data);
+            }
+
+            void write(const reshadefx::annotation& value)
+            {
+                write(value.type);
+                write(value.name);
+                write(value.value);
+            }
+
+            void write(const reshadefx::texture_info& value)
+            {
+                write(value.unique_name);
+                write(value.semantic);
+                write(value.annotations);
+                write(value.width);
+                write(value.height);
+                write(value.levels);
+                write(value.format);
+            }
+
+            void write(const reshadefx::sampler_info& value)
+            {
+                write(value.unique_name);
+                write(value.texture_name);
+                write(value.annotations);
+                write(value.filter);
+                write(value.address_u);
+                write(value.address_v);
+                write(value.address_w);
+                write(value.min_lod);
+                write(value.max_lod);
+                write(value.lod_bias);
+                write(value.srgb);
+            }
+
+            void write(const reshadefx::uniform_info& value)
+            {
+                write(value.name);
+                write(value.type);
+                write(value.size);
+                write(value.offset);
+                write(value.annotations);
+            }
+
+            void write(const reshadefx::pass_info& value)
+            {
+                for (const auto& renderTargetName : value.render_target_names)
+                {
+                    write(renderTargetName);
+                }
+                write(value.vs_entry_point);
+                write(value.ps_entry_point);
+                write(value.clear_render_targets);
+                write(value.srgb_write_enable);
+                write(value.blend_enable);
+                write(value.stencil_enable);
+                write(value.color_write_mask);
+                write(value.stencil_read_mask);
+                write(value.stencil_write_mask);
+                write(value.blend_op);
+                write(value.blend_op_alpha);
+                write(value.src_blend);
+                write(value.dest_blend);
+                write(value.src_blend_alpha);
+                write(value.dest_blend_alpha);
+                write(value.stencil_comparison_func);
+                write(value.stencil_reference_value);
+                write(value.stencil_op_pass);
+                write(value.stencil_op_fail);
+                write(value.stencil_op_depth_fail);
+                write(value.num_vertices);
+                write(value.topology);
+                write(value.viewport_width);
+                write(value.viewport_height);
+            }
+
+            void write(const reshadefx::technique_info& value)
+            {
+                write(value.name);
+                write(value.passes);
+                write(value.annotations);
+            }
+        };
+
+        class ReshadeModuleReader : public ModuleReader<ReshadeModuleReader>
+        {
+        public:
+            using ModuleReader::ModuleReader;
+            using ModuleReader::read;
+
+            void read(reshadefx::constant& value)
+            {
+                read(value.as_uint);
+                read(value.string_data);
+                read(value.array_data);
+            }
+
+            void read(reshadefx::annotation& value)
+            {
+                read(value.type);
+                read(value.name);
+                read(value.value);
+            }
+
+            void read(reshadefx::texture_info& value)
+            {
+                read(value.unique_name);
+                read(value.semantic);
+                read(value.annotations);
+                read(value.width);
+                read(value.height);
+                read(value.levels);
+                read(value.format);
+            }
+
+            void read(reshadefx::sampler_info& value)
+            {
+                read(value.unique_name);
+                read(value.texture_name);
+                read(value.annotations);
+                read(value.filter);
+                read(value.address_u);
+                read(value.address_v);
+                read(value.address_w);
+                read(value.min_lod);
+                read(value.max_lod);
+                read(value.lod_bias);
+                read(value.srgb);
+            }
+
+            void read(reshadefx::uniform_info& value)
+            {
+                read(value.name);
+                read(value.type);
+                read(value.size);
+                read(value.offset);
+                read(value.annotations);
+            }
+
+            void read(reshadefx::pass_info& value)
+            {
+                for (auto& renderTargetName : value.render_target_names)
+                {
+                    read(renderTargetName);
+                }
+                read(value.vs_entry_point);
+                read(value.ps_entry_point);
+                read(value.clear_render_targets);
+                read(value.srgb_write_enable);
+                read(value.blend_enable);
+                read(value.stencil_enable);
+                read(value.color_write_mask);
+                read(value.stencil_read_mask);
+                read(value.stencil_write_mask);
+                read(value.blend_op);
+                read(value.blend_op_alpha);
+                read(value.src_blend);
+                read(value.dest_blend);
+                read(value.src_blend_alpha);
+                read(value.dest_blend_alpha);
+                read(value.stencil_comparison_func);
+                read(value.stencil_reference_value);
+                read(value.stencil_op_pass);
+                read(value.stencil_op_fail);
+                read(value.stencil_op_depth_fail);
+                read(value.num_vertices);
+                read(value.topology);
+                read(value.viewport_width);
+                read(value.viewport_height);
+            }
+
+            void read(reshadefx::technique_info& value)
+            {
+                read(value.name);
+                read(value.passes);
+                read(value.annotations);
+            }
+        };
+
+        std::string getCacheFileName(uint64_t key)
+        {
+            std::string cacheDir = getCacheDirectory();
+            if (cacheDir.empty())
+            {
+                return "";
+            }
+
+            std::stringstream ss;
+            ss << cacheDir << "/reshade_" << std::hex << std::setw(16) << std::setfill('0') << key << ".module";
+            return ss.str();
+        }
+
+        void logCacheStatistics(const std::string& result)
+        {
+            Logger::info("reshade module cache " + result + " (" + std::to_string(cacheHits) + " hits, " + std::to_string(cacheMisses)
+                         + " misses)");
+        }
+    } // namespace
+
+    bool loadReshadeModule(uint64_t key, reshadefx::module& module)
+    {
+        std::string fileName = getCacheFileName(key);
+
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (fileName.empty() || !file)
+        {
+            cacheMisses++;
+            logCacheStatistics("miss");
+            return false;
+        }
+
+        std::vector<char> data((size_t) file.tellg());
+        file.seekg(0);
+        file.read(data.data(), data.size());
+
+        ReshadeModuleReader reader(data);
+        reader.readHeader(cacheMagic, cacheFormatVersion, key);
+
+        reshadefx::module cachedModule;
+        reader.read(cachedModule.spirv);
+        reader.read(cachedModule.textures);
+        reader.read(cachedModule.samplers);
+        reader.read(cachedModule.uniforms);
+        reader.read(cachedModule.spec_constants);
+        reader.read(cachedModule.techniques);
+        reader.read(cachedModule.total_uniform_size);
+        reader.failed = reader.failed || !reader.atEnd();
+
+        if (reader.failed)
+        {
+            Logger::warn("ignoring invalid reshade module cache file " + fileName);
+            cacheMisses++;
+            logCacheStatistics("miss");
+            return false;
+        }
+
+        module = std::move(cachedModule);
+        cacheHits++;
+        logCacheStatistics("hit");
+        return true;
+    }
+
+    void saveReshadeModule(uint64_t key, const reshadefx::module& module)
+    {
+        std::string fileName = getCacheFileName(key);
+        if (fileName.empty())
+        {
+            return;
+        }
+
+        ReshadeModuleWriter writer;
+        writer.writeHeader(cacheMagic, cacheFormatVersion, key);
+        writer.write(module.spirv);
+        writer.write(module.textures);
+        writer.write(module.samplers);
+        writer.write(module.uniforms);
+        writer.write(module.spec_constants);
+        writer.write(module.techniques);
+        writer.write(module.total_uniform_size);
+
+        // write to a temporary file first so that concurrent processes never read a half written file
+        std::string   tempFileName = getTempFileName(fileName);
+        std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+        file.write(writer.data.data(), writer.data.size());
+        file.close();
+
+        if (!file || std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+        {
+            Logger::warn("could not write reshade module cache file " + fileName);
+            std::remove(tempFileName.c_str());
+            return;
+        }
+        Logger::debug("wrote reshade module cache file " + fileName);
+    }
+} // namespace vkBasalt
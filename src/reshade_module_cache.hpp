@@ -0,0 +1,21 @@
+#ifndef RESHADE_MODULE_CACHE_HPP_INCLUDED
+#define RESHADE_MODULE_CACHE_HPP_INCLUDED
+#include <vector>
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+#include "../reshade/source/effect_module.hpp"
+
+namespace vkBasalt
+{
+    // The compiled reshadefx::module gets stored under the cache directory, named after the key.
+    // The key has to cover everything that changes the compiled module, see ReshadeEffect::createReshadeModule.
+    // Only the parts of the module that vkBasalt reads get stored.
+    bool loadReshadeModule(uint64_t key, reshadefx::module& module);
+    void saveReshadeModule(uint64_t key, const reshadefx::module& module);
+} // namespace vkBasalt
+
+#endif // RESHADE_MODULE_CACHE_HPP_INCLUDED
@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "logger.hpp"
+#include "keyboard_input.hpp"
 
 namespace vkBasalt
 {
@@ -289,12 +290,42 @@ namespace vkBasalt
         {
             Logger::err("Tried to create a KeyUniform from a non key uniform_info");
         }
+        if (auto keycodeAnnotation =
+                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "keycode"; });
+            keycodeAnnotation != uniformInfo.annotations.end())
+        {
+            keySym = convertToKeySym(keycodeAnnotation->value.as_int[0]);
+        }
+        if (auto modeAnnotation =
+                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "mode"; });
+            modeAnnotation != uniformInfo.annotations.end())
+        {
+            toggle  = modeAnnotation->value.string_data == "toggle";
+            onPress = modeAnnotation->value.string_data == "press";
+        }
         offset = uniformInfo.offset;
         size   = uniformInfo.size;
     }
     void KeyUniform::update(void* mapedBuffer)
     {
-        VkBool32 keyDown = VK_FALSE; // TODO
+        // only reads the state published by the input thread
+        bool pressed = isKeyPressed(keySym);
+
+        VkBool32 keyDown = pressed ? VK_TRUE : VK_FALSE;
+        if (toggle)
+        {
+            if (pressed && !wasPressed)
+            {
+                toggled = !toggled;
+            }
+            keyDown = toggled;
+        }
+        else if (onPress)
+        {
+            keyDown = (pressed && !wasPressed) ? VK_TRUE : VK_FALSE;
+        }
+        wasPressed = pressed;
+
         std::memcpy((uint8_t*) mapedBuffer + offset, &(keyDown), sizeof(VkBool32));
     }
     KeyUniform::~KeyUniform()
@@ -309,12 +340,42 @@ namespace vkBasalt
         {
             Logger::err("Tried to create a MouseButtonUniform from a non mousebutton uniform_info");
         }
+        if (auto keycodeAnnotation =
+                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "keycode"; });
+            keycodeAnnotation != uniformInfo.annotations.end())
+        {
+            button = keycodeAnnotation->value.as_int[0];
+        }
+        if (auto modeAnnotation =
+                std::find_if(uniformInfo.annotations.begin(), uniformInfo.annotations.end(), [](const auto& a) { return a.name == "mode"; });
+            modeAnnotation != uniformInfo.annotations.end())
+        {
+            toggle  = modeAnnotation->value.string_data == "toggle";
+            onPress = modeAnnotation->value.string_data == "press";
+        }
         offset = uniformInfo.offset;
         size   = uniformInfo.size;
     }
     void MouseButtonUniform::update(void* mapedBuffer)
     {
-        VkBool32 keyDown = VK_FALSE; // TODO
+        // only reads the state published by the input thread
+        bool pressed = isMouseButtonPressed(button);
+
+        VkBool32 keyDown = pressed ? VK_TRUE : VK_FALSE;
+        if (toggle)
+        {
+            if (pressed && !wasPressed)
+            {
+                toggled = !toggled;
+            }
+            keyDown = toggled;
+        }
+        else if (onPress)
+        {
+            keyDown = (pressed && !wasPressed) ? VK_TRUE : VK_FALSE;
+        }
+        wasPressed = pressed;
+
         std::memcpy((uint8_t*) mapedBuffer + offset, &(keyDown), sizeof(VkBool32));
     }
     MouseButtonUniform::~MouseButtonUniform()
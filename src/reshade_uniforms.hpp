@@ -106,6 +106,13 @@ namespace vkBasalt
         KeyUniform(reshadefx::uniform_info uniformInfo);
         void virtual update(void* mapedBuffer) override;
         virtual ~KeyUniform();
+
+    private:
+        uint64_t keySym     = 0; // X11 KeySym, the X11 headers are kept out of here since their macros clash with reshade
+        bool     toggle     = false;
+        bool     onPress    = false;
+        bool     wasPressed = false;
+        VkBool32 toggled    = VK_FALSE;
     };
 
     class MouseButtonUniform : public ReshadeUniform
@@ -114,6 +121,13 @@ namespace vkBasalt
         MouseButtonUniform(reshadefx::uniform_info uniformInfo);
         void virtual update(void* mapedBuffer) override;
         virtual ~MouseButtonUniform();
+
+    private:
+        uint32_t button     = 0;
+        bool     toggle     = false;
+        bool     onPress    = false;
+        bool     wasPressed = false;
+        VkBool32 toggled    = VK_FALSE;
     };
 
     class MousePointUniform : public ReshadeUniform
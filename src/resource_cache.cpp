@@ -0,0 +1,298 @@
+#include "resource_cache.hpp"
+
+#include <cstring>
+
+#include "vulkan/hash_util.h"
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        uint64_t floatBits(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        template<typename Handle>
+        uint64_t handleBits(Handle handle)
+        {
+            return (uint64_t) handle;
+        }
+
+        void appendAttachmentReferences(std::vector<uint64_t>& key, uint32_t count, const VkAttachmentReference* pReferences)
+        {
+            key.push_back(pReferences ? count : 0);
+            for (uint32_t i = 0; pReferences && i < count; i++)
+            {
+                key.insert(key.end(), {pReferences[i].attachment, (uint64_t) pReferences[i].layout});
+            }
+        }
+    } // namespace
+
+    size_t ResourceCache::KeyHash::operator()(const Key& key) const
+    {
+        return hash_util::HashCombiner().Combine(key).Value();
+    }
+
+    ResourceCache::ResourceCache(const VkLayerDispatchTable* pDispatchTable, VkDevice device, MemoryAllocator* pAllocator)
+        : pDispatchTable(pDispatchTable), device(device), pAllocator(pAllocator)
+    {
+    }
+
+    ResourceCache::~ResourceCache()
+    {
+        Logger::debug("resource cache created " + std::to_string(createCount) + " objects and reused them " + std::to_string(reuseCount)
+                      + " times");
+        if (entries.size() || textures.size())
+        {
+            Logger::warn(std::to_string(entries.size() + textures.size()) + " cached objects are still in use");
+        }
+        for (auto& entry : entries)
+        {
+            destroy(static_cast<ObjectType>(entry.first[0]), entry.second.handle);
+        }
+        for (auto& texture : textures)
+        {
+            pDispatchTable->DestroyImageView(device, texture.second.texture.imageView, nullptr);
+            pDispatchTable->DestroyImage(device, texture.second.texture.image, nullptr);
+            pAllocator->free(texture.second.texture.memory);
+        }
+    }
+
+    VkSampler ResourceCache::getSampler(const VkSamplerCreateInfo& createInfo)
+    {
+        Key key = {(uint64_t) ObjectType::sampler,
+                   createInfo.flags,
+                   (uint64_t) createInfo.magFilter,
+                   (uint64_t) createInfo.minFilter,
+                   (uint64_t) createInfo.mipmapMode,
+                   (uint64_t) createInfo.addressModeU,
+                   (uint64_t) createInfo.addressModeV,
+                   (uint64_t) createInfo.addressModeW,
+                   floatBits(createInfo.mipLodBias),
+                   createInfo.anisotropyEnable,
+                   floatBits(createInfo.maxAnisotropy),
+                   createInfo.compareEnable,
+                   (uint64_t) createInfo.compareOp,
+                   floatBits(createInfo.minLod),
+                   floatBits(createInfo.maxLod),
+                   (uint64_t) createInfo.borderColor,
+                   createInfo.unnormalizedCoordinates};
+
+        return (VkSampler) get(key, [&]() {
+            VkSampler sampler;
+            VkResult  result = pDispatchTable->CreateSampler(device, &createInfo, nullptr, &sampler);
+            ASSERT_VULKAN(result);
+            return handleBits(sampler);
+        });
+    }
+
+    VkRenderPass ResourceCache::getRenderPass(const VkRenderPassCreateInfo& createInfo)
+    {
+        Key key = {(uint64_t) ObjectType::renderPass, createInfo.flags, createInfo.attachmentCount};
+        for (uint32_t i = 0; i < createInfo.attachmentCount; i++)
+        {
+            const VkAttachmentDescription& attachment = createInfo.pAttachments[i];
+            key.insert(key.end(),
+                       {attachment.flags,
+                        (uint64_t) attachment.format,
+                        (uint64_t) attachment.samples,
+                        (uint64_t) attachment.loadOp,
+                        (uint64_t) attachment.storeOp,
+                        (uint64_t) attachment.stencilLoadOp,
+                        (uint64_t) attachment.stencilStoreOp,
+                        (uint64_t) attachment.initialLayout,
+                        (uint64_t) attachment.finalLayout});
+        }
+        key.push_back(createInfo.subpassCount);
+        for (uint32_t i = 0; i < createInfo.subpassCount; i++)
+        {
+            const VkSubpassDescription& subpass = createInfo.pSubpasses[i];
+            key.insert(key.end(), {subpass.flags, (uint64_t) subpass.pipelineBindPoint});
+            appendAttachmentReferences(key, subpass.inputAttachmentCount, subpass.pInputAttachments);
+            appendAttachmentReferences(key, subpass.colorAttachmentCount, subpass.pColorAttachments);
+            appendAttachmentReferences(key, subpass.colorAttachmentCount, subpass.pResolveAttachments);
+            appendAttachmentReferences(key, 1, subpass.pDepthStencilAttachment);
+            key.push_back(subpass.preserveAttachmentCount);
+            key.insert(key.end(), subpass.pPreserveAttachments, subpass.pPreserveAttachments + subpass.preserveAttachmentCount);
+        }
+        key.push_back(createInfo.dependencyCount);
+        for (uint32_t i = 0; i < createInfo.dependencyCount; i++)
+        {
+            const VkSubpassDependency& dependency = createInfo.pDependencies[i];
+            key.insert(key.end(),
+                       {dependency.srcSubpass,
+                        dependency.dstSubpass,
+                        dependency.srcStageMask,
+                        dependency.dstStageMask,
+                        dependency.srcAccessMask,
+                        dependency.dstAccessMask,
+                        dependency.dependencyFlags});
+        }
+
+        return (VkRenderPass) get(key, [&]() {
+            VkRenderPass renderPass;
+            VkResult     result = pDispatchTable->CreateRenderPass(device, &createInfo, nullptr, &renderPass);
+            ASSERT_VULKAN(result);
+            return handleBits(renderPass);
+        });
+    }
+
+    VkDescriptorSetLayout ResourceCache::getDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo& createInfo)
+    {
+        Key key = {(uint64_t) ObjectType::descriptorSetLayout, createInfo.flags, createInfo.bindingCount};
+        for (uint32_t i = 0; i < createInfo.bindingCount; i++)
+        {
+            const VkDescriptorSetLayoutBinding& binding = createInfo.pBindings[i];
+            key.insert(key.end(), {binding.binding, (uint64_t) binding.descriptorType, binding.descriptorCount, binding.stageFlags});
+            key.push_back(binding.pImmutableSamplers != nullptr);
+            for (uint32_t j = 0; binding.pImmutableSamplers && j < binding.descriptorCount; j++)
+            {
+                key.push_back(handleBits(binding.pImmutableSamplers[j]));
+            }
+        }
+
+        return (VkDescriptorSetLayout) get(key, [&]() {
+            VkDescriptorSetLayout descriptorSetLayout;
+            VkResult              result = pDispatchTable->CreateDescriptorSetLayout(device, &createInfo, nullptr, &descriptorSetLayout);
+            ASSERT_VULKAN(result);
+            return handleBits(descriptorSetLayout);
+        });
+    }
+
+    VkPipelineLayout ResourceCache::getPipelineLayout(const VkPipelineLayoutCreateInfo& createInfo)
+    {
+        // the set layouts come from the cache as well, so equal handles mean equal layouts
+        Key key = {(uint64_t) ObjectType::pipelineLayout, createInfo.flags, createInfo.setLayoutCount};
+        for (uint32_t i = 0; i < createInfo.setLayoutCount; i++)
+        {
+            key.push_back(handleBits(createInfo.pSetLayouts[i]));
+        }
+        key.push_back(createInfo.pushConstantRangeCount);
+        for (uint32_t i = 0; i < createInfo.pushConstantRangeCount; i++)
+        {
+            const VkPushConstantRange& range = createInfo.pPushConstantRanges[i];
+            key.insert(key.end(), {range.stageFlags, range.offset, range.size});
+        }
+
+        return (VkPipelineLayout) get(key, [&]() {
+            VkPipelineLayout pipelineLayout;
+            VkResult         result = pDispatchTable->CreatePipelineLayout(device, &createInfo, nullptr, &pipelineLayout);
+            ASSERT_VULKAN(result);
+            return handleBits(pipelineLayout);
+        });
+    }
+
+    void ResourceCache::releaseSampler(VkSampler sampler)
+    {
+        release(ObjectType::sampler, handleBits(sampler));
+    }
+
+    void ResourceCache::releaseRenderPass(VkRenderPass renderPass)
+    {
+        release(ObjectType::renderPass, handleBits(renderPass));
+    }
+
+    void ResourceCache::releaseDescriptorSetLayout(VkDescriptorSetLayout descriptorSetLayout)
+    {
+        release(ObjectType::descriptorSetLayout, handleBits(descriptorSetLayout));
+    }
+
+    void ResourceCache::releasePipelineLayout(VkPipelineLayout pipelineLayout)
+    {
+        release(ObjectType::pipelineLayout, handleBits(pipelineLayout));
+    }
+
+    CachedTexture ResourceCache::getTexture(const std::string& name, const std::function<CachedTexture()>& create)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = textures.find(name);
+        if (it != textures.end())
+        {
+            it->second.references++;
+            reuseCount++;
+            return it->second.texture;
+        }
+
+        Logger::debug("creating cached texture " + name);
+        createCount++;
+        return textures.emplace(name, TextureEntry{create(), 1}).first->second.texture;
+    }
+
+    void ResourceCache::releaseTexture(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = textures.find(name);
+        if (it == textures.end() || --it->second.references)
+        {
+            return;
+        }
+        pDispatchTable->DestroyImageView(device, it->second.texture.imageView, nullptr);
+        pDispatchTable->DestroyImage(device, it->second.texture.image, nullptr);
+        pAllocator->free(it->second.texture.memory);
+        textures.erase(it);
+    }
+
+    uint64_t ResourceCache::get(const Key& key, const std::function<uint64_t()>& create)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            it->second.references++;
+            reuseCount++;
+            return it->second.handle;
+        }
+
+        uint64_t handle = create();
+        createCount++;
+        entries.emplace(key, Entry{handle, 1});
+        handleKeys.emplace(Key{key[0], handle}, key);
+        return handle;
+    }
+
+    void ResourceCache::release(ObjectType type, uint64_t handle)
+    {
+        if (!handle)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto handleIt = handleKeys.find(Key{(uint64_t) type, handle});
+        if (handleIt == handleKeys.end())
+        {
+            Logger::err("released an object that is not in the resource cache");
+            return;
+        }
+        auto it = entries.find(handleIt->second);
+        if (--it->second.references)
+        {
+            return;
+        }
+        destroy(type, handle);
+        entries.erase(it);
+        handleKeys.erase(handleIt);
+    }
+
+    void ResourceCache::destroy(ObjectType type, uint64_t handle)
+    {
+        switch (type)
+        {
+            case ObjectType::sampler: pDispatchTable->DestroySampler(device, (VkSampler) handle, nullptr); break;
+            case ObjectType::renderPass: pDispatchTable->DestroyRenderPass(device, (VkRenderPass) handle, nullptr); break;
+            case ObjectType::descriptorSetLayout:
+                pDispatchTable->DestroyDescriptorSetLayout(device, (VkDescriptorSetLayout) handle, nullptr);
+                break;
+            case ObjectType::pipelineLayout: pDispatchTable->DestroyPipelineLayout(device, (VkPipelineLayout) handle, nullptr); break;
+        }
+    }
+} // namespace vkBasalt
@@ -0,0 +1,96 @@
+#ifndef RESOURCE_CACHE_HPP_INCLUDED
+#define RESOURCE_CACHE_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+#include "memory_allocator.hpp"
+
+namespace vkBasalt
+{
+    // an image that is shared by all effects of a device, e.g. the lookup textures of smaa
+    struct CachedTexture
+    {
+        VkImage          image     = VK_NULL_HANDLE;
+        VkImageView      imageView = VK_NULL_HANDLE;
+        MemoryAllocation memory;
+    };
+
+    // Shares the immutable objects of the effects between all effects and swapchains of a device.
+    // Objects get looked up by their create info, effects with the same samplers, render passes or layouts get the same handle.
+    // Every get has to be paired with a release, the object gets destroyed once the last user released it.
+    // The create infos must not have a pNext chain. The handles are released by type, since all non dispatchable
+    // handles are the same type in 32 bit builds.
+    class ResourceCache
+    {
+    public:
+        ResourceCache(const VkLayerDispatchTable* pDispatchTable, VkDevice device, MemoryAllocator* pAllocator);
+        ~ResourceCache();
+
+        VkSampler             getSampler(const VkSamplerCreateInfo& createInfo);
+        VkRenderPass          getRenderPass(const VkRenderPassCreateInfo& createInfo);
+        VkDescriptorSetLayout getDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo& createInfo);
+        VkPipelineLayout      getPipelineLayout(const VkPipelineLayoutCreateInfo& createInfo);
+
+        void releaseSampler(VkSampler sampler);
+        void releaseRenderPass(VkRenderPass renderPass);
+        void releaseDescriptorSetLayout(VkDescriptorSetLayout descriptorSetLayout);
+        void releasePipelineLayout(VkPipelineLayout pipelineLayout);
+
+        // returns the texture with the given name, create gets called only if no effect holds it yet.
+        // create runs while the cache is locked, so it must not use the cache itself
+        CachedTexture getTexture(const std::string& name, const std::function<CachedTexture()>& create);
+        void          releaseTexture(const std::string& name);
+
+    private:
+        enum class ObjectType : uint64_t
+        {
+            sampler,
+            renderPass,
+            descriptorSetLayout,
+            pipelineLayout
+        };
+
+        // the create info with every pointer followed, two create infos are equal if their keys are equal
+        using Key = std::vector<uint64_t>;
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Entry
+        {
+            uint64_t handle;
+            uint32_t references;
+        };
+
+        struct TextureEntry
+        {
+            CachedTexture texture;
+            uint32_t      references;
+        };
+
+        uint64_t get(const Key& key, const std::function<uint64_t()>& create);
+        void     release(ObjectType type, uint64_t handle);
+        void     destroy(ObjectType type, uint64_t handle);
+
+        const VkLayerDispatchTable* pDispatchTable;
+        VkDevice                    device;
+        MemoryAllocator*            pAllocator;
+
+        std::mutex                                    mutex;
+        std::unordered_map<Key, Entry, KeyHash>       entries;
+        std::unordered_map<Key, Key, KeyHash>         handleKeys; // {type, handle} to the key of the entry
+        std::unordered_map<std::string, TextureEntry> textures;
+        uint32_t                                      createCount = 0;
+        uint32_t                                      reuseCount  = 0;
+    };
+} // namespace vkBasalt
+
+#endif // RESOURCE_CACHE_HPP_INCLUDED
@@ -4,8 +4,6 @@ namespace vkBasalt
 {
     VkSampler createSampler(std::shared_ptr<LogicalDevice> pLogicalDevice)
     {
-        VkSampler sampler;
-
         VkSamplerCreateInfo samplerCreateInfo;
         samplerCreateInfo.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
         samplerCreateInfo.pNext                   = nullptr;
@@ -26,15 +24,11 @@ namespace vkBasalt
         samplerCreateInfo.borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
         samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 
-        VkResult result = pLogicalDevice->vkd.CreateSampler(pLogicalDevice->device, &samplerCreateInfo, nullptr, &sampler);
-        ASSERT_VULKAN(result);
-        return sampler;
+        return pLogicalDevice->resourceCache->getSampler(samplerCreateInfo);
     }
 
     VkSampler createReshadeSampler(std::shared_ptr<LogicalDevice> pLogicalDevice, const reshadefx::sampler_info& samplerInfo)
     {
-        VkSampler sampler;
-
         VkFilter            minFilter;
         VkFilter            magFilter;
         VkSamplerMipmapMode mipmapMode;
@@ -60,9 +54,7 @@ namespace vkBasalt
         samplerCreateInfo.borderColor             = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
         samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
 
-        VkResult result = pLogicalDevice->vkd.CreateSampler(pLogicalDevice->device, &samplerCreateInfo, nullptr, &sampler);
-        ASSERT_VULKAN(result);
-        return sampler;
+        return pLogicalDevice->resourceCache->getSampler(samplerCreateInfo);
     }
 
     VkSamplerAddressMode convertReshadeAddressMode(const reshadefx::texture_address_mode& addressMode)
@@ -3,41 +3,54 @@
 #include <array>
 #include <filesystem>
 
+#include "builtin_shaders.hpp"
+
 namespace vkBasalt
 {
+    static std::string findShaderDir()
+    {
+        // Custom shader directory path
+        const char* tmpShaderEnv    = std::getenv("VKBASALT_SHADER_PATH");
+        std::string customShaderDir = tmpShaderEnv ? std::string(tmpShaderEnv) : "";
+
+        // User shader directory path
+        const char* tmpHomeEnv = std::getenv("XDG_DATA_HOME");
+        std::string userShaderDir =
+            tmpHomeEnv ? std::string(tmpHomeEnv) + "/vkBasalt/shader" : std::string(std::getenv("HOME")) + "/.local/share/vkBasalt/shader";
+
+        // Allowed config paths
+        const std::array<std::string, 4> shaderPath = {
+            customShaderDir,                    // custom shaders (VKBASALT_SHADER_PATH=/path/to/vkBasalt/shader)
+            userShaderDir,                      // default shaders
+            "/usr/share/vkBasalt/shader",       // system-wide shaders
+            "/usr/local/share/vkBasalt/shader", // system-wide shaders (alternative)
+        };
+
+        for (const auto& sDir : shaderPath)
+        {
+            if (!std::filesystem::is_directory(sDir))
+                continue;
+
+            Logger::info("shader directory: " + sDir);
+            return sDir + "/";
+        }
+        return "";
+    }
+
     std::vector<char> readFile(const std::string& filename)
     {
-        static std::string shaderDir;
+        // the shaders are linked into the layer, VKBASALT_SHADER_PATH loads them from disk instead, e.g. to try out changes
+        static const bool useBuiltinShaders = std::getenv("VKBASALT_SHADER_PATH") == nullptr;
 
-        if (shaderDir.empty())
+        std::vector<char> code;
+        if (filename[0] != '/' && useBuiltinShaders && getBuiltinShader(filename, code))
         {
-            // Custom shader directory path
-            const char* tmpShaderEnv    = std::getenv("VKBASALT_SHADER_PATH");
-            std::string customShaderDir = tmpShaderEnv ? std::string(tmpShaderEnv) : "";
-
-            // User shader directory path
-            const char* tmpHomeEnv = std::getenv("XDG_DATA_HOME");
-            std::string userShaderDir =
-                tmpHomeEnv ? std::string(tmpHomeEnv) + "/vkBasalt/shader" : std::string(std::getenv("HOME")) + "/.local/share/vkBasalt/shader";
-
-            // Allowed config paths
-            const std::array<std::string, 4> shaderPath = {
-                customShaderDir,                    // custom shaders (VKBASALT_SHADER_PATH=/path/to/vkBasalt/shader)
-                userShaderDir,                      // default shaders
-                "/usr/share/vkBasalt/shader",       // system-wide shaders
-                "/usr/local/share/vkBasalt/shader", // system-wide shaders (alternative)
-            };
-
-            for (const auto& sDir : shaderPath)
-            {
-                if (!std::filesystem::is_directory(sDir))
-                    continue;
-
-                Logger::info("shader directory: " + sDir);
-                shaderDir = sDir + "/";
-                break;
-            }
+            return code;
         }
+
+        // effects get created on several threads, the initialization of a static is thread safe
+        static const std::string shaderDir = findShaderDir();
+
         std::ifstream file;
 
         if (filename[0] != '/')
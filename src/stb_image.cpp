@@ -1,5 +1,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
+// the failure reason is a global, images get decoded on several threads at once
+#define STBI_NO_FAILURE_STRINGS
 #define STB_IMAGE_DDS_IMPLEMENTATION
 #include "stb_image.h"
 #include "stb_image_dds.h"
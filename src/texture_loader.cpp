@@ -0,0 +1,288 @@
+#include "texture_loader.hpp"
+
+#include <cstdio>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "format.hpp"
+#include "logger.hpp"
+
+#include "stb_image.h"
+#include "stb_image_dds.h"
+#include "stb_image_resize.h"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        // the parts of a dds header that are needed to upload the payload as it is
+        struct DdsInfo
+        {
+            VkFormat format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t mipLevels;
+            long     dataOffset;
+        };
+
+        constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+        {
+            return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+        }
+
+        VkFormat convertFourCC(uint32_t fourCC)
+        {
+            switch (fourCC)
+            {
+                case makeFourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+                case makeFourCC('D', 'X', 'T', '2'): return VK_FORMAT_BC2_UNORM_BLOCK;
+                case makeFourCC('D', 'X', 'T', '3'): return VK_FORMAT_BC2_UNORM_BLOCK;
+                case makeFourCC('D', 'X', 'T', '4'): return VK_FORMAT_BC3_UNORM_BLOCK;
+                case makeFourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+                case makeFourCC('A', 'T', 'I', '1'): return VK_FORMAT_BC4_UNORM_BLOCK;
+                case makeFourCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+                case makeFourCC('A', 'T', 'I', '2'): return VK_FORMAT_BC5_UNORM_BLOCK;
+                case makeFourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+                default: return VK_FORMAT_UNDEFINED;
+            }
+        }
+
+        // the srgb variants map to unorm, the texture gets an unorm and a srgb view anyway
+        VkFormat convertDxgiFormat(uint32_t dxgiFormat)
+        {
+            switch (dxgiFormat)
+            {
+                case 71: // DXGI_FORMAT_BC1_UNORM
+                case 72: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+                case 74: // DXGI_FORMAT_BC2_UNORM
+                case 75: return VK_FORMAT_BC2_UNORM_BLOCK;
+                case 77: // DXGI_FORMAT_BC3_UNORM
+                case 78: return VK_FORMAT_BC3_UNORM_BLOCK;
+                case 80: return VK_FORMAT_BC4_UNORM_BLOCK; // DXGI_FORMAT_BC4_UNORM
+                case 83: return VK_FORMAT_BC5_UNORM_BLOCK; // DXGI_FORMAT_BC5_UNORM
+                case 98: // DXGI_FORMAT_BC7_UNORM
+                case 99: return VK_FORMAT_BC7_UNORM_BLOCK;
+                default: return VK_FORMAT_UNDEFINED;
+            }
+        }
+
+        // only accepts plain 2D textures, cube maps, volumes and arrays get decoded by stb
+        bool readDdsInfo(FILE* file, DdsInfo& info)
+        {
+            uint32_t header[32]; // the magic number followed by the 124 byte DDS_HEADER
+            if (fread(header, sizeof(header), 1, file) != 1 || header[0] != makeFourCC('D', 'D', 'S', ' ') || header[1] != 124)
+            {
+                return false;
+            }
+
+            const uint32_t flags           = header[2];
+            const uint32_t pixelFlags      = header[20];
+            const uint32_t fourCC          = header[21];
+            const uint32_t caps2           = header[28];
+            const uint32_t mipMapCountFlag = 0x00020000; // DDSD_MIPMAPCOUNT
+            const uint32_t fourCCFlag      = 0x00000004; // DDPF_FOURCC
+            const uint32_t volumeOrCube    = 0x00200000 | 0x00000200; // DDSCAPS2_VOLUME | DDSCAPS2_CUBEMAP
+
+            if (!(pixelFlags & fourCCFlag) || (caps2 & volumeOrCube))
+            {
+                return false;
+            }
+
+            info.width      = header[4];
+            info.height     = header[3];
+            info.mipLevels  = (flags & mipMapCountFlag) && header[7] ? header[7] : 1;
+            info.dataOffset = sizeof(header);
+
+            if (fourCC == makeFourCC('D', 'X', '1', '0'))
+            {
+                uint32_t header10[5]; // DDS_HEADER_DXT10
+                if (fread(header10, sizeof(header10), 1, file) != 1 || header10[1] != 3 || header10[3] > 1) // only single 2D textures
+                {
+                    return false;
+                }
+                info.format = convertDxgiFormat(header10[0]);
+                info.dataOffset += sizeof(header10);
+            }
+            else
+            {
+                info.format = convertFourCC(fourCC);
+            }
+            return info.format != VK_FORMAT_UNDEFINED;
+        }
+
+        // whether sampling the compressed texture gives the same channels as sampling the decoded one
+        bool isCompatible(VkFormat compressedFormat, VkFormat format)
+        {
+            switch (convertToUNORM(format))
+            {
+                case VK_FORMAT_R8_UNORM: return compressedFormat == VK_FORMAT_BC4_UNORM_BLOCK;
+                case VK_FORMAT_R8G8_UNORM: return compressedFormat == VK_FORMAT_BC5_UNORM_BLOCK;
+                case VK_FORMAT_R8G8B8A8_UNORM:
+                    return compressedFormat == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || compressedFormat == VK_FORMAT_BC2_UNORM_BLOCK
+                           || compressedFormat == VK_FORMAT_BC3_UNORM_BLOCK || compressedFormat == VK_FORMAT_BC7_UNORM_BLOCK;
+                default: return false;
+            }
+        }
+
+        VkDeviceSize getCompressedSize(VkFormat compressedFormat, VkExtent3D extent, uint32_t mipLevels)
+        {
+            VkDeviceSize size = 0;
+            for (uint32_t i = 0; i < mipLevels; i++)
+            {
+                VkDeviceSize width  = std::max(extent.width >> i, 1u);
+                VkDeviceSize height = std::max(extent.height >> i, 1u);
+                size += ((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(compressedFormat);
+            }
+            return size;
+        }
+    } // namespace
+
+    TextureData loadTexture(const std::string& filePath, VkFormat format, VkExtent3D extent, bool resize)
+    {
+        int  desiredChannels;
+        bool repack = false;
+        switch (convertToUNORM(format))
+        {
+            case VK_FORMAT_R8_UNORM: desiredChannels = STBI_grey; break;
+            case VK_FORMAT_R8G8_UNORM:
+                // STBI_grey_alpha would compute the luminance, so load rgba and drop blue and alpha afterwards
+                desiredChannels = STBI_rgb_alpha;
+                repack          = true;
+                break;
+            case VK_FORMAT_R8G8B8A8_UNORM: desiredChannels = STBI_rgb_alpha; break;
+            default: Logger::err("unsupported texture upload format" + std::to_string(format)); return {{}, extent};
+        }
+
+        FILE* const file = fopen(filePath.c_str(), "rb");
+        if (file == nullptr)
+        {
+            Logger::err("couldn't open texture: " + filePath);
+            return {{}, extent};
+        }
+
+        int      width;
+        int      height;
+        int      channels;
+        stbi_uc* pixels = stbi_dds_test_file(file) ? stbi_dds_load_from_file(file, &width, &height, &channels, desiredChannels)
+                                                   : stbi_load_from_file(file, &width, &height, &channels, desiredChannels);
+        fclose(file);
+
+        if (pixels == nullptr)
+        {
+            Logger::err("couldn't decode texture: " + filePath);
+            return {{}, extent};
+        }
+
+        if (repack)
+        {
+            repackRGBAToRG(pixels, pixels, static_cast<size_t>(width) * height);
+            desiredChannels = 2;
+        }
+
+        TextureData texture;
+        texture.extent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+        if (resize && (texture.extent.width != extent.width || texture.extent.height != extent.height))
+        {
+            texture.pixels.resize(static_cast<size_t>(extent.width) * extent.height * desiredChannels);
+            stbir_resize_uint8(pixels, width, height, 0, texture.pixels.data(), extent.width, extent.height, 0, desiredChannels);
+            texture.extent = extent;
+        }
+        else
+        {
+            texture.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * desiredChannels);
+        }
+        stbi_image_free(pixels);
+
+        return texture;
+    }
+
+    VkFormat getCompressedTextureFormat(
+        std::shared_ptr<LogicalDevice> pLogicalDevice, const std::string& filePath, VkFormat format, VkExtent3D extent, uint32_t mipLevels)
+    {
+        if (!pLogicalDevice->supportsTextureCompressionBC)
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        FILE* const file = fopen(filePath.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+        DdsInfo info;
+        bool    isDds = readDdsInfo(file, info);
+        fclose(file);
+
+        if (!isDds || !isCompatible(info.format, format))
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+        // compressed data can neither get resized nor get mip maps generated by a blit
+        if (info.width != extent.width || info.height != extent.height || info.mipLevels < mipLevels)
+        {
+            Logger::debug("decoding " + filePath + " since its size or mip levels don't match the texture");
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        VkFormatProperties properties;
+        pLogicalDevice->vki.GetPhysicalDeviceFormatProperties(pLogicalDevice->physicalDevice, info.format, &properties);
+        if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        return info.format;
+    }
+
+    TextureData loadCompressedTexture(const std::string& filePath, VkFormat compressedFormat, VkExtent3D extent, uint32_t mipLevels)
+    {
+        FILE* const file = fopen(filePath.c_str(), "rb");
+        if (file == nullptr)
+        {
+            Logger::err("couldn't open texture: " + filePath);
+            return {{}, extent};
+        }
+
+        TextureData texture;
+        texture.pixels.resize(getCompressedSize(compressedFormat, extent, mipLevels));
+        texture.extent = extent;
+
+        // the levels are stored one after the other, so the first mipLevels levels are one contiguous read
+        DdsInfo info;
+        bool    success = readDdsInfo(file, info) && info.format == compressedFormat && fseek(file, info.dataOffset, SEEK_SET) == 0
+                       && fread(texture.pixels.data(), texture.pixels.size(), 1, file) == 1;
+        fclose(file);
+
+        if (!success)
+        {
+            Logger::err("couldn't read compressed texture: " + filePath);
+            return {{}, extent};
+        }
+        return texture;
+    }
+
+    void repackRGBAToRG(const unsigned char* src, unsigned char* dst, size_t pixelCount)
+    {
+        size_t i = 0;
+#ifdef __SSE2__
+        // 8 pixels at a time, both loads happen before the store, so this also works in place
+        for (; i + 8 <= pixelCount; i += 8)
+        {
+            __m128i first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4 + 16));
+            // sign extend the lower 16 bits (red and green) of every pixel, so that the saturating pack keeps them as they are
+            first  = _mm_srai_epi32(_mm_slli_epi32(first, 16), 16);
+            second = _mm_srai_epi32(_mm_slli_epi32(second, 16), 16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_packs_epi32(first, second));
+        }
+#endif
+        for (; i < pixelCount; i++)
+        {
+            dst[i * 2]     = src[i * 4];
+            dst[i * 2 + 1] = src[i * 4 + 1];
+        }
+    }
+} // namespace vkBasalt
@@ -0,0 +1,41 @@
+#ifndef TEXTURE_LOADER_HPP_INCLUDED
+#define TEXTURE_LOADER_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // the content of a texture file, pixels is empty if the file could not be read
+    struct TextureData
+    {
+        std::vector<unsigned char> pixels;
+        VkExtent3D                 extent;
+    };
+
+    // Decodes a png or dds file into the pixels of a texture with the given format.
+    // If resize is true and the size of the file differs from extent, the pixels get resized on the cpu,
+    // otherwise they keep the size of the file. Only reads the file and touches no vulkan object,
+    // so many textures can get decoded at once on the thread pool.
+    TextureData loadTexture(const std::string& filePath, VkFormat format, VkExtent3D extent, bool resize);
+
+    // Returns the BCn format that the dds file at filePath can get uploaded with, without decoding it, into a texture
+    // with the given format, extent and mip levels. Returns VK_FORMAT_UNDEFINED if the file has to get decoded instead,
+    // e.g. because it is no BCn dds file, its size differs, it has too few mip levels or the device can't sample the format.
+    VkFormat getCompressedTextureFormat(
+        std::shared_ptr<LogicalDevice> pLogicalDevice, const std::string& filePath, VkFormat format, VkExtent3D extent, uint32_t mipLevels);
+
+    // reads the first mipLevels levels of a dds file that getCompressedTextureFormat accepted
+    TextureData loadCompressedTexture(const std::string& filePath, VkFormat compressedFormat, VkExtent3D extent, uint32_t mipLevels);
+
+    // keeps the red and green channel of rgba pixels, src and dst may point to the same pixels
+    void repackRGBAToRG(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+} // namespace vkBasalt
+
+#endif // TEXTURE_LOADER_HPP_INCLUDED
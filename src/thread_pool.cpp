@@ -0,0 +1,56 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    ThreadPool::ThreadPool(uint32_t threadCount)
+    {
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            threads.emplace_back(&ThreadPool::run, this);
+        }
+        Logger::debug("created thread pool with " + std::to_string(threadCount) + " threads");
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        condition.notify_all();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::run()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stop || !tasks.empty(); });
+                // the remaining tasks still get executed so nobody waits forever on their futures
+                if (tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    ThreadPool& getThreadPool()
+    {
+        static ThreadPool threadPool(std::max(1u, std::thread::hardware_concurrency()));
+        return threadPool;
+    }
+} // namespace vkBasalt
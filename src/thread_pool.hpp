@@ -0,0 +1,73 @@
+#ifndef THREAD_POOL_HPP_INCLUDED
+#define THREAD_POOL_HPP_INCLUDED
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+namespace vkBasalt
+{
+    // Fixed set of worker threads for the expensive cpu side work like compiling effects and decoding textures.
+    // Tasks must only wait on other tasks of the pool through wait(), blocking on a future directly could deadlock once all workers are waiting.
+    class ThreadPool
+    {
+    public:
+        ThreadPool(uint32_t threadCount);
+        ~ThreadPool();
+
+        // exceptions thrown by func get rethrown by the get() of the returned future
+        template<typename Func>
+        auto submit(Func func) -> std::future<decltype(func())>
+        {
+            auto task   = std::make_shared<std::packaged_task<decltype(func())()>>(std::move(func));
+            auto future = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back([task]() { (*task)(); });
+            }
+            condition.notify_one();
+            return future;
+        }
+
+        // runs queued tasks on the calling thread until future is ready, so that tasks can wait on tasks that they submitted
+        template<typename T>
+        T wait(std::future<T>& future)
+        {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                std::function<void()> task;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (tasks.empty())
+                    {
+                        break;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+            // once the queue is empty, the task of future already runs on another thread
+            return future.get();
+        }
+
+    private:
+        std::vector<std::thread>          threads;
+        std::deque<std::function<void()>> tasks;
+        std::mutex                        mutex;
+        std::condition_variable           condition;
+        bool                              stop = false;
+
+        void run();
+    };
+
+    // one pool per process with a thread per core, it gets created on first use
+    ThreadPool& getThreadPool();
+} // namespace vkBasalt
+
+#endif // THREAD_POOL_HPP_INCLUDED
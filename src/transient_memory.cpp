@@ -0,0 +1,188 @@
+#include "transient_memory.hpp"
+
+#include <algorithm>
+
+#include "memory.hpp"
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        thread_local TransientImageMemory* pCurrentMemory     = nullptr;
+        thread_local uint32_t              currentEffectIndex = 0;
+
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        std::string formatMegaBytes(VkDeviceSize bytes)
+        {
+            return std::to_string(bytes / (1024 * 1024)) + " MiB";
+        }
+    } // namespace
+
+    TransientImageMemory::TransientImageMemory(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t imageCount, bool aliasing)
+        : pLogicalDevice(pLogicalDevice), imageCount(imageCount), aliasing(aliasing), lanes(imageCount + 1)
+    {
+    }
+
+    TransientImageMemory::~TransientImageMemory()
+    {
+        for (auto& lane : lanes)
+        {
+            for (auto& slab : lane)
+            {
+                freeMemory(pLogicalDevice, slab.memory);
+            }
+        }
+    }
+
+    void TransientImageMemory::bindImages(const std::vector<VkImage>& images, uint32_t firstEffect, uint32_t lastEffect)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (images.size() == imageCount)
+        {
+            for (uint32_t i = 0; i < images.size(); i++)
+            {
+                bindImage(lanes[i], images[i], firstEffect, lastEffect);
+            }
+        }
+        else if (images.size() == 1)
+        {
+            bindImage(lanes.back(), images[0], firstEffect, lastEffect);
+        }
+        else
+        {
+            Logger::err("can not bind " + std::to_string(images.size()) + " transient images for " + std::to_string(imageCount)
+                        + " swapchain images");
+        }
+    }
+
+    void TransientImageMemory::logStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        uint32_t slabCount = 0;
+        for (auto& lane : lanes)
+        {
+            slabCount += lane.size();
+        }
+        Logger::info("transient images: " + std::to_string(boundImages) + " images need " + formatMegaBytes(requestedBytes)
+                     + " without aliasing, " + formatMegaBytes(allocatedBytes) + " in " + std::to_string(slabCount) + " allocations"
+                     + (aliasing ? " with aliasing" : " with aliasing disabled"));
+    }
+
+    bool TransientImageMemory::isAliasing()
+    {
+        return aliasing;
+    }
+
+    void TransientImageMemory::bindImage(std::vector<Slab>& lane, VkImage image, uint32_t firstEffect, uint32_t lastEffect)
+    {
+        VkMemoryRequirements memoryRequirements;
+        pLogicalDevice->vkd.GetImageMemoryRequirements(pLogicalDevice->device, image, &memoryRequirements);
+
+        boundImages++;
+        requestedBytes += memoryRequirements.size;
+
+        if (!aliasing)
+        {
+            // every image overlaps with every other image
+            firstEffect = 0;
+            lastEffect  = UINT32_MAX;
+        }
+
+        uint32_t memoryTypeIndex = findMemoryTypeIndex(pLogicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        Slab*        pSlab  = nullptr;
+        VkDeviceSize offset = 0;
+        for (auto& slab : lane)
+        {
+            if (slab.memoryTypeIndex != memoryTypeIndex || slab.memory.size < memoryRequirements.size)
+            {
+                continue;
+            }
+
+            // the lowest fitting offset is either the start of the slab or the end of a placement that is alive at the same time
+            std::vector<VkDeviceSize> candidates = {alignUp(slab.memory.offset, memoryRequirements.alignment)};
+            for (auto& placement : slab.placements)
+            {
+                if (placement.firstEffect <= lastEffect && firstEffect <= placement.lastEffect)
+                {
+                    candidates.push_back(alignUp(slab.memory.offset + placement.offset + placement.size, memoryRequirements.alignment));
+                }
+            }
+            std::sort(candidates.begin(), candidates.end());
+
+            for (VkDeviceSize candidate : candidates)
+            {
+                VkDeviceSize start = candidate - slab.memory.offset;
+                VkDeviceSize end   = start + memoryRequirements.size;
+                if (end > slab.memory.size)
+                {
+                    continue;
+                }
+
+                bool overlaps = std::any_of(slab.placements.begin(), slab.placements.end(), [&](const Placement& placement) {
+                    return placement.firstEffect <= lastEffect && firstEffect <= placement.lastEffect && placement.offset < end
+                           && start < placement.offset + placement.size;
+                });
+                if (!overlaps)
+                {
+                    pSlab  = &slab;
+                    offset = start;
+                    break;
+                }
+            }
+
+            if (pSlab)
+            {
+                break;
+            }
+        }
+
+        if (!pSlab)
+        {
+            Slab slab;
+            slab.memory          = allocateMemory(pLogicalDevice, memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+            slab.memoryTypeIndex = memoryTypeIndex;
+            allocatedBytes += slab.memory.size;
+
+            lane.push_back(slab);
+            pSlab  = &lane.back();
+            offset = 0;
+        }
+
+        pSlab->placements.push_back({offset, memoryRequirements.size, firstEffect, lastEffect});
+
+        VkResult result =
+            pLogicalDevice->vkd.BindImageMemory(pLogicalDevice->device, image, pSlab->memory.memory, pSlab->memory.offset + offset);
+        ASSERT_VULKAN(result);
+    }
+
+    TransientImageScope::TransientImageScope(TransientImageMemory* pTransientMemory, uint32_t effectIndex)
+        : pPreviousMemory(pCurrentMemory), previousEffectIndex(currentEffectIndex)
+    {
+        pCurrentMemory     = pTransientMemory;
+        currentEffectIndex = effectIndex;
+    }
+
+    TransientImageScope::~TransientImageScope()
+    {
+        pCurrentMemory     = pPreviousMemory;
+        currentEffectIndex = previousEffectIndex;
+    }
+
+    void bindTransientImages(const std::vector<VkImage>& images)
+    {
+        if (!pCurrentMemory)
+        {
+            Logger::err("transient images can only be created while creating an effect");
+            return;
+        }
+        pCurrentMemory->bindImages(images, currentEffectIndex, currentEffectIndex);
+    }
+} // namespace vkBasalt
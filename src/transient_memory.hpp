@@ -0,0 +1,82 @@
+#ifndef TRANSIENT_MEMORY_HPP_INCLUDED
+#define TRANSIENT_MEMORY_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // Binds the images whose content only has to survive a part of the effect chain, like the images between two effects,
+    // the edge and blend images of smaa or the back buffers of reshade effects.
+    // The lifetime of an image is the range of effect indices that use it. Images only share memory if their lifetimes don't overlap,
+    // so for a long chain the images between the effects end up ping-ponging between two memory ranges.
+    // Every swapchain image gets its own lane of memory, since the command buffers of different swapchain images are independent.
+    // Images that the command buffers of all swapchain images use go into an extra shared lane.
+    class TransientImageMemory
+    {
+    public:
+        // without aliasing every image gets its own memory, the statistics still get collected
+        TransientImageMemory(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t imageCount, bool aliasing);
+        ~TransientImageMemory();
+
+        // images has to contain either one image per swapchain image or a single image that all swapchain images use
+        void bindImages(const std::vector<VkImage>& images, uint32_t firstEffect, uint32_t lastEffect);
+
+        // if images of different effects can share memory, the effects need a barrier between them then
+        bool isAliasing();
+
+        // logs the memory that the images would need without aliasing and the memory that actually got allocated
+        void logStatistics();
+
+    private:
+        struct Placement
+        {
+            VkDeviceSize offset;
+            VkDeviceSize size;
+            uint32_t     firstEffect;
+            uint32_t     lastEffect;
+        };
+
+        struct Slab
+        {
+            MemoryAllocation       memory;
+            uint32_t               memoryTypeIndex;
+            std::vector<Placement> placements;
+        };
+
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        uint32_t                       imageCount;
+        bool                           aliasing;
+
+        std::mutex                     mutex;
+        std::vector<std::vector<Slab>> lanes;
+        uint32_t                       boundImages    = 0;
+        VkDeviceSize                   requestedBytes = 0;
+        VkDeviceSize                   allocatedBytes = 0;
+
+        void bindImage(std::vector<Slab>& lane, VkImage image, uint32_t firstEffect, uint32_t lastEffect);
+    };
+
+    // Makes createTransientImages on the current thread bind into transientMemory for the effect with the given index.
+    class TransientImageScope
+    {
+    public:
+        TransientImageScope(TransientImageMemory* pTransientMemory, uint32_t effectIndex);
+        ~TransientImageScope();
+
+    private:
+        TransientImageMemory* pPreviousMemory;
+        uint32_t              previousEffectIndex;
+    };
+
+    // binds images that are only used while the current effect gets applied, has to be called inside of a TransientImageScope
+    void bindTransientImages(const std::vector<VkImage>& images);
+} // namespace vkBasalt
+
+#endif // TRANSIENT_MEMORY_HPP_INCLUDED
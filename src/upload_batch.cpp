@@ -0,0 +1,366 @@
+#include "upload_batch.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "buffer.hpp"
+#include "memory.hpp"
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    namespace
+    {
+        thread_local UploadBatch* pCurrentBatch = nullptr;
+
+        // small textures that don't fit into the ring share a staging buffer, bigger ones get their own
+        const VkDeviceSize stagingBufferSize = 16 * 1024 * 1024;
+        // covers the texel block size of every format that gets uploaded
+        const VkDeviceSize stagingAlignment = 16;
+
+        // finds size bytes in the staging ring after the newest range, wrapping around to the start if they don't fit at the end.
+        // Returns false instead of waiting if the ranges of other batches are in the way
+        bool allocateStagingRange(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                                  VkDeviceSize                   size,
+                                  VkBuffer&                      buffer,
+                                  VkDeviceSize&                  offset,
+                                  char*&                         pMapped)
+        {
+            StagingRing&                ring = pLogicalDevice->stagingRing;
+            std::lock_guard<std::mutex> lock(ring.mutex);
+
+            if (size > stagingRingSize / 4)
+            {
+                return false;
+            }
+            if (ring.buffer == VK_NULL_HANDLE)
+            {
+                createBuffer(pLogicalDevice,
+                             stagingRingSize,
+                             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             ring.buffer,
+                             ring.memory);
+                ring.head = 0;
+                Logger::debug("created staging ring with " + std::to_string(stagingRingSize / 1024) + " KiB");
+            }
+
+            if (ring.ranges.empty())
+            {
+                offset = 0;
+            }
+            else
+            {
+                // the free space is behind head up to the oldest range, once head wrapped around it ends there
+                VkDeviceSize tail    = ring.ranges.front().offset;
+                bool         wrapped = ring.ranges.back().offset < tail;
+                if (!wrapped && ring.head + size <= stagingRingSize)
+                {
+                    offset = ring.head;
+                }
+                else if (!wrapped && size <= tail)
+                {
+                    offset = 0;
+                }
+                else if (wrapped && ring.head + size <= tail)
+                {
+                    offset = ring.head;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            ring.head = offset + size;
+            ring.ranges.push_back({offset, false});
+            buffer  = ring.buffer;
+            pMapped = static_cast<char*>(ring.memory.pMapped) + offset;
+            return true;
+        }
+
+        void freeStagingRanges(std::shared_ptr<LogicalDevice> pLogicalDevice, const std::vector<VkDeviceSize>& offsets)
+        {
+            StagingRing&                ring = pLogicalDevice->stagingRing;
+            std::lock_guard<std::mutex> lock(ring.mutex);
+
+            for (VkDeviceSize offset : offsets)
+            {
+                for (auto& range : ring.ranges)
+                {
+                    if (range.offset == offset && !range.done)
+                    {
+                        range.done = true;
+                        break;
+                    }
+                }
+            }
+            while (ring.ranges.size() && ring.ranges.front().done)
+            {
+                ring.ranges.pop_front();
+            }
+            if (ring.ranges.empty())
+            {
+                ring.head = 0;
+            }
+        }
+
+        void destroyStagingRing(std::shared_ptr<LogicalDevice> pLogicalDevice)
+        {
+            StagingRing&                ring = pLogicalDevice->stagingRing;
+            std::lock_guard<std::mutex> lock(ring.mutex);
+
+            if (ring.buffer == VK_NULL_HANDLE || ring.ranges.size())
+            {
+                return;
+            }
+            pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, ring.buffer, nullptr);
+            freeMemory(pLogicalDevice, ring.memory);
+            ring.buffer = VK_NULL_HANDLE;
+            ring.memory = MemoryAllocation();
+        }
+
+        void releasePendingSubmit(std::shared_ptr<LogicalDevice> pLogicalDevice, const PendingSubmit& pendingSubmit)
+        {
+            // destroying the pool frees the command buffer as well
+            pLogicalDevice->vkd.DestroyCommandPool(pLogicalDevice->device, pendingSubmit.commandPool, nullptr);
+            for (uint32_t i = 0; i < pendingSubmit.stagingBuffers.size(); i++)
+            {
+                pLogicalDevice->vkd.DestroyBuffer(pLogicalDevice->device, pendingSubmit.stagingBuffers[i], nullptr);
+                freeMemory(pLogicalDevice, pendingSubmit.stagingMemory[i]);
+            }
+            for (uint32_t i = 0; i < pendingSubmit.stagingImages.size(); i++)
+            {
+                pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, pendingSubmit.stagingImages[i], nullptr);
+                freeMemory(pLogicalDevice, pendingSubmit.stagingImageMemory[i]);
+            }
+            freeStagingRanges(pLogicalDevice, pendingSubmit.stagingRingOffsets);
+        }
+    } // namespace
+
+    UploadBatch::UploadBatch(std::shared_ptr<LogicalDevice> pLogicalDevice) : pLogicalDevice(pLogicalDevice), pPreviousBatch(pCurrentBatch)
+    {
+        pCurrentBatch = this;
+    }
+
+    UploadBatch::~UploadBatch()
+    {
+        submit();
+        pCurrentBatch = pPreviousBatch;
+    }
+
+    UploadBatch* UploadBatch::current()
+    {
+        return pCurrentBatch;
+    }
+
+    VkCommandBuffer UploadBatch::getCommandBuffer()
+    {
+        if (commandBuffer != VK_NULL_HANDLE)
+        {
+            return commandBuffer;
+        }
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo;
+        commandPoolCreateInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.pNext            = nullptr;
+        commandPoolCreateInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        commandPoolCreateInfo.queueFamilyIndex = pLogicalDevice->queueFamilyIndex;
+
+        VkResult result = pLogicalDevice->vkd.CreateCommandPool(pLogicalDevice->device, &commandPoolCreateInfo, nullptr, &commandPool);
+        ASSERT_VULKAN(result);
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+
+        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool        = commandPool;
+        allocInfo.commandBufferCount = 1;
+
+        result = pLogicalDevice->vkd.AllocateCommandBuffers(pLogicalDevice->device, &allocInfo, &commandBuffer);
+        ASSERT_VULKAN(result);
+        // initialize dispatch table for commandBuffer since it is a dispatchable object
+        initializeDispatchTable(commandBuffer, pLogicalDevice->device);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+
+        return commandBuffer;
+    }
+
+    void UploadBatch::stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset)
+    {
+        uploadCount++;
+        uploadBytes += size;
+
+        char*        pMapped;
+        VkDeviceSize rangeSize = std::max(stagingAlignment, (size + stagingAlignment - 1) / stagingAlignment * stagingAlignment);
+        if (allocateStagingRange(pLogicalDevice, rangeSize, buffer, offset, pMapped))
+        {
+            stagingRingOffsets.push_back(offset);
+            std::memcpy(pMapped, data, size);
+            return;
+        }
+
+        stagingOffset = (stagingOffset + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+        if (stagingOffset + size > stagingCapacity)
+        {
+            stagingCapacity = std::max(size, stagingBufferSize);
+            stagingBuffers.push_back(VK_NULL_HANDLE);
+            stagingMemory.push_back(MemoryAllocation());
+            createBuffer(pLogicalDevice,
+                         stagingCapacity,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         stagingBuffers.back(),
+                         stagingMemory.back());
+            stagingOffset = 0;
+        }
+
+        buffer = stagingBuffers.back();
+        offset = stagingOffset;
+
+        // host visible memory stays mapped
+        std::memcpy(static_cast<char*>(stagingMemory.back().pMapped) + stagingOffset, data, size);
+        stagingOffset += size;
+    }
+
+    void UploadBatch::keepImage(VkImage image, const MemoryAllocation& memory)
+    {
+        stagingImages.push_back(image);
+        stagingImageMemory.push_back(memory);
+    }
+
+    void UploadBatch::submit()
+    {
+        if (commandBuffer == VK_NULL_HANDLE)
+        {
+            // nothing copies from the staged data, the ring must not wait for it
+            freeStagingRanges(pLogicalDevice, stagingRingOffsets);
+            stagingRingOffsets.clear();
+            return;
+        }
+
+        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+
+        PendingSubmit pendingSubmit;
+        pendingSubmit.commandPool        = commandPool;
+        pendingSubmit.commandBuffer      = commandBuffer;
+        pendingSubmit.stagingBuffers     = std::move(stagingBuffers);
+        pendingSubmit.stagingMemory      = std::move(stagingMemory);
+        pendingSubmit.stagingImages      = std::move(stagingImages);
+        pendingSubmit.stagingImageMemory = std::move(stagingImageMemory);
+        pendingSubmit.stagingRingOffsets = std::move(stagingRingOffsets);
+
+        commandPool   = VK_NULL_HANDLE;
+        commandBuffer = VK_NULL_HANDLE;
+        stagingBuffers.clear();
+        stagingMemory.clear();
+        stagingImages.clear();
+        stagingImageMemory.clear();
+        stagingRingOffsets.clear();
+        stagingOffset   = 0;
+        stagingCapacity = 0;
+
+        Logger::debug("upload batch with " + std::to_string(uploadCount) + " uploads and " + std::to_string(uploadBytes / 1024)
+                      + " KiB of staging data");
+
+        std::lock_guard<std::mutex> lock(pLogicalDevice->submitMutex);
+
+        if (pLogicalDevice->deferSubmitCount)
+        {
+            pLogicalDevice->pendingSubmits.push_back(std::move(pendingSubmit));
+            return;
+        }
+
+        VkFenceCreateInfo fenceCreateInfo;
+        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceCreateInfo.pNext = nullptr;
+        fenceCreateInfo.flags = 0;
+
+        VkFence  fence;
+        VkResult result = pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &fenceCreateInfo, nullptr, &fence);
+        ASSERT_VULKAN(result);
+
+        VkSubmitInfo submitInfo = {};
+
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &pendingSubmit.commandBuffer;
+
+        // only waits for this batch instead of draining the whole queue of the application
+        result = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, fence);
+        ASSERT_VULKAN(result);
+        pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &fence, VK_TRUE, UINT64_MAX);
+        pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fence, nullptr);
+
+        releasePendingSubmit(pLogicalDevice, pendingSubmit);
+    }
+
+    void flushPendingSubmits(std::shared_ptr<LogicalDevice> pLogicalDevice, bool wait)
+    {
+        std::lock_guard<std::mutex> lock(pLogicalDevice->submitMutex);
+
+        if (pLogicalDevice->pendingSubmits.size())
+        {
+            std::vector<VkCommandBuffer> commandBuffers;
+            for (auto& pendingSubmit : pLogicalDevice->pendingSubmits)
+            {
+                commandBuffers.push_back(pendingSubmit.commandBuffer);
+            }
+
+            VkFenceCreateInfo fenceCreateInfo;
+            fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            fenceCreateInfo.pNext = nullptr;
+            fenceCreateInfo.flags = 0;
+
+            VkFence  fence;
+            VkResult result = pLogicalDevice->vkd.CreateFence(pLogicalDevice->device, &fenceCreateInfo, nullptr, &fence);
+            ASSERT_VULKAN(result);
+
+            VkSubmitInfo submitInfo = {};
+
+            submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = commandBuffers.size();
+            submitInfo.pCommandBuffers    = commandBuffers.data();
+
+            result = pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, fence);
+            ASSERT_VULKAN(result);
+            Logger::debug("submitted " + std::to_string(commandBuffers.size()) + " deferred upload batches");
+
+            pLogicalDevice->submittedPendingSubmits.emplace_back(fence, std::move(pLogicalDevice->pendingSubmits));
+            pLogicalDevice->pendingSubmits.clear();
+        }
+
+        auto& submitted = pLogicalDevice->submittedPendingSubmits;
+        for (auto it = submitted.begin(); it != submitted.end();)
+        {
+            if (wait)
+            {
+                pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &it->first, VK_TRUE, UINT64_MAX);
+            }
+            if (pLogicalDevice->vkd.GetFenceStatus(pLogicalDevice->device, it->first) != VK_SUCCESS)
+            {
+                it++;
+                continue;
+            }
+
+            for (auto& pendingSubmit : it->second)
+            {
+                releasePendingSubmit(pLogicalDevice, pendingSubmit);
+            }
+            pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, it->first, nullptr);
+            it = submitted.erase(it);
+        }
+
+        // the ring only keeps its memory while effects get created
+        if (wait)
+        {
+            destroyStagingRing(pLogicalDevice);
+        }
+    }
+} // namespace vkBasalt
@@ -0,0 +1,70 @@
+#ifndef UPLOAD_BATCH_HPP_INCLUDED
+#define UPLOAD_BATCH_HPP_INCLUDED
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+#include "logical_device.hpp"
+
+namespace vkBasalt
+{
+    // the size of the staging ring of a device, bigger uploads than a quarter of it get a staging buffer of the batch
+    const VkDeviceSize stagingRingSize = 32 * 1024 * 1024;
+
+    // Collects the uploads, layout changes and mip map generation of one effect in a single command buffer,
+    // so that creating an effect needs one submit and one fence wait instead of one queue drain per texture.
+    // While a batch exists, uploadToImage and changeImageLayout on the same thread record into it.
+    // The staging data gets sub-allocated from the staging ring of the device, so effects that get created one after another
+    // reuse the same memory. Data that does not fit into the ring right now gets packed into a few big host visible buffers
+    // of the batch instead of waiting for other batches, they live until the commands are done.
+    // Every batch has its own command pool, so that batches can get recorded on several threads at once.
+    class UploadBatch
+    {
+    public:
+        UploadBatch(std::shared_ptr<LogicalDevice> pLogicalDevice);
+        // submits the batch if that did not happen yet
+        ~UploadBatch();
+
+        // the batch of the current thread, nullptr if there is none
+        static UploadBatch* current();
+
+        // begins the command buffer on first use
+        VkCommandBuffer getCommandBuffer();
+
+        // copies data into the staging memory, buffer and offset are the source of the copy commands
+        void stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+
+        // destroys the image and frees its memory once the recorded commands are done with it
+        void keepImage(VkImage image, const MemoryAllocation& memory);
+
+        // submits the recorded commands and waits for them, or queues them if submits are deferred right now
+        void submit();
+
+    private:
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        UploadBatch*                   pPreviousBatch;
+
+        VkCommandPool   commandPool   = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+        std::vector<VkBuffer>         stagingBuffers;
+        std::vector<MemoryAllocation> stagingMemory;
+        VkDeviceSize                  stagingOffset   = 0;
+        VkDeviceSize                  stagingCapacity = 0; // size of the last staging buffer
+        std::vector<VkImage>          stagingImages;
+        std::vector<MemoryAllocation> stagingImageMemory;
+        std::vector<VkDeviceSize>     stagingRingOffsets;
+
+        uint32_t     uploadCount = 0;
+        VkDeviceSize uploadBytes = 0;
+    };
+
+    // submits the deferred upload batches and releases the ones that are done,
+    // only call this from a thread that may use the queue. wait blocks until all of them are done
+    // and frees the staging ring if no batch uses it anymore
+    void flushPendingSubmits(std::shared_ptr<LogicalDevice> pLogicalDevice, bool wait);
+} // namespace vkBasalt
+
+#endif // UPLOAD_BATCH_HPP_INCLUDED
@@ -1,8 +1,12 @@
 #include "util.hpp"
 
 #include <iostream>
+#include <filesystem>
+#include <atomic>
 #include <unistd.h>
 
+#include "logger.hpp"
+
 namespace vkBasalt
 {
     void addUniqueCString(std::vector<const char*>& stringVector, const char* addString)
@@ -63,4 +67,50 @@ namespace vkBasalt
             std::cout << "\033[" << magicString << "m" << output << "\033[0m" << std::endl;
         }
     }
+
+    std::string getCacheDirectory()
+    {
+        const char* tmpCacheEnv = std::getenv("XDG_CACHE_HOME");
+        const char* tmpHomeEnv  = std::getenv("HOME");
+
+        std::string cacheDir;
+        if (tmpCacheEnv && tmpCacheEnv[0] != '\0')
+        {
+            cacheDir = std::string(tmpCacheEnv) + "/vkBasalt";
+        }
+        else if (tmpHomeEnv)
+        {
+            cacheDir = std::string(tmpHomeEnv) + "/.cache/vkBasalt";
+        }
+        else
+        {
+            return "";
+        }
+
+        std::error_code errorCode;
+        std::filesystem::create_directories(cacheDir, errorCode);
+        if (errorCode)
+        {
+            Logger::warn("could not create cache directory " + cacheDir + ": " + errorCode.message());
+            return "";
+        }
+        return cacheDir;
+    }
+
+    std::string getTempFileName(const std::string& fileName)
+    {
+        // effects get created in parallel, so the process id alone is not enough
+        static std::atomic<uint64_t> tempFileCount = 0;
+        return fileName + "." + std::to_string(getpid()) + "." + std::to_string(tempFileCount++) + ".tmp";
+    }
+
+    uint64_t hashString(const std::string& data, uint64_t hash)
+    {
+        for (unsigned char c : data)
+        {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
 } // namespace vkBasalt
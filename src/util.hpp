@@ -4,6 +4,7 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <cstdint>
 
 namespace vkBasalt
 {
@@ -25,6 +26,16 @@ namespace vkBasalt
 
     void outputInColor(std::string output, Color foreground = Color::defaultColor, Color background = Color::defaultColor);
 
+    // $XDG_CACHE_HOME/vkBasalt or ~/.cache/vkBasalt, gets created if it does not exist yet
+    std::string getCacheDirectory();
+
+    // a name next to fileName that no other thread or process uses at the same time.
+    // Writing there and renaming it to fileName keeps readers from seeing a half written file
+    std::string getTempFileName(const std::string& fileName);
+
+    // 64 bit FNV-1a, pass the previous result as hash to hash multiple strings
+    uint64_t hashString(const std::string& data, uint64_t hash = 0xcbf29ce484222325ull);
+
     template<typename T>
     std::string convertToString(T object)
     {
@@ -3,6 +3,15 @@
 
 #include <assert.h> //vulkan/vk_dispatch_table_helper.h needs this
 
+// the helpers include these, they must not see the define below
+#include <cstring>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #define VK_NO_PROTOTYPES
 
 #define requires _requires
@@ -0,0 +1,26 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace vkBasalt::test
+{
+    double measure(const std::string& label, uint32_t runs, const std::function<void()>& function)
+    {
+        std::vector<double> times;
+        for (uint32_t i = 0; i < runs; i++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            function();
+            std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+            times.push_back(time.count());
+        }
+        std::sort(times.begin(), times.end());
+
+        double median = times[times.size() / 2];
+        std::printf("%-48s median %10.3f ms   min %10.3f ms   (%u runs)\n", label.c_str(), median, times[0], runs);
+        return median;
+    }
+} // namespace vkBasalt::test
@@ -0,0 +1,14 @@
+#ifndef BENCH_HPP_INCLUDED
+#define BENCH_HPP_INCLUDED
+#include <string>
+#include <functional>
+#include <cstdint>
+
+namespace vkBasalt::test
+{
+    // Runs function runs times and prints the median and the fastest run in milliseconds, returns the median.
+    // The benchmarks are TEST cases of their own *_bench.cpp executables, so they can CHECK that the paths they compare agree.
+    double measure(const std::string& label, uint32_t runs, const std::function<void()>& function);
+} // namespace vkBasalt::test
+
+#endif // BENCH_HPP_INCLUDED
@@ -0,0 +1,329 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+
+using namespace vkBasalt::test;
+
+namespace
+{
+    // just enough of glsl to compile shader/cas.h and shader/cas_tile.h on the cpu, so the filter and the tiling are the ones the shaders use
+    struct vec3
+    {
+        float x, y, z;
+
+        vec3() = default;
+        explicit vec3(float value) : x(value), y(value), z(value)
+        {
+        }
+        vec3(float x, float y, float z) : x(x), y(y), z(z)
+        {
+        }
+
+        vec3& operator+=(vec3 other)
+        {
+            x += other.x;
+            y += other.y;
+            z += other.z;
+            return *this;
+        }
+    };
+
+    vec3 operator+(vec3 a, vec3 b)
+    {
+        return {a.x + b.x, a.y + b.y, a.z + b.z};
+    }
+    vec3 operator*(vec3 a, vec3 b)
+    {
+        return {a.x * b.x, a.y * b.y, a.z * b.z};
+    }
+    vec3 operator/(vec3 a, vec3 b)
+    {
+        return {a.x / b.x, a.y / b.y, a.z / b.z};
+    }
+    vec3 operator-(vec3 a)
+    {
+        return {-a.x, -a.y, -a.z};
+    }
+    vec3 operator+(float a, vec3 b)
+    {
+        return vec3(a) + b;
+    }
+    vec3 operator-(float a, vec3 b)
+    {
+        return vec3(a) + -b;
+    }
+    vec3 operator*(vec3 a, float b)
+    {
+        return a * vec3(b);
+    }
+    vec3 operator*(float a, vec3 b)
+    {
+        return vec3(a) * b;
+    }
+    vec3 min(vec3 a, vec3 b)
+    {
+        return {std::fmin(a.x, b.x), std::fmin(a.y, b.y), std::fmin(a.z, b.z)};
+    }
+    vec3 max(vec3 a, vec3 b)
+    {
+        return {std::fmax(a.x, b.x), std::fmax(a.y, b.y), std::fmax(a.z, b.z)};
+    }
+    vec3 clamp(vec3 a, float low, float high)
+    {
+        return min(max(a, vec3(low)), vec3(high));
+    }
+    vec3 inversesqrt(vec3 a)
+    {
+        return {1.0f / std::sqrt(a.x), 1.0f / std::sqrt(a.y), 1.0f / std::sqrt(a.z)};
+    }
+
+    struct vec4
+    {
+        vec3  rgb;
+        float a;
+
+        vec4() = default;
+        vec4(vec3 rgb, float a) : rgb(rgb), a(a)
+        {
+        }
+    };
+
+    struct ivec2
+    {
+        int x, y;
+
+        ivec2(int x, int y) : x(x), y(y)
+        {
+        }
+    };
+
+    ivec2 operator+(ivec2 a, ivec2 b)
+    {
+        return {a.x + b.x, a.y + b.y};
+    }
+    ivec2 operator-(ivec2 a, int b)
+    {
+        return {a.x - b, a.y - b};
+    }
+    ivec2 operator*(ivec2 a, int b)
+    {
+        return {a.x * b, a.y * b};
+    }
+    ivec2 operator%(ivec2 a, ivec2 b)
+    {
+        return {a.x % b.x, a.y % b.y};
+    }
+
+    const float sharpness = 0.4f;
+
+#include "../shader/cas.h"
+#include "../shader/cas_tile.h"
+
+    struct Image
+    {
+        int               width;
+        int               height;
+        std::vector<vec4> texels;
+
+        vec4& at(int x, int y)
+        {
+            return texels[y * width + x];
+        }
+    };
+
+    // unorm texels, so that neighbors differ and the filter does not saturate everywhere
+    Image createImage(int width, int height, uint32_t seed)
+    {
+        std::mt19937                       random(seed);
+        std::uniform_int_distribution<int> channel(0, 255);
+
+        Image image = {width, height, std::vector<vec4>(width * height)};
+        for (vec4& texel : image.texels)
+        {
+            texel = {{channel(random) / 255.0f, channel(random) / 255.0f, channel(random) / 255.0f}, channel(random) / 255.0f};
+        }
+        return image;
+    }
+
+    int wrap(int coordinate, int size)
+    {
+        return ((coordinate % size) + size) % size;
+    }
+
+    // VK_FILTER_LINEAR with VK_SAMPLER_ADDRESS_MODE_REPEAT like createSampler, with the 8 bits of sub texel precision of common gpus
+    vec4 textureOffset(Image& image, float u, float v, int offsetX, int offsetY)
+    {
+        float x = u * image.width + offsetX - 0.5f;
+        float y = v * image.height + offsetY - 0.5f;
+        int   x0 = std::floor(x);
+        int   y0 = std::floor(y);
+        float fx = std::round((x - x0) * 256.0f) / 256.0f;
+        float fy = std::round((y - y0) * 256.0f) / 256.0f;
+
+        vec4 result = {vec3(0.0f), 0.0f};
+        for (int j = 0; j < 2; j++)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                float weight = (i ? fx : 1.0f - fx) * (j ? fy : 1.0f - fy);
+                vec4& texel  = image.at(wrap(x0 + i, image.width), wrap(y0 + j, image.height));
+                result.rgb   = result.rgb + texel.rgb * weight;
+                result.a += texel.a * weight;
+            }
+        }
+        return result;
+    }
+
+    // shader/cas.frag.glsl, the full screen triangle interpolates textureCoord to the center of the pixel at pixelCenter
+    Image runFragmentShader(Image& input, float pixelCenter = 0.5f)
+    {
+        Image output = {input.width, input.height, std::vector<vec4>(input.texels.size())};
+        for (int y = 0; y < input.height; y++)
+        {
+            for (int x = 0; x < input.width; x++)
+            {
+                float u = (x + pixelCenter) / input.width;
+                float v = (y + pixelCenter) / input.height;
+
+                vec3 n[9];
+                for (int i = 0; i < 9; i++)
+                {
+                    n[i] = textureOffset(input, u, v, i % 3 - 1, i / 3 - 1).rgb;
+                }
+                float alpha     = textureOffset(input, u, v, 0, 0).a;
+                output.at(x, y) = {casFilter(n[0], n[1], n[2], n[3], n[4], n[5], n[6], n[7], n[8]), alpha};
+            }
+        }
+        return output;
+    }
+
+    // the images and the shared memory of shader/cas.comp.glsl for the work group that runs on the cpu
+    struct ComputeState
+    {
+        Image*            pInput;
+        Image*            pOutput;
+        std::vector<int>* pWrites;
+        ivec2             fetchOffset = {0, 0}; // moves every fetch, a tile that gets loaded off by that much
+        vec4              tile[casApronSize][casApronSize];
+    };
+
+    ComputeState computeState;
+
+    vec4 casFetchTexel(ivec2 coord)
+    {
+        Image& input = *computeState.pInput;
+        return input.at(wrap(coord.x + computeState.fetchOffset.x, input.width), wrap(coord.y + computeState.fetchOffset.y, input.height));
+    }
+
+    vec4 casTileTexel(ivec2 local)
+    {
+        return computeState.tile[local.y][local.x];
+    }
+
+    void casStoreTileTexel(ivec2 local, vec4 texel)
+    {
+        computeState.tile[local.y][local.x] = texel;
+    }
+
+    void casStorePixel(ivec2 coord, vec4 color)
+    {
+        computeState.pOutput->at(coord.x, coord.y) = color;
+        (*computeState.pWrites)[coord.y * computeState.pOutput->width + coord.x]++;
+    }
+
+    // dispatches shader/cas.comp.glsl like ComputeEffect, the code of the work groups is the one of shader/cas_tile.h.
+    // writes counts how often every pixel got written
+    Image runComputeShader(Image& input, std::vector<int>& writes, ivec2 fetchOffset = {0, 0})
+    {
+        Image output = {input.width, input.height, std::vector<vec4>(input.texels.size())};
+        writes.assign(input.texels.size(), 0);
+        computeState.pInput      = &input;
+        computeState.pOutput     = &output;
+        computeState.pWrites     = &writes;
+        computeState.fetchOffset = fetchOffset;
+
+        ivec2 size(input.width, input.height);
+        int   groupCountX = (input.width + casTileSize - 1) / casTileSize;
+        int   groupCountY = (input.height + casTileSize - 1) / casTileSize;
+        for (int groupY = 0; groupY < groupCountY; groupY++)
+        {
+            for (int groupX = 0; groupX < groupCountX; groupX++)
+            {
+                ivec2 tileOrigin = ivec2(groupX, groupY) * casTileSize;
+
+                // every invocation loads its part of the tile before any of them sharpens, like the barrier of the shader
+                for (int invocation = 0; invocation < casGroupSize * casGroupSize; invocation++)
+                {
+                    casLoadTile(tileOrigin, invocation, size);
+                }
+                for (int invocation = 0; invocation < casGroupSize * casGroupSize; invocation++)
+                {
+                    casSharpenPixels(tileOrigin, ivec2(invocation % casGroupSize, invocation / casGroupSize), size);
+                }
+            }
+        }
+        return output;
+    }
+
+    float maxDifference(Image& a, Image& b)
+    {
+        float difference = 0.0f;
+        for (size_t i = 0; i < a.texels.size(); i++)
+        {
+            difference = std::fmax(difference, std::fabs(a.texels[i].rgb.x - b.texels[i].rgb.x));
+            difference = std::fmax(difference, std::fabs(a.texels[i].rgb.y - b.texels[i].rgb.y));
+            difference = std::fmax(difference, std::fabs(a.texels[i].rgb.z - b.texels[i].rgb.z));
+            difference = std::fmax(difference, std::fabs(a.texels[i].a - b.texels[i].a));
+        }
+        return difference;
+    }
+
+    void compareShaders(int width, int height, uint32_t seed)
+    {
+        Image input = createImage(width, height, seed);
+
+        std::vector<int> writes;
+        Image            fragmentOutput = runFragmentShader(input);
+        Image            computeOutput  = runComputeShader(input, writes);
+
+        // every pixel gets written exactly once, also in the tiles at the right and bottom edge that stick out of the image
+        bool writtenOnce = true;
+        for (int count : writes)
+        {
+            writtenOnce = writtenOnce && count == 1;
+        }
+        CHECK(writtenOnce);
+        // far below the 1/255 of an 8 bit swapchain, the sampler only adds rounding noise
+        CHECK(maxDifference(fragmentOutput, computeOutput) < 1e-5f);
+    }
+} // namespace
+
+// the compute shader has to sharpen exactly like the fragment shader it replaces with casCompute
+TEST(computeMatchesFragmentShader)
+{
+    compareShaders(64, 32, 1);
+    // partial tiles at the right and bottom edge, the border wraps around at every edge
+    compareShaders(37, 21, 2);
+    compareShaders(17, 1, 3);
+    compareShaders(1, 1, 4);
+}
+
+// the comparison has to catch the mistakes a tiled version of a sampling shader is prone to
+TEST(referenceDetectsAddressingErrors)
+{
+    Image            input = createImage(37, 21, 5);
+    std::vector<int> writes;
+    Image            fragmentOutput = runFragmentShader(input);
+
+    // a tile that got loaded one texel off
+    Image shiftedOutput = runComputeShader(input, writes, {1, 0});
+    CHECK(maxDifference(fragmentOutput, shiftedOutput) > 0.01f);
+
+    // texture coordinates at the corner of the pixels blend four texels
+    Image computeOutput = runComputeShader(input, writes);
+    Image cornerOutput  = runFragmentShader(input, 0.0f);
+    CHECK(maxDifference(cornerOutput, computeOutput) > 0.01f);
+}
@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mock_device.hpp"
+#include "command_buffer.hpp"
+#include "builtin_shaders.hpp"
+#include "effect_fxaa.hpp"
+#include "image.hpp"
+#include "memory.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace vkBasalt
+{
+    // the mock does not look at the SPIR-V, so the tests don't need the compiled shaders of the layer
+    bool getBuiltinShader(const std::string& name, std::vector<char>& code)
+    {
+        code.assign(16, 0);
+        return true;
+    }
+} // namespace vkBasalt
+
+namespace
+{
+    const VkExtent2D imageExtent = {64, 64};
+
+    // the images of the application and the images between the effects like the layer creates them for a swapchain
+    struct EffectChain
+    {
+        std::vector<std::vector<VkImage>>    images;
+        std::vector<MemoryAllocation>        memory;
+        std::vector<std::shared_ptr<Effect>> effects;
+        std::vector<VkCommandBuffer>         commandBuffers;
+    };
+
+    EffectChain createChain(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t effectCount, bool aliasing)
+    {
+        uint32_t    imageCount = getMockSettings().swapchainImageCount;
+        EffectChain chain;
+        chain.images.resize(effectCount + 1);
+        chain.memory.resize(effectCount + 1);
+        for (uint32_t i = 0; i <= effectCount; i++)
+        {
+            chain.images[i] = createImages(pLogicalDevice,
+                                           imageCount,
+                                           {imageExtent.width, imageExtent.height, 1},
+                                           VK_FORMAT_B8G8R8A8_UNORM,
+                                           VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                           chain.memory[i]);
+        }
+
+        setenv("VKBASALT_CONFIG_FILE", "/dev/null", 1);
+        auto pConfig = std::make_shared<Config>();
+        for (uint32_t i = 0; i < effectCount; i++)
+        {
+            chain.effects.push_back(std::make_shared<FxaaEffect>(
+                pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, imageExtent, chain.images[i], chain.images[i + 1], pConfig));
+        }
+
+        chain.commandBuffers = allocateCommandBuffer(pLogicalDevice, imageCount);
+        writeCommandBuffers(pLogicalDevice, chain.effects, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_FORMAT_UNDEFINED, chain.commandBuffers, aliasing);
+        return chain;
+    }
+
+    void destroyChain(std::shared_ptr<LogicalDevice> pLogicalDevice, EffectChain& chain)
+    {
+        pLogicalDevice->vkd.FreeCommandBuffers(
+            pLogicalDevice->device, pLogicalDevice->commandPool, chain.commandBuffers.size(), chain.commandBuffers.data());
+        chain.effects.clear();
+        for (uint32_t i = 0; i < chain.images.size(); i++)
+        {
+            for (VkImage image : chain.images[i])
+            {
+                pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+            }
+            freeMemory(pLogicalDevice, chain.memory[i]);
+        }
+    }
+} // namespace
+
+// every simple effect used to transition its input there and back and the chain added a memory barrier between the effects,
+// 8 vkCmdPipelineBarrier for three effects. Now each effect gets one barrier before its render pass and the end of the chain one
+TEST(oneBarrierPerEffect)
+{
+    resetMock();
+    auto pLogicalDevice = createMockLogicalDevice();
+
+    EffectChain chain = createChain(pLogicalDevice, 3, false);
+    for (VkCommandBuffer commandBuffer : chain.commandBuffers)
+    {
+        MockCommands commands = getRecordedCommands(commandBuffer);
+        CHECK(commands.draws == 3);
+        CHECK(commands.renderPasses == 3);
+        CHECK(commands.pipelineBarriers == 4);
+    }
+    destroyChain(pLogicalDevice, chain);
+
+    destroyMockLogicalDevice(pLogicalDevice);
+    CHECK(getMockStatistics().validationErrors == 0);
+}
+
+// the memory barrier between effects whose transient images share memory goes into the barrier of the next effect
+TEST(aliasingDoesNotAddBarriers)
+{
+    resetMock();
+    auto pLogicalDevice = createMockLogicalDevice();
+
+    EffectChain chain = createChain(pLogicalDevice, 3, true);
+    for (VkCommandBuffer commandBuffer : chain.commandBuffers)
+    {
+        CHECK(getRecordedCommands(commandBuffer).pipelineBarriers == 4);
+    }
+    destroyChain(pLogicalDevice, chain);
+
+    // a single effect needs the barrier before it and the one that hands its output back to the present
+    chain = createChain(pLogicalDevice, 1, true);
+    for (VkCommandBuffer commandBuffer : chain.commandBuffers)
+    {
+        CHECK(getRecordedCommands(commandBuffer).pipelineBarriers == 2);
+    }
+    destroyChain(pLogicalDevice, chain);
+
+    destroyMockLogicalDevice(pLogicalDevice);
+    CHECK(getMockStatistics().validationErrors == 0);
+}
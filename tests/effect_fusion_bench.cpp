@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mock_device.hpp"
+#include "command_buffer.hpp"
+#include "effect_cas.hpp"
+#include "effect_lut.hpp"
+#include "image.hpp"
+#include "memory.hpp"
+#include "bench.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const uint32_t   runs        = 20;
+    const VkExtent2D imageExtent = {1920, 1080};
+    const VkFormat   format      = VK_FORMAT_B8G8R8A8_UNORM;
+
+    // the config of the effects, with a 33 point lut that is not the identity
+    std::shared_ptr<Config> createConfig(const std::string& directory)
+    {
+        std::string cubePath = directory + "/grade.cube";
+        FILE*       file     = std::fopen(cubePath.c_str(), "w");
+        std::fprintf(file, "LUT_3D_SIZE 33\n");
+        for (uint32_t i = 0; i < 33 * 33 * 33; i++)
+        {
+            std::fprintf(file, "%.6f %.6f %.6f\n", (i % 33) / 32.0f, (i / 33 % 33) / 32.0f * 0.9f, (i / 33 / 33) / 32.0f);
+        }
+        std::fclose(file);
+
+        std::string configPath = directory + "/vkBasalt.conf";
+        file                   = std::fopen(configPath.c_str(), "w");
+        std::fprintf(file, "casSharpness = 0.4\nlutFile = %s\n", cubePath.c_str());
+        std::fclose(file);
+
+        setenv("VKBASALT_CONFIG_FILE", configPath.c_str(), 1);
+        return std::make_shared<Config>();
+    }
+
+    struct ChainImages
+    {
+        std::vector<VkImage> images;
+        MemoryAllocation     memory;
+    };
+
+    ChainImages createChainImages(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        ChainImages chainImages;
+        chainImages.images = createImages(pLogicalDevice,
+                                          1,
+                                          {imageExtent.width, imageExtent.height, 1},
+                                          format,
+                                          VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                          chainImages.memory);
+        return chainImages;
+    }
+
+    // records the effects like the layer does for one swapchain image and measures submitting it until its fence is signaled
+    void measureChain(std::shared_ptr<LogicalDevice> pLogicalDevice, const std::string& label, std::vector<std::shared_ptr<Effect>> effects)
+    {
+        std::vector<VkCommandBuffer> commandBuffers = allocateCommandBuffer(pLogicalDevice, 1);
+        writeCommandBuffers(pLogicalDevice, effects, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_FORMAT_UNDEFINED, commandBuffers, false);
+        VkFence fence = createFences(pLogicalDevice, 1)[0];
+
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = commandBuffers.data();
+
+        auto submitAndWait = [&]() {
+            pLogicalDevice->vkd.ResetFences(pLogicalDevice->device, 1, &fence);
+            CHECK(pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, fence) == VK_SUCCESS);
+            pLogicalDevice->vkd.WaitForFences(pLogicalDevice->device, 1, &fence, VK_TRUE, UINT64_MAX);
+        };
+        // the first submit pays for the compilation of the pipelines in some drivers
+        submitAndWait();
+        measure(label, runs, submitAndWait);
+
+        pLogicalDevice->vkd.DestroyFence(pLogicalDevice->device, fence, nullptr);
+        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, commandBuffers.data());
+    }
+} // namespace
+
+// cas followed by lut at 1080p, as two passes with an image in between and as the cas+lut pass that fuseEffects creates.
+// Run this with a gpu or lavapipe, without a vulkan driver it runs on the mock and only the recording gets compared
+TEST(fusedAgainstUnfusedChain)
+{
+    bool mock;
+    auto pLogicalDevice = createBenchLogicalDevice(mock);
+
+    std::string directory = (std::filesystem::temp_directory_path() / ("vkBasalt_fusion_" + std::to_string(getpid()))).string();
+    std::filesystem::create_directories(directory);
+    auto pConfig = createConfig(directory);
+
+    ChainImages input        = createChainImages(pLogicalDevice);
+    ChainImages intermediate = createChainImages(pLogicalDevice);
+    ChainImages output       = createChainImages(pLogicalDevice);
+
+    {
+        std::vector<std::shared_ptr<Effect>> unfused = {
+            std::make_shared<CasEffect>(pLogicalDevice, format, imageExtent, input.images, intermediate.images, pConfig),
+            std::make_shared<LutEffect>(pLogicalDevice, format, imageExtent, intermediate.images, output.images, pConfig)};
+        std::vector<std::shared_ptr<Effect>> fused = {
+            std::make_shared<CasEffect>(pLogicalDevice, format, imageExtent, input.images, output.images, pConfig, true)};
+
+        MockStatistics before = getMockStatistics();
+        measureChain(pLogicalDevice, "cas and lut as two passes", unfused);
+        MockStatistics between = getMockStatistics();
+        measureChain(pLogicalDevice, "cas+lut as one pass", fused);
+        MockStatistics after = getMockStatistics();
+
+        if (mock)
+        {
+            // every submit of the fused chain has one render pass less
+            uint64_t submits = runs + 1;
+            CHECK(between.submitted.renderPasses - before.submitted.renderPasses == submits * 2);
+            CHECK(after.submitted.renderPasses - between.submitted.renderPasses == submits);
+        }
+    }
+
+    for (ChainImages* pChainImages : {&input, &intermediate, &output})
+    {
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, pChainImages->images[0], nullptr);
+        freeMemory(pLogicalDevice, pChainImages->memory);
+    }
+    std::filesystem::remove_all(directory);
+
+    destroyBenchLogicalDevice(pLogicalDevice, mock);
+}
@@ -0,0 +1,123 @@
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mock_device.hpp"
+#include "command_buffer.hpp"
+#include "builtin_shaders.hpp"
+#include "effect_smaa.hpp"
+#include "transient_memory.hpp"
+#include "image.hpp"
+#include "memory.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace vkBasalt
+{
+    // the mock does not look at the SPIR-V, so the tests don't need the compiled shaders of the layer
+    bool getBuiltinShader(const std::string& name, std::vector<char>& code)
+    {
+        code.assign(16, 0);
+        return true;
+    }
+} // namespace vkBasalt
+
+namespace
+{
+    const VkExtent2D imageExtent = {64, 64};
+} // namespace
+
+// the edge pass marks the pixels with edges in the stencil, the blend pass only runs where it got marked
+TEST(blendPassTestsStencilOfEdgePass)
+{
+    resetMock();
+    auto     pLogicalDevice = createMockLogicalDevice();
+    uint32_t imageCount     = getMockSettings().swapchainImageCount;
+
+    std::vector<MemoryAllocation>     memory(2);
+    std::vector<std::vector<VkImage>> images(2);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        images[i] = createImages(pLogicalDevice,
+                                 imageCount,
+                                 {imageExtent.width, imageExtent.height, 1},
+                                 VK_FORMAT_B8G8R8A8_UNORM,
+                                 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                 memory[i]);
+    }
+
+    // the edge, blend and stencil images are transient like when the layer creates the effect
+    setenv("VKBASALT_CONFIG_FILE", "/dev/null", 1);
+    auto                                 pTransientMemory = std::make_unique<TransientImageMemory>(pLogicalDevice, imageCount, true);
+    std::vector<std::shared_ptr<Effect>> effects;
+    {
+        TransientImageScope transientImageScope(pTransientMemory.get(), 0);
+        effects.push_back(std::make_shared<SmaaEffect>(
+            pLogicalDevice, VK_FORMAT_B8G8R8A8_UNORM, imageExtent, images[0], images[1], std::make_shared<Config>()));
+    }
+
+    std::vector<VkCommandBuffer> commandBuffers = allocateCommandBuffer(pLogicalDevice, imageCount);
+    writeCommandBuffers(pLogicalDevice, effects, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_FORMAT_UNDEFINED, commandBuffers, false);
+
+    for (VkCommandBuffer commandBuffer : commandBuffers)
+    {
+        // edge detection, blending weights and neighborhood blending
+        std::vector<MockStencilDraw> draws = getRecordedStencilDraws(commandBuffer);
+        CHECK(draws.size() == 3);
+        if (draws.size() != 3)
+        {
+            continue;
+        }
+        MockStencilDraw& edge  = draws[0];
+        MockStencilDraw& blend = draws[1];
+
+        // the edge pass starts from a cleared stencil and keeps what it writes for the blend pass
+        CHECK(edge.stencilAttachment);
+        CHECK(edge.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_CLEAR);
+        CHECK(edge.stencilStoreOp == VK_ATTACHMENT_STORE_OP_STORE);
+        CHECK(edge.stencilTestEnable);
+        for (VkStencilOpState& state : {std::ref(edge.front), std::ref(edge.back)})
+        {
+            CHECK(state.compareOp == VK_COMPARE_OP_ALWAYS);
+            CHECK(state.passOp == VK_STENCIL_OP_REPLACE);
+            CHECK(state.writeMask != 0);
+            CHECK(state.reference != edge.stencilClearValue);
+        }
+
+        // the blend pass reads the stencil of the edge pass and only runs on the pixels that got the reference value
+        CHECK(blend.stencilAttachment);
+        CHECK(blend.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD);
+        CHECK(blend.stencilTestEnable);
+        for (VkStencilOpState& state : {std::ref(blend.front), std::ref(blend.back)})
+        {
+            CHECK(state.compareOp == VK_COMPARE_OP_EQUAL);
+            CHECK(state.reference == edge.front.reference);
+            CHECK((state.compareMask & edge.front.writeMask) == edge.front.writeMask);
+            CHECK(state.writeMask == 0);
+        }
+
+        // neighborhood blending writes the output without a stencil
+        CHECK(!draws[2].stencilAttachment);
+        CHECK(!draws[2].stencilTestEnable);
+    }
+
+    pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, commandBuffers.size(), commandBuffers.data());
+    effects.clear();
+    pTransientMemory.reset();
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        for (VkImage image : images[i])
+        {
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        }
+        freeMemory(pLogicalDevice, memory[i]);
+    }
+
+    destroyMockLogicalDevice(pLogicalDevice);
+    CHECK(getMockStatistics().validationErrors == 0);
+}
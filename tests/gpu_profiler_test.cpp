@@ -0,0 +1,221 @@
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include "mock_device.hpp"
+#include "gpu_profiler.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    struct Report
+    {
+        float    minimum;
+        float    average;
+        float    percentile;
+        uint32_t samples;
+    };
+
+    std::string getCsvFile()
+    {
+        return (std::filesystem::temp_directory_path() / ("vkBasalt_profile_" + std::to_string(getpid()) + ".csv")).string();
+    }
+
+    // the last line of every scope in the csv file of the profiler
+    std::unordered_map<std::string, Report> readReport()
+    {
+        std::unordered_map<std::string, Report> reports;
+
+        FILE* file = std::fopen(getCsvFile().c_str(), "r");
+        CHECK(file != nullptr);
+        if (file == nullptr)
+        {
+            return reports;
+        }
+
+        char line[512];
+        CHECK(std::fgets(line, sizeof(line), file) != nullptr);
+        CHECK(std::string(line) == "time_s,scope,min_ms,avg_ms,p99_ms,samples\n");
+        while (std::fgets(line, sizeof(line), file))
+        {
+            float  seconds;
+            char   name[256];
+            Report report;
+            CHECK(std::sscanf(line, "%f,%255[^,],%f,%f,%f,%u", &seconds, name, &report.minimum, &report.average, &report.percentile, &report.samples)
+                  == 6);
+            reports[name] = report;
+        }
+        std::fclose(file);
+        return reports;
+    }
+
+    VkCommandBuffer beginCommandBuffer(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool                 = pLogicalDevice->commandPool;
+        allocInfo.commandBufferCount          = 1;
+
+        VkCommandBuffer commandBuffer;
+        CHECK(pLogicalDevice->vkd.AllocateCommandBuffers(pLogicalDevice->device, &allocInfo, &commandBuffer) == VK_SUCCESS);
+        initializeDispatchTable(commandBuffer, pLogicalDevice->device);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+        return commandBuffer;
+    }
+
+    // submits and executes the command buffer, the timestamps of the submit are ticks apart
+    void submit(std::shared_ptr<LogicalDevice> pLogicalDevice, VkCommandBuffer commandBuffer, uint64_t ticks)
+    {
+        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+        CHECK(pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+
+        getMockSettings().timestampStep = ticks;
+        completeMockQueue();
+        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
+    }
+
+    // what the present records for one effect, and the collect of the next present of the same image
+    void profileFrame(std::shared_ptr<LogicalDevice> pLogicalDevice, GpuProfiler& profiler, uint32_t imageIndex, uint64_t ticks)
+    {
+        VkCommandBuffer commandBuffer = beginCommandBuffer(pLogicalDevice);
+        profiler.beginCommandBuffer(imageIndex, commandBuffer);
+        profiler.beginEffectScope(commandBuffer, 0);
+        profiler.endScope(commandBuffer);
+        profiler.endCommandBuffer();
+        submit(pLogicalDevice, commandBuffer, ticks);
+
+        profiler.markSubmitted(imageIndex);
+        profiler.collect(imageIndex);
+    }
+} // namespace
+
+// a timestamp counter with less than 64 valid bits wraps, the difference has to be taken modulo its range
+TEST(timestampsWrapAtTheValidBits)
+{
+    resetMock();
+    std::filesystem::remove(getCsvFile());
+    getMockSettings().timestampValidBits = 32;
+    getMockSettings().timestampPeriod    = 1000.0f;
+    auto pLogicalDevice                  = createMockLogicalDevice();
+    {
+        GpuProfiler profiler(pLogicalDevice, 2, {"cas"}, 1000.0f, getCsvFile());
+        CHECK(profiler.isSupported());
+
+        // the end of the scope gets written after the counter wrapped to 500
+        getMockSettings().nextTimestamp = 0xFFFFFFFF - 499;
+        profileFrame(pLogicalDevice, profiler, 0, 1000);
+        profileFrame(pLogicalDevice, profiler, 1, 2000);
+    }
+
+    auto reports = readReport();
+    CHECK(reports.size() == 1);
+    CHECK(reports["cas"].samples == 2);
+    CHECK(reports["cas"].minimum == 1.0f);
+    CHECK(reports["cas"].average == 1.5f);
+
+    destroyMockLogicalDevice(pLogicalDevice);
+    std::filesystem::remove(getCsvFile());
+    CHECK(getMockStatistics().validationErrors == 0);
+}
+
+// a scope only counts when both of its queries are available, neither may be read as a time of 0 or of the last frame
+TEST(unavailableQueriesGetSkipped)
+{
+    resetMock();
+    std::filesystem::remove(getCsvFile());
+    auto pLogicalDevice = createMockLogicalDevice();
+    {
+        GpuProfiler profiler(pLogicalDevice, 3, {"cas"}, 1000.0f, getCsvFile());
+
+        // the end of the scope got recorded into a command buffer that never got submitted
+        VkCommandBuffer commandBuffer = beginCommandBuffer(pLogicalDevice);
+        VkCommandBuffer lostBuffer    = beginCommandBuffer(pLogicalDevice);
+        profiler.beginCommandBuffer(0, commandBuffer);
+        profiler.beginEffectScope(commandBuffer, 0);
+        profiler.endScope(lostBuffer);
+        profiler.endCommandBuffer();
+        submit(pLogicalDevice, commandBuffer, 1000000);
+        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &lostBuffer);
+        profiler.markSubmitted(0);
+        profiler.collect(0);
+
+        // nothing of image 1 ever got executed
+        commandBuffer = beginCommandBuffer(pLogicalDevice);
+        profiler.beginCommandBuffer(1, commandBuffer);
+        profiler.beginEffectScope(commandBuffer, 0);
+        profiler.endScope(commandBuffer);
+        profiler.endCommandBuffer();
+        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
+        profiler.markSubmitted(1);
+        profiler.collect(1);
+
+        // images that did not get submitted are not read
+        profiler.collect(2);
+
+        profileFrame(pLogicalDevice, profiler, 2, 2000000);
+    }
+
+    auto reports = readReport();
+    CHECK(reports.size() == 1);
+    CHECK(reports["cas"].samples == 1);
+    CHECK(reports["cas"].minimum == 2.0f);
+
+    destroyMockLogicalDevice(pLogicalDevice);
+    std::filesystem::remove(getCsvFile());
+}
+
+// the report takes the 99th percentile of the sorted samples and forgets the oldest sample once the ring buffer is full
+TEST(percentileOfTheLastSamples)
+{
+    resetMock();
+    std::filesystem::remove(getCsvFile());
+    auto pLogicalDevice = createMockLogicalDevice();
+    {
+        // 100 samples of 1 to 100 ms in reverse order, the index (100 - 1) * 99 / 100 = 98 holds 99 ms
+        GpuProfiler profiler(pLogicalDevice, 3, {"cas"}, 1000.0f, getCsvFile());
+        for (uint32_t i = 100; i > 0; i--)
+        {
+            profileFrame(pLogicalDevice, profiler, i % 3, i * 1000000);
+        }
+    }
+
+    auto reports = readReport();
+    CHECK(reports["cas"].samples == 100);
+    CHECK(reports["cas"].minimum == 1.0f);
+    CHECK(reports["cas"].average == 50.5f);
+    CHECK(reports["cas"].percentile == 99.0f);
+    std::filesystem::remove(getCsvFile());
+
+    {
+        // 600 samples of 1 to 600 ms, only the last 512 from 89 ms on are kept, the index 511 * 99 / 100 = 505 holds 594 ms
+        GpuProfiler profiler(pLogicalDevice, 3, {"cas"}, 1000.0f, getCsvFile());
+        for (uint32_t i = 1; i <= 600; i++)
+        {
+            profileFrame(pLogicalDevice, profiler, i % 3, i * 1000000);
+        }
+    }
+
+    reports = readReport();
+    CHECK(reports["cas"].samples == 512);
+    CHECK(reports["cas"].minimum == 89.0f);
+    CHECK(reports["cas"].percentile == 594.0f);
+
+    destroyMockLogicalDevice(pLogicalDevice);
+    std::filesystem::remove(getCsvFile());
+}
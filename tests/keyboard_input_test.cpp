@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+#include "keyboard_input.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+
+namespace
+{
+    // the input thread reads the env var once, so every test uses the same file
+    const std::string& getFakeInputFile()
+    {
+        static std::string fakeInputFile = []() {
+            std::string file = (std::filesystem::temp_directory_path() / ("vkBasalt_fake_input_" + std::to_string(getpid()))).string();
+            setenv("VKBASALT_FAKE_INPUT", file.c_str(), 1);
+            unsetenv("DISPLAY");
+            return file;
+        }();
+        return fakeInputFile;
+    }
+
+    void setFakeInput(const std::vector<std::string>& lines)
+    {
+        std::ofstream file(getFakeInputFile() + ".tmp");
+        for (const auto& line : lines)
+        {
+            file << line << std::endl;
+        }
+        file.close();
+        std::filesystem::rename(getFakeInputFile() + ".tmp", getFakeInputFile());
+    }
+
+    // the input thread polls every 10 ms
+    template<typename Condition>
+    bool waitFor(Condition condition)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            if (condition())
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+} // namespace
+
+TEST(fakeKeys)
+{
+    setFakeInput({"Home", "a"});
+    CHECK(waitFor([]() { return isKeyPressed(XK_Home); }));
+    CHECK(isKeyPressed(XK_a));
+    CHECK(!isKeyPressed(XK_b));
+
+    setFakeInput({"b"});
+    CHECK(waitFor([]() { return !isKeyPressed(XK_Home); }));
+    CHECK(!isKeyPressed(XK_a));
+    CHECK(isKeyPressed(XK_b));
+
+    std::filesystem::remove(getFakeInputFile());
+    CHECK(waitFor([]() { return !isKeyPressed(XK_b); }));
+}
+
+TEST(fakeMouseButtons)
+{
+    // reshade counts left, right, middle
+    setFakeInput({"Button1", "Button3"});
+    CHECK(waitFor([]() { return isMouseButtonPressed(0); }));
+    CHECK(isMouseButtonPressed(1));
+    CHECK(!isMouseButtonPressed(2));
+    CHECK(!isMouseButtonPressed(5));
+
+    setFakeInput({"Button2"});
+    CHECK(waitFor([]() { return isMouseButtonPressed(2); }));
+    CHECK(!isMouseButtonPressed(0));
+    CHECK(!isMouseButtonPressed(1));
+
+    std::filesystem::remove(getFakeInputFile());
+    CHECK(waitFor([]() { return !isMouseButtonPressed(2); }));
+}
+
+TEST(virtualKeyCodes)
+{
+    CHECK(convertToKeySym(0x24) == XK_Home);
+    CHECK(convertToKeySym(0x41) == XK_a);
+    CHECK(convertToKeySym(0x35) == XK_5);
+    CHECK(convertToKeySym(0x71) == XK_F2);
+    CHECK(convertToKeySym(0xFF) == NoSymbol);
+}
@@ -0,0 +1,203 @@
+#include "layer_harness.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.hpp"
+
+namespace vkBasalt::test
+{
+    LayerHarness::LayerHarness(const std::vector<std::string>& configLines)
+    {
+        char directoryTemplate[] = "/tmp/vkBasalt_test_XXXXXX";
+        directory                = mkdtemp(directoryTemplate);
+
+        std::ofstream configFile(directory + "/vkBasalt.conf");
+        for (const auto& line : configLines)
+        {
+            configFile << line << std::endl;
+        }
+        configFile.close();
+
+        // the layer must not touch the caches or configs of the user and must not read the real keyboard
+        setenv("VKBASALT_CONFIG_FILE", (directory + "/vkBasalt.conf").c_str(), 1);
+        setenv("XDG_CACHE_HOME", directory.c_str(), 1);
+        setenv("HOME", directory.c_str(), 1);
+        unsetenv("DISPLAY");
+
+        pLibrary = dlopen(VKBASALT_LAYER_FILE, RTLD_NOW | RTLD_LOCAL);
+        if (pLibrary == nullptr)
+        {
+            std::cerr << "could not load " VKBASALT_LAYER_FILE ": " << dlerror() << std::endl;
+            std::_Exit(1);
+        }
+        getInstanceProcAddr = reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(pLibrary, "vkBasalt_GetInstanceProcAddr"));
+        getDeviceProcAddr   = reinterpret_cast<PFN_vkGetDeviceProcAddr>(dlsym(pLibrary, "vkBasalt_GetDeviceProcAddr"));
+    }
+
+    LayerHarness::~LayerHarness()
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    void LayerHarness::createDevice()
+    {
+        VkLayerInstanceLink instanceLink;
+        instanceLink.pNext                            = nullptr;
+        instanceLink.pfnNextGetInstanceProcAddr       = getMockInstanceProcAddr;
+        instanceLink.pfnNextGetPhysicalDeviceProcAddr = nullptr;
+
+        VkLayerInstanceCreateInfo layerInstanceCreateInfo;
+        layerInstanceCreateInfo.sType        = VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO;
+        layerInstanceCreateInfo.pNext        = nullptr;
+        layerInstanceCreateInfo.function     = VK_LAYER_LINK_INFO;
+        layerInstanceCreateInfo.u.pLayerInfo = &instanceLink;
+
+        VkInstanceCreateInfo instanceCreateInfo = {};
+        instanceCreateInfo.sType                = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceCreateInfo.pNext                = &layerInstanceCreateInfo;
+
+        auto createInstance = reinterpret_cast<PFN_vkCreateInstance>(getInstanceProcAddr(VK_NULL_HANDLE, "vkCreateInstance"));
+        CHECK(createInstance(&instanceCreateInfo, nullptr, &instance) == VK_SUCCESS);
+
+        uint32_t physicalDeviceCount = 1;
+        auto     enumeratePhysicalDevices =
+            reinterpret_cast<PFN_vkEnumeratePhysicalDevices>(getInstanceProcAddr(instance, "vkEnumeratePhysicalDevices"));
+        enumeratePhysicalDevices(instance, &physicalDeviceCount, &physicalDevice);
+
+        VkLayerDeviceLink deviceLink;
+        deviceLink.pNext                      = nullptr;
+        deviceLink.pfnNextGetInstanceProcAddr = getMockInstanceProcAddr;
+        deviceLink.pfnNextGetDeviceProcAddr   = getMockDeviceProcAddr;
+
+        VkLayerDeviceCreateInfo layerDeviceCreateInfo;
+        layerDeviceCreateInfo.sType        = VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO;
+        layerDeviceCreateInfo.pNext        = nullptr;
+        layerDeviceCreateInfo.function     = VK_LAYER_LINK_INFO;
+        layerDeviceCreateInfo.u.pLayerInfo = &deviceLink;
+
+        float                   queuePriority   = 1.0f;
+        VkDeviceQueueCreateInfo queueCreateInfo = {};
+        queueCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfo.queueFamilyIndex        = 0;
+        queueCreateInfo.queueCount              = 1;
+        queueCreateInfo.pQueuePriorities        = &queuePriority;
+
+        const char*        swapchainExtension = "VK_KHR_swapchain";
+        VkDeviceCreateInfo deviceCreateInfo   = {};
+        deviceCreateInfo.sType                = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceCreateInfo.pNext                = &layerDeviceCreateInfo;
+        deviceCreateInfo.queueCreateInfoCount = 1;
+        deviceCreateInfo.pQueueCreateInfos    = &queueCreateInfo;
+        deviceCreateInfo.enabledExtensionCount   = 1;
+        deviceCreateInfo.ppEnabledExtensionNames = &swapchainExtension;
+
+        auto createDevice = reinterpret_cast<PFN_vkCreateDevice>(getInstanceProcAddr(instance, "vkCreateDevice"));
+        CHECK(createDevice(physicalDevice, &deviceCreateInfo, nullptr, &device) == VK_SUCCESS);
+
+        getDeviceFunction<PFN_vkGetDeviceQueue>("vkGetDeviceQueue")(device, 0, 0, &queue);
+    }
+
+    void LayerHarness::destroyDevice()
+    {
+        getDeviceFunction<PFN_vkDestroyDevice>("vkDestroyDevice")(device, nullptr);
+        reinterpret_cast<PFN_vkDestroyInstance>(getInstanceProcAddr(instance, "vkDestroyInstance"))(instance, nullptr);
+        device   = VK_NULL_HANDLE;
+        instance = VK_NULL_HANDLE;
+    }
+
+    VkSwapchainKHR LayerHarness::createSwapchain(VkExtent2D extent, VkFormat format)
+    {
+        VkSwapchainCreateInfoKHR swapchainCreateInfo = {};
+        swapchainCreateInfo.sType                    = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        swapchainCreateInfo.surface                  = (VkSurfaceKHR) 1;
+        swapchainCreateInfo.minImageCount            = 3;
+        swapchainCreateInfo.imageFormat              = format;
+        swapchainCreateInfo.imageColorSpace          = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+        swapchainCreateInfo.imageExtent              = extent;
+        swapchainCreateInfo.imageArrayLayers         = 1;
+        swapchainCreateInfo.imageUsage               = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        swapchainCreateInfo.imageSharingMode         = VK_SHARING_MODE_EXCLUSIVE;
+        swapchainCreateInfo.preTransform             = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+        swapchainCreateInfo.compositeAlpha           = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+        swapchainCreateInfo.presentMode              = VK_PRESENT_MODE_FIFO_KHR;
+        swapchainCreateInfo.clipped                  = VK_TRUE;
+
+        VkSwapchainKHR swapchain;
+        CHECK(getDeviceFunction<PFN_vkCreateSwapchainKHR>("vkCreateSwapchainKHR")(device, &swapchainCreateInfo, nullptr, &swapchain)
+              == VK_SUCCESS);
+        return swapchain;
+    }
+
+    std::vector<VkImage> LayerHarness::getSwapchainImages(VkSwapchainKHR swapchain)
+    {
+        auto getSwapchainImages = getDeviceFunction<PFN_vkGetSwapchainImagesKHR>("vkGetSwapchainImagesKHR");
+
+        uint32_t imageCount = 0;
+        getSwapchainImages(device, swapchain, &imageCount, nullptr);
+        std::vector<VkImage> images(imageCount);
+        CHECK(getSwapchainImages(device, swapchain, &imageCount, images.data()) == VK_SUCCESS);
+        return images;
+    }
+
+    void LayerHarness::destroySwapchain(VkSwapchainKHR swapchain)
+    {
+        getDeviceFunction<PFN_vkDestroySwapchainKHR>("vkDestroySwapchainKHR")(device, swapchain, nullptr);
+    }
+
+    VkResult LayerHarness::present(VkSwapchainKHR swapchain, uint32_t imageIndex)
+    {
+        return present(std::vector<VkSwapchainKHR>{swapchain}, std::vector<uint32_t>{imageIndex});
+    }
+
+    VkResult LayerHarness::present(const std::vector<VkSwapchainKHR>& swapchains, const std::vector<uint32_t>& imageIndices)
+    {
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType            = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.swapchainCount   = swapchains.size();
+        presentInfo.pSwapchains      = swapchains.data();
+        presentInfo.pImageIndices    = imageIndices.data();
+
+        return getDeviceFunction<PFN_vkQueuePresentKHR>("vkQueuePresentKHR")(queue, &presentInfo);
+    }
+
+    const std::string& LayerHarness::getDirectory()
+    {
+        return directory;
+    }
+
+    bool runInProcess(const std::function<void()>& scenario, uint32_t timeoutSeconds)
+    {
+        std::cout.flush();
+        std::cerr.flush();
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            // a deadlock in the layer kills the scenario instead of the whole test run
+            alarm(timeoutSeconds);
+            scenario();
+            std::cout.flush();
+            std::cerr.flush();
+            // skips the destructors of the layer, its threads might still be running
+            std::_Exit(failureCount() ? 1 : 0);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (WIFSIGNALED(status))
+        {
+            std::cerr << "the scenario got killed by signal " << WTERMSIG(status) << std::endl;
+            return false;
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+} // namespace vkBasalt::test
@@ -0,0 +1,57 @@
+#ifndef LAYER_HARNESS_HPP_INCLUDED
+#define LAYER_HARNESS_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "mock_vulkan.hpp"
+
+namespace vkBasalt::test
+{
+    // Loads the built layer and calls it like the vulkan loader and an application would, the layer calls down into the mock driver.
+    // The layer reads its config only once per process, so every scenario has to run in its own process with runInProcess.
+    class LayerHarness
+    {
+    public:
+        // writes the config lines into a config file of a temporary directory, which is also the cache directory of the layer
+        LayerHarness(const std::vector<std::string>& configLines);
+        ~LayerHarness();
+
+        // creates the instance, the device and gets the queue
+        void createDevice();
+        void destroyDevice();
+
+        VkSwapchainKHR       createSwapchain(VkExtent2D extent, VkFormat format = VK_FORMAT_B8G8R8A8_UNORM);
+        std::vector<VkImage> getSwapchainImages(VkSwapchainKHR swapchain);
+        void                 destroySwapchain(VkSwapchainKHR swapchain);
+
+        VkResult present(VkSwapchainKHR swapchain, uint32_t imageIndex);
+        VkResult present(const std::vector<VkSwapchainKHR>& swapchains, const std::vector<uint32_t>& imageIndices);
+
+        // a device function as the application would get it from the layer
+        template<typename Function>
+        Function getDeviceFunction(const char* pName)
+        {
+            return reinterpret_cast<Function>(getDeviceProcAddr(device, pName));
+        }
+
+        const std::string& getDirectory();
+
+        VkInstance       instance       = VK_NULL_HANDLE;
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkDevice         device         = VK_NULL_HANDLE;
+        VkQueue          queue          = VK_NULL_HANDLE;
+
+    private:
+        std::string               directory;
+        void*                     pLibrary = nullptr;
+        PFN_vkGetInstanceProcAddr getInstanceProcAddr;
+        PFN_vkGetDeviceProcAddr   getDeviceProcAddr;
+    };
+
+    // runs the scenario in a child process, returns false if a check of the scenario failed or the process did not exit in time
+    bool runInProcess(const std::function<void()>& scenario, uint32_t timeoutSeconds = 120);
+} // namespace vkBasalt::test
+
+#endif // LAYER_HARNESS_HPP_INCLUDED
@@ -0,0 +1,182 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "layer_harness.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt::test;
+
+namespace
+{
+    // a reshade effect with uniforms that change every frame, the layer writes them into the slice of the swapchain image
+    std::string writeUniformEffect()
+    {
+        std::string path = (std::filesystem::temp_directory_path() / ("vkBasalt_uniforms_" + std::to_string(getpid()) + ".fx")).string();
+
+        std::ofstream file(path);
+        file << R"(
+uniform int   frameCount < source = "framecount"; >;
+uniform float frameTime < source = "frametime"; >;
+uniform float timer < source = "timer"; >;
+
+texture BackBufferTex : COLOR;
+sampler BackBuffer { Texture = BackBufferTex; };
+
+void FullscreenVS(in uint id : SV_VertexID, out float4 position : SV_Position, out float2 texcoord : TEXCOORD)
+{
+    texcoord.x = (id == 2) ? 2.0 : 0.0;
+    texcoord.y = (id == 1) ? 2.0 : 0.0;
+    position   = float4(texcoord * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+}
+
+float4 TintPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+    return tex2D(BackBuffer, texcoord) * (1.0 + frameCount * 0.0001 + frameTime * timer * 0.0);
+}
+
+technique Tint
+{
+    pass
+    {
+        VertexShader = FullscreenVS;
+        PixelShader  = TintPS;
+    }
+}
+)";
+        return path;
+    }
+
+    void checkCleanShutdown()
+    {
+        MockStatistics statistics = getMockStatistics();
+        CHECK(statistics.validationErrors == 0);
+        CHECK(statistics.blockedWaits == 0);
+        CHECK(statistics.liveImages == 0);
+        CHECK(statistics.liveMemoryAllocations == 0);
+    }
+} // namespace
+
+// the cpu writes the uniforms of a frame while the frames of the other swapchain images are still in flight,
+// the mock counts every byte that changes before the submit that reads it completed
+TEST(uniformSlicesAreNotOverwrittenInFlight)
+{
+    CHECK(runInProcess([]() {
+        std::string effectPath = writeUniformEffect();
+        LayerHarness harness({"effects = tint:cas", "tint = " + effectPath});
+        harness.createDevice();
+
+        VkSwapchainKHR       swapchain      = harness.createSwapchain({1280, 720});
+        VkSwapchainKHR       otherSwapchain = harness.createSwapchain({640, 480});
+        std::vector<VkImage> images         = harness.getSwapchainImages(swapchain);
+        std::vector<VkImage> otherImages    = harness.getSwapchainImages(otherSwapchain);
+
+        for (uint32_t frame = 0; frame < 100; frame++)
+        {
+            CHECK(harness.present(swapchain, frame % images.size()) == VK_SUCCESS);
+        }
+        // out of order like a mailbox swapchain, and two swapchains in one present
+        for (uint32_t frame = 0; frame < 100; frame++)
+        {
+            uint32_t index      = (frame * 7 / 3) % images.size();
+            uint32_t otherIndex = frame % otherImages.size();
+            CHECK(harness.present({swapchain, otherSwapchain}, {index, otherIndex}) == VK_SUCCESS);
+        }
+
+        MockStatistics statistics = getMockStatistics();
+        CHECK(statistics.submitted.draws > 0);
+        CHECK(statistics.overwrittenUniformBytes == 0);
+
+        harness.destroySwapchain(otherSwapchain);
+        harness.destroySwapchain(swapchain);
+        harness.destroyDevice();
+        std::filesystem::remove(effectPath);
+        checkCleanShutdown();
+    }));
+}
+
+// a failed submit leaves the fence of the frame unsignaled, the next frame of that image must not wait on it forever
+TEST(presentAfterFailedSubmit)
+{
+    CHECK(runInProcess(
+        []() {
+            LayerHarness harness({"effects = cas"});
+            harness.createDevice();
+
+            VkSwapchainKHR       swapchain      = harness.createSwapchain({1280, 720});
+            VkSwapchainKHR       otherSwapchain = harness.createSwapchain({640, 480});
+            harness.getSwapchainImages(swapchain);
+            harness.getSwapchainImages(otherSwapchain);
+
+            CHECK(harness.present(swapchain, 0) == VK_SUCCESS);
+
+            getMockSettings().failingSubmits = 1;
+            CHECK(harness.present(swapchain, 1) == VK_ERROR_DEVICE_LOST);
+            CHECK(harness.present(swapchain, 1) == VK_SUCCESS);
+
+            // both swapchains keep their signaled fences when the submit for both of them fails
+            CHECK(harness.present({swapchain, otherSwapchain}, {2, 0}) == VK_SUCCESS);
+            getMockSettings().failingSubmits = 1;
+            CHECK(harness.present({swapchain, otherSwapchain}, {0, 0}) == VK_ERROR_DEVICE_LOST);
+            CHECK(harness.present({swapchain, otherSwapchain}, {0, 0}) == VK_SUCCESS);
+
+            harness.destroySwapchain(otherSwapchain);
+            harness.destroySwapchain(swapchain);
+            harness.destroyDevice();
+            checkCleanShutdown();
+        },
+        30));
+}
+
+// the storage usage can keep the driver from compressing the swapchain images, they only get it when the compute shader of cas writes them
+TEST(storageUsageOnlyForComputeOutput)
+{
+    for (std::string effects : {"deband:cas", "cas:deband"})
+    {
+        CHECK(runInProcess([effects]() {
+            LayerHarness harness({"effects = " + effects, "casCompute = on"});
+            harness.createDevice();
+
+            VkSwapchainKHR swapchain = harness.createSwapchain({1280, 720});
+            bool           casIsLast = effects == "deband:cas";
+            CHECK(((getMockStatistics().swapchainUsage & VK_IMAGE_USAGE_STORAGE_BIT) != 0) == casIsLast);
+            harness.getSwapchainImages(swapchain);
+
+            // cas runs as compute shader in both orders
+            CHECK(harness.present(swapchain, 0) == VK_SUCCESS);
+            CHECK(getMockStatistics().submitted.dispatches > 0);
+
+            harness.destroySwapchain(swapchain);
+            harness.destroyDevice();
+            checkCleanShutdown();
+        }));
+    }
+}
+
+// destroying a swapchain right after presenting must wait for the frames before it frees what they use
+TEST(destroyRightAfterPresent)
+{
+    CHECK(runInProcess([]() {
+        std::string effectPath = writeUniformEffect();
+        LayerHarness harness({"effects = tint:smaa:cas", "tint = " + effectPath});
+        harness.createDevice();
+
+        for (uint32_t i = 0; i < 5; i++)
+        {
+            VkSwapchainKHR       swapchain = harness.createSwapchain({1280, 720});
+            std::vector<VkImage> images    = harness.getSwapchainImages(swapchain);
+            for (uint32_t j = 0; j < images.size(); j++)
+            {
+                CHECK(harness.present(swapchain, j) == VK_SUCCESS);
+            }
+            harness.destroySwapchain(swapchain);
+            CHECK(getMockStatistics().validationErrors == 0);
+        }
+
+        harness.destroyDevice();
+        std::filesystem::remove(effectPath);
+        checkCleanShutdown();
+    }));
+}
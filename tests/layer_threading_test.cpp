@@ -0,0 +1,260 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <thread>
+
+#include "layer_harness.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt::test;
+
+namespace
+{
+    // only the allocations of the thread that counts and outside of the mock driver
+    std::atomic<uint64_t> allocationCount  = 0;
+    thread_local bool     countAllocations = false;
+
+    // what the application does for a depth buffer, the layer hooks all three functions when depthCapture is on
+    void cycleDepthImage(LayerHarness& harness, VkDeviceMemory memory)
+    {
+        VkImageCreateInfo imageCreateInfo = {};
+        imageCreateInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType         = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format            = VK_FORMAT_D32_SFLOAT;
+        imageCreateInfo.extent            = {1280, 720, 1};
+        imageCreateInfo.mipLevels         = 1;
+        imageCreateInfo.arrayLayers       = 1;
+        imageCreateInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage             = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        imageCreateInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkImage image;
+        CHECK(harness.getDeviceFunction<PFN_vkCreateImage>("vkCreateImage")(harness.device, &imageCreateInfo, nullptr, &image) == VK_SUCCESS);
+        CHECK(harness.getDeviceFunction<PFN_vkBindImageMemory>("vkBindImageMemory")(harness.device, image, memory, 0) == VK_SUCCESS);
+        harness.getDeviceFunction<PFN_vkDestroyImage>("vkDestroyImage")(harness.device, image, nullptr);
+    }
+
+    VkDeviceMemory allocateMemory(LayerHarness& harness)
+    {
+        VkMemoryAllocateInfo allocateInfo = {};
+        allocateInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocateInfo.allocationSize       = 16 * 1024 * 1024;
+        allocateInfo.memoryTypeIndex      = 0;
+
+        VkDeviceMemory memory;
+        harness.getDeviceFunction<PFN_vkAllocateMemory>("vkAllocateMemory")(harness.device, &allocateInfo, nullptr, &memory);
+        return memory;
+    }
+
+    void freeMemory(LayerHarness& harness, VkDeviceMemory memory)
+    {
+        harness.getDeviceFunction<PFN_vkFreeMemory>("vkFreeMemory")(harness.device, memory, nullptr);
+    }
+
+    void checkCleanShutdown()
+    {
+        MockStatistics statistics = getMockStatistics();
+        CHECK(statistics.validationErrors == 0);
+        CHECK(statistics.blockedWaits == 0);
+        CHECK(statistics.liveImages == 0);
+        CHECK(statistics.liveMemoryAllocations == 0);
+    }
+} // namespace
+
+// the layer gets loaded after the test, so it uses this operator new as well
+void* operator new(std::size_t size)
+{
+    if (countAllocations && !isInsideMockDriver())
+    {
+        allocationCount++;
+    }
+    void* pMemory = std::malloc(size ? size : 1);
+    if (!pMemory)
+    {
+        throw std::bad_alloc();
+    }
+    return pMemory;
+}
+
+void operator delete(void* pMemory) noexcept
+{
+    std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t size) noexcept
+{
+    std::free(pMemory);
+}
+
+// depth images get created and destroyed on several threads while one thread presents and another one recreates a swapchain,
+// every depth image change rewrites the command buffers of all swapchains
+TEST(imageHooksWhilePresenting)
+{
+    CHECK(runInProcess([]() {
+        LayerHarness harness({"effects = cas:deband", "depthCapture = on"});
+        harness.createDevice();
+
+        VkSwapchainKHR       swapchain = harness.createSwapchain({1280, 720});
+        std::vector<VkImage> images    = harness.getSwapchainImages(swapchain);
+
+        std::atomic<bool>        done = false;
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&]() {
+                VkDeviceMemory memory = allocateMemory(harness);
+                while (!done)
+                {
+                    cycleDepthImage(harness, memory);
+                }
+                freeMemory(harness, memory);
+            });
+        }
+        threads.emplace_back([&]() {
+            for (uint32_t i = 0; i < 10; i++)
+            {
+                VkSwapchainKHR otherSwapchain = harness.createSwapchain({640, 480});
+                harness.getSwapchainImages(otherSwapchain);
+                harness.destroySwapchain(otherSwapchain);
+            }
+        });
+
+        for (uint32_t frame = 0; frame < 1000; frame++)
+        {
+            CHECK(harness.present(swapchain, frame % images.size()) == VK_SUCCESS);
+        }
+        done = true;
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        harness.destroySwapchain(swapchain);
+        harness.destroyDevice();
+        checkCleanShutdown();
+    }));
+}
+
+// creating the effects of a swapchain takes long, the image functions of the application must not wait for it
+TEST(imageHooksDuringEffectCreation)
+{
+    CHECK(runInProcess(
+        []() {
+            LayerHarness harness({"effects = cas", "depthCapture = on"});
+            harness.createDevice();
+            VkDeviceMemory memory    = allocateMemory(harness);
+            VkSwapchainKHR swapchain = harness.createSwapchain({1280, 720});
+
+            // the hook runs on a thread of the layer that creates an effect, a deadlock gets the scenario killed by the timeout
+            std::atomic<bool> hookCalled = false;
+            getMockSettings().pipelineCreationHook = [&]() {
+                if (hookCalled.exchange(true))
+                {
+                    return;
+                }
+                auto imageFuture = std::async(std::launch::async, [&]() { cycleDepthImage(harness, memory); });
+                CHECK(imageFuture.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+            };
+            harness.getSwapchainImages(swapchain);
+            getMockSettings().pipelineCreationHook = nullptr;
+            CHECK(hookCalled);
+
+            CHECK(harness.present(swapchain, 0) == VK_SUCCESS);
+            harness.destroySwapchain(swapchain);
+            freeMemory(harness, memory);
+            harness.destroyDevice();
+            checkCleanShutdown();
+        },
+        30));
+}
+
+// while the effects get created, another thread can already get the images and present them without the effects
+TEST(presentDuringEffectCreation)
+{
+    CHECK(runInProcess(
+        []() {
+            LayerHarness harness({"effects = cas"});
+            harness.createDevice();
+            VkSwapchainKHR swapchain = harness.createSwapchain({1280, 720});
+
+            std::atomic<bool> hookCalled = false;
+            getMockSettings().pipelineCreationHook = [&]() {
+                if (hookCalled.exchange(true))
+                {
+                    return;
+                }
+                auto presentFuture = std::async(std::launch::async, [&]() {
+                    std::vector<VkImage> images = harness.getSwapchainImages(swapchain);
+                    CHECK(images.size() == getMockSettings().swapchainImageCount);
+                    for (uint32_t i = 0; i < images.size(); i++)
+                    {
+                        CHECK(harness.present(swapchain, i) == VK_SUCCESS);
+                    }
+                });
+                CHECK(presentFuture.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+            };
+            std::vector<VkImage> images = harness.getSwapchainImages(swapchain);
+            getMockSettings().pipelineCreationHook = nullptr;
+            CHECK(hookCalled);
+
+            // both callers got the same images
+            CHECK(harness.getSwapchainImages(swapchain) == images);
+            CHECK(harness.present(swapchain, 0) == VK_SUCCESS);
+            harness.destroySwapchain(swapchain);
+            harness.destroyDevice();
+            checkCleanShutdown();
+        },
+        30));
+}
+
+// once the scratch vectors and the present fences are enough, presenting does not allocate anymore
+TEST(presentDoesNotAllocate)
+{
+    CHECK(runInProcess([]() {
+        LayerHarness harness({"effects = cas:deband"});
+        harness.createDevice();
+
+        VkSwapchainKHR swapchains[] = {harness.createSwapchain({1280, 720}), harness.createSwapchain({640, 480})};
+        uint32_t       imageCount   = harness.getSwapchainImages(swapchains[0]).size();
+        harness.getSwapchainImages(swapchains[1]);
+
+        // calls the layer directly, the present of the harness allocates the vectors for the present info
+        auto     queuePresent   = harness.getDeviceFunction<PFN_vkQueuePresentKHR>("vkQueuePresentKHR");
+        uint32_t imageIndices[] = {0, 0};
+
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType            = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.swapchainCount   = 2;
+        presentInfo.pSwapchains      = swapchains;
+        presentInfo.pImageIndices    = imageIndices;
+
+        auto presentFrames = [&](uint32_t frameCount) {
+            for (uint32_t frame = 0; frame < frameCount; frame++)
+            {
+                imageIndices[0] = frame % imageCount;
+                imageIndices[1] = frame % imageCount;
+                CHECK(queuePresent(harness.queue, &presentInfo) == VK_SUCCESS);
+            }
+        };
+
+        // activates the effects and starts the input thread
+        presentFrames(2 * imageCount);
+
+        allocationCount        = 0;
+        countAllocations       = true;
+        uint64_t submitsBefore = getMockStatistics().submits;
+        presentFrames(100);
+        countAllocations = false;
+        CHECK(allocationCount == 0);
+        // both swapchains go into one submit with one fence
+        CHECK(getMockStatistics().submits - submitsBefore == 100);
+
+        harness.destroySwapchain(swapchains[0]);
+        harness.destroySwapchain(swapchains[1]);
+        harness.destroyDevice();
+        checkCleanShutdown();
+    }));
+}
@@ -0,0 +1,7 @@
+#include "logger.hpp"
+
+namespace vkBasalt
+{
+    // basalt.cpp defines the logger of the layer, the unit tests link the other sources without it
+    Logger Logger::s_instance;
+} // namespace vkBasalt
@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "lut_cube.hpp"
+#include "bench.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const uint32_t runs = 5;
+
+    // a 65 point cube like the ones that grading tools export, 274625 lines of colors
+    std::string writeCube(const std::string& directory, uint32_t size)
+    {
+        std::string path = directory + "/grade" + std::to_string(size) + ".cube";
+        FILE*       file = std::fopen(path.c_str(), "w");
+        std::fprintf(file, "# generated\nTITLE \"grade\"\nLUT_3D_SIZE %u\nDOMAIN_MIN 0.0 0.0 0.0\nDOMAIN_MAX 1.0 1.0 1.0\n", size);
+        for (uint32_t b = 0; b < size; b++)
+        {
+            for (uint32_t g = 0; g < size; g++)
+            {
+                for (uint32_t r = 0; r < size; r++)
+                {
+                    std::fprintf(file, "%.6f %.6f %.6f\n", r / float(size - 1), g / float(size - 1) * 0.9f, b / float(size - 1) + 0.01f);
+                }
+            }
+        }
+        std::fclose(file);
+        return path;
+    }
+
+    // the line by line parser with getline and stof that LutCube used before
+    std::vector<float> parseWithStreams(const std::string& path)
+    {
+        std::ifstream      file(path);
+        std::string        line;
+        std::vector<float> colorCube;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#' || line.rfind("TITLE", 0) == 0 || line.rfind("DOMAIN", 0) == 0)
+            {
+                continue;
+            }
+            std::istringstream stream(line);
+            if (line.rfind("LUT_3D_SIZE", 0) == 0)
+            {
+                std::string keyword;
+                int         size;
+                stream >> keyword >> size;
+                colorCube.reserve(size * size * size * 4);
+                continue;
+            }
+            std::string r, g, b;
+            stream >> r >> g >> b;
+            colorCube.insert(colorCube.end(), {std::stof(r), std::stof(g), std::stof(b), 1.0f});
+        }
+        return colorCube;
+    }
+} // namespace
+
+TEST(parseAndCache)
+{
+    std::string directory = (std::filesystem::temp_directory_path() / ("vkBasalt_lut_" + std::to_string(getpid()))).string();
+    std::filesystem::create_directories(directory);
+    setenv("XDG_CACHE_HOME", (directory + "/cache").c_str(), 1);
+
+    std::string path = writeCube(directory, 65);
+
+    std::vector<float> reference;
+    measure("65^3 cube with getline and stof", runs, [&]() { reference = parseWithStreams(path); });
+
+    // every run parses again, since the cache of the previous run gets removed
+    std::vector<float> parsed;
+    measure("65^3 cube with LutCube, parsing", runs, [&]() {
+        std::filesystem::remove_all(directory + "/cache");
+        LutCube cube(path);
+        parsed = cube.colorCube;
+    });
+    CHECK(parsed == reference);
+
+    std::vector<float> cached;
+    measure("65^3 cube with LutCube, from the cache", runs, [&]() {
+        LutCube cube(path);
+        cached = cube.colorCube;
+    });
+    CHECK(cached == reference);
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,35 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+#include "lut_cube.hpp"
+
+// A libFuzzer target for the .cube parser, make fuzz builds it with clang. Run it with VKBASALT_LOG_LEVEL=none, e.g.
+// VKBASALT_LOG_LEVEL=none ../build/tests/fuzz/lut_cube_fuzz -max_len=4096 corpus/
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // without a cache directory every input gets parsed, the cache would return an older input of the same size and mtime
+    static const std::string path = []() {
+        unsetenv("XDG_CACHE_HOME");
+        unsetenv("HOME");
+        return "/tmp/vkBasalt_fuzz_" + std::to_string(getpid()) + ".cube";
+    }();
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(data, 1, size, file);
+    std::fclose(file);
+
+    vkBasalt::LutCube cube(path);
+    if (!cube.colorCube.empty())
+    {
+        size_t cubeSize = cube.size;
+        if (cube.size < 2 || cube.size > 256 || cube.colorCube.size() != cubeSize * cubeSize * cubeSize * 4)
+        {
+            std::abort();
+        }
+    }
+    return 0;
+}
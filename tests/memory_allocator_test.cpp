@@ -0,0 +1,278 @@
+#include <memory>
+#include <vector>
+
+#include "mock_device.hpp"
+#include "memory_allocator.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const VkDeviceSize blockSize = 1024 * 1024;
+
+    // memory type 0 of the mock is device local, 1 is host visible
+    const uint32_t deviceLocalType = 0;
+    const uint32_t hostVisibleType = 1;
+
+    VkMemoryRequirements requirements(VkDeviceSize size, VkDeviceSize alignment = 1)
+    {
+        return {size, alignment, 0x3};
+    }
+
+    MemoryAllocation allocate(MemoryAllocator& allocator, VkDeviceSize size, VkDeviceSize alignment = 1, bool linear = false)
+    {
+        MemoryAllocation allocation;
+        CHECK(allocator.allocate(requirements(size, alignment), deviceLocalType, linear, allocation) == VK_SUCCESS);
+        return allocation;
+    }
+
+    uint64_t liveMemoryAllocations()
+    {
+        return getMockStatistics().liveMemoryAllocations;
+    }
+
+    // every test gets its own device and allocator with small blocks
+    struct AllocatorTest
+    {
+        std::shared_ptr<LogicalDevice> pLogicalDevice;
+        std::unique_ptr<MemoryAllocator> pAllocator;
+
+        AllocatorTest(VkDeviceSize bufferImageGranularity = 1)
+        {
+            resetMock();
+            pLogicalDevice = createMockLogicalDevice();
+
+            VkPhysicalDeviceMemoryProperties memoryProperties;
+            pLogicalDevice->vki.GetPhysicalDeviceMemoryProperties(pLogicalDevice->physicalDevice, &memoryProperties);
+            pAllocator = std::make_unique<MemoryAllocator>(
+                &pLogicalDevice->vkd, pLogicalDevice->device, memoryProperties, bufferImageGranularity, blockSize);
+        }
+
+        ~AllocatorTest()
+        {
+            pAllocator.reset();
+            CHECK(liveMemoryAllocations() == 0);
+            destroyMockLogicalDevice(pLogicalDevice);
+            CHECK(getMockStatistics().validationErrors == 0);
+        }
+    };
+} // namespace
+
+TEST(firstFitAndSplit)
+{
+    AllocatorTest    test;
+    MemoryAllocator& allocator = *test.pAllocator;
+
+    // one block gets split into consecutive regions
+    MemoryAllocation first  = allocate(allocator, 4096);
+    MemoryAllocation second = allocate(allocator, 4096);
+    MemoryAllocation third  = allocate(allocator, 4096);
+    CHECK(liveMemoryAllocations() == 1);
+    CHECK(second.memory == first.memory && third.memory == first.memory);
+    CHECK(first.offset == 0);
+    CHECK(second.offset == 4096);
+    CHECK(third.offset == 8192);
+    CHECK(first.size == 4096);
+
+    // a hole of the same size gets used again instead of the rest of the block
+    allocator.free(second);
+    MemoryAllocation reused = allocate(allocator, 4096);
+    CHECK(reused.memory == first.memory);
+    CHECK(reused.offset == 4096);
+
+    // a smaller allocation splits the hole, the rest of it stays free
+    allocator.free(reused);
+    MemoryAllocation small = allocate(allocator, 1024);
+    MemoryAllocation rest  = allocate(allocator, 2048);
+    CHECK(small.offset == 4096);
+    CHECK(rest.offset == 4096 + 1024);
+
+    allocator.free(first);
+    allocator.free(small);
+    allocator.free(rest);
+    allocator.free(third);
+}
+
+TEST(mergeOnFree)
+{
+    AllocatorTest    test;
+    MemoryAllocator& allocator = *test.pAllocator;
+
+    MemoryAllocation first  = allocate(allocator, 4096);
+    MemoryAllocation second = allocate(allocator, 4096);
+    MemoryAllocation third  = allocate(allocator, 4096);
+
+    // freeing in this order merges with the previous and with the next region
+    allocator.free(first);
+    allocator.free(third);
+    allocator.free(second);
+
+    // only fits if the whole block is one region again
+    MemoryAllocation lowerHalf = allocate(allocator, blockSize / 2);
+    MemoryAllocation upperHalf = allocate(allocator, blockSize / 2);
+    CHECK(liveMemoryAllocations() == 1);
+    CHECK(lowerHalf.memory == upperHalf.memory);
+    CHECK(lowerHalf.offset == 0);
+    CHECK(upperHalf.offset == blockSize / 2);
+
+    allocator.free(lowerHalf);
+    allocator.free(upperHalf);
+}
+
+TEST(wholeBlockRelease)
+{
+    AllocatorTest    test;
+    MemoryAllocator& allocator = *test.pAllocator;
+
+    MemoryAllocation first  = allocate(allocator, blockSize / 2);
+    MemoryAllocation second = allocate(allocator, blockSize / 2);
+    MemoryAllocation third  = allocate(allocator, blockSize / 2);
+    CHECK(liveMemoryAllocations() == 2);
+    CHECK(first.memory == second.memory);
+    CHECK(third.memory != first.memory);
+
+    // an empty block goes back to the driver
+    allocator.free(third);
+    CHECK(liveMemoryAllocations() == 1);
+
+    // but the last block of a pool stays for the next swapchain
+    allocator.free(first);
+    allocator.free(second);
+    CHECK(liveMemoryAllocations() == 1);
+
+    // and gets used again
+    MemoryAllocation again = allocate(allocator, 4096);
+    CHECK(liveMemoryAllocations() == 1);
+    CHECK(again.offset == 0);
+    allocator.free(again);
+}
+
+TEST(dedicatedAllocations)
+{
+    AllocatorTest    test;
+    MemoryAllocator& allocator = *test.pAllocator;
+
+    // bigger than half a block
+    MemoryAllocation big = allocate(allocator, blockSize / 2 + 1);
+    CHECK(liveMemoryAllocations() == 1);
+    CHECK(big.offset == 0);
+    CHECK(big.region == UINT32_MAX);
+
+    MemoryAllocation small = allocate(allocator, 4096);
+    CHECK(liveMemoryAllocations() == 2);
+    CHECK(small.memory != big.memory);
+
+    allocator.free(big);
+    CHECK(liveMemoryAllocations() == 1);
+    allocator.free(small);
+}
+
+TEST(alignment)
+{
+    AllocatorTest    test;
+    MemoryAllocator& allocator = *test.pAllocator;
+
+    MemoryAllocation unaligned = allocate(allocator, 100);
+    MemoryAllocation aligned   = allocate(allocator, 1000, 4096);
+    CHECK(aligned.memory == unaligned.memory);
+    CHECK(aligned.offset == 4096);
+    CHECK(aligned.size == 1000);
+
+    // the padding in front of the aligned region stays free
+    MemoryAllocation padding = allocate(allocator, 100);
+    CHECK(padding.memory == unaligned.memory);
+    CHECK(padding.offset >= 100 && padding.offset + 100 <= 4096);
+
+    // the mapped pointer of host visible memory points at the offset already
+    MemoryAllocation firstMapped;
+    MemoryAllocation secondMapped;
+    CHECK(allocator.allocate(requirements(100), hostVisibleType, true, firstMapped) == VK_SUCCESS);
+    CHECK(allocator.allocate(requirements(100, 256), hostVisibleType, true, secondMapped) == VK_SUCCESS);
+    CHECK(firstMapped.pMapped != nullptr);
+    CHECK(secondMapped.offset == 256);
+    CHECK(static_cast<char*>(secondMapped.pMapped) - static_cast<char*>(firstMapped.pMapped) == 256);
+    CHECK(aligned.pMapped == nullptr);
+
+    allocator.free(unaligned);
+    allocator.free(aligned);
+    allocator.free(padding);
+    allocator.free(firstMapped);
+    allocator.free(secondMapped);
+}
+
+TEST(granularitySplitsLinearAndOptimal)
+{
+    {
+        // buffers and optimal tiling images would need padding between them, so they get their own blocks
+        AllocatorTest    test(1024);
+        MemoryAllocator& allocator = *test.pAllocator;
+
+        MemoryAllocation buffer = allocate(allocator, 4096, 1, true);
+        MemoryAllocation image  = allocate(allocator, 4096, 1, false);
+        CHECK(liveMemoryAllocations() == 2);
+        CHECK(buffer.memory != image.memory);
+        CHECK(buffer.pool != image.pool);
+
+        allocator.free(buffer);
+        allocator.free(image);
+    }
+    {
+        // without a granularity they share a block
+        AllocatorTest    test(1);
+        MemoryAllocator& allocator = *test.pAllocator;
+
+        MemoryAllocation buffer = allocate(allocator, 4096, 1, true);
+        MemoryAllocation image  = allocate(allocator, 4096, 1, false);
+        CHECK(liveMemoryAllocations() == 1);
+        CHECK(buffer.memory == image.memory);
+        CHECK(image.offset == 4096);
+
+        allocator.free(buffer);
+        allocator.free(image);
+    }
+}
+
+// allocating and freeing in random order must neither leak nor hand out overlapping regions
+TEST(randomAllocations)
+{
+    AllocatorTest    test;
+    MemoryAllocator& allocator = *test.pAllocator;
+
+    std::vector<MemoryAllocation> allocations;
+    uint32_t                      random = 12345;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        random = random * 1103515245 + 12345;
+        if (allocations.size() && (random >> 16) % 3 == 0)
+        {
+            uint32_t index = (random >> 8) % allocations.size();
+            allocator.free(allocations[index]);
+            allocations.erase(allocations.begin() + index);
+        }
+        else
+        {
+            VkDeviceSize size      = 1 + (random >> 12) % (64 * 1024);
+            VkDeviceSize alignment = VkDeviceSize(1) << ((random >> 4) % 12);
+            allocations.push_back(allocate(allocator, size, alignment));
+            CHECK(allocations.back().offset % alignment == 0);
+        }
+    }
+
+    for (uint32_t i = 0; i < allocations.size(); i++)
+    {
+        for (uint32_t j = i + 1; j < allocations.size(); j++)
+        {
+            const MemoryAllocation& a = allocations[i];
+            const MemoryAllocation& b = allocations[j];
+            CHECK(a.memory != b.memory || a.offset + a.size <= b.offset || b.offset + b.size <= a.offset);
+        }
+    }
+
+    for (auto& allocation : allocations)
+    {
+        allocator.free(allocation);
+    }
+    CHECK(liveMemoryAllocations() == 1);
+}
@@ -0,0 +1,168 @@
+#include "mock_device.hpp"
+
+#include <cstdio>
+
+#include <dlfcn.h>
+
+#include "test.hpp"
+
+namespace vkBasalt::test
+{
+    namespace
+    {
+        std::shared_ptr<LogicalDevice> createLogicalDevice(PFN_vkGetInstanceProcAddr getInstanceProcAddr)
+        {
+            VkApplicationInfo applicationInfo = {};
+            applicationInfo.sType             = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+            applicationInfo.apiVersion        = VK_API_VERSION_1_1;
+
+            VkInstanceCreateInfo instanceCreateInfo = {};
+            instanceCreateInfo.sType                = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+            instanceCreateInfo.pApplicationInfo     = &applicationInfo;
+
+            VkInstance instance;
+            auto       createInstance = reinterpret_cast<PFN_vkCreateInstance>(getInstanceProcAddr(VK_NULL_HANDLE, "vkCreateInstance"));
+            if (createInstance(&instanceCreateInfo, nullptr, &instance) != VK_SUCCESS)
+            {
+                return nullptr;
+            }
+
+            std::shared_ptr<LogicalDevice> pLogicalDevice(new LogicalDevice());
+            layer_init_instance_dispatch_table(instance, &pLogicalDevice->vki, getInstanceProcAddr);
+            pLogicalDevice->instance = instance;
+
+            uint32_t physicalDeviceCount = 1;
+            pLogicalDevice->vki.EnumeratePhysicalDevices(instance, &physicalDeviceCount, &pLogicalDevice->physicalDevice);
+            if (physicalDeviceCount == 0)
+            {
+                pLogicalDevice->vki.DestroyInstance(instance, nullptr);
+                return nullptr;
+            }
+
+            // the first queue family with graphics, the layer uses the queue of the application and it always has one
+            uint32_t queueFamilyCount = 0;
+            pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+            pLogicalDevice->vki.GetPhysicalDeviceQueueFamilyProperties(pLogicalDevice->physicalDevice, &queueFamilyCount, queueFamilies.data());
+            pLogicalDevice->queueFamilyIndex = 0;
+            while (pLogicalDevice->queueFamilyIndex + 1 < queueFamilyCount
+                   && !(queueFamilies[pLogicalDevice->queueFamilyIndex].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                pLogicalDevice->queueFamilyIndex++;
+            }
+
+            float                   queuePriority   = 1.0f;
+            VkDeviceQueueCreateInfo queueCreateInfo = {};
+            queueCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCreateInfo.queueFamilyIndex        = pLogicalDevice->queueFamilyIndex;
+            queueCreateInfo.queueCount              = 1;
+            queueCreateInfo.pQueuePriorities        = &queuePriority;
+
+            VkPhysicalDeviceFeatures supportedFeatures;
+            pLogicalDevice->vki.GetPhysicalDeviceFeatures(pLogicalDevice->physicalDevice, &supportedFeatures);
+
+            VkDeviceCreateInfo deviceCreateInfo   = {};
+            deviceCreateInfo.sType                = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+            deviceCreateInfo.queueCreateInfoCount = 1;
+            deviceCreateInfo.pQueueCreateInfos    = &queueCreateInfo;
+            deviceCreateInfo.pEnabledFeatures     = &supportedFeatures;
+
+            auto createDevice      = reinterpret_cast<PFN_vkCreateDevice>(getInstanceProcAddr(instance, "vkCreateDevice"));
+            auto getDeviceProcAddr = reinterpret_cast<PFN_vkGetDeviceProcAddr>(getInstanceProcAddr(instance, "vkGetDeviceProcAddr"));
+            CHECK(createDevice(pLogicalDevice->physicalDevice, &deviceCreateInfo, nullptr, &pLogicalDevice->device) == VK_SUCCESS);
+            layer_init_device_dispatch_table(pLogicalDevice->device, &pLogicalDevice->vkd, getDeviceProcAddr);
+
+            pLogicalDevice->deferSubmitCount             = 0;
+            pLogicalDevice->supportsMutableFormat        = true;
+            pLogicalDevice->supportsTextureCompressionBC = supportedFeatures.textureCompressionBC;
+            pLogicalDevice->supportsStorageImages =
+                supportedFeatures.shaderStorageImageWriteWithoutFormat && supportedFeatures.shaderStorageImageArrayDynamicIndexing;
+            pLogicalDevice->pipelineCache        = VK_NULL_HANDLE;
+            pLogicalDevice->pipelineCount        = 0;
+            pLogicalDevice->pipelineCreationTime = 0;
+
+            pLogicalDevice->vkd.GetDeviceQueue(pLogicalDevice->device, pLogicalDevice->queueFamilyIndex, 0, &pLogicalDevice->queue);
+
+            VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+            commandPoolCreateInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            commandPoolCreateInfo.queueFamilyIndex        = pLogicalDevice->queueFamilyIndex;
+            pLogicalDevice->vkd.CreateCommandPool(pLogicalDevice->device, &commandPoolCreateInfo, nullptr, &pLogicalDevice->commandPool);
+
+            VkPhysicalDeviceProperties       physicalDeviceProperties;
+            VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
+            pLogicalDevice->vki.GetPhysicalDeviceProperties(pLogicalDevice->physicalDevice, &physicalDeviceProperties);
+            pLogicalDevice->vki.GetPhysicalDeviceMemoryProperties(pLogicalDevice->physicalDevice, &physicalDeviceMemoryProperties);
+            pLogicalDevice->allocator = std::make_unique<MemoryAllocator>(&pLogicalDevice->vkd,
+                                                                          pLogicalDevice->device,
+                                                                          physicalDeviceMemoryProperties,
+                                                                          physicalDeviceProperties.limits.bufferImageGranularity);
+            pLogicalDevice->resourceCache =
+                std::make_unique<ResourceCache>(&pLogicalDevice->vkd, pLogicalDevice->device, pLogicalDevice->allocator.get());
+
+            return pLogicalDevice;
+        }
+
+        void destroyLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice)
+        {
+            pLogicalDevice->vkd.DestroyCommandPool(pLogicalDevice->device, pLogicalDevice->commandPool, nullptr);
+            pLogicalDevice->resourceCache.reset();
+            pLogicalDevice->allocator.reset();
+            pLogicalDevice->vkd.DestroyDevice(pLogicalDevice->device, nullptr);
+            pLogicalDevice->vki.DestroyInstance(pLogicalDevice->instance, nullptr);
+        }
+    } // namespace
+
+    std::shared_ptr<LogicalDevice> createMockLogicalDevice()
+    {
+        return createLogicalDevice(getMockInstanceProcAddr);
+    }
+
+    void destroyMockLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        completeMockQueue();
+        destroyLogicalDevice(pLogicalDevice);
+    }
+
+    std::shared_ptr<LogicalDevice> createSystemLogicalDevice()
+    {
+        // stays loaded, the driver must not get unloaded while the device exists
+        static void* pLibrary = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+        if (!pLibrary)
+        {
+            return nullptr;
+        }
+        return createLogicalDevice(reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(pLibrary, "vkGetInstanceProcAddr")));
+    }
+
+    void destroySystemLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        pLogicalDevice->vkd.DeviceWaitIdle(pLogicalDevice->device);
+        destroyLogicalDevice(pLogicalDevice);
+    }
+
+    std::shared_ptr<LogicalDevice> createBenchLogicalDevice(bool& mock)
+    {
+        auto pLogicalDevice = createSystemLogicalDevice();
+        mock                = !pLogicalDevice;
+        if (mock)
+        {
+            std::printf("no vulkan device, running on the mock driver\n");
+            resetMock();
+            pLogicalDevice = createMockLogicalDevice();
+        }
+        return pLogicalDevice;
+    }
+
+    void destroyBenchLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice, bool mock)
+    {
+        if (mock)
+        {
+            destroyMockLogicalDevice(pLogicalDevice);
+            CHECK(getMockStatistics().validationErrors == 0);
+        }
+        else
+        {
+            destroySystemLogicalDevice(pLogicalDevice);
+        }
+    }
+} // namespace vkBasalt::test
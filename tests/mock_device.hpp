@@ -0,0 +1,27 @@
+#ifndef MOCK_DEVICE_HPP_INCLUDED
+#define MOCK_DEVICE_HPP_INCLUDED
+#include <memory>
+
+#include "mock_vulkan.hpp"
+#include "logical_device.hpp"
+
+namespace vkBasalt::test
+{
+    // a device of the mock driver with the LogicalDevice that vkBasalt_CreateDevice and vkGetDeviceQueue would create,
+    // for the unit tests that call the sources of the layer directly. The mock settings have to be set before
+    std::shared_ptr<LogicalDevice> createMockLogicalDevice();
+    // completes the queue and destroys what createMockLogicalDevice created
+    void destroyMockLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice);
+
+    // the same on the vulkan driver of the system, for the benchmarks that need a real gpu or lavapipe.
+    // Returns nullptr if libvulkan.so.1 can't get loaded or there is no device
+    std::shared_ptr<LogicalDevice> createSystemLogicalDevice();
+    void                           destroySystemLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice);
+
+    // for the benchmarks, the device of the system or the mock one if there is none, mock tells which one it is
+    std::shared_ptr<LogicalDevice> createBenchLogicalDevice(bool& mock);
+    // destroys the device of createBenchLogicalDevice, on the mock the benchmark must not have caused validation errors
+    void destroyBenchLogicalDevice(std::shared_ptr<LogicalDevice> pLogicalDevice, bool mock);
+} // namespace vkBasalt::test
+
+#endif // MOCK_DEVICE_HPP_INCLUDED
@@ -0,0 +1,1466 @@
+#include "mock_vulkan.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+namespace vkBasalt::test
+{
+    namespace
+    {
+        // instances, physical devices, devices, queues and command buffers start with the pointer the loader keeps its dispatch table in,
+        // the layer uses it as key. The physical device shares it with its instance and the queues share it with their device.
+        struct DispatchableObject
+        {
+            void* loaderData;
+        };
+
+        struct MockMemory
+        {
+            VkDeviceSize size;
+            bool         hostVisible;
+            char*        pData;
+        };
+
+        struct MockBuffer
+        {
+            VkDeviceSize size;
+            MockMemory*  pMemory;
+            VkDeviceSize memoryOffset;
+        };
+
+        struct MockFence
+        {
+            bool signaled;
+            bool pending;
+        };
+
+        struct DynamicBuffer
+        {
+            MockBuffer*  pBuffer;
+            VkDeviceSize offset;
+            VkDeviceSize range;
+        };
+
+        struct MockDescriptorSet
+        {
+            // the dynamic uniform buffers ordered by binding, which is the order the dynamic offsets get consumed in
+            std::map<uint32_t, DynamicBuffer> dynamicBuffers;
+        };
+
+        struct MockDescriptorPool
+        {
+            std::vector<MockDescriptorSet*> sets;
+        };
+
+        struct MockQueryPool
+        {
+            std::vector<uint64_t> values;
+            std::vector<bool>     available;
+        };
+
+        struct UniformRead
+        {
+            MockMemory*  pMemory;
+            VkDeviceSize offset;
+            VkDeviceSize size;
+        };
+
+        struct QueryCommand
+        {
+            MockQueryPool* pPool;
+            uint32_t       firstQuery;
+            uint32_t       queryCount; // 0 for a timestamp
+        };
+
+        // the depth stencil attachment of the first subpass
+        struct MockRenderPass
+        {
+            bool                stencilAttachment;
+            uint32_t            attachment;
+            VkAttachmentLoadOp  stencilLoadOp;
+            VkAttachmentStoreOp stencilStoreOp;
+        };
+
+        // compute pipelines have no depth stencil state
+        struct MockPipeline
+        {
+            VkBool32         stencilTestEnable;
+            VkStencilOpState front;
+            VkStencilOpState back;
+        };
+
+        struct MockCommandPool;
+
+        struct MockCommandBuffer : DispatchableObject
+        {
+            MockCommandPool*             pPool;
+            bool                         recording;
+            uint32_t                     pendingCount;
+            MockCommands                 commands;
+            std::vector<UniformRead>     uniformReads;
+            std::vector<QueryCommand>    queryCommands;
+            MockStencilDraw              renderPassStencil;
+            MockPipeline                 graphicsPipeline;
+            std::vector<MockStencilDraw> stencilDraws;
+        };
+
+        struct MockCommandPool
+        {
+            std::unordered_set<MockCommandBuffer*> commandBuffers;
+        };
+
+        struct MockSwapchain
+        {
+            std::vector<VkImage> images;
+        };
+
+        struct Submission
+        {
+            std::vector<MockCommandBuffer*>                      commandBuffers;
+            MockFence*                                           pFence;
+            std::vector<std::pair<UniformRead, std::vector<char>>> uniformSnapshots;
+        };
+
+        // objects that the mock does not need to keep any state for
+        struct MockObject
+        {
+            uint64_t value;
+        };
+
+        MockSettings defaultSettings()
+        {
+            MockSettings settings = {};
+            settings.features.shaderImageGatherExtended              = VK_TRUE;
+            settings.features.shaderStorageImageWriteWithoutFormat   = VK_TRUE;
+            settings.features.shaderStorageImageArrayDynamicIndexing = VK_TRUE;
+            settings.features.textureCompressionBC                   = VK_TRUE;
+            settings.deviceExtensions = {"VK_KHR_swapchain", "VK_KHR_swapchain_mutable_format", "VK_KHR_image_format_list", "VK_KHR_maintenance2"};
+            settings.optimalTilingFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT
+                                             | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+                                             | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+                                             | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT
+                                             | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+            settings.surfaceUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT
+                                    | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            settings.swapchainImageCount             = 3;
+            settings.minUniformBufferOffsetAlignment = 256;
+            settings.timestampValidBits              = 64;
+            settings.timestampPeriod                 = 1.0f;
+            settings.nextTimestamp                   = 0;
+            settings.timestampStep                   = 1000;
+            settings.failingSubmits                  = 0;
+            return settings;
+        }
+
+        std::mutex     driverMutex;
+        MockSettings   settings = defaultSettings();
+        MockStatistics statistics = {};
+
+        std::deque<Submission> submissions;
+
+        thread_local uint32_t driverDepth = 0;
+
+        // every entry point of the mock holds the driver lock, allocations of the mock itself don't count as allocations of the layer
+        class DriverScope
+        {
+        public:
+            DriverScope() : lock(driverMutex)
+            {
+                driverDepth++;
+            }
+            ~DriverScope()
+            {
+                driverDepth--;
+            }
+
+        private:
+            std::lock_guard<std::mutex> lock;
+        };
+
+        void validationError(const std::string& message)
+        {
+            statistics.validationErrors++;
+            std::fprintf(stderr, "mock driver: %s\n", message.c_str());
+        }
+
+        template<typename Handle, typename Object>
+        Handle toHandle(Object* pObject)
+        {
+            return (Handle) (uintptr_t) pObject;
+        }
+
+        template<typename Object, typename Handle>
+        Object* fromHandle(Handle handle)
+        {
+            return (Object*) (uintptr_t) handle;
+        }
+
+        template<typename Handle>
+        Handle createObject(uint64_t value)
+        {
+            return toHandle<Handle>(new MockObject{value});
+        }
+
+        template<typename Handle>
+        void destroyObject(Handle handle)
+        {
+            delete fromHandle<MockObject>(handle);
+        }
+
+        void addCommands(MockCommands& sum, const MockCommands& commands)
+        {
+            sum.pipelineBarriers += commands.pipelineBarriers;
+            sum.imageBarriers += commands.imageBarriers;
+            sum.renderPasses += commands.renderPasses;
+            sum.draws += commands.draws;
+            sum.dispatches += commands.dispatches;
+            sum.blits += commands.blits;
+            sum.copies += commands.copies;
+            sum.timestamps += commands.timestamps;
+        }
+
+        // the gpu part of a submit, the uniforms it reads have to be the same as when it got submitted
+        void execute(Submission& submission)
+        {
+            for (auto& [read, snapshot] : submission.uniformSnapshots)
+            {
+                const char* pCurrent = read.pMemory->pData + read.offset;
+                for (VkDeviceSize i = 0; i < read.size; i++)
+                {
+                    statistics.overwrittenUniformBytes += pCurrent[i] != snapshot[i];
+                }
+            }
+
+            uint64_t mask = settings.timestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << settings.timestampValidBits) - 1;
+            for (MockCommandBuffer* pCommandBuffer : submission.commandBuffers)
+            {
+                for (const QueryCommand& command : pCommandBuffer->queryCommands)
+                {
+                    if (command.queryCount)
+                    {
+                        for (uint32_t i = command.firstQuery; i < command.firstQuery + command.queryCount; i++)
+                        {
+                            command.pPool->available[i] = false;
+                        }
+                    }
+                    else
+                    {
+                        command.pPool->values[command.firstQuery]    = settings.nextTimestamp & mask;
+                        command.pPool->available[command.firstQuery] = true;
+                        settings.nextTimestamp += settings.timestampStep;
+                    }
+                }
+                pCommandBuffer->pendingCount--;
+            }
+
+            if (submission.pFence)
+            {
+                submission.pFence->pending  = false;
+                submission.pFence->signaled = true;
+            }
+        }
+
+        void executeAll()
+        {
+            while (!submissions.empty())
+            {
+                execute(submissions.front());
+                submissions.pop_front();
+            }
+        }
+
+        // the queue executes in order, so everything before the submit of the fence completes as well
+        bool executeUntil(MockFence* pFence)
+        {
+            if (!pFence->pending)
+            {
+                return pFence->signaled;
+            }
+            while (!pFence->signaled)
+            {
+                execute(submissions.front());
+                submissions.pop_front();
+            }
+            return true;
+        }
+
+        ///////////////////////////////////////////////////////////////////////////////////////////
+        // instance functions
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                      const VkAllocationCallbacks* pAllocator,
+                                                      VkInstance*                  pInstance)
+        {
+            DriverScope scope;
+
+            DispatchableObject* pInstanceObject       = new DispatchableObject;
+            DispatchableObject* pPhysicalDeviceObject = new DispatchableObject;
+            pInstanceObject->loaderData               = pPhysicalDeviceObject;
+            pPhysicalDeviceObject->loaderData         = pPhysicalDeviceObject;
+            *pInstance                                = reinterpret_cast<VkInstance>(pInstanceObject);
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope         scope;
+            DispatchableObject* pInstanceObject = reinterpret_cast<DispatchableObject*>(instance);
+            delete static_cast<DispatchableObject*>(pInstanceObject->loaderData);
+            delete pInstanceObject;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL EnumeratePhysicalDevices(VkInstance instance, uint32_t* pCount, VkPhysicalDevice* pPhysicalDevices)
+        {
+            DriverScope scope;
+            if (pPhysicalDevices)
+            {
+                pPhysicalDevices[0] = reinterpret_cast<VkPhysicalDevice>(reinterpret_cast<DispatchableObject*>(instance)->loaderData);
+            }
+            *pCount = 1;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFeatures(VkPhysicalDevice physicalDevice, VkPhysicalDeviceFeatures* pFeatures)
+        {
+            DriverScope scope;
+            *pFeatures = settings.features;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties* pProperties)
+        {
+            DriverScope scope;
+            *pProperties                                        = {};
+            pProperties->apiVersion                             = VK_API_VERSION_1_2;
+            pProperties->deviceType                             = VK_PHYSICAL_DEVICE_TYPE_CPU;
+            pProperties->limits.maxImageDimension2D             = 16384;
+            pProperties->limits.maxImageArrayLayers             = 2048;
+            pProperties->limits.maxMemoryAllocationCount        = 4096;
+            pProperties->limits.bufferImageGranularity          = 1024;
+            pProperties->limits.minUniformBufferOffsetAlignment = settings.minUniformBufferOffsetAlignment;
+            pProperties->limits.maxComputeWorkGroupSize[0]      = 1024;
+            pProperties->limits.maxComputeWorkGroupSize[1]      = 1024;
+            pProperties->limits.maxComputeWorkGroupSize[2]      = 64;
+            pProperties->limits.maxComputeWorkGroupInvocations  = 1024;
+            pProperties->limits.timestampComputeAndGraphics     = VK_TRUE;
+            pProperties->limits.timestampPeriod                 = settings.timestampPeriod;
+            std::strcpy(pProperties->deviceName, "vkBasalt mock device");
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceMemoryProperties(VkPhysicalDevice                  physicalDevice,
+                                                                     VkPhysicalDeviceMemoryProperties* pProperties)
+        {
+            DriverScope scope;
+            *pProperties                              = {};
+            pProperties->memoryTypeCount              = 2;
+            pProperties->memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            pProperties->memoryTypes[0].heapIndex     = 0;
+            pProperties->memoryTypes[1].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            pProperties->memoryTypes[1].heapIndex     = 1;
+            pProperties->memoryHeapCount              = 2;
+            pProperties->memoryHeaps[0].size          = VkDeviceSize(4) << 30;
+            pProperties->memoryHeaps[0].flags         = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+            pProperties->memoryHeaps[1].size          = VkDeviceSize(4) << 30;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceFormatProperties(VkPhysicalDevice    physicalDevice,
+                                                                     VkFormat            format,
+                                                                     VkFormatProperties* pProperties)
+        {
+            DriverScope scope;
+            pProperties->linearTilingFeatures  = settings.optimalTilingFeatures;
+            pProperties->optimalTilingFeatures = settings.optimalTilingFeatures;
+            pProperties->bufferFeatures        = 0;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice         physicalDevice,
+                                                                          uint32_t*                pCount,
+                                                                          VkQueueFamilyProperties* pProperties)
+        {
+            DriverScope scope;
+            if (pProperties)
+            {
+                pProperties[0]                    = {};
+                pProperties[0].queueFlags         = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+                pProperties[0].queueCount         = 1;
+                pProperties[0].timestampValidBits = settings.timestampValidBits;
+                pProperties[0].minImageTransferGranularity = {1, 1, 1};
+            }
+            *pCount = 1;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL EnumerateDeviceExtensionProperties(VkPhysicalDevice       physicalDevice,
+                                                                          const char*            pLayerName,
+                                                                          uint32_t*              pCount,
+                                                                          VkExtensionProperties* pProperties)
+        {
+            DriverScope scope;
+            if (pProperties)
+            {
+                for (uint32_t i = 0; i < *pCount && i < settings.deviceExtensions.size(); i++)
+                {
+                    std::strcpy(pProperties[i].extensionName, settings.deviceExtensions[i].c_str());
+                    pProperties[i].specVersion = 1;
+                }
+            }
+            *pCount = settings.deviceExtensions.size();
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice          physicalDevice,
+                                                                               VkSurfaceKHR              surface,
+                                                                               VkSurfaceCapabilitiesKHR* pCapabilities)
+        {
+            DriverScope scope;
+            *pCapabilities                     = {};
+            pCapabilities->minImageCount       = 2;
+            pCapabilities->maxImageCount       = 8;
+            pCapabilities->maxImageArrayLayers = 1;
+            pCapabilities->supportedUsageFlags = settings.surfaceUsage;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                    const VkDeviceCreateInfo*    pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkDevice*                    pDevice)
+        {
+            DriverScope scope;
+
+            statistics.enabledExtensions.clear();
+            for (uint32_t i = 0; i < pCreateInfo->enabledExtensionCount; i++)
+            {
+                std::string name = pCreateInfo->ppEnabledExtensionNames[i];
+                bool        supported = false;
+                for (const auto& extension : settings.deviceExtensions)
+                {
+                    supported |= extension == name;
+                }
+                if (!supported)
+                {
+                    return VK_ERROR_EXTENSION_NOT_PRESENT;
+                }
+                statistics.enabledExtensions.push_back(name);
+            }
+            statistics.enabledFeatures = pCreateInfo->pEnabledFeatures ? *pCreateInfo->pEnabledFeatures : VkPhysicalDeviceFeatures{};
+
+            DispatchableObject* pDeviceObject = new DispatchableObject;
+            DispatchableObject* pQueueObject  = new DispatchableObject;
+            pDeviceObject->loaderData         = pQueueObject;
+            pQueueObject->loaderData          = pQueueObject;
+            *pDevice                          = reinterpret_cast<VkDevice>(pDeviceObject);
+            return VK_SUCCESS;
+        }
+
+        ///////////////////////////////////////////////////////////////////////////////////////////
+        // device functions
+
+        VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            if (!submissions.empty())
+            {
+                validationError("the device got destroyed while the queue was busy");
+                executeAll();
+            }
+            DispatchableObject* pDeviceObject = reinterpret_cast<DispatchableObject*>(device);
+            delete static_cast<DispatchableObject*>(pDeviceObject->loaderData);
+            delete pDeviceObject;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue* pQueue)
+        {
+            DriverScope scope;
+            *pQueue = reinterpret_cast<VkQueue>(reinterpret_cast<DispatchableObject*>(device)->loaderData);
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetDeviceQueue2(VkDevice device, const VkDeviceQueueInfo2* pQueueInfo, VkQueue* pQueue)
+        {
+            DriverScope scope;
+            *pQueue = reinterpret_cast<VkQueue>(reinterpret_cast<DispatchableObject*>(device)->loaderData);
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL AllocateMemory(VkDevice                     device,
+                                                      const VkMemoryAllocateInfo*  pAllocateInfo,
+                                                      const VkAllocationCallbacks* pAllocator,
+                                                      VkDeviceMemory*              pMemory)
+        {
+            DriverScope scope;
+
+            MockMemory* pMockMemory  = new MockMemory;
+            pMockMemory->size        = pAllocateInfo->allocationSize;
+            pMockMemory->hostVisible = pAllocateInfo->memoryTypeIndex == 1;
+            // calloc does not touch the pages, so the big blocks of the allocator don't cost anything until they get written
+            pMockMemory->pData = pMockMemory->hostVisible ? static_cast<char*>(std::calloc(pMockMemory->size, 1)) : nullptr;
+            statistics.liveMemoryAllocations++;
+
+            *pMemory = toHandle<VkDeviceMemory>(pMockMemory);
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL FreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            if (memory == VK_NULL_HANDLE)
+            {
+                return;
+            }
+
+            MockMemory* pMockMemory = fromHandle<MockMemory>(memory);
+            for (const auto& submission : submissions)
+            {
+                for (const auto& [read, snapshot] : submission.uniformSnapshots)
+                {
+                    if (read.pMemory == pMockMemory)
+                    {
+                        validationError("memory got freed while a submit that reads it is in flight");
+                        executeAll();
+                        break;
+                    }
+                }
+            }
+
+            std::free(pMockMemory->pData);
+            delete pMockMemory;
+            statistics.liveMemoryAllocations--;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL
+        MapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void** ppData)
+        {
+            DriverScope scope;
+
+            MockMemory* pMockMemory = fromHandle<MockMemory>(memory);
+            if (!pMockMemory->hostVisible)
+            {
+                validationError("memory that is not host visible got mapped");
+                return VK_ERROR_MEMORY_MAP_FAILED;
+            }
+            *ppData = pMockMemory->pData + offset;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL UnmapMemory(VkDevice device, VkDeviceMemory memory)
+        {
+            DriverScope scope;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateBuffer(VkDevice                     device,
+                                                    const VkBufferCreateInfo*    pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkBuffer*                    pBuffer)
+        {
+            DriverScope scope;
+            *pBuffer = toHandle<VkBuffer>(new MockBuffer{pCreateInfo->size, nullptr, 0});
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            delete fromHandle<MockBuffer>(buffer);
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements* pRequirements)
+        {
+            DriverScope scope;
+            pRequirements->size           = (fromHandle<MockBuffer>(buffer)->size + 255) / 256 * 256;
+            pRequirements->alignment      = 256;
+            pRequirements->memoryTypeBits = 0x3;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL BindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+        {
+            DriverScope scope;
+            MockBuffer* pBuffer   = fromHandle<MockBuffer>(buffer);
+            pBuffer->pMemory      = fromHandle<MockMemory>(memory);
+            pBuffer->memoryOffset = memoryOffset;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateImage(VkDevice                     device,
+                                                   const VkImageCreateInfo*     pCreateInfo,
+                                                   const VkAllocationCallbacks* pAllocator,
+                                                   VkImage*                     pImage)
+        {
+            DriverScope scope;
+
+            // the size of the image is stored as the object, GetImageMemoryRequirements returns it
+            VkDeviceSize size = VkDeviceSize(pCreateInfo->extent.width) * pCreateInfo->extent.height * pCreateInfo->extent.depth
+                                * pCreateInfo->arrayLayers * 8 * (pCreateInfo->mipLevels > 1 ? 2 : 1);
+            *pImage = createObject<VkImage>(size);
+            statistics.liveImages++;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            if (image == VK_NULL_HANDLE)
+            {
+                return;
+            }
+            destroyObject(image);
+            statistics.liveImages--;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL GetImageMemoryRequirements(VkDevice device, VkImage image, VkMemoryRequirements* pRequirements)
+        {
+            DriverScope scope;
+            pRequirements->size           = (fromHandle<MockObject>(image)->value + 1023) / 1024 * 1024;
+            pRequirements->alignment      = 1024;
+            pRequirements->memoryTypeBits = 0x3;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL BindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+        {
+            DriverScope scope;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateFence(VkDevice                     device,
+                                                   const VkFenceCreateInfo*     pCreateInfo,
+                                                   const VkAllocationCallbacks* pAllocator,
+                                                   VkFence*                     pFence)
+        {
+            DriverScope scope;
+            *pFence = toHandle<VkFence>(new MockFence{(pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0, false});
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            if (fence == VK_NULL_HANDLE)
+            {
+                return;
+            }
+            MockFence* pFence = fromHandle<MockFence>(fence);
+            if (pFence->pending)
+            {
+                validationError("a fence got destroyed while its submit is in flight");
+                executeUntil(pFence);
+            }
+            delete pFence;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL ResetFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences)
+        {
+            DriverScope scope;
+            for (uint32_t i = 0; i < fenceCount; i++)
+            {
+                MockFence* pFence = fromHandle<MockFence>(pFences[i]);
+                if (pFence->pending)
+                {
+                    validationError("a fence got reset while its submit is in flight");
+                    executeUntil(pFence);
+                }
+                pFence->signaled = false;
+            }
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL GetFenceStatus(VkDevice device, VkFence fence)
+        {
+            DriverScope scope;
+            // polling lets the gpu finish, otherwise polling would never see the fence signaled
+            return executeUntil(fromHandle<MockFence>(fence)) ? VK_SUCCESS : VK_NOT_READY;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL
+        WaitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+        {
+            DriverScope scope;
+            for (uint32_t i = 0; i < fenceCount; i++)
+            {
+                if (!executeUntil(fromHandle<MockFence>(pFences[i])))
+                {
+                    // nothing will signal the fence anymore, a real driver would block the thread forever
+                    statistics.blockedWaits++;
+                    std::fprintf(stderr, "mock driver: waiting on a fence that never gets signaled\n");
+                    return VK_TIMEOUT;
+                }
+            }
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateCommandPool(VkDevice                       device,
+                                                         const VkCommandPoolCreateInfo* pCreateInfo,
+                                                         const VkAllocationCallbacks*   pAllocator,
+                                                         VkCommandPool*                 pCommandPool)
+        {
+            DriverScope scope;
+            *pCommandPool = toHandle<VkCommandPool>(new MockCommandPool);
+            return VK_SUCCESS;
+        }
+
+        void freeCommandBuffer(MockCommandBuffer* pCommandBuffer)
+        {
+            if (pCommandBuffer->pendingCount)
+            {
+                validationError("a command buffer got freed while it is in flight");
+                executeAll();
+            }
+            pCommandBuffer->pPool->commandBuffers.erase(pCommandBuffer);
+            delete pCommandBuffer;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            if (commandPool == VK_NULL_HANDLE)
+            {
+                return;
+            }
+            MockCommandPool* pPool = fromHandle<MockCommandPool>(commandPool);
+            while (!pPool->commandBuffers.empty())
+            {
+                freeCommandBuffer(*pPool->commandBuffers.begin());
+            }
+            delete pPool;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice                           device,
+                                                              const VkCommandBufferAllocateInfo* pAllocateInfo,
+                                                              VkCommandBuffer*                   pCommandBuffers)
+        {
+            DriverScope scope;
+            MockCommandPool* pPool = fromHandle<MockCommandPool>(pAllocateInfo->commandPool);
+            for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++)
+            {
+                MockCommandBuffer* pCommandBuffer = new MockCommandBuffer();
+                pCommandBuffer->loaderData        = reinterpret_cast<DispatchableObject*>(device)->loaderData;
+                pCommandBuffer->pPool             = pPool;
+                pPool->commandBuffers.insert(pCommandBuffer);
+                pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(pCommandBuffer);
+            }
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL FreeCommandBuffers(VkDevice               device,
+                                                      VkCommandPool          commandPool,
+                                                      uint32_t               commandBufferCount,
+                                                      const VkCommandBuffer* pCommandBuffers)
+        {
+            DriverScope scope;
+            for (uint32_t i = 0; i < commandBufferCount; i++)
+            {
+                if (pCommandBuffers[i] != VK_NULL_HANDLE)
+                {
+                    freeCommandBuffer(reinterpret_cast<MockCommandBuffer*>(pCommandBuffers[i]));
+                }
+            }
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo)
+        {
+            DriverScope        scope;
+            MockCommandBuffer* pCommandBuffer = reinterpret_cast<MockCommandBuffer*>(commandBuffer);
+            if (pCommandBuffer->pendingCount)
+            {
+                validationError("a command buffer got recorded while it is in flight");
+            }
+            pCommandBuffer->recording = true;
+            pCommandBuffer->commands  = {};
+            pCommandBuffer->uniformReads.clear();
+            pCommandBuffer->queryCommands.clear();
+            pCommandBuffer->renderPassStencil = {};
+            pCommandBuffer->graphicsPipeline  = {};
+            pCommandBuffer->stencilDraws.clear();
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL EndCommandBuffer(VkCommandBuffer commandBuffer)
+        {
+            DriverScope scope;
+            reinterpret_cast<MockCommandBuffer*>(commandBuffer)->recording = false;
+            return VK_SUCCESS;
+        }
+
+        MockCommands& recordedCommands(VkCommandBuffer commandBuffer)
+        {
+            MockCommandBuffer* pCommandBuffer = reinterpret_cast<MockCommandBuffer*>(commandBuffer);
+            if (!pCommandBuffer->recording)
+            {
+                validationError("a command got recorded outside of vkBeginCommandBuffer and vkEndCommandBuffer");
+            }
+            return pCommandBuffer->commands;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdPipelineBarrier(VkCommandBuffer              commandBuffer,
+                                                      VkPipelineStageFlags         srcStageMask,
+                                                      VkPipelineStageFlags         dstStageMask,
+                                                      VkDependencyFlags            dependencyFlags,
+                                                      uint32_t                     memoryBarrierCount,
+                                                      const VkMemoryBarrier*       pMemoryBarriers,
+                                                      uint32_t                     bufferMemoryBarrierCount,
+                                                      const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+                                                      uint32_t                     imageMemoryBarrierCount,
+                                                      const VkImageMemoryBarrier*  pImageMemoryBarriers)
+        {
+            DriverScope   scope;
+            MockCommands& commands = recordedCommands(commandBuffer);
+            commands.pipelineBarriers++;
+            commands.imageBarriers += imageMemoryBarrierCount;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdBeginRenderPass(VkCommandBuffer              commandBuffer,
+                                                      const VkRenderPassBeginInfo* pRenderPassBegin,
+                                                      VkSubpassContents            contents)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).renderPasses++;
+
+            MockRenderPass*  pRenderPass = fromHandle<MockRenderPass>(pRenderPassBegin->renderPass);
+            MockStencilDraw& stencil     = reinterpret_cast<MockCommandBuffer*>(commandBuffer)->renderPassStencil;
+            stencil                      = {};
+            stencil.stencilAttachment    = pRenderPass->stencilAttachment;
+            stencil.stencilLoadOp        = pRenderPass->stencilLoadOp;
+            stencil.stencilStoreOp       = pRenderPass->stencilStoreOp;
+            if (pRenderPass->stencilAttachment && pRenderPass->stencilLoadOp == VK_ATTACHMENT_LOAD_OP_CLEAR)
+            {
+                if (pRenderPass->attachment >= pRenderPassBegin->clearValueCount)
+                {
+                    validationError("a render pass that clears got begun without a clear value for the stencil");
+                }
+                else
+                {
+                    stencil.stencilClearValue = pRenderPassBegin->pClearValues[pRenderPass->attachment].depthStencil.stencil;
+                }
+            }
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdEndRenderPass(VkCommandBuffer commandBuffer)
+        {
+            DriverScope scope;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL
+        CmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).draws++;
+
+            MockCommandBuffer* pCommandBuffer = reinterpret_cast<MockCommandBuffer*>(commandBuffer);
+            MockStencilDraw    draw           = pCommandBuffer->renderPassStencil;
+            draw.stencilTestEnable            = pCommandBuffer->graphicsPipeline.stencilTestEnable;
+            draw.front                        = pCommandBuffer->graphicsPipeline.front;
+            draw.back                         = pCommandBuffer->graphicsPipeline.back;
+            pCommandBuffer->stencilDraws.push_back(draw);
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).dispatches++;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdBlitImage(VkCommandBuffer    commandBuffer,
+                                                VkImage            srcImage,
+                                                VkImageLayout      srcImageLayout,
+                                                VkImage            dstImage,
+                                                VkImageLayout      dstImageLayout,
+                                                uint32_t           regionCount,
+                                                const VkImageBlit* pRegions,
+                                                VkFilter           filter)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).blits++;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdCopyImage(VkCommandBuffer    commandBuffer,
+                                                VkImage            srcImage,
+                                                VkImageLayout      srcImageLayout,
+                                                VkImage            dstImage,
+                                                VkImageLayout      dstImageLayout,
+                                                uint32_t           regionCount,
+                                                const VkImageCopy* pRegions)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).copies++;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdCopyBufferToImage(VkCommandBuffer          commandBuffer,
+                                                        VkBuffer                 srcBuffer,
+                                                        VkImage                  dstImage,
+                                                        VkImageLayout            dstImageLayout,
+                                                        uint32_t                 regionCount,
+                                                        const VkBufferImageCopy* pRegions)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).copies++;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL
+        CmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer);
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer);
+            if (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS)
+            {
+                reinterpret_cast<MockCommandBuffer*>(commandBuffer)->graphicsPipeline = *fromHandle<MockPipeline>(pipeline);
+            }
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdBindDescriptorSets(VkCommandBuffer        commandBuffer,
+                                                         VkPipelineBindPoint    pipelineBindPoint,
+                                                         VkPipelineLayout       layout,
+                                                         uint32_t               firstSet,
+                                                         uint32_t               descriptorSetCount,
+                                                         const VkDescriptorSet* pDescriptorSets,
+                                                         uint32_t               dynamicOffsetCount,
+                                                         const uint32_t*        pDynamicOffsets)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer);
+
+            // remember which bytes of host visible memory the commands after this read
+            MockCommandBuffer* pCommandBuffer = reinterpret_cast<MockCommandBuffer*>(commandBuffer);
+            uint32_t           dynamicOffset  = 0;
+            for (uint32_t i = 0; i < descriptorSetCount; i++)
+            {
+                for (const auto& [binding, dynamicBuffer] : fromHandle<MockDescriptorSet>(pDescriptorSets[i])->dynamicBuffers)
+                {
+                    if (dynamicOffset >= dynamicOffsetCount)
+                    {
+                        validationError("missing dynamic offset for binding " + std::to_string(binding));
+                        return;
+                    }
+                    MockMemory* pMemory = dynamicBuffer.pBuffer->pMemory;
+                    if (pMemory && pMemory->hostVisible)
+                    {
+                        VkDeviceSize offset = dynamicBuffer.pBuffer->memoryOffset + dynamicBuffer.offset + pDynamicOffsets[dynamicOffset];
+                        VkDeviceSize size   = std::min(dynamicBuffer.range, pMemory->size - offset);
+                        pCommandBuffer->uniformReads.push_back({pMemory, offset, size});
+                    }
+                    dynamicOffset++;
+                }
+            }
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer);
+            reinterpret_cast<MockCommandBuffer*>(commandBuffer)
+                ->queryCommands.push_back({fromHandle<MockQueryPool>(queryPool), firstQuery, queryCount});
+        }
+
+        VKAPI_ATTR void VKAPI_CALL CmdWriteTimestamp(VkCommandBuffer         commandBuffer,
+                                                     VkPipelineStageFlagBits pipelineStage,
+                                                     VkQueryPool             queryPool,
+                                                     uint32_t                query)
+        {
+            DriverScope scope;
+            recordedCommands(commandBuffer).timestamps++;
+            reinterpret_cast<MockCommandBuffer*>(commandBuffer)->queryCommands.push_back({fromHandle<MockQueryPool>(queryPool), query, 0});
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateQueryPool(VkDevice                     device,
+                                                       const VkQueryPoolCreateInfo* pCreateInfo,
+                                                       const VkAllocationCallbacks* pAllocator,
+                                                       VkQueryPool*                 pQueryPool)
+        {
+            DriverScope    scope;
+            MockQueryPool* pPool = new MockQueryPool;
+            pPool->values.resize(pCreateInfo->queryCount, 0);
+            pPool->available.resize(pCreateInfo->queryCount, false);
+            *pQueryPool = toHandle<VkQueryPool>(pPool);
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            delete fromHandle<MockQueryPool>(queryPool);
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL GetQueryPoolResults(VkDevice           device,
+                                                           VkQueryPool        queryPool,
+                                                           uint32_t           firstQuery,
+                                                           uint32_t           queryCount,
+                                                           size_t             dataSize,
+                                                           void*              pData,
+                                                           VkDeviceSize       stride,
+                                                           VkQueryResultFlags flags)
+        {
+            DriverScope scope;
+            if (!(flags & VK_QUERY_RESULT_64_BIT))
+            {
+                validationError("the mock only returns 64 bit query results");
+                return VK_ERROR_FEATURE_NOT_PRESENT;
+            }
+
+            MockQueryPool* pPool  = fromHandle<MockQueryPool>(queryPool);
+            VkResult       result = VK_SUCCESS;
+            for (uint32_t i = 0; i < queryCount; i++)
+            {
+                uint64_t* pResult   = reinterpret_cast<uint64_t*>(static_cast<char*>(pData) + stride * i);
+                bool      available = pPool->available[firstQuery + i];
+                if (available)
+                {
+                    pResult[0] = pPool->values[firstQuery + i];
+                }
+                else
+                {
+                    result = VK_NOT_READY;
+                }
+                if (flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT)
+                {
+                    pResult[1] = available;
+                }
+            }
+            return result;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL AllocateDescriptorSets(VkDevice                           device,
+                                                              const VkDescriptorSetAllocateInfo* pAllocateInfo,
+                                                              VkDescriptorSet*                   pDescriptorSets)
+        {
+            DriverScope         scope;
+            MockDescriptorPool* pPool = fromHandle<MockDescriptorPool>(pAllocateInfo->descriptorPool);
+            for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++)
+            {
+                pPool->sets.push_back(new MockDescriptorSet);
+                pDescriptorSets[i] = toHandle<VkDescriptorSet>(pPool->sets.back());
+            }
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL UpdateDescriptorSets(VkDevice                    device,
+                                                        uint32_t                    descriptorWriteCount,
+                                                        const VkWriteDescriptorSet* pDescriptorWrites,
+                                                        uint32_t                    descriptorCopyCount,
+                                                        const VkCopyDescriptorSet*  pDescriptorCopies)
+        {
+            DriverScope scope;
+            for (uint32_t i = 0; i < descriptorWriteCount; i++)
+            {
+                const VkWriteDescriptorSet& write = pDescriptorWrites[i];
+                if (write.descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+                {
+                    continue;
+                }
+                for (uint32_t j = 0; j < write.descriptorCount; j++)
+                {
+                    const VkDescriptorBufferInfo& info = write.pBufferInfo[j];
+                    fromHandle<MockDescriptorSet>(write.dstSet)->dynamicBuffers[write.dstBinding + j] = {
+                        fromHandle<MockBuffer>(info.buffer), info.offset, info.range};
+                }
+            }
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateDescriptorPool(VkDevice                          device,
+                                                            const VkDescriptorPoolCreateInfo* pCreateInfo,
+                                                            const VkAllocationCallbacks*      pAllocator,
+                                                            VkDescriptorPool*                 pDescriptorPool)
+        {
+            DriverScope scope;
+            *pDescriptorPool = toHandle<VkDescriptorPool>(new MockDescriptorPool);
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope         scope;
+            MockDescriptorPool* pPool = fromHandle<MockDescriptorPool>(descriptorPool);
+            if (pPool == nullptr)
+            {
+                return;
+            }
+            for (MockDescriptorSet* pSet : pPool->sets)
+            {
+                delete pSet;
+            }
+            delete pPool;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateSwapchainKHR(VkDevice                        device,
+                                                          const VkSwapchainCreateInfoKHR* pCreateInfo,
+                                                          const VkAllocationCallbacks*    pAllocator,
+                                                          VkSwapchainKHR*                 pSwapchain)
+        {
+            DriverScope    scope;
+            MockSwapchain* pMockSwapchain = new MockSwapchain;
+            statistics.swapchainUsage     = pCreateInfo->imageUsage;
+            for (uint32_t i = 0; i < settings.swapchainImageCount; i++)
+            {
+                pMockSwapchain->images.push_back(createObject<VkImage>(0));
+            }
+            *pSwapchain = toHandle<VkSwapchainKHR>(pMockSwapchain);
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope    scope;
+            MockSwapchain* pMockSwapchain = fromHandle<MockSwapchain>(swapchain);
+            for (VkImage image : pMockSwapchain->images)
+            {
+                destroyObject(image);
+            }
+            delete pMockSwapchain;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t* pCount, VkImage* pImages)
+        {
+            DriverScope    scope;
+            MockSwapchain* pMockSwapchain = fromHandle<MockSwapchain>(swapchain);
+            if (pImages)
+            {
+                for (uint32_t i = 0; i < *pCount && i < pMockSwapchain->images.size(); i++)
+                {
+                    pImages[i] = pMockSwapchain->images[i];
+                }
+            }
+            *pCount = pMockSwapchain->images.size();
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+        {
+            DriverScope scope;
+            if (settings.failingSubmits)
+            {
+                settings.failingSubmits--;
+                return VK_ERROR_DEVICE_LOST;
+            }
+
+            Submission submission;
+            submission.pFence = fromHandle<MockFence>(fence);
+            if (submission.pFence)
+            {
+                if (submission.pFence->signaled || submission.pFence->pending)
+                {
+                    validationError("a fence got submitted that is not unsignaled");
+                }
+                submission.pFence->signaled = false;
+                submission.pFence->pending  = true;
+            }
+
+            for (uint32_t i = 0; i < submitCount; i++)
+            {
+                for (uint32_t j = 0; j < pSubmits[i].commandBufferCount; j++)
+                {
+                    MockCommandBuffer* pCommandBuffer = reinterpret_cast<MockCommandBuffer*>(pSubmits[i].pCommandBuffers[j]);
+                    if (pCommandBuffer->recording)
+                    {
+                        validationError("a command buffer got submitted that is still recording");
+                    }
+                    pCommandBuffer->pendingCount++;
+                    submission.commandBuffers.push_back(pCommandBuffer);
+                    addCommands(statistics.submitted, pCommandBuffer->commands);
+                    statistics.submittedCommandBuffers++;
+
+                    // the gpu reads the uniforms whenever it gets to them, so they have to stay the same until the submit is done
+                    for (const UniformRead& read : pCommandBuffer->uniformReads)
+                    {
+                        const char* pRead = read.pMemory->pData + read.offset;
+                        submission.uniformSnapshots.emplace_back(read, std::vector<char>(pRead, pRead + read.size));
+                    }
+                }
+            }
+            statistics.submits++;
+
+            submissions.push_back(std::move(submission));
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL QueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+        {
+            DriverScope scope;
+            statistics.presents++;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL QueueWaitIdle(VkQueue queue)
+        {
+            DriverScope scope;
+            executeAll();
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL DeviceWaitIdle(VkDevice device)
+        {
+            DriverScope scope;
+            executeAll();
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL GetPipelineCacheData(VkDevice device, VkPipelineCache pipelineCache, size_t* pDataSize, void* pData)
+        {
+            DriverScope scope;
+            *pDataSize = 0;
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateGraphicsPipelines(VkDevice                            device,
+                                                               VkPipelineCache                     pipelineCache,
+                                                               uint32_t                            createInfoCount,
+                                                               const VkGraphicsPipelineCreateInfo* pCreateInfos,
+                                                               const VkAllocationCallbacks*        pAllocator,
+                                                               VkPipeline*                         pPipelines)
+        {
+            std::function<void()> hook;
+            {
+                DriverScope scope;
+                for (uint32_t i = 0; i < createInfoCount; i++)
+                {
+                    MockPipeline* pPipeline = new MockPipeline{};
+                    if (const VkPipelineDepthStencilStateCreateInfo* pDepthStencilState = pCreateInfos[i].pDepthStencilState)
+                    {
+                        pPipeline->stencilTestEnable = pDepthStencilState->stencilTestEnable;
+                        pPipeline->front             = pDepthStencilState->front;
+                        pPipeline->back              = pDepthStencilState->back;
+                    }
+                    pPipelines[i] = toHandle<VkPipeline>(pPipeline);
+                }
+                hook = settings.pipelineCreationHook;
+            }
+            if (hook)
+            {
+                hook();
+            }
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateComputePipelines(VkDevice                           device,
+                                                              VkPipelineCache                    pipelineCache,
+                                                              uint32_t                           createInfoCount,
+                                                              const VkComputePipelineCreateInfo* pCreateInfos,
+                                                              const VkAllocationCallbacks*       pAllocator,
+                                                              VkPipeline*                        pPipelines)
+        {
+            DriverScope scope;
+            for (uint32_t i = 0; i < createInfoCount; i++)
+            {
+                pPipelines[i] = toHandle<VkPipeline>(new MockPipeline{});
+            }
+            return VK_SUCCESS;
+        }
+
+// the objects that only need a handle
+#define MOCK_OBJECT_FUNCTIONS(Type)                                                                                                                  \
+    VKAPI_ATTR VkResult VKAPI_CALL Create##Type(                                                                                                     \
+        VkDevice device, const Vk##Type##CreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, Vk##Type* pObject)                        \
+    {                                                                                                                                                \
+        DriverScope scope;                                                                                                                           \
+        *pObject = createObject<Vk##Type>(0);                                                                                                        \
+        return VK_SUCCESS;                                                                                                                           \
+    }                                                                                                                                                \
+    VKAPI_ATTR void VKAPI_CALL Destroy##Type(VkDevice device, Vk##Type object, const VkAllocationCallbacks* pAllocator)                              \
+    {                                                                                                                                                \
+        DriverScope scope;                                                                                                                           \
+        if (object != VK_NULL_HANDLE)                                                                                                                \
+        {                                                                                                                                            \
+            destroyObject(object);                                                                                                                   \
+        }                                                                                                                                            \
+    }
+
+        MOCK_OBJECT_FUNCTIONS(ImageView)
+        MOCK_OBJECT_FUNCTIONS(Sampler)
+        MOCK_OBJECT_FUNCTIONS(ShaderModule)
+        MOCK_OBJECT_FUNCTIONS(PipelineCache)
+        MOCK_OBJECT_FUNCTIONS(PipelineLayout)
+        MOCK_OBJECT_FUNCTIONS(DescriptorSetLayout)
+        MOCK_OBJECT_FUNCTIONS(Framebuffer)
+        MOCK_OBJECT_FUNCTIONS(Semaphore)
+
+        VKAPI_ATTR void VKAPI_CALL DestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            delete fromHandle<MockPipeline>(pipeline);
+        }
+
+        VKAPI_ATTR VkResult VKAPI_CALL CreateRenderPass(VkDevice                      device,
+                                                        const VkRenderPassCreateInfo* pCreateInfo,
+                                                        const VkAllocationCallbacks*  pAllocator,
+                                                        VkRenderPass*                 pRenderPass)
+        {
+            DriverScope     scope;
+            MockRenderPass* pMockRenderPass = new MockRenderPass{};
+            if (pCreateInfo->subpassCount && pCreateInfo->pSubpasses[0].pDepthStencilAttachment)
+            {
+                uint32_t attachment = pCreateInfo->pSubpasses[0].pDepthStencilAttachment->attachment;
+                if (attachment != VK_ATTACHMENT_UNUSED)
+                {
+                    pMockRenderPass->stencilAttachment = true;
+                    pMockRenderPass->attachment        = attachment;
+                    pMockRenderPass->stencilLoadOp     = pCreateInfo->pAttachments[attachment].stencilLoadOp;
+                    pMockRenderPass->stencilStoreOp    = pCreateInfo->pAttachments[attachment].stencilStoreOp;
+                }
+            }
+            *pRenderPass = toHandle<VkRenderPass>(pMockRenderPass);
+            return VK_SUCCESS;
+        }
+
+        VKAPI_ATTR void VKAPI_CALL DestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks* pAllocator)
+        {
+            DriverScope scope;
+            delete fromHandle<MockRenderPass>(renderPass);
+        }
+
+#define MOCK_FUNCTION(name)                                                                                                                          \
+    if (!std::strcmp(pName, "vk" #name))                                                                                                             \
+        return (PFN_vkVoidFunction) &name;
+
+#define MOCK_DEVICE_FUNCTIONS                                                                                                                        \
+    MOCK_FUNCTION(DestroyDevice)                                                                                                                     \
+    MOCK_FUNCTION(GetDeviceQueue)                                                                                                                    \
+    MOCK_FUNCTION(GetDeviceQueue2)                                                                                                                   \
+    MOCK_FUNCTION(AllocateMemory)                                                                                                                    \
+    MOCK_FUNCTION(FreeMemory)                                                                                                                        \
+    MOCK_FUNCTION(MapMemory)                                                                                                                         \
+    MOCK_FUNCTION(UnmapMemory)                                                                                                                       \
+    MOCK_FUNCTION(CreateBuffer)                                                                                                                      \
+    MOCK_FUNCTION(DestroyBuffer)                                                                                                                     \
+    MOCK_FUNCTION(GetBufferMemoryRequirements)                                                                                                       \
+    MOCK_FUNCTION(BindBufferMemory)                                                                                                                  \
+    MOCK_FUNCTION(CreateImage)                                                                                                                       \
+    MOCK_FUNCTION(DestroyImage)                                                                                                                      \
+    MOCK_FUNCTION(GetImageMemoryRequirements)                                                                                                        \
+    MOCK_FUNCTION(BindImageMemory)                                                                                                                   \
+    MOCK_FUNCTION(CreateFence)                                                                                                                       \
+    MOCK_FUNCTION(DestroyFence)                                                                                                                      \
+    MOCK_FUNCTION(ResetFences)                                                                                                                       \
+    MOCK_FUNCTION(GetFenceStatus)                                                                                                                    \
+    MOCK_FUNCTION(WaitForFences)                                                                                                                     \
+    MOCK_FUNCTION(CreateCommandPool)                                                                                                                 \
+    MOCK_FUNCTION(DestroyCommandPool)                                                                                                                \
+    MOCK_FUNCTION(AllocateCommandBuffers)                                                                                                            \
+    MOCK_FUNCTION(FreeCommandBuffers)                                                                                                                \
+    MOCK_FUNCTION(BeginCommandBuffer)                                                                                                                \
+    MOCK_FUNCTION(EndCommandBuffer)                                                                                                                  \
+    MOCK_FUNCTION(CmdPipelineBarrier)                                                                                                                \
+    MOCK_FUNCTION(CmdBeginRenderPass)                                                                                                                \
+    MOCK_FUNCTION(CmdEndRenderPass)                                                                                                                  \
+    MOCK_FUNCTION(CmdDraw)                                                                                                                           \
+    MOCK_FUNCTION(CmdDispatch)                                                                                                                       \
+    MOCK_FUNCTION(CmdBlitImage)                                                                                                                      \
+    MOCK_FUNCTION(CmdCopyImage)                                                                                                                      \
+    MOCK_FUNCTION(CmdCopyBufferToImage)                                                                                                              \
+    MOCK_FUNCTION(CmdFillBuffer)                                                                                                                     \
+    MOCK_FUNCTION(CmdBindPipeline)                                                                                                                   \
+    MOCK_FUNCTION(CmdBindDescriptorSets)                                                                                                             \
+    MOCK_FUNCTION(CmdResetQueryPool)                                                                                                                 \
+    MOCK_FUNCTION(CmdWriteTimestamp)                                                                                                                 \
+    MOCK_FUNCTION(CreateQueryPool)                                                                                                                   \
+    MOCK_FUNCTION(DestroyQueryPool)                                                                                                                  \
+    MOCK_FUNCTION(GetQueryPoolResults)                                                                                                               \
+    MOCK_FUNCTION(AllocateDescriptorSets)                                                                                                            \
+    MOCK_FUNCTION(UpdateDescriptorSets)                                                                                                              \
+    MOCK_FUNCTION(CreateDescriptorPool)                                                                                                              \
+    MOCK_FUNCTION(DestroyDescriptorPool)                                                                                                             \
+    MOCK_FUNCTION(CreateSwapchainKHR)                                                                                                                \
+    MOCK_FUNCTION(DestroySwapchainKHR)                                                                                                               \
+    MOCK_FUNCTION(GetSwapchainImagesKHR)                                                                                                             \
+    MOCK_FUNCTION(QueueSubmit)                                                                                                                       \
+    MOCK_FUNCTION(QueuePresentKHR)                                                                                                                   \
+    MOCK_FUNCTION(QueueWaitIdle)                                                                                                                     \
+    MOCK_FUNCTION(DeviceWaitIdle)                                                                                                                    \
+    MOCK_FUNCTION(GetPipelineCacheData)                                                                                                              \
+    MOCK_FUNCTION(CreateGraphicsPipelines)                                                                                                           \
+    MOCK_FUNCTION(CreateComputePipelines)                                                                                                            \
+    MOCK_FUNCTION(DestroyPipeline)                                                                                                                   \
+    MOCK_FUNCTION(CreateImageView)                                                                                                                   \
+    MOCK_FUNCTION(DestroyImageView)                                                                                                                  \
+    MOCK_FUNCTION(CreateSampler)                                                                                                                     \
+    MOCK_FUNCTION(DestroySampler)                                                                                                                    \
+    MOCK_FUNCTION(CreateShaderModule)                                                                                                                \
+    MOCK_FUNCTION(DestroyShaderModule)                                                                                                               \
+    MOCK_FUNCTION(CreatePipelineCache)                                                                                                               \
+    MOCK_FUNCTION(DestroyPipelineCache)                                                                                                              \
+    MOCK_FUNCTION(CreatePipelineLayout)                                                                                                              \
+    MOCK_FUNCTION(DestroyPipelineLayout)                                                                                                             \
+    MOCK_FUNCTION(CreateDescriptorSetLayout)                                                                                                         \
+    MOCK_FUNCTION(DestroyDescriptorSetLayout)                                                                                                        \
+    MOCK_FUNCTION(CreateRenderPass)                                                                                                                  \
+    MOCK_FUNCTION(DestroyRenderPass)                                                                                                                 \
+    MOCK_FUNCTION(CreateFramebuffer)                                                                                                                 \
+    MOCK_FUNCTION(DestroyFramebuffer)                                                                                                                \
+    MOCK_FUNCTION(CreateSemaphore)                                                                                                                   \
+    MOCK_FUNCTION(DestroySemaphore)
+    } // namespace
+
+    MockSettings& getMockSettings()
+    {
+        return settings;
+    }
+
+    MockStatistics getMockStatistics()
+    {
+        DriverScope scope;
+        return statistics;
+    }
+
+    void resetMock()
+    {
+        DriverScope scope;
+        executeAll();
+        settings   = defaultSettings();
+        statistics = {};
+    }
+
+    MockCommands getRecordedCommands(VkCommandBuffer commandBuffer)
+    {
+        DriverScope scope;
+        return reinterpret_cast<MockCommandBuffer*>(commandBuffer)->commands;
+    }
+
+    std::vector<MockStencilDraw> getRecordedStencilDraws(VkCommandBuffer commandBuffer)
+    {
+        DriverScope scope;
+        return reinterpret_cast<MockCommandBuffer*>(commandBuffer)->stencilDraws;
+    }
+
+    void completeMockQueue()
+    {
+        DriverScope scope;
+        executeAll();
+    }
+
+    bool isInsideMockDriver()
+    {
+        return driverDepth > 0;
+    }
+
+    PFN_vkVoidFunction VKAPI_CALL getMockDeviceProcAddr(VkDevice device, const char* pName)
+    {
+        if (!std::strcmp(pName, "vkGetDeviceProcAddr"))
+            return (PFN_vkVoidFunction) &getMockDeviceProcAddr;
+        MOCK_DEVICE_FUNCTIONS
+        return nullptr;
+    }
+
+    PFN_vkVoidFunction VKAPI_CALL getMockInstanceProcAddr(VkInstance instance, const char* pName)
+    {
+        if (!std::strcmp(pName, "vkGetInstanceProcAddr"))
+            return (PFN_vkVoidFunction) &getMockInstanceProcAddr;
+        if (!std::strcmp(pName, "vkGetDeviceProcAddr"))
+            return (PFN_vkVoidFunction) &getMockDeviceProcAddr;
+        MOCK_FUNCTION(CreateInstance)
+        MOCK_FUNCTION(DestroyInstance)
+        MOCK_FUNCTION(EnumeratePhysicalDevices)
+        MOCK_FUNCTION(GetPhysicalDeviceFeatures)
+        MOCK_FUNCTION(GetPhysicalDeviceProperties)
+        MOCK_FUNCTION(GetPhysicalDeviceMemoryProperties)
+        MOCK_FUNCTION(GetPhysicalDeviceFormatProperties)
+        MOCK_FUNCTION(GetPhysicalDeviceQueueFamilyProperties)
+        MOCK_FUNCTION(GetPhysicalDeviceSurfaceCapabilitiesKHR)
+        MOCK_FUNCTION(EnumerateDeviceExtensionProperties)
+        MOCK_FUNCTION(CreateDevice)
+        MOCK_DEVICE_FUNCTIONS
+        return nullptr;
+    }
+} // namespace vkBasalt::test
@@ -0,0 +1,107 @@
+#ifndef MOCK_VULKAN_HPP_INCLUDED
+#define MOCK_VULKAN_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <set>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+#include "vulkan_include.hpp"
+
+namespace vkBasalt::test
+{
+    // A driver that implements the vulkan functions the layer uses on the cpu, so that the layer can be tested without a gpu.
+    // Nothing gets rendered, but the mock keeps the state that the tests look at: the commands in every command buffer,
+    // the fences and what the submits of the queue read. The queue executes its submits lazily, a submit only completes when
+    // a fence it signals gets waited on or when completeMockQueue is called, so anything that touches memory or objects of a
+    // submit that is still in flight is seen by the mock. Every misuse the mock detects counts as a validation error.
+    // All functions are thread safe.
+
+    // what the mock physical device reports, tests change it before they create the instance
+    struct MockSettings
+    {
+        VkPhysicalDeviceFeatures features;
+        std::vector<std::string> deviceExtensions;
+        VkFormatFeatureFlags     optimalTilingFeatures;
+        VkImageUsageFlags        surfaceUsage;
+        uint32_t                 swapchainImageCount;
+        VkDeviceSize             minUniformBufferOffsetAlignment;
+        uint32_t                 timestampValidBits;
+        float                    timestampPeriod;
+        // the value the next executed timestamp writes and the amount it grows per timestamp, both get masked by timestampValidBits
+        uint64_t nextTimestamp;
+        uint64_t timestampStep;
+        // the next failingSubmits calls of vkQueueSubmit return VK_ERROR_DEVICE_LOST without doing anything
+        uint32_t failingSubmits;
+        // gets called without the driver lock after a graphics pipeline got created, so tests can run code while the layer creates effects
+        std::function<void()> pipelineCreationHook;
+    };
+
+    // the commands of a command buffer, or of everything that got submitted
+    struct MockCommands
+    {
+        uint64_t pipelineBarriers;
+        uint64_t imageBarriers;
+        uint64_t renderPasses;
+        uint64_t draws;
+        uint64_t dispatches;
+        uint64_t blits;
+        uint64_t copies;
+        uint64_t timestamps;
+    };
+
+    // the stencil state a draw ran with, the depth stencil attachment of the subpass and the stencil test of the bound graphics pipeline
+    struct MockStencilDraw
+    {
+        bool                stencilAttachment;
+        VkAttachmentLoadOp  stencilLoadOp;
+        VkAttachmentStoreOp stencilStoreOp;
+        // the stencil value of the clear value of the attachment, only set with VK_ATTACHMENT_LOAD_OP_CLEAR
+        uint32_t         stencilClearValue;
+        VkBool32         stencilTestEnable;
+        VkStencilOpState front;
+        VkStencilOpState back;
+    };
+
+    struct MockStatistics
+    {
+        MockCommands submitted;
+        uint64_t     submits;
+        uint64_t     submittedCommandBuffers;
+        uint64_t     presents;
+        uint64_t     liveMemoryAllocations;
+        uint64_t     liveImages;
+        // misuse like resetting a fence that is in flight or freeing a command buffer that is in flight
+        uint64_t validationErrors;
+        // waits on a fence that nothing will ever signal, a real driver would wait forever
+        uint64_t blockedWaits;
+        // bytes of dynamic uniform buffers that got written by the cpu while a submit that reads them was in flight
+        uint64_t overwrittenUniformBytes;
+        // what the last vkCreateDevice enabled
+        std::vector<std::string> enabledExtensions;
+        VkPhysicalDeviceFeatures enabledFeatures;
+        // the usage the images of the last vkCreateSwapchainKHR got created with
+        VkImageUsageFlags swapchainUsage;
+    };
+
+    MockSettings&  getMockSettings();
+    MockStatistics getMockStatistics();
+    // sets the settings and statistics back to the default, all mock objects have to be destroyed
+    void resetMock();
+
+    MockCommands getRecordedCommands(VkCommandBuffer commandBuffer);
+    // one entry per draw of the command buffer, in the order they got recorded
+    std::vector<MockStencilDraw> getRecordedStencilDraws(VkCommandBuffer commandBuffer);
+
+    // executes everything that got submitted so far
+    void completeMockQueue();
+
+    // true while the calling thread is inside of a function of the mock driver
+    bool isInsideMockDriver();
+
+    PFN_vkVoidFunction VKAPI_CALL getMockInstanceProcAddr(VkInstance instance, const char* pName);
+    PFN_vkVoidFunction VKAPI_CALL getMockDeviceProcAddr(VkDevice device, const char* pName);
+} // namespace vkBasalt::test
+
+#endif // MOCK_VULKAN_HPP_INCLUDED
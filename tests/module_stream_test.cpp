@@ -0,0 +1,170 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "module_stream.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+
+namespace
+{
+    const char     magic[8]      = {'v', 'k', 'B', 'T', 'E', 'S', 'T', '0'};
+    const uint32_t formatVersion = 3;
+    const uint64_t key           = 0x0123456789abcdefull;
+
+    // nested like the techniques of a reshade module: strings, a trivially copyable vector and a vector of structs
+    struct Pass
+    {
+        std::string           name;
+        std::vector<uint32_t> code;
+        uint32_t              flags;
+    };
+
+    struct Technique
+    {
+        std::string       name;
+        std::vector<Pass> passes;
+    };
+
+    class TestWriter : public ModuleWriter<TestWriter>
+    {
+    public:
+        using ModuleWriter::write;
+
+        void write(const Pass& value)
+        {
+            write(value.name);
+            write(value.code);
+            write(value.flags);
+        }
+
+        void write(const Technique& value)
+        {
+            write(value.name);
+            write(value.passes);
+        }
+    };
+
+    class TestReader : public ModuleReader<TestReader>
+    {
+    public:
+        using ModuleReader::ModuleReader;
+        using ModuleReader::read;
+
+        void read(Pass& value)
+        {
+            read(value.name);
+            read(value.code);
+            read(value.flags);
+        }
+
+        void read(Technique& value)
+        {
+            read(value.name);
+            read(value.passes);
+        }
+    };
+
+    std::vector<Technique> createTechniques()
+    {
+        return {{"Sharpen", {{"Edges", {0x07230203, 1, 2, 3}, 1}, {"", {}, 0}}}, {"Bloom", {{"Downsample", {4, 5}, 2}}}};
+    }
+
+    std::vector<char> writeFile(const std::vector<Technique>& techniques)
+    {
+        TestWriter writer;
+        writer.writeHeader(magic, formatVersion, key);
+        writer.write(techniques);
+        writer.write<uint32_t>(64);
+        return writer.data;
+    }
+
+    // reads the file like loadReshadeModule does, false if the reader has to ignore it
+    bool readFile(const std::vector<char>& data, std::vector<Technique>& techniques)
+    {
+        uint32_t   uniformSize = 0;
+        TestReader reader(data);
+        reader.readHeader(magic, formatVersion, key);
+        reader.read(techniques);
+        reader.read(uniformSize);
+        return !reader.failed && reader.atEnd() && uniformSize == 64;
+    }
+} // namespace
+
+TEST(roundTrip)
+{
+    std::vector<Technique> techniques = createTechniques();
+    std::vector<Technique> result;
+    CHECK(readFile(writeFile(techniques), result));
+
+    CHECK(result.size() == techniques.size());
+    for (size_t i = 0; i < result.size() && i < techniques.size(); i++)
+    {
+        CHECK(result[i].name == techniques[i].name);
+        CHECK(result[i].passes.size() == techniques[i].passes.size());
+        for (size_t j = 0; j < result[i].passes.size() && j < techniques[i].passes.size(); j++)
+        {
+            CHECK(result[i].passes[j].name == techniques[i].passes[j].name);
+            CHECK(result[i].passes[j].code == techniques[i].passes[j].code);
+            CHECK(result[i].passes[j].flags == techniques[i].passes[j].flags);
+        }
+    }
+}
+
+// a file that got cut off anywhere, like by a full disk, must not be read past its end
+TEST(truncatedFilesGetIgnored)
+{
+    std::vector<char> data = writeFile(createTechniques());
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        std::vector<Technique> result;
+        CHECK(!readFile(std::vector<char>(data.begin(), data.begin() + size), result));
+    }
+
+    // as well as a file that is longer than what got written
+    data.push_back(0);
+    std::vector<Technique> result;
+    CHECK(!readFile(data, result));
+}
+
+// a file of another version or key, or with a damaged header, belongs to something else
+TEST(foreignHeadersGetIgnored)
+{
+    const std::vector<char> data       = writeFile(createTechniques());
+    const size_t            headerSize = sizeof(magic) + sizeof(formatVersion) + sizeof(key);
+    for (size_t i = 0; i < headerSize; i++)
+    {
+        std::vector<char> corrupted = data;
+        corrupted[i] ^= 0x10;
+        std::vector<Technique> result;
+        CHECK(!readFile(corrupted, result));
+    }
+}
+
+// sizes that don't fit into the file must neither allocate nor read, every byte of the body gets changed once
+TEST(corruptSizesGetIgnored)
+{
+    const std::vector<char> data       = writeFile(createTechniques());
+    const size_t            headerSize = sizeof(magic) + sizeof(formatVersion) + sizeof(key);
+
+    // the count of the techniques, a count that would allocate petabytes if the reader trusted it
+    std::vector<char> corrupted = data;
+    uint64_t          count     = UINT64_MAX / 2;
+    std::memcpy(corrupted.data() + headerSize, &count, sizeof(count));
+    std::vector<Technique> result;
+    CHECK(!readFile(corrupted, result));
+    CHECK(result.empty());
+
+    for (size_t i = headerSize; i < data.size(); i++)
+    {
+        for (char value : {char(0x7f), char(0xff)})
+        {
+            corrupted    = data;
+            corrupted[i] = value;
+            // the content of strings and code can change without the file getting shorter or longer, all that counts is not crashing
+            readFile(corrupted, result);
+        }
+    }
+}
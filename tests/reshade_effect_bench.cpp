@@ -0,0 +1,158 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mock_device.hpp"
+#include "effect_reshade.hpp"
+#include "image.hpp"
+#include "memory.hpp"
+#include "bench.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const uint32_t   runs        = 5;
+    const VkExtent2D imageExtent = {1920, 1080};
+    const VkFormat   format      = VK_FORMAT_B8G8R8A8_UNORM;
+
+    // a separable blur over render targets, about the size of the effects people stack in games
+    void writeEffect(const std::string& path)
+    {
+        std::ofstream file(path);
+        file << R"(
+uniform float BlurRadius < ui_type = "slider"; ui_min = 0.0; ui_max = 4.0; > = 1.5;
+uniform int   frameCount < source = "framecount"; >;
+
+texture BackBufferTex : COLOR;
+sampler BackBuffer { Texture = BackBufferTex; };
+
+texture HalfTex { Width = BUFFER_WIDTH / 2; Height = BUFFER_HEIGHT / 2; Format = RGBA16F; };
+texture BlurTex { Width = BUFFER_WIDTH / 2; Height = BUFFER_HEIGHT / 2; Format = RGBA16F; };
+sampler Half { Texture = HalfTex; };
+sampler Blur { Texture = BlurTex; };
+
+static const float Weights[8] = {0.1995, 0.1760, 0.1210, 0.0648, 0.0270, 0.0088, 0.0022, 0.0004};
+
+void FullscreenVS(in uint id : SV_VertexID, out float4 position : SV_Position, out float2 texcoord : TEXCOORD)
+{
+    texcoord.x = (id == 2) ? 2.0 : 0.0;
+    texcoord.y = (id == 1) ? 2.0 : 0.0;
+    position   = float4(texcoord * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+}
+
+float4 GaussianBlur(sampler source, float2 texcoord, float2 direction)
+{
+    float4 color = tex2D(source, texcoord) * Weights[0];
+    [unroll]
+    for (int i = 1; i < 8; i++)
+    {
+        float2 offset = direction * BUFFER_PIXEL_SIZE * i * BlurRadius;
+        color += tex2D(source, texcoord + offset) * Weights[i];
+        color += tex2D(source, texcoord - offset) * Weights[i];
+    }
+    return color;
+}
+
+float4 DownsamplePS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+    return tex2D(BackBuffer, texcoord);
+}
+
+float4 HorizontalPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+    return GaussianBlur(Half, texcoord, float2(2.0, 0.0));
+}
+
+float4 VerticalPS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+    return GaussianBlur(Blur, texcoord, float2(0.0, 2.0));
+}
+
+float4 CombinePS(float4 position : SV_Position, float2 texcoord : TEXCOORD) : SV_Target
+{
+    float4 color = tex2D(BackBuffer, texcoord);
+    float4 bloom = tex2D(Half, texcoord);
+    float  luma  = dot(bloom.rgb, float3(0.2126, 0.7152, 0.0722));
+    return lerp(color, color + bloom * saturate(luma - 0.5), 0.5 + (frameCount % 2) * 0.0);
+}
+
+technique Bloom
+{
+    pass { VertexShader = FullscreenVS; PixelShader = DownsamplePS; RenderTarget = HalfTex; }
+    pass { VertexShader = FullscreenVS; PixelShader = HorizontalPS; RenderTarget = BlurTex; }
+    pass { VertexShader = FullscreenVS; PixelShader = VerticalPS; RenderTarget = HalfTex; }
+    pass { VertexShader = FullscreenVS; PixelShader = CombinePS; }
+}
+)";
+    }
+
+    std::shared_ptr<Config> createConfig(const std::string& directory)
+    {
+        std::string effectPath = directory + "/bloom.fx";
+        writeEffect(effectPath);
+
+        std::string configPath = directory + "/vkBasalt.conf";
+        std::ofstream(configPath) << "bloom = " << effectPath << "\nreshadeIncludePath = " << directory << "\n";
+
+        setenv("VKBASALT_CONFIG_FILE", configPath.c_str(), 1);
+        return std::make_shared<Config>();
+    }
+
+    std::vector<VkImage> createImage(std::shared_ptr<LogicalDevice> pLogicalDevice, MemoryAllocation& memory)
+    {
+        return createImages(pLogicalDevice,
+                            1,
+                            {imageExtent.width, imageExtent.height, 1},
+                            format,
+                            VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            memory);
+    }
+} // namespace
+
+// Creating a reshade effect with an empty module cache, where it gets preprocessed, parsed and compiled to SPIR-V,
+// against creating it again once its module got cached. Both create the same pipelines, so that part runs on the mock as well
+TEST(coldAgainstWarmCreation)
+{
+    bool mock;
+    auto pLogicalDevice = createBenchLogicalDevice(mock);
+
+    std::string directory = (std::filesystem::temp_directory_path() / ("vkBasalt_reshade_" + std::to_string(getpid()))).string();
+    std::string cacheDir  = directory + "/cache";
+    std::filesystem::create_directories(directory);
+    setenv("XDG_CACHE_HOME", cacheDir.c_str(), 1);
+    auto pConfig = createConfig(directory);
+
+    MemoryAllocation     inputMemory;
+    MemoryAllocation     outputMemory;
+    std::vector<VkImage> inputImages  = createImage(pLogicalDevice, inputMemory);
+    std::vector<VkImage> outputImages = createImage(pLogicalDevice, outputMemory);
+
+    auto createEffect = [&]() { ReshadeEffect effect(pLogicalDevice, format, imageExtent, inputImages, outputImages, pConfig, "bloom"); };
+
+    double cold = measure("cold, empty module cache", runs, [&]() {
+        std::filesystem::remove_all(cacheDir);
+        createEffect();
+    });
+    // the last cold run left the module in the cache
+    CHECK(!std::filesystem::is_empty(cacheDir + "/vkBasalt"));
+    double warm = measure("warm, cached module", runs, createEffect);
+    CHECK(warm < cold);
+
+    pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, inputImages[0], nullptr);
+    pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, outputImages[0], nullptr);
+    freeMemory(pLogicalDevice, inputMemory);
+    freeMemory(pLogicalDevice, outputMemory);
+    std::filesystem::remove_all(directory);
+    unsetenv("XDG_CACHE_HOME");
+
+    destroyBenchLogicalDevice(pLogicalDevice, mock);
+}
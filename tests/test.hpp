@@ -0,0 +1,43 @@
+#ifndef TEST_HPP_INCLUDED
+#define TEST_HPP_INCLUDED
+#include <string>
+#include <vector>
+
+namespace vkBasalt::test
+{
+    struct TestCase
+    {
+        const char* name;
+        void (*function)();
+    };
+
+    std::vector<TestCase>& getTestCases();
+
+    struct TestRegistration
+    {
+        TestRegistration(const char* name, void (*function)())
+        {
+            getTestCases().push_back({name, function});
+        }
+    };
+
+    // records a failed check, the test keeps running so that one run shows every failing check
+    void fail(const char* file, int line, const std::string& expression);
+
+    // number of failed checks in this process
+    uint32_t failureCount();
+} // namespace vkBasalt::test
+
+// every test file is its own executable, test_main.cpp runs all tests that got registered with TEST
+#define TEST(name)                                                                                                                                   \
+    static void                             test_##name();                                                                                           \
+    static vkBasalt::test::TestRegistration registration_##name(#name, &test_##name);                                                                \
+    static void                             test_##name()
+
+#define CHECK(expression)                                                                                                                            \
+    if (!(expression))                                                                                                                               \
+    {                                                                                                                                                \
+        vkBasalt::test::fail(__FILE__, __LINE__, #expression);                                                                                       \
+    }
+
+#endif // TEST_HPP_INCLUDED
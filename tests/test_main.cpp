@@ -0,0 +1,51 @@
+#include "test.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <atomic>
+
+namespace vkBasalt::test
+{
+    namespace
+    {
+        std::atomic<uint32_t> failures = 0;
+    } // namespace
+
+    std::vector<TestCase>& getTestCases()
+    {
+        static std::vector<TestCase> testCases;
+        return testCases;
+    }
+
+    void fail(const char* file, int line, const std::string& expression)
+    {
+        failures++;
+        std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+    }
+
+    uint32_t failureCount()
+    {
+        return failures;
+    }
+} // namespace vkBasalt::test
+
+// usage: <test> [name of a test case]
+int main(int argc, char** argv)
+{
+    uint32_t testCount = 0;
+    for (const auto& testCase : vkBasalt::test::getTestCases())
+    {
+        if (argc > 1 && std::strcmp(argv[1], testCase.name))
+        {
+            continue;
+        }
+
+        uint32_t failuresBefore = vkBasalt::test::failureCount();
+        testCase.function();
+        testCount++;
+        std::cout << (vkBasalt::test::failureCount() == failuresBefore ? "[ OK ] " : "[FAIL] ") << testCase.name << std::endl;
+    }
+
+    std::cout << testCount << " tests, " << vkBasalt::test::failureCount() << " failed checks" << std::endl;
+    return vkBasalt::test::failureCount() ? 1 : 0;
+}
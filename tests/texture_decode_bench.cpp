@@ -0,0 +1,148 @@
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "texture_loader.hpp"
+#include "thread_pool.hpp"
+#include "texture_files.hpp"
+#include "bench.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const uint32_t runs = 5;
+
+    // VKBASALT_BENCH_TEXTURES can point to a directory with the textures of a shader pack,
+    // otherwise the benchmark decodes generated pngs and dds files of the size of typical noise and lut textures
+    std::vector<std::string> getTextureFiles(std::string& generatedDirectory)
+    {
+        std::vector<std::string> files;
+        if (const char* directory = std::getenv("VKBASALT_BENCH_TEXTURES"))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(directory))
+            {
+                std::string extension = entry.path().extension().string();
+                if (extension == ".png" || extension == ".dds")
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+            return files;
+        }
+
+        generatedDirectory = (std::filesystem::temp_directory_path() / ("vkBasalt_bench_" + std::to_string(getpid()))).string();
+        std::filesystem::create_directories(generatedDirectory);
+        for (uint32_t i = 0; i < 12; i++)
+        {
+            files.push_back(generatedDirectory + "/noise" + std::to_string(i) + ".png");
+            writePng(files.back(), 1024, 1024, createNoise(1024 * 1024 * 4, i));
+        }
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            files.push_back(generatedDirectory + "/normals" + std::to_string(i) + ".dds");
+            writeDds(files.back(), "DXT5", 0, 2048, 2048, 1, 16);
+        }
+        return files;
+    }
+
+    bool samePixels(const std::vector<TextureData>& a, const std::vector<TextureData>& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < a.size(); i++)
+        {
+            if (a[i].pixels != b[i].pixels)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+// what the constructor of ReshadeEffect did before and what it does now for the textures with a source annotation
+TEST(serialAgainstThreadPoolDecode)
+{
+    std::string              generatedDirectory;
+    std::vector<std::string> files = getTextureFiles(generatedDirectory);
+    CHECK(files.size() > 0);
+
+    std::vector<TextureData> serialTextures;
+    measure("decode " + std::to_string(files.size()) + " textures serially", runs, [&]() {
+        serialTextures.clear();
+        for (const auto& file : files)
+        {
+            serialTextures.push_back(loadTexture(file, VK_FORMAT_R8G8B8A8_UNORM, {1024, 1024, 1}, false));
+        }
+    });
+
+    std::vector<TextureData> parallelTextures;
+    measure("decode " + std::to_string(files.size()) + " textures on the thread pool", runs, [&]() {
+        std::vector<std::future<TextureData>> futures;
+        for (const auto& file : files)
+        {
+            futures.push_back(getThreadPool().submit([file]() { return loadTexture(file, VK_FORMAT_R8G8B8A8_UNORM, {1024, 1024, 1}, false); }));
+        }
+        parallelTextures.clear();
+        for (auto& future : futures)
+        {
+            parallelTextures.push_back(getThreadPool().wait(future));
+        }
+    });
+    CHECK(samePixels(serialTextures, parallelTextures));
+    if (generatedDirectory.size())
+    {
+        CHECK(serialTextures[0].pixels == createNoise(1024 * 1024 * 4, 0));
+    }
+
+    // r8g8 textures get decoded to rgba and repacked
+    measure("decode " + std::to_string(files.size()) + " r8g8 textures on the thread pool", runs, [&]() {
+        std::vector<std::future<TextureData>> futures;
+        for (const auto& file : files)
+        {
+            futures.push_back(getThreadPool().submit([file]() { return loadTexture(file, VK_FORMAT_R8G8_UNORM, {1024, 1024, 1}, false); }));
+        }
+        for (auto& future : futures)
+        {
+            getThreadPool().wait(future);
+        }
+    });
+
+    if (generatedDirectory.size())
+    {
+        std::filesystem::remove_all(generatedDirectory);
+    }
+}
+
+TEST(repackRGBAToRG)
+{
+    const size_t               pixelCount = 4096 * 4096;
+    std::vector<unsigned char> rgba       = createNoise(pixelCount * 4, 1);
+
+    std::vector<unsigned char> scalar(pixelCount * 2);
+    measure("repack 16 Mpixel scalar", runs, [&]() {
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            scalar[i * 2]     = rgba[i * 4];
+            scalar[i * 2 + 1] = rgba[i * 4 + 1];
+        }
+    });
+
+    std::vector<unsigned char> repacked(pixelCount * 2);
+    measure("repack 16 Mpixel repackRGBAToRG", runs, [&]() { repackRGBAToRG(rgba.data(), repacked.data(), pixelCount); });
+    CHECK(repacked == scalar);
+
+    // in place, like loadTexture does it
+    std::vector<unsigned char> inPlace = rgba;
+    repackRGBAToRG(inPlace.data(), inPlace.data(), pixelCount);
+    CHECK(std::equal(scalar.begin(), scalar.end(), inPlace.begin()));
+}
@@ -0,0 +1,138 @@
+#include "texture_files.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace vkBasalt::test
+{
+    namespace
+    {
+        uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+        {
+            crc = ~crc;
+            for (size_t i = 0; i < size; i++)
+            {
+                crc ^= data[i];
+                for (uint32_t bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+                }
+            }
+            return ~crc;
+        }
+
+        void appendBigEndian(std::vector<unsigned char>& data, uint32_t value)
+        {
+            data.push_back(value >> 24);
+            data.push_back(value >> 16);
+            data.push_back(value >> 8);
+            data.push_back(value);
+        }
+
+        void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& content)
+        {
+            std::vector<unsigned char> chunk;
+            appendBigEndian(chunk, content.size());
+            chunk.insert(chunk.end(), type, type + 4);
+            chunk.insert(chunk.end(), content.begin(), content.end());
+            appendBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+            file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+        }
+    } // namespace
+
+    void writePng(const std::string& path, uint32_t width, uint32_t height, const std::vector<unsigned char>& pixels)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write("\x89PNG\r\n\x1a\n", 8);
+
+        std::vector<unsigned char> header;
+        appendBigEndian(header, width);
+        appendBigEndian(header, height);
+        header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit rgba, no interlacing
+        writeChunk(file, "IHDR", header);
+
+        // every row starts with filter type none
+        std::vector<unsigned char> rows;
+        for (uint32_t y = 0; y < height; y++)
+        {
+            rows.push_back(0);
+            rows.insert(rows.end(), pixels.begin() + size_t(y) * width * 4, pixels.begin() + size_t(y + 1) * width * 4);
+        }
+
+        // a zlib stream of stored blocks
+        std::vector<unsigned char> stream = {0x78, 0x01};
+        for (size_t offset = 0; offset < rows.size() || offset == 0; offset += 65535)
+        {
+            size_t size = std::min<size_t>(rows.size() - offset, 65535);
+            stream.push_back(offset + size == rows.size() ? 1 : 0);
+            stream.insert(stream.end(), {uint8_t(size), uint8_t(size >> 8), uint8_t(~size), uint8_t(~size >> 8)});
+            stream.insert(stream.end(), rows.begin() + offset, rows.begin() + offset + size);
+        }
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (unsigned char byte : rows)
+        {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        appendBigEndian(stream, (b << 16) | a);
+        writeChunk(file, "IDAT", stream);
+
+        writeChunk(file, "IEND", {});
+    }
+
+    std::vector<unsigned char> writeDds(const std::string& path,
+                                        const char*        fourCC,
+                                        uint32_t           dxgiFormat,
+                                        uint32_t           width,
+                                        uint32_t           height,
+                                        uint32_t           mipLevels,
+                                        uint32_t           blockSize,
+                                        size_t             missingBytes)
+    {
+        size_t size = 0;
+        for (uint32_t i = 0; i < mipLevels; i++)
+        {
+            size += size_t((std::max(width >> i, 1u) + 3) / 4) * ((std::max(height >> i, 1u) + 3) / 4) * blockSize;
+        }
+        std::vector<unsigned char> blocks = createNoise(size, width * 31 + height * 17 + mipLevels);
+
+        // the magic number followed by the 124 byte DDS_HEADER
+        uint32_t header[32] = {};
+        header[0]           = 0x20534444; // "DDS "
+        header[1]           = 124;
+        header[2]           = 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000 | (mipLevels > 1 ? 0x20000 : 0);
+        header[3]           = height;
+        header[4]           = width;
+        header[5]           = ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+        header[7]           = mipLevels;
+        header[19]          = 32;
+        header[20]          = 0x4; // DDPF_FOURCC
+        header[27]          = 0x1000 | (mipLevels > 1 ? 0x400008 : 0);
+        std::memcpy(&header[21], fourCC, 4);
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        if (std::string(fourCC) == "DX10")
+        {
+            uint32_t header10[5] = {dxgiFormat, 3, 0, 1, 0}; // a single 2D texture
+            file.write(reinterpret_cast<const char*>(header10), sizeof(header10));
+        }
+        file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() - std::min(missingBytes, blocks.size()));
+
+        return blocks;
+    }
+
+    std::vector<unsigned char> createNoise(size_t size, uint32_t seed)
+    {
+        std::vector<unsigned char> noise(size);
+        uint32_t                   random = seed;
+        for (auto& byte : noise)
+        {
+            random = random * 1103515245 + 12345;
+            byte   = random >> 16;
+        }
+        return noise;
+    }
+} // namespace vkBasalt::test
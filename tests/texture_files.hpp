@@ -0,0 +1,29 @@
+#ifndef TEXTURE_FILES_HPP_INCLUDED
+#define TEXTURE_FILES_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace vkBasalt::test
+{
+    // writes rgba pixels as a png with uncompressed deflate blocks, stb_image reads it like any other png
+    void writePng(const std::string& path, uint32_t width, uint32_t height, const std::vector<unsigned char>& pixels);
+
+    // Writes a dds file of a block compressed 2D texture with random blocks and returns the blocks of all mip levels.
+    // fourCC is e.g. "DXT5" or "DX10", the latter writes the extended header with dxgiFormat.
+    // The last missingBytes bytes of the blocks get left out of the file, like a truncated download would.
+    std::vector<unsigned char> writeDds(const std::string& path,
+                                        const char*        fourCC,
+                                        uint32_t           dxgiFormat,
+                                        uint32_t           width,
+                                        uint32_t           height,
+                                        uint32_t           mipLevels,
+                                        uint32_t           blockSize,
+                                        size_t             missingBytes = 0);
+
+    // pixels that look like noise to a compressor
+    std::vector<unsigned char> createNoise(size_t size, uint32_t seed);
+} // namespace vkBasalt::test
+
+#endif // TEXTURE_FILES_HPP_INCLUDED
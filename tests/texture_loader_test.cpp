@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mock_device.hpp"
+#include "texture_loader.hpp"
+#include "texture_files.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const uint32_t dxgiFormatBC4 = 80;
+    const uint32_t dxgiFormatBC5 = 83;
+    const uint32_t dxgiFormatBC7 = 98;
+
+    std::string getPath(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / ("vkBasalt_" + std::to_string(getpid()) + "_" + name)).string();
+    }
+
+    std::shared_ptr<LogicalDevice> createDevice()
+    {
+        resetMock();
+        return createMockLogicalDevice();
+    }
+
+    VkFormat getFormat(std::shared_ptr<LogicalDevice> pLogicalDevice,
+                       const std::string&             path,
+                       VkFormat                       format,
+                       uint32_t                       size,
+                       uint32_t                       mipLevels = 1)
+    {
+        return getCompressedTextureFormat(pLogicalDevice, path, format, {size, size, 1}, mipLevels);
+    }
+
+    // the blocks of the first mipLevels levels
+    std::vector<unsigned char> firstLevels(const std::vector<unsigned char>& blocks, uint32_t size, uint32_t mipLevels, uint32_t blockSize)
+    {
+        size_t levelsSize = 0;
+        for (uint32_t i = 0; i < mipLevels; i++)
+        {
+            uint32_t blocksPerRow = (std::max(size >> i, 1u) + 3) / 4;
+            levelsSize += size_t(blocksPerRow) * blocksPerRow * blockSize;
+        }
+        return std::vector<unsigned char>(blocks.begin(), blocks.begin() + levelsSize);
+    }
+} // namespace
+
+TEST(legacyHeader)
+{
+    auto        pLogicalDevice = createDevice();
+    std::string path           = getPath("dxt5.dds");
+
+    std::vector<unsigned char> blocks = writeDds(path, "DXT5", 0, 256, 256, 1, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256) == VK_FORMAT_BC3_UNORM_BLOCK);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_SRGB, 256) == VK_FORMAT_BC3_UNORM_BLOCK);
+
+    TextureData texture = loadCompressedTexture(path, VK_FORMAT_BC3_UNORM_BLOCK, {256, 256, 1}, 1);
+    CHECK(texture.pixels == blocks);
+    CHECK(texture.extent.width == 256 && texture.extent.height == 256);
+
+    writeDds(path, "DXT1", 0, 256, 256, 1, 8);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256) == VK_FORMAT_BC1_RGBA_UNORM_BLOCK);
+    writeDds(path, "ATI2", 0, 256, 256, 1, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8_UNORM, 256) == VK_FORMAT_BC5_UNORM_BLOCK);
+
+    // the decoded texture would have other channels than the compressed one
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256) == VK_FORMAT_UNDEFINED);
+
+    // stb decodes the same file when it can't get uploaded compressed
+    writeDds(path, "DXT5", 0, 256, 256, 1, 16);
+    TextureData decoded = loadTexture(path, VK_FORMAT_R8G8B8A8_UNORM, {256, 256, 1}, false);
+    CHECK(decoded.pixels.size() == 256 * 256 * 4);
+
+    std::filesystem::remove(path);
+    destroyMockLogicalDevice(pLogicalDevice);
+}
+
+TEST(dx10Header)
+{
+    auto        pLogicalDevice = createDevice();
+    std::string path           = getPath("dx10.dds");
+
+    std::vector<unsigned char> blocks = writeDds(path, "DX10", dxgiFormatBC7, 128, 128, 1, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 128) == VK_FORMAT_BC7_UNORM_BLOCK);
+    // the payload starts after the extended header
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC7_UNORM_BLOCK, {128, 128, 1}, 1).pixels == blocks);
+
+    writeDds(path, "DX10", dxgiFormatBC4, 128, 128, 1, 8);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8_UNORM, 128) == VK_FORMAT_BC4_UNORM_BLOCK);
+    writeDds(path, "DX10", dxgiFormatBC5, 128, 128, 1, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8_UNORM, 128) == VK_FORMAT_BC5_UNORM_BLOCK);
+
+    // a format that only gets decoded, DXGI_FORMAT_BC6H_UF16
+    writeDds(path, "DX10", 95, 128, 128, 1, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 128) == VK_FORMAT_UNDEFINED);
+
+    std::filesystem::remove(path);
+    destroyMockLogicalDevice(pLogicalDevice);
+}
+
+TEST(mipLevels)
+{
+    auto        pLogicalDevice = createDevice();
+    std::string path           = getPath("mips.dds");
+
+    // the precomputed mip chain gets used as far as the texture needs it
+    std::vector<unsigned char> blocks = writeDds(path, "DXT5", 0, 256, 256, 9, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256, 9) == VK_FORMAT_BC3_UNORM_BLOCK);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256, 4) == VK_FORMAT_BC3_UNORM_BLOCK);
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC3_UNORM_BLOCK, {256, 256, 1}, 9).pixels == blocks);
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC3_UNORM_BLOCK, {256, 256, 1}, 4).pixels == firstLevels(blocks, 256, 4, 16));
+
+    // compressed levels can't get generated by a blit, so a file with too few levels gets decoded
+    writeDds(path, "DXT5", 0, 256, 256, 3, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256, 4) == VK_FORMAT_UNDEFINED);
+    writeDds(path, "DX10", dxgiFormatBC7, 256, 256, 1, 16);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256, 2) == VK_FORMAT_UNDEFINED);
+
+    // neither can they get resized
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 128, 1) == VK_FORMAT_UNDEFINED);
+
+    std::filesystem::remove(path);
+    destroyMockLogicalDevice(pLogicalDevice);
+}
+
+TEST(truncatedFiles)
+{
+    auto        pLogicalDevice = createDevice();
+    std::string path           = getPath("truncated.dds");
+
+    // the header is complete, but the blocks are not
+    writeDds(path, "DXT5", 0, 256, 256, 1, 16, 100);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256) == VK_FORMAT_BC3_UNORM_BLOCK);
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC3_UNORM_BLOCK, {256, 256, 1}, 1).pixels.empty());
+
+    // the first levels are there, the last one is not
+    writeDds(path, "DXT5", 0, 256, 256, 9, 16, 1);
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC3_UNORM_BLOCK, {256, 256, 1}, 8).pixels.size() > 0);
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC3_UNORM_BLOCK, {256, 256, 1}, 9).pixels.empty());
+
+    // the extended header is missing
+    writeDds(path, "DX10", dxgiFormatBC7, 256, 256, 1, 16);
+    std::filesystem::resize_file(path, 128 + 10);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256) == VK_FORMAT_UNDEFINED);
+
+    // the header is cut off
+    std::filesystem::resize_file(path, 60);
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 256) == VK_FORMAT_UNDEFINED);
+    CHECK(loadCompressedTexture(path, VK_FORMAT_BC7_UNORM_BLOCK, {256, 256, 1}, 1).pixels.empty());
+
+    // no dds file at all
+    writePng(path, 4, 4, createNoise(4 * 4 * 4, 1));
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 4) == VK_FORMAT_UNDEFINED);
+    CHECK(getFormat(pLogicalDevice, getPath("missing.dds"), VK_FORMAT_R8G8B8A8_UNORM, 4) == VK_FORMAT_UNDEFINED);
+
+    std::filesystem::remove(path);
+    destroyMockLogicalDevice(pLogicalDevice);
+}
+
+// devices that can't sample the compressed format get the decoded texture
+TEST(formatSupport)
+{
+    std::string path = getPath("support.dds");
+    writeDds(path, "DXT5", 0, 64, 64, 1, 16);
+
+    resetMock();
+    getMockSettings().features.textureCompressionBC = VK_FALSE;
+    auto pLogicalDevice                             = createMockLogicalDevice();
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 64) == VK_FORMAT_UNDEFINED);
+    destroyMockLogicalDevice(pLogicalDevice);
+
+    resetMock();
+    getMockSettings().optimalTilingFeatures = VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    pLogicalDevice                          = createMockLogicalDevice();
+    CHECK(getFormat(pLogicalDevice, path, VK_FORMAT_R8G8B8A8_UNORM, 64) == VK_FORMAT_UNDEFINED);
+    destroyMockLogicalDevice(pLogicalDevice);
+
+    std::filesystem::remove(path);
+}
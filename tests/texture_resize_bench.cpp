@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include <unistd.h>
+
+#include "mock_device.hpp"
+#include "image.hpp"
+#include "memory.hpp"
+#include "texture_loader.hpp"
+#include "texture_files.hpp"
+#include "bench.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    const uint32_t runs = 5;
+} // namespace
+
+// A texture file that is bigger than the texture it gets declared as, like a 4k noise texture for a 1k texture.
+// Run this with a gpu or lavapipe, without a vulkan driver it runs on the mock and the gpu time of the blit is missing
+TEST(cpuAgainstBlitResize)
+{
+    bool mock;
+    auto pLogicalDevice = createBenchLogicalDevice(mock);
+
+    const VkFormat   format     = VK_FORMAT_R8G8B8A8_UNORM;
+    const VkExtent3D extent     = {1024, 1024, 1};
+    const uint32_t   mipLevels  = 11;
+    const uint32_t   sourceSize = 4096;
+
+    std::string path = (std::filesystem::temp_directory_path() / ("vkBasalt_resize_" + std::to_string(getpid()) + ".png")).string();
+    writePng(path, sourceSize, sourceSize, createNoise(sourceSize * sourceSize * 4, 1));
+
+    if (!supportsBlitResize(pLogicalDevice, format))
+    {
+        std::printf("the device can't blit the format with a linear filter, skipped\n");
+    }
+    else
+    {
+        MemoryAllocation imageMemory;
+        VkImage          image = createImages(pLogicalDevice,
+                                     1,
+                                     extent,
+                                     format,
+                                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                     imageMemory,
+                                     mipLevels)[0];
+
+        measure("decode only", runs, [&]() { loadTexture(path, format, extent, false); });
+
+        // the upload waits for the gpu when its batch ends
+        measure("decode, resize on the cpu and upload", runs, [&]() {
+            TextureData texture = loadTexture(path, format, extent, true);
+            CHECK(texture.extent.width == extent.width);
+            uploadToImage(pLogicalDevice, image, extent, texture.pixels.size(), texture.pixels.data(), mipLevels);
+        });
+
+        measure("decode, upload and blit on the gpu", runs, [&]() {
+            TextureData texture = loadTexture(path, format, extent, false);
+            CHECK(texture.extent.width == sourceSize);
+            uploadResizedToImage(
+                pLogicalDevice, image, extent, format, texture.extent, texture.pixels.size(), texture.pixels.data(), mipLevels);
+        });
+
+        pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+        freeMemory(pLogicalDevice, imageMemory);
+    }
+
+    std::filesystem::remove(path);
+    destroyBenchLogicalDevice(pLogicalDevice, mock);
+}
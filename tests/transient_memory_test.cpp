@@ -0,0 +1,247 @@
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "mock_device.hpp"
+#include "transient_memory.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    struct Binding
+    {
+        VkDeviceMemory memory;
+        VkDeviceSize   offset;
+        VkDeviceSize   size;
+    };
+
+    // where the images got bound, recorded by wrapping BindImageMemory of the device
+    std::map<VkImage, Binding>     bindings;
+    PFN_vkBindImageMemory          mockBindImageMemory;
+    std::shared_ptr<LogicalDevice> pBindingDevice;
+
+    VKAPI_ATTR VkResult VKAPI_CALL recordBindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+    {
+        VkMemoryRequirements memoryRequirements;
+        pBindingDevice->vkd.GetImageMemoryRequirements(device, image, &memoryRequirements);
+        bindings[image] = {memory, memoryOffset, memoryRequirements.size};
+        return mockBindImageMemory(device, image, memory, memoryOffset);
+    }
+
+    std::shared_ptr<LogicalDevice> createDevice()
+    {
+        resetMock();
+        bindings.clear();
+
+        pBindingDevice                      = createMockLogicalDevice();
+        mockBindImageMemory                 = pBindingDevice->vkd.BindImageMemory;
+        pBindingDevice->vkd.BindImageMemory = recordBindImageMemory;
+        return pBindingDevice;
+    }
+
+    void destroyDevice(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        for (auto& binding : bindings)
+        {
+            pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, binding.first, nullptr);
+        }
+        bindings.clear();
+        pBindingDevice.reset();
+
+        destroyMockLogicalDevice(pLogicalDevice);
+        CHECK(getMockStatistics().liveImages == 0);
+        CHECK(getMockStatistics().liveMemoryAllocations == 0);
+        CHECK(getMockStatistics().validationErrors == 0);
+    }
+
+    // the mock makes the memory requirements of an image 8 bytes per texel
+    std::vector<VkImage> createImages(std::shared_ptr<LogicalDevice> pLogicalDevice, uint32_t count, uint32_t width)
+    {
+        VkImageCreateInfo imageCreateInfo = {};
+        imageCreateInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType         = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format            = VK_FORMAT_R8G8B8A8_UNORM;
+        imageCreateInfo.extent            = {width, 64, 1};
+        imageCreateInfo.mipLevels         = 1;
+        imageCreateInfo.arrayLayers       = 1;
+        imageCreateInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.usage             = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+        std::vector<VkImage> images(count);
+        for (auto& image : images)
+        {
+            CHECK(pLogicalDevice->vkd.CreateImage(pLogicalDevice->device, &imageCreateInfo, nullptr, &image) == VK_SUCCESS);
+        }
+        return images;
+    }
+
+    bool sameRange(VkImage a, VkImage b)
+    {
+        return bindings[a].memory == bindings[b].memory && bindings[a].offset == bindings[b].offset;
+    }
+
+    bool sharesMemory(VkImage a, VkImage b)
+    {
+        const Binding& first  = bindings[a];
+        const Binding& second = bindings[b];
+        return first.memory == second.memory && first.offset < second.offset + second.size && second.offset < first.offset + first.size;
+    }
+} // namespace
+
+// the images between the effects of a chain only live from the effect that writes them to the effect that reads them
+TEST(chainPingPongsBetweenTwoRanges)
+{
+    const uint32_t imageCount  = 3;
+    const uint32_t effectCount = 6;
+
+    auto pLogicalDevice = createDevice();
+    {
+        TransientImageMemory transientMemory(pLogicalDevice, imageCount, true);
+
+        std::vector<std::vector<VkImage>> links;
+        for (uint32_t i = 0; i + 1 < effectCount; i++)
+        {
+            links.push_back(createImages(pLogicalDevice, imageCount, 256));
+            transientMemory.bindImages(links.back(), i, i + 1);
+        }
+
+        for (uint32_t lane = 0; lane < imageCount; lane++)
+        {
+            for (uint32_t i = 0; i + 1 < links.size(); i++)
+            {
+                CHECK(!sharesMemory(links[i][lane], links[i + 1][lane]));
+            }
+            for (uint32_t i = 0; i + 2 < links.size(); i++)
+            {
+                CHECK(sameRange(links[i][lane], links[i + 2][lane]));
+            }
+        }
+
+        // the lanes of different swapchain images never share memory, their command buffers may run at the same time
+        for (auto& first : links)
+        {
+            for (auto& second : links)
+            {
+                for (uint32_t lane = 0; lane < imageCount; lane++)
+                {
+                    for (uint32_t otherLane = lane + 1; otherLane < imageCount; otherLane++)
+                    {
+                        CHECK(!sharesMemory(first[lane], second[otherLane]));
+                    }
+                }
+            }
+        }
+    }
+    destroyDevice(pLogicalDevice);
+}
+
+TEST(overlappingLifetimesNeverShareMemory)
+{
+    auto pLogicalDevice = createDevice();
+    {
+        TransientImageMemory transientMemory(pLogicalDevice, 2, true);
+
+        struct Lifetime
+        {
+            VkImage  image;
+            uint32_t firstEffect;
+            uint32_t lastEffect;
+        };
+
+        std::vector<Lifetime> lifetimes;
+        uint32_t              random = 12345;
+        for (uint32_t i = 0; i < 200; i++)
+        {
+            random               = random * 1103515245 + 12345;
+            uint32_t firstEffect = (random >> 8) % 16;
+            uint32_t lastEffect  = firstEffect + (random >> 16) % 4;
+            uint32_t width       = 16 << ((random >> 4) % 5);
+
+            // a single image goes into the lane that all swapchain images share
+            VkImage image = createImages(pLogicalDevice, 1, width)[0];
+            transientMemory.bindImages({image}, firstEffect, lastEffect);
+            lifetimes.push_back({image, firstEffect, lastEffect});
+        }
+
+        uint32_t aliasedPairs = 0;
+        for (uint32_t i = 0; i < lifetimes.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < lifetimes.size(); j++)
+            {
+                const Lifetime& a = lifetimes[i];
+                const Lifetime& b = lifetimes[j];
+                if (a.firstEffect <= b.lastEffect && b.firstEffect <= a.lastEffect)
+                {
+                    CHECK(!sharesMemory(a.image, b.image));
+                }
+                else if (sharesMemory(a.image, b.image))
+                {
+                    aliasedPairs++;
+                }
+            }
+        }
+        CHECK(aliasedPairs > 0);
+    }
+    destroyDevice(pLogicalDevice);
+}
+
+TEST(withoutAliasingNothingSharesMemory)
+{
+    auto pLogicalDevice = createDevice();
+    {
+        TransientImageMemory transientMemory(pLogicalDevice, 1, false);
+        CHECK(!transientMemory.isAliasing());
+
+        std::vector<VkImage> images;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            images.push_back(createImages(pLogicalDevice, 1, 256)[0]);
+            transientMemory.bindImages({images.back()}, i, i);
+        }
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < images.size(); j++)
+            {
+                CHECK(!sharesMemory(images[i], images[j]));
+            }
+        }
+    }
+    destroyDevice(pLogicalDevice);
+}
+
+// the images that an effect creates for itself only live while the effect gets applied
+TEST(scopeBindsToTheCurrentEffect)
+{
+    auto pLogicalDevice = createDevice();
+    {
+        TransientImageMemory transientMemory(pLogicalDevice, 1, true);
+
+        std::vector<VkImage> first  = createImages(pLogicalDevice, 2, 256);
+        std::vector<VkImage> second = createImages(pLogicalDevice, 2, 256);
+
+        // outside of a scope nothing gets bound
+        bindTransientImages({first[0]});
+        CHECK(bindings.empty());
+
+        {
+            TransientImageScope scope(&transientMemory, 0);
+            bindTransientImages({first[0]});
+            bindTransientImages({first[1]});
+        }
+        {
+            TransientImageScope scope(&transientMemory, 1);
+            bindTransientImages({second[0]});
+            bindTransientImages({second[1]});
+        }
+
+        CHECK(!sharesMemory(first[0], first[1]));
+        CHECK(!sharesMemory(second[0], second[1]));
+        CHECK(sameRange(first[0], second[0]));
+        CHECK(sameRange(first[1], second[1]));
+    }
+    destroyDevice(pLogicalDevice);
+}
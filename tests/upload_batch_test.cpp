@@ -0,0 +1,320 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mock_device.hpp"
+#include "upload_batch.hpp"
+#include "memory.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+using namespace vkBasalt::test;
+
+namespace
+{
+    VkImage createImage(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        VkImageCreateInfo imageCreateInfo = {};
+        imageCreateInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType         = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format            = VK_FORMAT_R8G8B8A8_UNORM;
+        imageCreateInfo.extent            = {64, 64, 1};
+        imageCreateInfo.mipLevels         = 1;
+        imageCreateInfo.arrayLayers       = 1;
+        imageCreateInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.usage             = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        VkImage image;
+        CHECK(pLogicalDevice->vkd.CreateImage(pLogicalDevice->device, &imageCreateInfo, nullptr, &image) == VK_SUCCESS);
+        return image;
+    }
+
+    // what uploadToImage records for a texture of an effect, the staging image stands in for the source of a mip map generation
+    void recordUpload(std::shared_ptr<LogicalDevice> pLogicalDevice, VkImage image)
+    {
+        UploadBatch* pBatch = UploadBatch::current();
+        CHECK(pBatch != nullptr);
+
+        std::vector<char> texels(64 * 64 * 4, 1);
+        VkBuffer          stagingBuffer;
+        VkDeviceSize      stagingOffset;
+        pBatch->stage(texels.data(), texels.size(), stagingBuffer, stagingOffset);
+
+        VkBufferImageCopy region           = {};
+        region.bufferOffset                = stagingOffset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent                 = {64, 64, 1};
+        pLogicalDevice->vkd.CmdCopyBufferToImage(
+            pBatch->getCommandBuffer(), stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        VkImage              stagingImage = createImage(pLogicalDevice);
+        VkMemoryRequirements memoryRequirements;
+        pLogicalDevice->vkd.GetImageMemoryRequirements(pLogicalDevice->device, stagingImage, &memoryRequirements);
+        MemoryAllocation stagingImageMemory = allocateMemory(pLogicalDevice, memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+        pBatch->keepImage(stagingImage, stagingImageMemory);
+    }
+
+    // the present of the application that the layer adds its command buffer to
+    void submitPresent(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool                 = pLogicalDevice->commandPool;
+        allocInfo.commandBufferCount          = 1;
+
+        VkCommandBuffer commandBuffer;
+        CHECK(pLogicalDevice->vkd.AllocateCommandBuffers(pLogicalDevice->device, &allocInfo, &commandBuffer) == VK_SUCCESS);
+        initializeDispatchTable(commandBuffer, pLogicalDevice->device);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        pLogicalDevice->vkd.BeginCommandBuffer(commandBuffer, &beginInfo);
+        pLogicalDevice->vkd.CmdDraw(commandBuffer, 3, 1, 0, 0);
+        pLogicalDevice->vkd.EndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo       = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+        CHECK(pLogicalDevice->vkd.QueueSubmit(pLogicalDevice->queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+
+        completeMockQueue();
+        pLogicalDevice->vkd.FreeCommandBuffers(pLogicalDevice->device, pLogicalDevice->commandPool, 1, &commandBuffer);
+    }
+
+    // stages size bytes, the command buffer of the batch stands in for the copy from them
+    void recordStaging(UploadBatch& batch, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset)
+    {
+        std::vector<char> data(size, 1);
+        batch.stage(data.data(), size, buffer, offset);
+        batch.getCommandBuffer();
+    }
+
+    // like vkDestroyDevice, which waits for the batches and frees the staging ring before it destroys the device
+    void destroyDevice(std::shared_ptr<LogicalDevice> pLogicalDevice)
+    {
+        flushPendingSubmits(pLogicalDevice, true);
+        CHECK(pLogicalDevice->stagingRing.buffer == VK_NULL_HANDLE);
+        destroyMockLogicalDevice(pLogicalDevice);
+    }
+
+    void checkCleanShutdown()
+    {
+        MockStatistics statistics = getMockStatistics();
+        CHECK(statistics.validationErrors == 0);
+        CHECK(statistics.blockedWaits == 0);
+        CHECK(statistics.liveImages == 0);
+        CHECK(statistics.liveMemoryAllocations == 0);
+    }
+} // namespace
+
+// without deferral a batch gets submitted and waited on when it goes out of scope
+TEST(batchSubmitsAtTheEndOfItsScope)
+{
+    resetMock();
+    auto    pLogicalDevice = createMockLogicalDevice();
+    VkImage image          = createImage(pLogicalDevice);
+
+    CHECK(UploadBatch::current() == nullptr);
+    {
+        UploadBatch batch(pLogicalDevice);
+        CHECK(UploadBatch::current() == &batch);
+        recordUpload(pLogicalDevice, image);
+        recordUpload(pLogicalDevice, image);
+        CHECK(getMockStatistics().submits == 0);
+    }
+    CHECK(UploadBatch::current() == nullptr);
+
+    // one submit for both uploads, the staging image is gone once the submit is done
+    MockStatistics statistics = getMockStatistics();
+    CHECK(statistics.submits == 1);
+    CHECK(statistics.submitted.copies == 2);
+    CHECK(statistics.liveImages == 1);
+    CHECK(pLogicalDevice->pendingSubmits.empty());
+
+    // a batch without commands does not submit
+    {
+        UploadBatch batch(pLogicalDevice);
+    }
+    CHECK(getMockStatistics().submits == 1);
+
+    pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+    destroyDevice(pLogicalDevice);
+    checkCleanShutdown();
+}
+
+// the effects get created on a thread of the layer while the application owns the queue,
+// their uploads have to be submitted by the present that swaps the effects in, before the commands that sample the textures
+TEST(backgroundUploadsGetFlushedBeforeTheFirstPresent)
+{
+    resetMock();
+    auto    pLogicalDevice = createMockLogicalDevice();
+    VkImage image          = createImage(pLogicalDevice);
+
+    pLogicalDevice->deferSubmitCount++;
+    std::vector<std::thread> effectThreads;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        effectThreads.emplace_back([&]() {
+            UploadBatch batch(pLogicalDevice);
+            recordUpload(pLogicalDevice, image);
+        });
+    }
+    for (auto& thread : effectThreads)
+    {
+        thread.join();
+    }
+    pLogicalDevice->deferSubmitCount--;
+
+    // nothing touched the queue of the application yet
+    CHECK(getMockStatistics().submits == 0);
+    CHECK(pLogicalDevice->pendingSubmits.size() == 3);
+    CHECK(getMockStatistics().liveImages == 4);
+
+    // the present that activates the effects
+    flushPendingSubmits(pLogicalDevice, false);
+    MockStatistics statistics = getMockStatistics();
+    CHECK(statistics.submits == 1);
+    CHECK(statistics.submittedCommandBuffers == 3);
+    CHECK(statistics.submitted.copies == 3);
+    CHECK(statistics.submitted.draws == 0);
+    CHECK(pLogicalDevice->pendingSubmits.empty());
+
+    submitPresent(pLogicalDevice);
+    CHECK(getMockStatistics().submitted.draws == 1);
+
+    // the next present releases the batches without waiting, their staging images are gone then
+    flushPendingSubmits(pLogicalDevice, false);
+    CHECK(pLogicalDevice->submittedPendingSubmits.empty());
+    CHECK(getMockStatistics().liveImages == 1);
+
+    pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+    destroyDevice(pLogicalDevice);
+    checkCleanShutdown();
+}
+
+// destroying a swapchain flushes with wait, nothing may still be in flight afterwards
+TEST(flushWithWaitReleasesEverything)
+{
+    resetMock();
+    auto    pLogicalDevice = createMockLogicalDevice();
+    VkImage image          = createImage(pLogicalDevice);
+
+    pLogicalDevice->deferSubmitCount++;
+    {
+        UploadBatch batch(pLogicalDevice);
+        recordUpload(pLogicalDevice, image);
+
+        // a nested batch records into its own command buffer and restores the outer one
+        {
+            UploadBatch nestedBatch(pLogicalDevice);
+            recordUpload(pLogicalDevice, image);
+        }
+        CHECK(UploadBatch::current() == &batch);
+        CHECK(pLogicalDevice->pendingSubmits.size() == 1);
+    }
+    pLogicalDevice->deferSubmitCount--;
+    CHECK(pLogicalDevice->pendingSubmits.size() == 2);
+
+    flushPendingSubmits(pLogicalDevice, true);
+    CHECK(pLogicalDevice->pendingSubmits.empty());
+    CHECK(pLogicalDevice->submittedPendingSubmits.empty());
+    CHECK(getMockStatistics().submitted.copies == 2);
+    CHECK(getMockStatistics().liveImages == 1);
+
+    // nothing left to submit
+    flushPendingSubmits(pLogicalDevice, true);
+    CHECK(getMockStatistics().submits == 1);
+
+    pLogicalDevice->vkd.DestroyImage(pLogicalDevice->device, image, nullptr);
+    destroyDevice(pLogicalDevice);
+    checkCleanShutdown();
+}
+
+// the batches of all effects sub-allocate their staging data from the ring of the device instead of allocating buffers of their own
+TEST(batchesShareTheStagingRing)
+{
+    resetMock();
+    auto pLogicalDevice = createMockLogicalDevice();
+    auto ringBuffer     = [&]() { return pLogicalDevice->stagingRing.buffer; };
+
+    VkBuffer     buffer;
+    VkDeviceSize offset;
+    VkBuffer     firstBuffer;
+    {
+        UploadBatch batch(pLogicalDevice);
+        recordStaging(batch, 100, firstBuffer, offset);
+        CHECK(firstBuffer == ringBuffer());
+        CHECK(offset == 0);
+        // the next range starts aligned
+        recordStaging(batch, 100, buffer, offset);
+        CHECK(buffer == firstBuffer);
+        CHECK(offset == 112);
+    }
+
+    // an effect that gets created after the first one got uploaded starts at the front of the same ring again
+    {
+        UploadBatch batch(pLogicalDevice);
+        recordStaging(batch, 100, buffer, offset);
+        CHECK(buffer == firstBuffer);
+        CHECK(offset == 0);
+    }
+
+    // a texture that would take most of the ring gets a staging buffer of the batch
+    {
+        UploadBatch batch(pLogicalDevice);
+        recordStaging(batch, stagingRingSize / 2, buffer, offset);
+        CHECK(buffer != ringBuffer());
+    }
+    CHECK(getMockStatistics().submits == 3);
+    CHECK(pLogicalDevice->stagingRing.ranges.empty());
+
+    destroyDevice(pLogicalDevice);
+    checkCleanShutdown();
+}
+
+// the range of a batch that is still open keeps the ring from reusing it, like an effect whose textures take a while,
+// while the batches of other effects finish around it. A full ring must not block them
+TEST(fullStagingRingWrapsAroundAndFallsBack)
+{
+    resetMock();
+    auto               pLogicalDevice = createMockLogicalDevice();
+    const VkDeviceSize quarter        = stagingRingSize / 4;
+
+    VkBuffer     buffer;
+    VkDeviceSize offset;
+    {
+        UploadBatch batch(pLogicalDevice);
+        {
+            UploadBatch firstBatch(pLogicalDevice);
+            recordStaging(firstBatch, quarter, buffer, offset);
+            CHECK(offset == 0);
+            recordStaging(batch, quarter, buffer, offset);
+            CHECK(offset == quarter);
+        }
+        // the first quarter is free again, but the ring continues behind the range of the open batch
+        {
+            UploadBatch secondBatch(pLogicalDevice);
+            recordStaging(secondBatch, quarter, buffer, offset);
+            CHECK(offset == 2 * quarter);
+            recordStaging(secondBatch, quarter, buffer, offset);
+            CHECK(offset == 3 * quarter);
+            // wraps around to the front up to the range of the open batch
+            recordStaging(secondBatch, quarter, buffer, offset);
+            CHECK(buffer == pLogicalDevice->stagingRing.buffer);
+            CHECK(offset == 0);
+            // and the ring is full
+            recordStaging(secondBatch, quarter, buffer, offset);
+            CHECK(buffer != pLogicalDevice->stagingRing.buffer);
+        }
+        // the ranges of the second batch are done, but they are behind the one of the open batch
+        CHECK(pLogicalDevice->stagingRing.ranges.size() == 4);
+    }
+    CHECK(pLogicalDevice->stagingRing.ranges.empty());
+    CHECK(getMockStatistics().submits == 3);
+
+    destroyDevice(pLogicalDevice);
+    checkCleanShutdown();
+}
@@ -0,0 +1,45 @@
+#include <set>
+#include <thread>
+#include <mutex>
+
+#include "util.hpp"
+#include "test.hpp"
+
+using namespace vkBasalt;
+
+// the effects write their cache files from several threads at once, two writers must never share a temporary file
+TEST(tempFileNamesAreUnique)
+{
+    std::mutex               namesMutex;
+    std::set<std::string>    names;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&]() {
+            for (uint32_t j = 0; j < 1000; j++)
+            {
+                std::string name = getTempFileName("/cache/module");
+                CHECK(name.rfind("/cache/module.", 0) == 0);
+                CHECK(name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0);
+
+                std::lock_guard<std::mutex> lock(namesMutex);
+                names.insert(name);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    CHECK(names.size() == 8000);
+}
+
+TEST(hashString)
+{
+    // the FNV-1a test vectors
+    CHECK(hashString("") == 0xcbf29ce484222325ull);
+    CHECK(hashString("a") == 0xaf63dc4c8601ec8cull);
+    CHECK(hashString("foobar") == 0x85944171f73967e8ull);
+    // hashing in parts is the same as hashing everything at once
+    CHECK(hashString("bar", hashString("foo")) == hashString("foobar"));
+}